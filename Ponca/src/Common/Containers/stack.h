@@ -40,6 +40,16 @@ namespace Ponca
         /// Get the number of elements in the Stack
         PONCA_MULTIARCH inline int size() const;
 
+        /// Read access to the i-th element of the Stack, starting from the bottom
+        PONCA_MULTIARCH inline const T& operator[](int i) const;
+        /// Write access to the i-th element of the Stack, starting from the bottom
+        PONCA_MULTIARCH inline T& operator[](int i);
+
+        /// Access to the fixed-size buffer, storing the size() elements of the Stack from the bottom
+        PONCA_MULTIARCH inline const T* data() const { return m_data.data(); }
+        /// \copydoc data() const
+        PONCA_MULTIARCH inline T* data() { return m_data.data(); }
+
         /// Add an element on top of the stack.
         /// \throw std::out_of_range when the Stack is full, only if compiled with PONCA_DEBUG
         PONCA_MULTIARCH inline void push(const T& value);
@@ -37,6 +37,18 @@ namespace Ponca
         return m_size;
     }
 
+    template <class T, int N>
+    const T& Stack<T, N>::operator[](int i) const
+    {
+        return STD_SAFE_AT(m_data, i);
+    }
+
+    template <class T, int N>
+    T& Stack<T, N>::operator[](int i)
+    {
+        return STD_SAFE_AT(m_data, i);
+    }
+
     template <class T, int N>
     void Stack<T, N>::push(const T& value)
     {
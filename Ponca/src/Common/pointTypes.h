@@ -9,6 +9,8 @@ This Source Code Form is subject to the terms of the Mozilla Public
 #include "./defines.h"
 #include <Eigen/Core>
 
+#include <type_traits>
+
 /*!
   \file pointTypes.h
   \brief Useful user-end DataPoint types
@@ -161,4 +163,67 @@ namespace Ponca
         const int m_id;
     };
     // [PointPositionNormalLazyBinding]
+
+    // [MixedPrecisionPoint]
+    /*! \brief Adapter reading a point in a higher precision scalar type
+     *
+     * The fitting objects use the Scalar type of their DataPoint both to read the points and to accumulate their
+     * statistics. With this adapter, the points can be stored in single precision to save memory, while the
+     * statistics are accumulated and the primitives are solved in double precision:
+     * \snippet mixed_precision.cpp MixedPrecisionFitType
+     *
+     * The adapter is implicitly constructible from `P`, so the containers of `P` can be passed to the fitting
+     * objects as is: each neighbor is converted when it is added to the fit.
+     *
+     * \tparam P Point type used to store the points, providing `pos()` and optionally `normal()`
+     * \tparam AccumScalar Scalar type used by the fitting objects
+     */
+    template <typename P, typename AccumScalar = double>
+    class MixedPrecisionPoint
+    {
+    public:
+        enum
+        {
+            Dim = P::Dim
+        };
+        using Scalar      = AccumScalar;
+        using VectorType  = Eigen::Matrix<Scalar, Dim, 1>;
+        using MatrixType  = Eigen::Matrix<Scalar, Dim, Dim>;
+        using StoredPoint = P; ///< Point type used to store the points
+
+        /// \brief Does the stored point type provide normals
+        static constexpr bool hasNormal = requires(const P& p) { p.normal(); };
+
+        PONCA_MULTIARCH inline MixedPrecisionPoint(const VectorType& pos    = VectorType::Zero(),
+                                                   const VectorType& normal = VectorType::Zero())
+            : m_pos(pos)
+        {
+            if constexpr (hasNormal)
+                m_normal = normal;
+        }
+
+        //! \brief Convert a stored point
+        PONCA_MULTIARCH inline MixedPrecisionPoint(const P& p) : m_pos(p.pos().template cast<Scalar>())
+        {
+            if constexpr (hasNormal)
+                m_normal = p.normal().template cast<Scalar>();
+        }
+
+        //! \copybrief PointPositionNormal::pos
+        PONCA_MULTIARCH [[nodiscard]] inline const VectorType& pos() const { return m_pos; }
+        //! \copybrief PointPositionNormal::normal
+        PONCA_MULTIARCH [[nodiscard]] inline const VectorType& normal() const
+            requires hasNormal
+        {
+            return m_normal;
+        }
+
+    private:
+        struct NoNormal
+        {
+        };
+        VectorType m_pos;
+        [[no_unique_address]] std::conditional_t<hasNormal, VectorType, NoNormal> m_normal;
+    };
+    // [MixedPrecisionPoint]
 } // namespace Ponca
@@ -10,6 +10,7 @@
 #include "enums.h"
 #include "primitive.h"
 #include "compute.h"
+#include "../Common/Containers/stack.h"
 
 namespace Ponca
 {
@@ -142,6 +143,8 @@ namespace Ponca
     public:
         using ComputeObject<Derived>::compute; // Makes the default compute(container) accessible when using a CPU
                                                // architecture
+        using ComputeObject<Derived>::computeWithTree;
+        using ComputeObject<Derived>::computeWithCache;
 
         /*!
          * \brief Convenience function for STL-like iterators
@@ -195,9 +198,11 @@ namespace Ponca
         }
     };
 
-#define WRITE_COMPUTE_FUNCTIONS                     \
-    using BasketComputeObject<Self, Base>::compute; \
-    using BasketComputeObject<Self, Base>::computeWithIds;
+#define WRITE_COMPUTE_FUNCTIONS                             \
+    using BasketComputeObject<Self, Base>::compute;         \
+    using BasketComputeObject<Self, Base>::computeWithIds;  \
+    using BasketComputeObject<Self, Base>::computeWithTree; \
+    using BasketComputeObject<Self, Base>::computeWithCache;
 
     /*!
          \brief Aggregator class used to declare specialized structures with derivatives computations, using CRTP
@@ -240,6 +245,17 @@ namespace Ponca
             }
             return false;
         }
+
+        /// \copydoc Basket::addWeightedNeighbor
+        PONCA_MULTIARCH inline void addWeightedNeighbor(const DataPoint& _nei, Scalar _w,
+                                                        const typename BasketType::VectorType& _localQ)
+        {
+            typename Base::ScalarArray dw;
+            Base::addLocalNeighbor(_w, _localQ, _nei, dw);
+        }
+
+        /// \copydoc Basket::merge
+        PONCA_MULTIARCH inline void merge(const BasketDiff& other) { Base::merge(other); }
     };
 
     /*!
@@ -268,9 +284,321 @@ namespace Ponca
         using DataPoint = P;
         /// Weighting function
         using NeighborFilter = NF;
+        /// Default number of neighbors accumulated at once by #computeByBlocks
+        static constexpr int DefaultBlockSize = 8;
+        /// Block of `BlockSize` neighbors accumulated at once by the fitting extensions, see #computeByBlocks
+        template <int BlockSize = DefaultBlockSize>
+        using Block = NeighborBlock<DataPoint, BlockSize>;
+
+        /// \brief Do all the fitting extensions provide a block version of `addLocalNeighbor` ?
+        ///
+        /// If not, the blocks are accumulated neighbor per neighbor.
+        static constexpr bool isBlockCompatible = internal::IsBlockCompatible<Base, Block<>>::value;
+
+        /// \brief Do all the fitting extensions provide `addLocalMoments` ?
+        ///
+        /// If not, #computeWithMoments adds the neighbors one by one.
+        static constexpr bool isMomentCompatible = internal::IsMomentCompatible<Base>::value;
 
         WRITE_COMPUTE_FUNCTIONS
 
+        /*!
+         * \brief Same as #compute, but the neighbors are accumulated by blocks of `BlockSize`
+         *
+         * The extensions accumulate the blocks with vectorized expressions when they are all block compatible (see
+         * #isBlockCompatible), otherwise the neighbors are added one by one. The result is the same as with #compute up
+         * to floating point rounding, which may flip the sign of unoriented primitives.
+         *
+         * This path is not used by #compute, as it is not always faster: with about 70 neighbors, SphereFit is about
+         * 1.2x faster by blocks, CovariancePlaneFit and UnorientedSphereFit are as fast, and OrientedSphereFit is 2x
+         * slower (see `examples/cpp/ponca_benchmark_blocks.cpp`).
+         * \tparam BlockSize Number of neighbors accumulated at once
+         */
+        template <int BlockSize = DefaultBlockSize, typename IteratorBegin, typename IteratorEnd>
+        PONCA_MULTIARCH inline FIT_RESULT computeByBlocks(const IteratorBegin& begin, const IteratorEnd& end)
+        {
+            // The blocks store pointers to the neighbors
+            if constexpr (!std::is_lvalue_reference_v<decltype(*begin)>)
+                return compute(begin, end);
+            else
+            {
+                Base::init();
+                FIT_RESULT res = UNDEFINED;
+                Block<BlockSize> block;
+
+                do
+                {
+                    Base::startNewPass();
+                    for (auto it = begin; it != end; ++it)
+                        addNeighbor(*it, block);
+                    addNeighbors(block);
+                    res = Base::finalize();
+                } while (res == NEED_OTHER_PASS);
+
+                return res;
+            }
+        }
+
+        /*!
+         * \brief Same as #computeWithIds, but the neighbors are accumulated by blocks of `BlockSize`
+         * \see computeByBlocks
+         */
+        template <int BlockSize = DefaultBlockSize, typename IndexRange, typename PointContainer>
+        PONCA_MULTIARCH inline FIT_RESULT computeWithIdsByBlocks(IndexRange ids, const PointContainer& points)
+        {
+            // The blocks store pointers to the neighbors
+            if constexpr (!std::is_lvalue_reference_v<decltype(points[0])>)
+                return computeWithIds(ids, points);
+            else
+            {
+                Base::init();
+                FIT_RESULT res = UNDEFINED;
+                Block<BlockSize> block;
+
+                do
+                {
+                    Base::startNewPass();
+                    for (const auto& i : ids)
+                        addNeighbor(points[i], block);
+                    addNeighbors(block);
+                    res = Base::finalize();
+                } while (res == NEED_OTHER_PASS);
+
+                return res;
+            }
+        }
+
+        /*!
+         * \brief Fit the neighborhood of the evaluation point `_i` stored in a NeighborhoodCache
+         *
+         * When the cache stores the weights of the neighbors (see NeighborhoodCache::computeWeights), they are used
+         * instead of evaluating the NeighborFilter: only the conversion to the local frame remains at each pass.
+         * Otherwise, the cached ids are used as with #computeWithIds.
+         *
+         * \warning The NeighborFilter must be set beforehand, consistently with the cache: same evaluation position and
+         * scale, and same kernel when the weights are cached.
+         */
+        template <typename Cache, typename PointContainer>
+        PONCA_MULTIARCH inline FIT_RESULT computeWithCache(const Cache& _cache, int _i, const PointContainer& _points)
+        {
+            static_assert(Cache::template isCompatible<typename Base::NeighborFilter>,
+                          "The cache truncates the support of non-compact NeighborFilters");
+            if (!_cache.hasWeights())
+                return computeWithIds(_cache.neighbors(_i), _points);
+
+            const auto ids     = _cache.neighbors(_i);
+            const auto weights = _cache.weights(_i);
+            const auto& filter = Base::getNeighborFilter();
+            Base::init();
+            FIT_RESULT res = UNDEFINED;
+
+            do
+            {
+                Base::startNewPass();
+                for (size_t k = 0; k < ids.size(); ++k)
+                {
+                    const Scalar w = Scalar(weights[k]);
+                    if (w > Scalar(0.))
+                    {
+                        const DataPoint& nei = _points[ids[k]];
+                        Base::addLocalNeighbor(w, filter.convertToLocalBasis(nei.pos()), nei);
+                    }
+                }
+                res = Base::finalize();
+            } while (res == NEED_OTHER_PASS);
+
+            return res;
+        }
+
+        /*!
+         * \brief Fit the samples of a kd-tree storing the moments of its nodes, see KdTreeMomentNode
+         *
+         * The tree is traversed from its root, skipping the nodes outside of the support of the NeighborFilter. When
+         * the neighbors have a uniform weight (see DistWeightFunc::hasUniformWeight) and the extensions accept moments
+         * (see #isMomentCompatible), the nodes fully contained in the support are accumulated at once from their
+         * moments, and only the samples of the leaves crossing its boundary are added one by one. Large neighborhoods
+         * then cost roughly their boundary instead of their volume. Otherwise, all the samples in the support are added
+         * one by one, as with a range query.
+         *
+         * \note Only uniform weights are aggregated, i.e. ConstantWeightKernel or NoWeightFunc: the nodes only store
+         * moments up to the second order, while polynomial kernels such as SmoothWeightKernel weight each sample by a
+         * polynomial of its distance, which would require higher order moments. With such kernels, the traversal only
+         * prunes the nodes outside of the support.
+         *
+         * The result is the same as with #computeWithIds up to floating point rounding, which may flip the sign of
+         * unoriented primitives.
+         *
+         * \tparam Tree KdTree using KdTreeMomentNode, or any node type providing `aabb()` and `moments()`
+         */
+        template <typename Tree>
+        PONCA_MULTIARCH inline FIT_RESULT computeWithMoments(const Tree& tree)
+        {
+            using NodeIndexType = typename Tree::NodeIndexType;
+            static_assert(requires(const typename Tree::NodeType& n) {
+                n.aabb();
+                n.moments();
+            }, "computeWithMoments requires a KdTree storing the moments of its nodes, see KdTreeMomentNode");
+
+            constexpr bool useMoments = isMomentCompatible && requires { requires NeighborFilter::hasUniformWeight; };
+            constexpr bool isCompact  = requires { requires NeighborFilter::isCompact; };
+
+            Base::init();
+            FIT_RESULT res = UNDEFINED;
+
+            do
+            {
+                Base::startNewPass();
+                if (tree.nodeCount() != 0)
+                {
+                    const auto& nFilter = Base::getNeighborFilter();
+                    Stack<NodeIndexType, 2 * Tree::MAX_DEPTH> stack;
+                    stack.push(0);
+                    while (!stack.empty())
+                    {
+                        const auto& node = tree.nodes()[stack.top()];
+                        stack.pop();
+                        if (node.moments().count == 0)
+                            continue;
+
+                        [[maybe_unused]] bool isContained = true;
+                        if constexpr (isCompact)
+                        {
+                            Scalar minDist2, maxDist2;
+                            boxSquaredDistances(node.aabb(), minDist2, maxDist2);
+                            const Scalar t2 = nFilter.evalScale() * nFilter.evalScale();
+                            if (minDist2 > t2)
+                                continue;
+                            isContained = maxDist2 < t2;
+                        }
+
+                        if constexpr (useMoments)
+                        {
+                            if (isContained)
+                            {
+                                NeighborMoments<DataPoint> moments;
+                                moments.set(node.moments(), nFilter.uniformWeight(),
+                                            nFilter.convertToLocalBasis(node.moments().centroid));
+                                Base::addLocalMoments(moments);
+                                continue;
+                            }
+                        }
+
+                        if (node.is_leaf())
+                        {
+                            const auto end = node.leaf_start() + node.leaf_size();
+                            for (auto i = node.leaf_start(); i < end; ++i)
+                                addNeighbor(tree.pointDataFromSample(i));
+                        }
+                        else
+                        {
+                            stack.push(node.inner_first_child_id());
+                            stack.push(node.inner_first_child_id() + 1);
+                        }
+                    }
+                }
+                res = Base::finalize();
+            } while (res == NEED_OTHER_PASS);
+
+            return res;
+        }
+
+        /*!
+         * \brief Fit a selection of nodes of a tree storing their moments, e.g. the result of Octree::lodNeighbors
+         *
+         * When the extensions accept moments (see #isMomentCompatible), each node is accumulated at once from its
+         * moments, all its samples sharing the weight of its representative sample (see OctreeNode::representative).
+         * This is a level of detail approximation of the fit of the samples of the nodes, whose cost depends on the
+         * number of nodes only: its accuracy is controlled by the level of detail of the selection. Otherwise, the
+         * samples of the nodes are added one by one, which gives the same result as #computeWithIds.
+         *
+         * With a compact NeighborFilter, only the nodes whose bounding box is fully contained in the support are
+         * accumulated from their moments. The nodes crossing the boundary of the support are refined through their
+         * children, down to the samples of the leaves which are added one by one, and the nodes outside of the
+         * support are skipped: the samples outside of the support never contribute to the fit. With uniform weights
+         * (see DistWeightFunc::hasUniformWeight), the result is then the same as with #computeWithIds up to floating
+         * point rounding, at any level of detail.
+         *
+         * \param nodeIds Range of node indices, e.g. an OctreeLodQuery
+         * \param tree Octree, or any tree whose nodes provide `aabb()`, `moments()`, `representative()`,
+         * `sample_start()`, `sample_size()`, `is_leaf()`, `first_child_id()` and `child_count()`
+         */
+        template <typename NodeIdRange, typename Tree>
+        PONCA_MULTIARCH inline FIT_RESULT computeWithNodes(NodeIdRange&& nodeIds, const Tree& tree)
+        {
+            using NodeIndexType = typename Tree::NodeIndexType;
+            static_assert(requires(const typename Tree::NodeType& n) {
+                n.aabb();
+                n.moments();
+                n.representative();
+            }, "computeWithNodes requires a tree storing the moments and the representative of its nodes");
+
+            constexpr bool isCompact = requires { requires NeighborFilter::isCompact; };
+
+            Base::init();
+            FIT_RESULT res = UNDEFINED;
+
+            do
+            {
+                Base::startNewPass();
+                const auto& nFilter = Base::getNeighborFilter();
+                for (const auto id : nodeIds)
+                {
+                    // The nodes crossing the boundary of the support are refined through their children
+                    Stack<NodeIndexType, Tree::MAX_DEPTH * ((1 << DataPoint::Dim) - 1) + 1> stack;
+                    stack.push(id);
+                    while (!stack.empty())
+                    {
+                        const auto& node = tree.nodes()[stack.top()];
+                        stack.pop();
+                        if (node.sample_size() == 0)
+                            continue;
+
+                        [[maybe_unused]] bool isContained = true;
+                        if constexpr (isCompact)
+                        {
+                            Scalar minDist2, maxDist2;
+                            boxSquaredDistances(node.aabb(), minDist2, maxDist2);
+                            const Scalar t2 = nFilter.evalScale() * nFilter.evalScale();
+                            if (minDist2 > t2)
+                                continue;
+                            isContained = maxDist2 < t2;
+                        }
+
+                        if constexpr (isMomentCompatible)
+                        {
+                            if (isContained)
+                            {
+                                const Scalar w = nFilter(tree.pointDataFromSample(node.representative())).first;
+                                if (w > Scalar(0.))
+                                {
+                                    NeighborMoments<DataPoint> moments;
+                                    moments.set(node.moments(), w,
+                                                nFilter.convertToLocalBasis(node.moments().centroid));
+                                    Base::addLocalMoments(moments);
+                                }
+                                continue;
+                            }
+                        }
+
+                        if (node.is_leaf() || !isMomentCompatible)
+                        {
+                            const auto end = node.sample_start() + node.sample_size();
+                            for (auto i = node.sample_start(); i < end; ++i)
+                                addNeighbor(tree.pointDataFromSample(i));
+                        }
+                        else
+                        {
+                            for (int c = 0; c < node.child_count(); ++c)
+                                stack.push(node.first_child_id() + c);
+                        }
+                    }
+                }
+                res = Base::finalize();
+            } while (res == NEED_OTHER_PASS);
+
+            return res;
+        }
+
         /// \brief Add a neighbor to perform the fit
         ///
         /// When called directly, don't forget to call PrimitiveBase::startNewPass when starting multiple passes
@@ -289,6 +617,80 @@ namespace Ponca
             }
             return false;
         }
+
+        /// \brief Add a neighbor whose weight and local coordinates are already computed by the NeighborFilter
+        ///
+        /// Allows to share the evaluation of the NeighborFilter between several fits, see MultiScaleFit.
+        /// \param _w Weight of the neighbor, which must be strictly positive
+        /// \param _localQ Neighbor position expressed in the frame of the NeighborFilter
+        PONCA_MULTIARCH inline void addWeightedNeighbor(const DataPoint& _nei, Scalar _w, const VectorType& _localQ)
+        {
+            Base::addLocalNeighbor(_w, _localQ, _nei);
+        }
+
+        /// \brief Add a neighbor to a block, which is accumulated and emptied when full
+        ///
+        /// Call #addNeighbors to accumulate the remaining neighbors before finalizing the fit.
+        /// \warning The block keeps a pointer to `_nei`, which must outlive it
+        /// \return false if param nei is not a valid neighbor (weight = 0)
+        template <int BlockSize>
+        PONCA_MULTIARCH inline bool addNeighbor(const DataPoint& _nei, Block<BlockSize>& _block)
+        {
+            auto neiFilterOutput = Base::getNeighborFilter()(_nei);
+
+            if (neiFilterOutput.first > Scalar(0.))
+            {
+                _block.push(neiFilterOutput.first, neiFilterOutput.second, _nei);
+                if (_block.full())
+                    addNeighbors(_block);
+                return true;
+            }
+            return false;
+        }
+
+        /// \brief Accumulate the neighbors stored in a block, and empty it
+        ///
+        /// The extensions accumulate the whole block at once when they are all block compatible, otherwise the
+        /// neighbors are added one by one.
+        /// \see isBlockCompatible
+        template <int BlockSize>
+        PONCA_MULTIARCH inline void addNeighbors(Block<BlockSize>& _block)
+        {
+            if constexpr (isBlockCompatible)
+                Base::addLocalNeighbors(_block);
+            else
+                for (int i = 0; i < _block.size; ++i)
+                    Base::addLocalNeighbor(_block.weights(i), _block.localQ.col(i), *_block.attributes[i]);
+            _block.clear();
+        }
+
+        /*!
+         * \brief Add the neighbors accumulated by another fit, as if they were added to this fit
+         *
+         * Allows to reduce partial fits computed over disjoint subsets of a neighborhood, e.g. by several threads:
+         * \code
+         * // each worker: fits[t].setNeighborFilter(nf); fits[t].init(); then fits[t].addNeighbor(...) on its subset
+         * for (int t = 1; t < nbWorkers; ++t)
+         *     fits[0].merge(fits[t]);
+         * FIT_RESULT res = fits[0].finalize();
+         * \endcode
+         * Both fits must use the same NeighborFilter and be at the same pass, between PrimitiveBase::startNewPass and
+         * #finalize. When #NEED_OTHER_PASS is returned, copy the merged fit to the workers and call
+         * PrimitiveBase::startNewPass before accumulating the next pass.
+         */
+        PONCA_MULTIARCH inline void merge(const Basket& other) { Base::merge(other); }
+
+    private:
+        /// \brief Squared distances from the evaluation position to the closest and the farthest points of a box
+        template <typename AabbType>
+        PONCA_MULTIARCH inline void boxSquaredDistances(const AabbType& aabb, Scalar& minDist2, Scalar& maxDist2) const
+        {
+            const auto& nFilter   = Base::getNeighborFilter();
+            const VectorType lmin = nFilter.convertToLocalBasis(aabb.min());
+            const VectorType lmax = nFilter.convertToLocalBasis(aabb.max());
+            minDist2 = (lmin.cwiseMax(VectorType::Zero()) + lmax.cwiseMin(VectorType::Zero())).squaredNorm();
+            maxDist2 = lmin.cwiseAbs().cwiseMax(lmax.cwiseAbs()).squaredNorm();
+        }
     }; // class Basket
 
 #undef WRITE_COMPUTE_FUNCTIONS
@@ -0,0 +1,220 @@
+/*
+ This Source Code Form is subject to the terms of the Mozilla Public
+ License, v. 2.0. If a copy of the MPL was not distributed with this
+ file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+#pragma once
+
+#include "defines.h"
+#include "enums.h"
+#include "compute.h"
+
+#include <algorithm>
+#include <tuple>
+#include <type_traits>
+
+namespace Ponca
+{
+    /*!
+     * \brief Compute object evaluating several fits in a single traversal of the neighborhood
+     *
+     * All the fits share the same NeighborFilter: the filter is evaluated once per neighbor, and the resulting weight
+     * and local position are dispatched to every fit, e.g.
+     * \code
+     * BasketGroup<PlaneFit, SphereFit, MongeFit> group;
+     * group.setNeighborFilter({pos, scale});
+     * group.computeWithIds(tree.rangeNeighbors(pos, scale), tree.points());
+     * auto n = group.template get<0>().primitiveGradient();
+     * \endcode
+     *
+     * When some of the fits return #NEED_OTHER_PASS, another traversal is done, dispatching the neighbors only to
+     * these fits. The other fits are left untouched.
+     *
+     * Fits can be Basket or BasketDiff: the derivatives of the weights are computed by each BasketDiff.
+     *
+     * \tparam Fits Fitting types, sharing the same DataPoint and NeighborFilter
+     */
+    template <typename Fit0, typename... Fits>
+    class BasketGroup : public ComputeObject<BasketGroup<Fit0, Fits...>>
+    {
+    public:
+        using DataPoint      = typename Fit0::DataPoint;      ///< Point type used for computation
+        using NeighborFilter = typename Fit0::NeighborFilter; ///< Filter shared by all the fits
+        using Scalar         = typename DataPoint::Scalar;    ///< Scalar type used for computation
+
+        static_assert((std::is_same_v<DataPoint, typename Fits::DataPoint> && ...),
+                      "All the fits of a BasketGroup must use the same DataPoint");
+        static_assert((std::is_same_v<NeighborFilter, typename Fits::NeighborFilter> && ...),
+                      "All the fits of a BasketGroup must use the same NeighborFilter");
+
+        /// \brief Number of fits in the group
+        static constexpr int size() { return 1 + int(sizeof...(Fits)); }
+
+    private:
+        std::tuple<Fit0, Fits...> m_fits;
+        /// \brief Fits that need to accumulate neighbors during the current pass
+        bool m_active[1 + sizeof...(Fits)];
+
+    public:
+        using ComputeObject<BasketGroup>::compute;
+
+        BasketGroup() { std::fill(std::begin(m_active), std::end(m_active), true); }
+
+        /// \brief Read/write access to the fit `I`
+        template <int I>
+        inline auto& get()
+        {
+            return std::get<I>(m_fits);
+        }
+
+        /// \brief Read access to the fit `I`
+        template <int I>
+        inline const auto& get() const
+        {
+            return std::get<I>(m_fits);
+        }
+
+        /// \brief Set the NeighborFilter of all the fits
+        inline void setNeighborFilter(const NeighborFilter& _nFilter)
+        {
+            std::apply([&](auto&... fit) { (fit.setNeighborFilter(_nFilter), ...); }, m_fits);
+        }
+
+        /// \brief Read access to the shared NeighborFilter
+        inline const NeighborFilter& getNeighborFilter() const { return std::get<0>(m_fits).getNeighborFilter(); }
+
+        /// \brief Reset the internal states of all the fits
+        inline void init()
+        {
+            std::apply([](auto&... fit) { (fit.init(), ...); }, m_fits);
+            std::fill(std::begin(m_active), std::end(m_active), true);
+        }
+
+        /// \brief Start a new pass for the fits that requested it
+        inline void startNewPass()
+        {
+            forEachActive([](auto& fit) { fit.startNewPass(); });
+        }
+
+        /// \brief Add a neighbor to the fits of the current pass
+        /// \return false if param nei is not a valid neighbor (weight = 0)
+        inline bool addNeighbor(const DataPoint& _nei)
+        {
+            auto neiFilterOutput = getNeighborFilter()(_nei);
+
+            if (neiFilterOutput.first > Scalar(0.))
+            {
+                forEachActive([&](auto& fit) {
+                    addLocalNeighbor(fit, neiFilterOutput.first, neiFilterOutput.second, _nei);
+                });
+                return true;
+            }
+            return false;
+        }
+
+        /*!
+         * \brief Finalize the fits of the current pass
+         *
+         * Fits returning #NEED_OTHER_PASS stay active for the next pass.
+         * \return #NEED_OTHER_PASS if at least one fit needs another pass, otherwise the worst state of the fits
+         * (#STABLE < #UNSTABLE < #UNDEFINED < #CONFLICT_ERROR_FOUND)
+         */
+        inline FIT_RESULT finalize()
+        {
+            bool needOtherPass = false;
+            forEachActive([&](auto& fit) { needOtherPass |= (fit.finalize() == NEED_OTHER_PASS); });
+
+            int i = 0;
+            std::apply([&](auto&... fit) { ((m_active[i++] = (fit.getCurrentState() == NEED_OTHER_PASS)), ...); },
+                       m_fits);
+            return needOtherPass ? NEED_OTHER_PASS : getCurrentState();
+        }
+
+        /// \brief Worst state of the fits (#STABLE < #UNSTABLE < #UNDEFINED < #CONFLICT_ERROR_FOUND)
+        [[nodiscard]] inline FIT_RESULT getCurrentState() const
+        {
+            FIT_RESULT res = STABLE;
+            std::apply([&](const auto&... fit) { ((res = std::max(res, fit.getCurrentState())), ...); }, m_fits);
+            return res;
+        }
+
+        /// \brief Are all the fits ready to use ?
+        [[nodiscard]] inline bool isReady() const
+        {
+            return std::apply([](const auto&... fit) { return (fit.isReady() && ...); }, m_fits);
+        }
+
+        /// \brief Are all the fits stable ?
+        [[nodiscard]] inline bool isStable() const
+        {
+            return std::apply([](const auto&... fit) { return (fit.isStable() && ...); }, m_fits);
+        }
+
+        /*!
+         * \brief Convenience function for STL-like iterators
+         * Add neighbors stored in a container using STL-like iterators, and call finalize at the end.
+         * The range is traversed again while some of the fits need another pass.
+         */
+        template <typename IteratorBegin, typename IteratorEnd>
+        inline FIT_RESULT compute(const IteratorBegin& begin, const IteratorEnd& end)
+        {
+            init();
+            FIT_RESULT res = UNDEFINED;
+
+            do
+            {
+                startNewPass();
+                for (auto it = begin; it != end; ++it)
+                    addNeighbor(*it);
+                res = finalize();
+            } while (res == NEED_OTHER_PASS);
+
+            return res;
+        }
+
+        /*!
+         * \brief Convenience function to iterate over a subset of samples in a PointContainer
+         * \see #compute(const IteratorBegin& begin, const IteratorEnd& end)
+         */
+        template <typename IndexRange, typename PointContainer>
+        inline FIT_RESULT computeWithIds(IndexRange ids, const PointContainer& points)
+        {
+            init();
+            FIT_RESULT res = UNDEFINED;
+
+            do
+            {
+                startNewPass();
+                for (const auto& i : ids)
+                    addNeighbor(points[i]);
+                res = finalize();
+            } while (res == NEED_OTHER_PASS);
+
+            return res;
+        }
+
+    private:
+        /// \brief Call `f` on each fit of the current pass
+        template <typename Func>
+        inline void forEachActive(Func&& f)
+        {
+            int i = 0;
+            std::apply([&](auto&... fit) { ((m_active[i++] ? f(fit) : void()), ...); }, m_fits);
+        }
+
+        /// \brief Dispatch a filtered neighbor to a Basket, or to a BasketDiff which also needs the weight derivatives
+        template <typename Fit>
+        static inline void addLocalNeighbor(Fit& fit, Scalar w, const typename DataPoint::VectorType& localQ,
+                                            const DataPoint& nei)
+        {
+            if constexpr (requires { typename Fit::ScalarArray; })
+            {
+                typename Fit::ScalarArray dw;
+                fit.addLocalNeighbor(w, localQ, nei, dw);
+            }
+            else
+                fit.addLocalNeighbor(w, localQ, nei);
+        }
+    };
+} // namespace Ponca
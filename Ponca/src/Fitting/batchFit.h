@@ -0,0 +1,152 @@
+/*
+ This Source Code Form is subject to the terms of the Mozilla Public
+ License, v. 2.0. If a copy of the MPL was not distributed with this
+ file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+#pragma once
+
+#include "defines.h"
+#include "enums.h"
+#include "../Common/Assert.h"
+
+#include <limits>
+
+namespace Ponca
+{
+    /*!
+     * \brief Scale policy for #batchFit: the same scale is used at every evaluation point
+     */
+    template <typename Scalar>
+    struct ConstantScale
+    {
+        Scalar scale; ///< Neighborhood radius
+
+        [[nodiscard]] inline Scalar operator()(int /*i*/) const { return scale; }
+    };
+
+    /*!
+     * \brief Scale policy for #batchFit: each evaluation point has its own scale
+     * \tparam ScaleContainer Random-access container storing one scale per evaluation point
+     */
+    template <typename ScaleContainer>
+    struct PerPointScale
+    {
+        const ScaleContainer& scales; ///< Neighborhood radius of each evaluation point
+
+        [[nodiscard]] inline auto operator()(int i) const { return scales[i]; }
+    };
+
+    /*!
+     * \brief Output arrays of #batchFit, stored as a structure of arrays
+     *
+     * Each array is optional: a `nullptr` disables the corresponding output. The arrays are indexed by the evaluation
+     * point id, and must be allocated by the caller. When a fit is not ready (see #PrimitiveBase::isReady), its
+     * values are set to NaN.
+     *
+     * \warning Requesting an output that the fit does not provide triggers an assertion.
+     */
+    template <typename Scalar>
+    struct BatchFitOutput
+    {
+        Scalar* normals{nullptr};    ///< `Dim` scalars per point: normalized `primitiveGradient()`
+        Scalar* potentials{nullptr}; ///< `potential()` at the evaluation point
+        Scalar* kmin{nullptr};       ///< `kmin()`, requires a curvature estimator
+        Scalar* kmax{nullptr};       ///< `kmax()`, requires a curvature estimator
+        FIT_RESULT* status{nullptr}; ///< Result of the fit
+    };
+
+    /*!
+     * \brief Fit a primitive at each evaluation point, using the neighbors found by a spatial structure
+     *
+     * This function replaces the usual loop calling, for each point, `setNeighborFilter`, a range query and
+     * `computeWithIds`. The evaluation points are distributed over the OpenMP threads, and each thread reuses the same
+     * fitting object for all its points.
+     *
+     * Randomized fits providing `setSeed` and `seed`, such as CNC, are reseeded at each evaluation point `i` with
+     * `_prototype.seed() + i`: the results do not depend on the distribution of the points over the threads.
+     *
+     * \tparam FitType Basket or CNC type. Its NeighborFilter must be constructible from an evaluation position (or an
+     * evaluation point, when the EvalContainer stores points) and a scale
+     * \tparam Tree Spatial structure used by ComputeObject::computeWithTree, e.g. a KdTree
+     * \tparam EvalContainer Random-access container of positions (`VectorType`) or points (providing `pos()`)
+     * \tparam ScalePolicy Functor returning the scale of the evaluation point `i`, e.g. ConstantScale or PerPointScale
+     *
+     * \param _tree Spatial structure storing the input points
+     * \param _evalPoints Evaluation points
+     * \param _scale Scale policy
+     * \param _out Output arrays
+     * \param _prototype Fitting object copied in each thread, for instance to configure some of its parameters
+     */
+    template <typename FitType, typename Tree, typename EvalContainer, typename ScalePolicy>
+    void batchFit(const Tree& _tree, const EvalContainer& _evalPoints, const ScalePolicy& _scale,
+                  const BatchFitOutput<typename FitType::Scalar>& _out, const FitType& _prototype = FitType())
+    {
+        using Scalar         = typename FitType::Scalar;
+        using VectorType     = typename FitType::VectorType;
+        using NeighborFilter = typename FitType::NeighborFilter;
+        constexpr int Dim    = FitType::DataPoint::Dim;
+        constexpr Scalar nan = std::numeric_limits<Scalar>::quiet_NaN();
+
+        constexpr bool hasPotential = requires(const FitType& f) { f.potential(); };
+        constexpr bool hasGradient  = requires(const FitType& f) { f.primitiveGradient(); };
+        constexpr bool hasCurvature = requires(const FitType& f) {
+            f.kmin();
+            f.kmax();
+        };
+        if constexpr (!hasPotential)
+            PONCA_ASSERT(_out.potentials == nullptr);
+        if constexpr (!hasGradient)
+            PONCA_ASSERT(_out.normals == nullptr);
+        if constexpr (!hasCurvature)
+            PONCA_ASSERT(_out.kmin == nullptr && _out.kmax == nullptr);
+
+        constexpr bool hasSeed = requires(FitType& f) { f.setSeed(_prototype.seed()); };
+
+        const int nbEval = int(_evalPoints.size());
+
+#pragma omp parallel
+        {
+            FitType fit = _prototype;
+
+#pragma omp for schedule(dynamic, 64)
+            for (int i = 0; i < nbEval; ++i)
+            {
+                // The fit may use a higher precision than the stored points, see MixedPrecisionPoint
+                VectorType pos;
+                if constexpr (requires { _evalPoints[i].pos(); })
+                    pos = _evalPoints[i].pos().template cast<Scalar>();
+                else
+                    pos = _evalPoints[i].template cast<Scalar>();
+                const Scalar t = _scale(i);
+
+                // Filters storing more than the evaluation position, e.g. its normal, are built from the point
+                if constexpr (requires { NeighborFilter(_evalPoints[i], t); })
+                    fit.setNeighborFilter(NeighborFilter(_evalPoints[i], t));
+                else
+                    fit.setNeighborFilter(NeighborFilter(pos, t));
+                if constexpr (hasSeed)
+                    fit.setSeed(_prototype.seed() + i);
+                const FIT_RESULT res = fit.computeWithTree(_tree);
+                const bool ready     = fit.isReady();
+
+                if (_out.status)
+                    _out.status[i] = res;
+                if constexpr (hasPotential)
+                    if (_out.potentials)
+                        _out.potentials[i] = ready ? Scalar(fit.potential()) : nan;
+                if constexpr (hasGradient)
+                    if (_out.normals)
+                        Eigen::Map<VectorType>(_out.normals + Dim * i) =
+                            ready ? VectorType(fit.primitiveGradient().normalized()) : VectorType::Constant(nan);
+                if constexpr (hasCurvature)
+                {
+                    if (_out.kmin)
+                        _out.kmin[i] = ready ? Scalar(fit.kmin()) : nan;
+                    if (_out.kmax)
+                        _out.kmax[i] = ready ? Scalar(fit.kmax()) : nan;
+                }
+            }
+        }
+    }
+} // namespace Ponca
@@ -0,0 +1,108 @@
+/*
+ This Source Code Form is subject to the terms of the Mozilla Public
+ License, v. 2.0. If a copy of the MPL was not distributed with this
+ file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+#pragma once
+
+#include "defines.h"
+#include "enums.h"
+#include "batchFit.h"
+#include "mlsEvaluationScheme.h"
+
+#include <limits>
+#include <type_traits>
+
+namespace Ponca
+{
+    /*!
+     * \brief Output arrays of #batchProject, stored as a structure of arrays
+     *
+     * Each array is optional: a `nullptr` disables the corresponding output. The arrays are indexed by the position id,
+     * and must be allocated by the caller.
+     */
+    template <typename Scalar>
+    struct BatchProjectOutput
+    {
+        Scalar* normals{nullptr};              ///< `Dim` scalars per point: normalized gradient at the projection
+        FIT_RESULT* status{nullptr};           ///< Result of the last fit
+        MLSConvergence* convergence{nullptr}; ///< Number of MLS iterations, and whether they converged
+    };
+
+    /*!
+     * \brief Project positions on the MLS surface defined by a fit, using the points stored in a spatial structure
+     *
+     * Each position is projected with the evaluation scheme, starting from its current value, and is then replaced by
+     * the projection computed from the last fit. Positions whose last fit is not stable are left unchanged, and their
+     * normals are set to NaN. Since the positions are updated in place, calling this function again, e.g. after
+     * moving the input points for denoising, warm-starts the projections from the previous results.
+     *
+     * The positions are distributed over the OpenMP threads. Each thread reuses the same fitting object and the same
+     * copy of the evaluation scheme, which, with the default CachedMLSEvaluationScheme, reuses the neighborhoods
+     * between the MLS iterations.
+     *
+     * \tparam FitType Basket type, providing the `isStable`, `primitiveGradient` and the projection functions used by
+     * `Project`. Its NeighborFilter must be constructible from an evaluation position and a scale
+     * \tparam Tree Spatial structure providing `rangeNeighbors(VectorType, Scalar)` and `points()`, e.g. a KdTree
+     * \tparam PositionContainer Random-access container of positions (`VectorType`)
+     * \tparam ScalePolicy Functor returning the scale of the position `i`, e.g. ConstantScale or PerPointScale
+     * \tparam Scheme Evaluation scheme providing `computeWithTree`, e.g. MLSEvaluationScheme or
+     * CachedMLSEvaluationScheme
+     * \tparam Project Projection functor type, e.g. DirectProjectionOperator or GradientDescentProjectionOperator
+     *
+     * \param _tree Spatial structure storing the input points
+     * \param _positions Positions to project, overwritten by their projections
+     * \param _scale Scale policy
+     * \param _out Output arrays
+     * \param _scheme Evaluation scheme copied in each thread, configuring the MLS iterations
+     * \param _project Projection functor
+     * \param _prototype Fitting object copied in each thread, for instance to configure some of its parameters
+     */
+    template <typename FitType, typename Tree, typename PositionContainer, typename ScalePolicy,
+              typename Scheme  = CachedMLSEvaluationScheme<typename FitType::Scalar>,
+              typename Project = DirectProjectionOperator>
+    void batchProject(const Tree& _tree, PositionContainer& _positions, const ScalePolicy& _scale,
+                      const BatchProjectOutput<typename FitType::Scalar>& _out = {}, const Scheme& _scheme = Scheme(),
+                      const Project& _project = Project(), const FitType& _prototype = FitType())
+    {
+        using Scalar         = typename FitType::Scalar;
+        using VectorType     = typename FitType::VectorType;
+        using NeighborFilter = typename FitType::NeighborFilter;
+        constexpr int Dim    = FitType::DataPoint::Dim;
+        constexpr Scalar nan = std::numeric_limits<Scalar>::quiet_NaN();
+
+        const int nbPositions = int(_positions.size());
+
+#pragma omp parallel
+        {
+            FitType fit   = _prototype;
+            Scheme scheme = _scheme;
+
+#pragma omp for schedule(dynamic, 64)
+            for (int i = 0; i < nbPositions; ++i)
+            {
+                // The fit may use a higher precision than the positions, see MixedPrecisionPoint
+                using PositionType = std::decay_t<decltype(_positions[i])>;
+
+                MLSConvergence convergence;
+                fit.setNeighborFilter(NeighborFilter(_positions[i].template cast<Scalar>().eval(), _scale(i)));
+                const FIT_RESULT res = scheme.computeWithTree(fit, _tree, _project, &convergence);
+                const bool stable    = fit.isStable();
+
+                if (stable)
+                    _positions[i] = _project(fit, fit.getNeighborFilter().evalPos())
+                                        .template cast<typename PositionType::Scalar>();
+
+                if (_out.status)
+                    _out.status[i] = res;
+                if (_out.convergence)
+                    _out.convergence[i] = convergence;
+                if (_out.normals)
+                    Eigen::Map<VectorType>(_out.normals + Dim * i) =
+                        stable ? VectorType(fit.primitiveGradient(_positions[i].template cast<Scalar>()).normalized())
+                               : VectorType::Constant(nan);
+            }
+        }
+    }
+} // namespace Ponca
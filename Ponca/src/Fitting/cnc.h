@@ -13,6 +13,11 @@ All rights reserved.
 #include "cncFormulaEigen.h"
 #include "weightFunc.h"
 #include "weightKernel.h"
+#include "../Common/Containers/stack.h"
+
+#include <random>
+#include <span>
+#include <vector>
 
 namespace Ponca
 {
@@ -39,6 +44,8 @@ namespace Ponca
             std::array<VectorType, 3> m_normals;
 
         public:
+            Triangle() = default;
+
             Triangle(DataPoint pointA, DataPoint pointB, DataPoint pointC)
             {
                 m_points  = {pointA.pos(), pointB.pos(), pointC.pos()};
@@ -93,6 +100,12 @@ namespace Ponca
         AvgHexagramGeneration
     };
 
+    namespace internal
+    {
+        template <TriangleGenerationMethod Method, typename P>
+        struct TriangleGenerator;
+    } // namespace internal
+
     /*!
      * \brief Corrected Normal Current Fit type.
      *
@@ -100,10 +113,15 @@ namespace Ponca
      * - The principal curvatures values and directions
      * - The mean and gaussian curvatures
      *
+     * The random triangle generations draw from a generator owned by each instance, and the triangles and neighbor
+     * indices are stored in buffers reused from one compute to the next: once warmed-up, distinct CNC objects can be
+     * computed concurrently without allocating, e.g. with #batchFit, which reseeds the generator at each evaluation
+     * point with #setSeed.
+     *
      * \see PROVIDES_PRINCIPAL_CURVATURES
      */
     template <class P, TriangleGenerationMethod _method = UniformGeneration>
-    class CNC : ComputeObject<CNC<P, _method>>
+    class CNC : public ComputeObject<CNC<P, _method>>
     {
     protected:
         enum
@@ -120,14 +138,24 @@ namespace Ponca
         using DenseMatrix = Eigen::MatrixXd;
         using NeighborFilter =
             NeighborFilterStoreNormal<DataPoint, DistWeightFunc<DataPoint, ConstantWeightKernel<Scalar>>>;
+        /// \brief Random number generator used by the triangle generation methods
+        using RandomGenerator = std::mt19937;
+        /// \brief Fixed-capacity buffer storing the generated triangles
+        using TriangleBuffer =
+            Stack<internal::Triangle<DataPoint>, internal::TriangleGenerator<_method, DataPoint>::maxTriangles>;
 
     protected:
         // Basis
         NeighborFilter m_nFilter;
 
+        // Random generation of the triangles
+        RandomGenerator::result_type m_seed{RandomGenerator::default_seed};
+        RandomGenerator m_rng{RandomGenerator::default_seed};
+
         // Triangles used for the computation
-        int m_nb_vt{0}; // Number of valid triangles
-        std::vector<internal::Triangle<DataPoint>> m_triangles;
+        int m_nb_vt{0};             // Number of valid triangles
+        TriangleBuffer m_triangles; // Generated triangles
+        std::vector<int> m_indices; // Neighbors selected by the generation methods, kept to reuse its capacity
 
         // Results of the fit
         Scalar m_A{0};   // Area
@@ -181,7 +209,7 @@ namespace Ponca
          * \tparam PointContainer An STL-like container storing the points
          */
         template <typename IndexRange, typename PointContainer>
-        PONCA_MULTIARCH inline FIT_RESULT computeWithIds(const IndexRange& ids, const PointContainer& points);
+        PONCA_MULTIARCH inline FIT_RESULT computeWithIds(IndexRange ids, const PointContainer& points);
 
         /*!
          * \brief Get the number of triangles that were generated with the compute method.
@@ -193,12 +221,32 @@ namespace Ponca
         PONCA_FITTING_APIDOC_SETWFUNC
         PONCA_MULTIARCH inline void setNeighborFilter(const NeighborFilter& _nFilter) { m_nFilter = _nFilter; }
 
+        /*! \brief Read access to the NeighborFilter \see setNeighborFilter */
+        PONCA_MULTIARCH inline const NeighborFilter& getNeighborFilter() const { return m_nFilter; }
+
+        /*!
+         * \brief Reset the random generator used by the triangle generation methods
+         *
+         * Two CNC objects with the same seed generate the same triangles from the same neighborhood.
+         */
+        PONCA_MULTIARCH inline void setSeed(RandomGenerator::result_type _seed)
+        {
+            m_seed = _seed;
+            m_rng.seed(_seed);
+        }
+
+        //! \brief Seed set by the last call to #setSeed
+        PONCA_MULTIARCH [[nodiscard]] inline RandomGenerator::result_type seed() const { return m_seed; }
+
         /*!
          * \brief Returns the triangles
          *
-         * \return A pointer to the array of triangle that was generated during the CNC Fit
+         * \return A view on the triangles that were generated during the CNC Fit
          */
-        PONCA_MULTIARCH [[nodiscard]] std::vector<internal::Triangle<DataPoint>>& getTriangles() { return m_triangles; }
+        PONCA_MULTIARCH [[nodiscard]] std::span<internal::Triangle<DataPoint>> getTriangles()
+        {
+            return {m_triangles.data(), size_t(m_triangles.size())};
+        }
 
         //! \brief Comparison operator
         PONCA_MULTIARCH [[nodiscard]] bool operator==(const CNC& other) const
@@ -232,6 +280,12 @@ namespace Ponca
         //! \brief Is the fitted primitive ready to use (finalize has been called and the result is stable)
         PONCA_MULTIARCH [[nodiscard]] inline bool isStable() const { return m_eCurrentState == STABLE; }
 
+        //! \brief Is the fitted primitive ready to use (finalize has been called)
+        PONCA_MULTIARCH [[nodiscard]] inline bool isReady() const
+        {
+            return (m_eCurrentState == STABLE) || (m_eCurrentState == UNSTABLE);
+        }
+
         //! \brief Returns an estimate of the minimal principal curvature value
         PONCA_MULTIARCH [[nodiscard]] inline Scalar kmin() const { return m_k1; }
 
@@ -9,8 +9,9 @@ All rights reserved.
 
 #pragma once
 
+#include <algorithm>
 #include <random>
-#include <numeric>
+#include <ranges>
 
 namespace Ponca::internal
 {
@@ -18,8 +19,9 @@ namespace Ponca::internal
      *
      * \brief Generates the triangles used by the CNC Fit depending on the method.
      *
-     * As an output, pushes every generated triangle into the `triangles` vector and returns the number of triangle that
-     * was pushed to the List.
+     * As an output, pushes every generated triangle into the `triangles` buffer, which can store up to `maxTriangles`
+     * triangles. The random generator `rng` and the `indices` scratch buffer are owned by the caller, so that the
+     * generation does not depend on any global state, and does not allocate once `indices` is large enough.
      *
      * \note Needs to be implemented for each triangle generation method by specializing the template over the
      * `TriangleGenerationMethod` enum.
@@ -29,10 +31,14 @@ namespace Ponca::internal
     template <TriangleGenerationMethod Method, typename P>
     struct TriangleGenerator
     {
+        static constexpr int maxTriangles{1};
+
         using VectorType = typename P::VectorType;
-        template <typename IndexRange, typename PointContainer, typename NeighborFilter>
-        static FIT_RESULT generate(const IndexRange& /*ids*/, const PointContainer& /*points*/,
-                                   const NeighborFilter& /*w*/, std::vector<Triangle<P>>& /*triangles*/
+        template <typename IndexRange, typename PointContainer, typename NeighborFilter, typename RandomGenerator,
+                  typename TriangleBuffer>
+        static FIT_RESULT generate(IndexRange&& /*ids*/, const PointContainer& /*points*/,
+                                   const NeighborFilter& /*w*/, RandomGenerator& /*rng*/, std::vector<int>& /*indices*/,
+                                   TriangleBuffer& /*triangles*/
         )
         {
             throw std::invalid_argument("Triangle generation method not implemented!");
@@ -46,19 +52,17 @@ namespace Ponca::internal
     template <typename P>
     struct TriangleGenerator<UniformGeneration, P>
     {
-    private:
         static constexpr int maxTriangles{100};
 
-    public:
         using VectorType = typename P::VectorType;
         using Scalar     = typename P::Scalar;
 
-        template <typename IndexRange, typename PointContainer, typename NeighborFilter>
-        static FIT_RESULT generate(const IndexRange& ids, const PointContainer& points, const NeighborFilter& w,
-                                   std::vector<Triangle<P>>& triangles)
+        template <typename IndexRange, typename PointContainer, typename NeighborFilter, typename RandomGenerator,
+                  typename TriangleBuffer>
+        static FIT_RESULT generate(IndexRange&& ids, const PointContainer& points, const NeighborFilter& w,
+                                   RandomGenerator& rng, std::vector<int>& indices, TriangleBuffer& triangles)
         {
-            // Makes a new array
-            std::vector<int> indices;
+            indices.clear();
             for (int index : ids)
             {
                 // Skip the points that are outside the kernel radius
@@ -69,17 +73,17 @@ namespace Ponca::internal
             if (indices.empty())
                 return UNDEFINED;
 
-            const int lastIndex = int(indices.size()) - 1;
+            std::uniform_int_distribution<int> randomIndex(0, int(indices.size()) - 1);
             for (int i = 0; i < maxTriangles; ++i)
             {
                 // Randomly select triangles
-                int i1 = indices[Eigen::internal::random<int>(0, lastIndex)];
-                int i2 = indices[Eigen::internal::random<int>(0, lastIndex)];
-                int i3 = indices[Eigen::internal::random<int>(0, lastIndex)];
+                int i1 = indices[randomIndex(rng)];
+                int i2 = indices[randomIndex(rng)];
+                int i3 = indices[randomIndex(rng)];
                 if (i1 == i2 || i1 == i3 || i2 == i3)
                     continue;
 
-                triangles.push_back(internal::Triangle<P>(points[i1], points[i2], points[i3]));
+                triangles.push(internal::Triangle<P>(points[i1], points[i2], points[i3]));
             }
             return STABLE;
         }
@@ -92,19 +96,18 @@ namespace Ponca::internal
     template <typename P>
     struct TriangleGenerator<IndependentGeneration, P>
     {
-    private:
         static constexpr int maxTriangles{100};
 
-    public:
         using VectorType = typename P::VectorType;
         using Scalar     = typename P::Scalar;
 
-        template <typename IndexRange, typename PointContainer, typename NeighborFilter>
-        static FIT_RESULT generate(const IndexRange& ids, const PointContainer& points, const NeighborFilter& w,
-                                   std::vector<Triangle<P>>& triangles)
+        template <typename IndexRange, typename PointContainer, typename NeighborFilter, typename RandomGenerator,
+                  typename TriangleBuffer>
+        static FIT_RESULT generate(IndexRange&& ids, const PointContainer& points, const NeighborFilter& w,
+                                   RandomGenerator& rng, std::vector<int>& indices, TriangleBuffer& triangles)
         {
-            // Makes a new array to shuffle
-            std::vector<int> indices;
+            // Gather the neighbors to shuffle
+            indices.clear();
             for (int index : ids)
             {
                 // Skip the points that are outside the kernel radius
@@ -116,19 +119,17 @@ namespace Ponca::internal
                 return UNDEFINED;
 
             // Shuffles the neighbors
-            std::random_device rd;
-            std::mt19937 rg(rd());
-            std::shuffle(indices.begin(), indices.end(), rg);
+            std::shuffle(indices.begin(), indices.end(), rng);
 
             // Compute the triangles
             triangles.clear();
-            const int max_triangles = std::min(maxTriangles, int(ids.size() / 3));
+            const int max_triangles = std::min(maxTriangles, int(indices.size() / 3));
             for (int nb_vt = 0; nb_vt < max_triangles - 2; nb_vt++)
             {
                 int i1 = indices[nb_vt];
                 int i2 = indices[nb_vt + 1];
                 int i3 = indices[nb_vt + 2];
-                triangles.push_back(internal::Triangle<P>(points[i1], points[i2], points[i3]));
+                triangles.push(internal::Triangle<P>(points[i1], points[i2], points[i3]));
             }
             return STABLE;
         }
@@ -148,12 +149,15 @@ namespace Ponca::internal
     template <typename P>
     struct TriangleGenerator<HexagramGeneration, P> : protected HexagramBase<P>
     {
+        static constexpr int maxTriangles{2};
+
         using VectorType = typename P::VectorType;
         using Scalar     = typename P::Scalar;
 
-        template <typename IndexRange, typename PointContainer, typename NeighborFilter>
-        static FIT_RESULT generate(const IndexRange& ids, const PointContainer& points, const NeighborFilter& w,
-                                   std::vector<Triangle<P>>& triangles)
+        template <typename IndexRange, typename PointContainer, typename NeighborFilter, typename RandomGenerator,
+                  typename TriangleBuffer>
+        static FIT_RESULT generate(IndexRange&& ids, const PointContainer& points, const NeighborFilter& w,
+                                   RandomGenerator& /*rng*/, std::vector<int>& /*indices*/, TriangleBuffer& triangles)
         {
             PONCA_MULTIARCH_STD_MATH(abs);
             // Compute normal and maximum distance.
@@ -229,10 +233,10 @@ namespace Ponca::internal
                     }
                 }
             }
-            triangles.push_back(internal::Triangle<P>({positions[0], positions[2], positions[4]},
-                                                      {normals[0], normals[2], normals[4]}));
-            triangles.push_back(internal::Triangle<P>({positions[1], positions[3], positions[5]},
-                                                      {normals[1], normals[3], normals[5]}));
+            triangles.push(internal::Triangle<P>({positions[0], positions[2], positions[4]},
+                                                 {normals[0], normals[2], normals[4]}));
+            triangles.push(internal::Triangle<P>({positions[1], positions[3], positions[5]},
+                                                 {normals[1], normals[3], normals[5]}));
 
             return STABLE;
         }
@@ -245,12 +249,15 @@ namespace Ponca::internal
     template <typename P>
     struct TriangleGenerator<AvgHexagramGeneration, P> : protected HexagramBase<P>
     {
+        static constexpr int maxTriangles{2};
+
         using VectorType = typename P::VectorType;
         using Scalar     = typename P::Scalar;
 
-        template <typename IndexRange, typename PointContainer, typename NeighborFilter>
-        static FIT_RESULT generate(const IndexRange& ids, const PointContainer& points, const NeighborFilter& w,
-                                   std::vector<Triangle<P>>& triangles)
+        template <typename IndexRange, typename PointContainer, typename NeighborFilter, typename RandomGenerator,
+                  typename TriangleBuffer>
+        static FIT_RESULT generate(IndexRange&& ids, const PointContainer& points, const NeighborFilter& w,
+                                   RandomGenerator& /*rng*/, std::vector<int>& /*indices*/, TriangleBuffer& triangles)
         {
             // Compute normal and maximum distance.
             VectorType c = w.evalPos();
@@ -337,12 +344,10 @@ namespace Ponca::internal
                 }
             }
 
-            triangles.push_back(
-                internal::Triangle<P>({array_avg_pos[0], array_avg_pos[2], array_avg_pos[4]},
-                                      {array_avg_normals[0], array_avg_normals[2], array_avg_normals[4]}));
-            triangles.push_back(
-                internal::Triangle<P>({array_avg_pos[1], array_avg_pos[3], array_avg_pos[5]},
-                                      {array_avg_normals[1], array_avg_normals[3], array_avg_normals[5]}));
+            triangles.push(internal::Triangle<P>({array_avg_pos[0], array_avg_pos[2], array_avg_pos[4]},
+                                                 {array_avg_normals[0], array_avg_normals[2], array_avg_normals[4]}));
+            triangles.push(internal::Triangle<P>({array_avg_pos[1], array_avg_pos[3], array_avg_pos[5]},
+                                                 {array_avg_normals[1], array_avg_normals[3], array_avg_normals[5]}));
             return STABLE;
         }
     };
@@ -355,10 +360,8 @@ namespace Ponca
     FIT_RESULT CNC<P, M>::compute(const PointContainer& points)
     {
         init();
-        std::vector<unsigned int> indicesSample(points.size());
-        std::iota(indicesSample.begin(), indicesSample.end(), 0);
-
-        m_eCurrentState = internal::TriangleGenerator<M, P>::generate(indicesSample, points, m_nFilter, m_triangles);
+        m_eCurrentState = internal::TriangleGenerator<M, P>::generate(std::views::iota(0, int(points.size())), points,
+                                                                      m_nFilter, m_rng, m_indices, m_triangles);
         if (m_eCurrentState != STABLE)
             return m_eCurrentState;
         m_nb_vt = int(m_triangles.size());
@@ -367,10 +370,11 @@ namespace Ponca
 
     template <class P, TriangleGenerationMethod M>
     template <typename IndexRange, typename PointContainer>
-    FIT_RESULT CNC<P, M>::computeWithIds(const IndexRange& ids, const PointContainer& points)
+    FIT_RESULT CNC<P, M>::computeWithIds(IndexRange ids, const PointContainer& points)
     {
         init();
-        m_eCurrentState = internal::TriangleGenerator<M, P>::generate(ids, points, m_nFilter, m_triangles);
+        m_eCurrentState =
+            internal::TriangleGenerator<M, P>::generate(ids, points, m_nFilter, m_rng, m_indices, m_triangles);
         if (m_eCurrentState != STABLE)
             return m_eCurrentState;
         m_nb_vt = int(m_triangles.size());
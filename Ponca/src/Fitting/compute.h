@@ -8,9 +8,27 @@
 
 #include "defines.h"
 #include PONCA_MULTIARCH_INCLUDE_STD(iterator)
+#include PONCA_MULTIARCH_INCLUDE_CU_STD(span)
+#include PONCA_MULTIARCH_INCLUDE_CU_STD(type_traits)
 
 namespace Ponca
 {
+    namespace internal
+    {
+        /*! \brief Spatial structures usable with ComputeObject::computeWithTree
+
+            The structure answers range queries around a position, and `samples()` lists the indices of the indexed
+            points in `points()`. This excludes the KnnGraph, whose samples are the concatenated adjacency lists.
+        */
+        template <typename Tree>
+        concept PositionQueryableTree =
+            requires(const Tree& _tree, const typename Tree::VectorType& _p, typename Tree::Scalar _r) {
+                _tree.rangeNeighbors(_p, _r);
+                _tree.samples();
+                _tree.points();
+            };
+    } // namespace internal
+
     /*!
       \brief ComputeObject is a virtual object that represents an algorithm which can be used with the compute
       functions.
@@ -62,6 +80,67 @@ namespace Ponca
         {
             return UNDEFINED;
         };
+
+        /*! \brief Fit the neighbors of the evaluation position of the NeighborFilter, found in a spatial structure
+
+            The query radius is derived from the support of the NeighborFilter, and does not need to be kept in sync
+            with its scale by hand: for compact filters (`NeighborFilter::isCompact == true`), the neighbors are queried
+            within the evaluation scale, otherwise all the samples of the spatial structure are used.
+
+            The inheriting class must provide `getNeighborFilter()` and #computeWithIds.
+
+            \tparam Tree Spatial structure providing `rangeNeighbors(VectorType, Scalar)`, `samples()` and `points()`,
+            e.g. a KdTree (see internal::PositionQueryableTree)
+            \see #computeWithIds
+        */
+        template <typename Tree>
+        PONCA_MULTIARCH inline FIT_RESULT computeWithTree(const Tree& _tree)
+        {
+            static_assert(internal::PositionQueryableTree<Tree>,
+                          "computeWithTree requires a spatial structure indexing positions, such as a KdTree");
+            const auto& filter   = derived().getNeighborFilter();
+            using NeighborFilter = PONCA_MULTIARCH_CU_STD_NAMESPACE(remove_cvref_t)<decltype(filter)>;
+            // The fit may use a higher precision than the stored points, see MixedPrecisionPoint
+            using TreeScalar = typename Tree::Scalar;
+
+            if constexpr (requires { requires NeighborFilter::isCompact; })
+                return derived().computeWithIds(
+                    _tree.rangeNeighbors(filter.evalPos().template cast<TreeScalar>().eval(),
+                                         TreeScalar(filter.evalScale())),
+                    _tree.points());
+            else
+                return derived().computeWithIds(PONCA_MULTIARCH_CU_STD_NAMESPACE(span)(_tree.samples()),
+                                                _tree.points());
+        }
+
+        /*! \brief Set the NeighborFilter, and fit its neighbors found in a spatial structure
+            \see #computeWithTree(const Tree&)
+        */
+        template <typename Tree, typename D = Derived>
+        PONCA_MULTIARCH inline FIT_RESULT computeWithTree(const Tree& _tree, const typename D::NeighborFilter& _nFilter)
+        {
+            derived().setNeighborFilter(_nFilter);
+            return computeWithTree(_tree);
+        }
+
+        /*! \brief Fit the neighborhood of the evaluation point `_i` stored in a NeighborhoodCache
+
+            The NeighborFilter must be set beforehand, at the evaluation position of `_i`. The cached ids are iterated
+            at each pass of the fit, without querying the spatial structure again.
+
+            \tparam Cache NeighborhoodCache type
+            \tparam PointContainer STL-like container storing the points
+            \see #computeWithIds
+        */
+        template <typename Cache, typename PointContainer>
+        PONCA_MULTIARCH inline FIT_RESULT computeWithCache(const Cache& _cache, int _i, const PointContainer& _points)
+        {
+            using NeighborFilter = PONCA_MULTIARCH_CU_STD_NAMESPACE(remove_cvref_t)<
+                decltype(derived().getNeighborFilter())>;
+            static_assert(Cache::template isCompatible<NeighborFilter>,
+                          "The cache truncates the support of non-compact NeighborFilters");
+            return derived().computeWithIds(_cache.neighbors(_i), _points);
+        }
     }; // struct ComputeObject
 } // namespace Ponca
 
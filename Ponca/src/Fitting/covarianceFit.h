@@ -9,6 +9,7 @@
 
 #pragma once
 #include "./defines.h"
+#include "./eigenSolverPolicy.h"
 
 #include PONCA_MULTIARCH_INCLUDE_STD(cmath)
 #include PONCA_MULTIARCH_INCLUDE_CU_STD(limits)
@@ -53,9 +54,12 @@ namespace Ponca
 
 
        \warning This class is valid only in 3D.
+
+       \tparam SolverPolicy Policy used to decompose the covariance matrix, see IterativeEigenSolverPolicy and
+       DirectEigenSolverPolicy
      */
 
-    template <class DataPoint, class _NFilter, typename T>
+    template <class DataPoint, class _NFilter, typename T, typename SolverPolicy = IterativeEigenSolverPolicy>
     class CovarianceFitBase : public T
     {
         PONCA_FITTING_DECLARE_DEFAULT_TYPES
@@ -79,7 +83,9 @@ namespace Ponca
 
     public:
         PONCA_EXPLICIT_CAST_OPERATORS(CovarianceFitBase, covarianceFit)
-        PONCA_FITTING_DECLARE_INIT_ADD_FINALIZE
+        PONCA_FITTING_DECLARE_INIT_ADDS_FINALIZE
+        PONCA_FITTING_DECLARE_ADDMOMENTS
+        PONCA_FITTING_DECLARE_MERGE(CovarianceFitBase)
 
         /*! \brief Implements \cite Pauly:2002:PSSimplification surface variation.
             It computes the ratio \f$ d \frac{\lambda_0}{\sum_i \lambda_i} \f$ with \c d the dimension of the ambient
@@ -161,6 +167,7 @@ namespace Ponca
     public:
         PONCA_EXPLICIT_CAST_OPERATORS_DER(CovarianceFitDer, covarianceFitDer)
         PONCA_FITTING_DECLARE_INIT_ADDDER_FINALIZE
+        PONCA_FITTING_DECLARE_MERGE(CovarianceFitDer)
     }; // class CovarianceFitDer
 
 #include "covarianceFit.hpp"
@@ -7,23 +7,46 @@
  file, You can obtain one at http://mozilla.org/MPL/2.0/.
 */
 
-template <class DataPoint, class _NFilter, typename T>
-void CovarianceFitBase<DataPoint, _NFilter, T>::init()
+template <class DataPoint, class _NFilter, typename T, typename SolverPolicy>
+void CovarianceFitBase<DataPoint, _NFilter, T, SolverPolicy>::init()
 {
     Base::init();
     m_cov.setZero();
 }
 
-template <class DataPoint, class _NFilter, typename T>
-void CovarianceFitBase<DataPoint, _NFilter, T>::addLocalNeighbor(Scalar w, const VectorType& localQ,
-                                                                 const DataPoint& attributes)
+template <class DataPoint, class _NFilter, typename T, typename SolverPolicy>
+void CovarianceFitBase<DataPoint, _NFilter, T, SolverPolicy>::addLocalNeighbor(Scalar w, const VectorType& localQ,
+                                                                               const DataPoint& attributes)
 {
     Base::addLocalNeighbor(w, localQ, attributes);
     m_cov += w * localQ * localQ.transpose();
 }
 
-template <class DataPoint, class _NFilter, typename T>
-FIT_RESULT CovarianceFitBase<DataPoint, _NFilter, T>::finalize()
+template <class DataPoint, class _NFilter, typename T, typename SolverPolicy>
+template <int BlockSize>
+void CovarianceFitBase<DataPoint, _NFilter, T, SolverPolicy>::addLocalNeighbors(
+    const NeighborBlock<DataPoint, BlockSize>& block)
+{
+    Base::addLocalNeighbors(block);
+    m_cov += block.localQ * block.weights.asDiagonal() * block.localQ.transpose();
+}
+
+template <class DataPoint, class _NFilter, typename T, typename SolverPolicy>
+void CovarianceFitBase<DataPoint, _NFilter, T, SolverPolicy>::addLocalMoments(const NeighborMoments<DataPoint>& moments)
+{
+    Base::addLocalMoments(moments);
+    m_cov += moments.sumQQt;
+}
+
+template <class DataPoint, class _NFilter, typename T, typename SolverPolicy>
+void CovarianceFitBase<DataPoint, _NFilter, T, SolverPolicy>::merge(const CovarianceFitBase& other)
+{
+    Base::merge(other);
+    m_cov += other.m_cov;
+}
+
+template <class DataPoint, class _NFilter, typename T, typename SolverPolicy>
+FIT_RESULT CovarianceFitBase<DataPoint, _NFilter, T, SolverPolicy>::finalize()
 {
     // handle specific configurations
     if (Base::finalize() != STABLE)
@@ -36,74 +59,73 @@ FIT_RESULT CovarianceFitBase<DataPoint, _NFilter, T>::finalize()
     auto centroid = Base::barycenterLocal();
     m_cov         = m_cov / Base::getWeightSum() - centroid * centroid.transpose();
 
-#ifdef __CUDACC__
-    m_solver.computeDirect(m_cov);
-#else
-    m_solver.compute(m_cov);
-#endif
+    SolverPolicy::computeSelfAdjoint(m_solver, m_cov);
     Base::m_eCurrentState = (m_solver.info() == Eigen::Success ? STABLE : UNDEFINED);
 
     return Base::m_eCurrentState;
 }
 
-template <class DataPoint, class _NFilter, typename T>
-typename CovarianceFitBase<DataPoint, _NFilter, T>::Scalar CovarianceFitBase<DataPoint, _NFilter, T>::surfaceVariation()
-    const
+template <class DataPoint, class _NFilter, typename T, typename SolverPolicy>
+typename CovarianceFitBase<DataPoint, _NFilter, T, SolverPolicy>::Scalar
+CovarianceFitBase<DataPoint, _NFilter, T, SolverPolicy>::surfaceVariation() const
 {
     return m_solver.eigenvalues()(0) / m_solver.eigenvalues().mean();
 }
 
-template <class DataPoint, class _WFunctor, typename T>
-typename CovarianceFitBase<DataPoint, _WFunctor, T>::Scalar CovarianceFitBase<DataPoint, _WFunctor, T>::planarity()
-    const
+template <class DataPoint, class _WFunctor, typename T, typename SolverPolicy>
+typename CovarianceFitBase<DataPoint, _WFunctor, T, SolverPolicy>::Scalar
+CovarianceFitBase<DataPoint, _WFunctor, T, SolverPolicy>::planarity() const
 {
     return (m_solver.eigenvalues()(1) - m_solver.eigenvalues()(0)) / m_solver.eigenvalues()(2);
 }
 
-template <class DataPoint, class _WFunctor, typename T>
-typename CovarianceFitBase<DataPoint, _WFunctor, T>::Scalar CovarianceFitBase<DataPoint, _WFunctor, T>::linearity()
-    const
+template <class DataPoint, class _WFunctor, typename T, typename SolverPolicy>
+typename CovarianceFitBase<DataPoint, _WFunctor, T, SolverPolicy>::Scalar
+CovarianceFitBase<DataPoint, _WFunctor, T, SolverPolicy>::linearity() const
 {
     return (m_solver.eigenvalues()(2) - m_solver.eigenvalues()(1)) / m_solver.eigenvalues()(2);
 }
 
-template <class DataPoint, class _WFunctor, typename T>
-typename CovarianceFitBase<DataPoint, _WFunctor, T>::Scalar CovarianceFitBase<DataPoint, _WFunctor, T>::sphericity()
-    const
+template <class DataPoint, class _WFunctor, typename T, typename SolverPolicy>
+typename CovarianceFitBase<DataPoint, _WFunctor, T, SolverPolicy>::Scalar
+CovarianceFitBase<DataPoint, _WFunctor, T, SolverPolicy>::sphericity() const
 {
     return (m_solver.eigenvalues()(0)) / m_solver.eigenvalues()(2);
 }
 
-template <class DataPoint, class _WFunctor, typename T>
-typename CovarianceFitBase<DataPoint, _WFunctor, T>::Scalar CovarianceFitBase<DataPoint, _WFunctor, T>::anisotropy()
-    const
+template <class DataPoint, class _WFunctor, typename T, typename SolverPolicy>
+typename CovarianceFitBase<DataPoint, _WFunctor, T, SolverPolicy>::Scalar
+CovarianceFitBase<DataPoint, _WFunctor, T, SolverPolicy>::anisotropy() const
 {
     return (m_solver.eigenvalues()(2) - m_solver.eigenvalues()(0)) / m_solver.eigenvalues()(2);
 }
 
-template <class DataPoint, class _WFunctor, typename T>
-typename CovarianceFitBase<DataPoint, _WFunctor, T>::Scalar CovarianceFitBase<DataPoint, _WFunctor, T>::eigenentropy()
-    const
+template <class DataPoint, class _WFunctor, typename T, typename SolverPolicy>
+typename CovarianceFitBase<DataPoint, _WFunctor, T, SolverPolicy>::Scalar
+CovarianceFitBase<DataPoint, _WFunctor, T, SolverPolicy>::eigenentropy() const
 {
     return -(m_solver.eigenvalues()(0) * log(m_solver.eigenvalues()(0)) +
              m_solver.eigenvalues()(1) * log(m_solver.eigenvalues()(1)) +
              m_solver.eigenvalues()(2) * log(m_solver.eigenvalues()(2)));
 }
 
-template <class DataPoint, class _WFunctor, typename T>
-typename CovarianceFitBase<DataPoint, _WFunctor, T>::Scalar CovarianceFitBase<DataPoint, _WFunctor, T>::lambda_0() const
+template <class DataPoint, class _WFunctor, typename T, typename SolverPolicy>
+typename CovarianceFitBase<DataPoint, _WFunctor, T, SolverPolicy>::Scalar
+CovarianceFitBase<DataPoint, _WFunctor, T, SolverPolicy>::lambda_0() const
 {
     return m_solver.eigenvalues()(0);
 }
 
-template <class DataPoint, class _WFunctor, typename T>
-typename CovarianceFitBase<DataPoint, _WFunctor, T>::Scalar CovarianceFitBase<DataPoint, _WFunctor, T>::lambda_1() const
+template <class DataPoint, class _WFunctor, typename T, typename SolverPolicy>
+typename CovarianceFitBase<DataPoint, _WFunctor, T, SolverPolicy>::Scalar
+CovarianceFitBase<DataPoint, _WFunctor, T, SolverPolicy>::lambda_1() const
 {
     return m_solver.eigenvalues()(1);
 }
 
-template <class DataPoint, class _WFunctor, typename T>
-typename CovarianceFitBase<DataPoint, _WFunctor, T>::Scalar CovarianceFitBase<DataPoint, _WFunctor, T>::lambda_2() const
+template <class DataPoint, class _WFunctor, typename T, typename SolverPolicy>
+typename CovarianceFitBase<DataPoint, _WFunctor, T, SolverPolicy>::Scalar
+CovarianceFitBase<DataPoint, _WFunctor, T, SolverPolicy>::lambda_2() const
 {
     return m_solver.eigenvalues()(2);
 }
@@ -122,8 +144,18 @@ void CovarianceFitDer<DataPoint, _NFilter, DiffType, T>::addLocalNeighbor(Scalar
                                                                           const DataPoint& attributes, ScalarArray& dw)
 {
     Base::addLocalNeighbor(w, localQ, attributes, dw);
+    // The outer product is shared by all the derivatives
+    const MatrixType qqT = localQ * localQ.transpose();
+    for (int k = 0; k < Base::NbDerivatives; ++k)
+        m_dCov[k] += dw[k] * qqT;
+}
+
+template <class DataPoint, class _NFilter, int DiffType, typename T>
+void CovarianceFitDer<DataPoint, _NFilter, DiffType, T>::merge(const CovarianceFitDer& other)
+{
+    Base::merge(other);
     for (int k = 0; k < Base::NbDerivatives; ++k)
-        m_dCov[k] += dw[k] * localQ * localQ.transpose();
+        m_dCov[k] += other.m_dCov[k];
 }
 
 template <class DataPoint, class _NFilter, int DiffType, typename T>
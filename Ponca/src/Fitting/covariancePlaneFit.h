@@ -129,7 +129,11 @@ namespace Ponca
 
         // \brief Returns the derivatives of the scalar field at the evaluation point
         //! \see method `#isSigned` of the fit to check if the sign is reliable
-        PONCA_MULTIARCH [[nodiscard]] inline ScalarArray dPotential() const { return m_dDist; }
+        PONCA_MULTIARCH [[nodiscard]] inline ScalarArray dPotential() const
+        {
+            static_assert(Base::isPotentialDer(), "dPotential is not in the requested derivative outputs");
+            return m_dDist;
+        }
 
         /*! \brief Returns the derivatives of the primitive normal */
         PONCA_MULTIARCH [[nodiscard]] inline VectorArray dNormal() const { return m_dNormal; }
@@ -80,10 +80,13 @@ FIT_RESULT CovariancePlaneDerImpl<DataPoint, _NFilter, DiffType, T>::finalize()
                 z(1) /= shifted_eivals(1);
             m_dNormal.col(k) = Base::m_solver.eigenvectors().template rightCols<2>() * z;
 
-            VectorType dDiff = dBarycenter.col(k);
-            if (k > 0 || !Base::isScaleDer())
-                dDiff(Base::isScaleDer() ? k - 1 : k) += 1;
-            m_dDist(k) = m_dNormal.col(k).dot(barycenter) + normal.dot(dDiff);
+            if constexpr (Base::isPotentialDer())
+            {
+                VectorType dDiff = dBarycenter.col(k);
+                if (k > 0 || !Base::isScaleDer())
+                    dDiff(Base::isScaleDer() ? k - 1 : k) += 1;
+                m_dDist(k) = m_dNormal.col(k).dot(barycenter) + normal.dot(dDiff);
+            }
         }
     }
 
@@ -20,15 +20,9 @@
 
 #define PONCA_EXPLICIT_CAST_OPERATORS(CLASSNAME, CONVERTER)                                          \
     /*! \brief Explicit conversion to CLASSNAME, to access methods potentially hidden by heritage */ \
-    PONCA_MULTIARCH inline CLASSNAME<DataPoint, _NFilter, T>& CONVERTER()                            \
-    {                                                                                                \
-        return *static_cast<CLASSNAME<DataPoint, _NFilter, T>*>(this);                               \
-    }                                                                                                \
+    PONCA_MULTIARCH inline CLASSNAME& CONVERTER() { return *static_cast<CLASSNAME*>(this); }         \
     /*! \brief Explicit conversion to CLASSNAME, to access methods potentially hidden by heritage */ \
-    PONCA_MULTIARCH inline const CLASSNAME<DataPoint, _NFilter, T>& CONVERTER() const                \
-    {                                                                                                \
-        return *static_cast<const CLASSNAME<DataPoint, _NFilter, T>*>(this);                         \
-    }
+    PONCA_MULTIARCH inline const CLASSNAME& CONVERTER() const { return *static_cast<const CLASSNAME*>(this); }
 
 // CAST OPERATORS
 
@@ -75,6 +69,16 @@ public:
  * after #setNeighborFilter) */
 #define PONCA_FITTING_APIDOC_ADDNEIGHBOR     /*! Add a neighbor to perform the fit */
 #define PONCA_FITTING_APIDOC_ADDNEIGHBOR_DER /*! Add a neighbor to perform the fit */
+#define PONCA_FITTING_APIDOC_ADDNEIGHBORS                                                                          \
+/*! Add a block of neighbors to perform the fit, with the same result as calling addLocalNeighbor on each of them \
+ * (up to floating point rounding). \see NeighborBlock */
+#define PONCA_FITTING_APIDOC_ADDMOMENTS                                                                             \
+/*! Add a group of neighbors sharing the same weight from their moments, with the same result as calling           \
+ * addLocalNeighbor on each of them (up to floating point rounding). \see NeighborMoments */
+#define PONCA_FITTING_APIDOC_MERGE                                                                                 \
+/*! Add the neighbors accumulated by another fit, with the same result as adding them to this fit (up to floating \
+ * point rounding). Both fits must share the same NeighborFilter and be at the same pass, between #startNewPass and \
+ * #finalize. */
 #define PONCA_FITTING_APIDOC_FINALIZE \
 /*! Finalize the procedure \return Fitting Status \warning Must be called be for any use of the fitting output */
 
@@ -95,12 +99,28 @@ public:
     PONCA_FITTING_APIDOC_ADDNEIGHBOR      \
     PONCA_MULTIARCH inline void addLocalNeighbor(Scalar w, const VectorType& localQ, const DataPoint& attributes);
 
+/// Declare the block version of Concept::ComputationalObjectConcept::addLocalNeighbor
+#define PONCA_FITTING_DECLARE_ADDNEIGHBORS \
+    PONCA_FITTING_APIDOC_ADDNEIGHBORS      \
+    template <int BlockSize>               \
+    PONCA_MULTIARCH inline void addLocalNeighbors(const NeighborBlock<DataPoint, BlockSize>& block);
+
+/// Declare the aggregated version of Concept::ComputationalObjectConcept::addLocalNeighbor
+#define PONCA_FITTING_DECLARE_ADDMOMENTS \
+    PONCA_FITTING_APIDOC_ADDMOMENTS      \
+    PONCA_MULTIARCH inline void addLocalMoments(const NeighborMoments<DataPoint>& moments);
+
 /// Declare Concept::ComputationalDerivativesConcept::addLocalNeighbor
 #define PONCA_FITTING_DECLARE_ADDNEIGHBOR_DER                                                                     \
     PONCA_FITTING_APIDOC_ADDNEIGHBOR_DER                                                                          \
     PONCA_MULTIARCH inline void addLocalNeighbor(Scalar w, const VectorType& localQ, const DataPoint& attributes, \
                                                  ScalarArray& dw);
 
+/// Declare the merge of the accumulators of two fits, where CLASS is the name of the fitting extension
+#define PONCA_FITTING_DECLARE_MERGE(CLASS) \
+    PONCA_FITTING_APIDOC_MERGE             \
+    PONCA_MULTIARCH inline void merge(const CLASS& other);
+
 /// Declare Concept::ComputationalObjectConcept::finalize
 #define PONCA_FITTING_DECLARE_FINALIZE \
     PONCA_FITTING_APIDOC_FINALIZE      \
@@ -111,6 +131,10 @@ public:
     PONCA_FITTING_DECLARE_ADDNEIGHBOR           \
     PONCA_FITTING_DECLARE_FINALIZE
 
+#define PONCA_FITTING_DECLARE_INIT_ADDS_FINALIZE \
+    PONCA_FITTING_DECLARE_INIT_ADD_FINALIZE      \
+    PONCA_FITTING_DECLARE_ADDNEIGHBORS
+
 #define PONCA_FITTING_DECLARE_INIT_ADDDER_FINALIZE \
     PONCA_FITTING_DECLARE_INIT                     \
     PONCA_FITTING_DECLARE_ADDNEIGHBOR_DER          \
@@ -39,6 +39,19 @@ namespace Ponca
             Base::addLocalNeighbor(w, localQ, attributes);
         }
 
+        PONCA_FITTING_APIDOC_ADDNEIGHBORS
+        template <int BlockSize>
+        PONCA_MULTIARCH inline void addLocalNeighbors(const NeighborBlock<DataPoint, BlockSize>& block)
+        {
+            Base::addLocalNeighbors(block);
+        }
+
+        PONCA_FITTING_APIDOC_ADDMOMENTS
+        PONCA_MULTIARCH inline void addLocalMoments(const NeighborMoments<DataPoint>& moments)
+        {
+            Base::addLocalMoments(moments);
+        }
+
         PONCA_FITTING_APIDOC_FINALIZE
         PONCA_MULTIARCH [[nodiscard]] inline FIT_RESULT finalize() { return Base::finalize(); }
 
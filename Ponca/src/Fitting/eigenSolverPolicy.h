@@ -0,0 +1,72 @@
+/*
+ This Source Code Form is subject to the terms of the Mozilla Public
+ License, v. 2.0. If a copy of the MPL was not distributed with this
+ file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+#pragma once
+
+#include "./defines.h"
+
+namespace Ponca
+{
+    /*!
+     * \brief Eigen solver policy relying on the iterative solvers of Eigen (default)
+     *
+     * - self-adjoint matrices are decomposed with `Eigen::SelfAdjointEigenSolver::compute`
+     *   (`Eigen::SelfAdjointEigenSolver::computeDirect` when compiled with CUDA),
+     * - generalized eigenvalue problems are solved with the non self-adjoint `Eigen::EigenSolver`.
+     *
+     * \see DirectEigenSolverPolicy
+     */
+    struct IterativeEigenSolverPolicy
+    {
+        /// \brief Are the generalized eigenvalue problems rewritten as self-adjoint ones ?
+        static constexpr bool isSelfAdjointGeneralized = false;
+
+        /// \brief Decompose the self-adjoint matrix `m`
+        template <typename Solver, typename MatrixType>
+        PONCA_MULTIARCH static inline void computeSelfAdjoint(Solver& solver, const MatrixType& m)
+        {
+#ifdef __CUDACC__
+            solver.computeDirect(m);
+#else
+            solver.compute(m);
+#endif
+        }
+    };
+
+    /*!
+     * \brief Eigen solver policy trading accuracy for speed
+     *
+     * - 2x2 and 3x3 self-adjoint matrices are decomposed in closed form with
+     *   `Eigen::SelfAdjointEigenSolver::computeDirect` (larger matrices use the iterative solver),
+     * - generalized eigenvalue problems \f$ A\mathbf{u} = \lambda B\mathbf{u} \f$ with a positive definite
+     *   \f$ B = LL^T \f$ are rewritten as the self-adjoint problem \f$ L^{-1}AL^{-T}\mathbf{y} = \lambda\mathbf{y} \f$.
+     *
+     * The closed-form solver loses accuracy on the eigenvectors when the eigenvalues are close, e.g. for isotropic
+     * neighborhoods. See `examples/cpp/ponca_benchmark_eigensolvers.cpp` for a comparison with
+     * IterativeEigenSolverPolicy.
+     *
+     * The policy is selected per fitting extension, e.g.
+     * \code
+     * template <class DataPoint, class _NFilter, typename T>
+     * using DirectCovariancePlaneFit = CovariancePlaneFitImpl<
+     *     DataPoint, _NFilter,
+     *     CovarianceFitBase<DataPoint, _NFilter, MeanPosition<DataPoint, _NFilter, Plane<DataPoint, _NFilter, T>>,
+     *                       DirectEigenSolverPolicy>>;
+     * \endcode
+     */
+    struct DirectEigenSolverPolicy
+    {
+        /// \copydoc IterativeEigenSolverPolicy::isSelfAdjointGeneralized
+        static constexpr bool isSelfAdjointGeneralized = true;
+
+        /// \copydoc IterativeEigenSolverPolicy::computeSelfAdjoint
+        template <typename Solver, typename MatrixType>
+        PONCA_MULTIARCH static inline void computeSelfAdjoint(Solver& solver, const MatrixType& m)
+        {
+            solver.computeDirect(m);
+        }
+    };
+} // namespace Ponca
@@ -29,12 +29,24 @@ namespace Ponca
     };
 
     /// Flags defining which derivatives need to be computed.
+    ///
+    /// The differentiation variables are selected by FitScaleDer and/or FitSpaceDer. The output flags FitPotentialDer
+    /// and FitNormalDer optionally restrict the derivatives computed by BasketDiff, so that the extensions can skip the
+    /// accumulators and finalize steps needed only by the other outputs. When no output flag is set, all the outputs
+    /// are computed.
     /// \warning Flags have to be combined using `|`
     enum DiffType : unsigned int
     {
-        FitScaleDer      = 0x01,                     /*!< \brief Flag indicating a scale differentiation. */
-        FitSpaceDer      = 0x02,                     /*!< \brief Flag indicating a space differentiation. */
-        FitScaleSpaceDer = FitScaleDer | FitSpaceDer /*!< \brief Flag indicating a scale-space differentiation. */
+        FitScaleDer      = 0x01,                      /*!< \brief Flag indicating a scale differentiation. */
+        FitSpaceDer      = 0x02,                      /*!< \brief Flag indicating a space differentiation. */
+        FitScaleSpaceDer = FitScaleDer | FitSpaceDer, /*!< \brief Flag indicating a scale-space differentiation. */
+        /*! \brief Flag restricting the derivative outputs to the derivatives of the potential (`dPotential`). */
+        FitPotentialDer = 0x04,
+        /*! \brief Flag restricting the derivative outputs to the derivatives of the normal (`dNormal`), and the
+            quantities computed from them (e.g. curvatures). */
+        FitNormalDer = 0x08,
+        /*! \brief Derivative outputs computed when no output flag is set. */
+        FitAllOutputsDer = FitPotentialDer | FitNormalDer
     };
 
 } // namespace Ponca
@@ -122,7 +122,7 @@ namespace Ponca
         PONCA_MULTIARCH [[nodiscard]] inline bool operator==(
             const QuadraticHeightField<DataPoint, _NFilter, T>& other) const
         {
-            return m_coeffs.isApprox(other.m_params);
+            return m_coeffs.isApprox(other.m_coeffs);
         }
 
         /*! \brief Comparison operator, convenience function */
@@ -246,7 +246,7 @@ namespace Ponca
         PONCA_MULTIARCH [[nodiscard]] inline bool operator==(
             const RestrictedQuadraticHeightField<DataPoint, _NFilter, T>& other) const
         {
-            return m_coeffs.isApprox(other.m_params);
+            return m_coeffs.isApprox(other.m_coeffs);
         }
 
         /*! \brief Comparison operator, convenience function */
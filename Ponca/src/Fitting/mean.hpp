@@ -22,6 +22,28 @@ void MeanPosition<DataPoint, _NFilter, T>::addLocalNeighbor(Scalar w, const Vect
     m_sumP += w * localQ;
 }
 
+template <class DataPoint, class _NFilter, typename T>
+template <int BlockSize>
+void MeanPosition<DataPoint, _NFilter, T>::addLocalNeighbors(const NeighborBlock<DataPoint, BlockSize>& block)
+{
+    Base::addLocalNeighbors(block);
+    m_sumP += block.localQ * block.weights;
+}
+
+template <class DataPoint, class _NFilter, typename T>
+void MeanPosition<DataPoint, _NFilter, T>::addLocalMoments(const NeighborMoments<DataPoint>& moments)
+{
+    Base::addLocalMoments(moments);
+    m_sumP += moments.sumQ;
+}
+
+template <class DataPoint, class _NFilter, typename T>
+void MeanPosition<DataPoint, _NFilter, T>::merge(const MeanPosition& other)
+{
+    Base::merge(other);
+    m_sumP += other.m_sumP;
+}
+
 template <class DataPoint, class _NFilter, typename T>
 void MeanNormal<DataPoint, _NFilter, T>::init()
 {
@@ -37,6 +59,28 @@ void MeanNormal<DataPoint, _NFilter, T>::addLocalNeighbor(Scalar w, const Vector
     m_sumN += w * attributes.normal();
 }
 
+template <class DataPoint, class _NFilter, typename T>
+template <int BlockSize>
+void MeanNormal<DataPoint, _NFilter, T>::addLocalNeighbors(const NeighborBlock<DataPoint, BlockSize>& block)
+{
+    Base::addLocalNeighbors(block);
+    m_sumN += block.normals * block.weights;
+}
+
+template <class DataPoint, class _NFilter, typename T>
+void MeanNormal<DataPoint, _NFilter, T>::addLocalMoments(const NeighborMoments<DataPoint>& moments)
+{
+    Base::addLocalMoments(moments);
+    m_sumN += moments.sumN;
+}
+
+template <class DataPoint, class _NFilter, typename T>
+void MeanNormal<DataPoint, _NFilter, T>::merge(const MeanNormal& other)
+{
+    Base::merge(other);
+    m_sumN += other.m_sumN;
+}
+
 template <class DataPoint, class _NFilter, int DiffType, typename T>
 void MeanPositionDer<DataPoint, _NFilter, DiffType, T>::init()
 {
@@ -52,6 +96,13 @@ void MeanPositionDer<DataPoint, _NFilter, DiffType, T>::addLocalNeighbor(Scalar
     m_dSumP += localQ * dw;
 }
 
+template <class DataPoint, class _NFilter, int DiffType, typename T>
+void MeanPositionDer<DataPoint, _NFilter, DiffType, T>::merge(const MeanPositionDer& other)
+{
+    Base::merge(other);
+    m_dSumP += other.m_dSumP;
+}
+
 template <class DataPoint, class _NFilter, int DiffType, typename T>
 void MeanNormalDer<DataPoint, _NFilter, DiffType, T>::init()
 {
@@ -66,3 +117,10 @@ void MeanNormalDer<DataPoint, _NFilter, DiffType, T>::addLocalNeighbor(Scalar w,
     Base::addLocalNeighbor(w, localQ, attributes, dw);
     m_dSumN += attributes.normal() * dw;
 }
+
+template <class DataPoint, class _NFilter, int DiffType, typename T>
+void MeanNormalDer<DataPoint, _NFilter, DiffType, T>::merge(const MeanNormalDer& other)
+{
+    Base::merge(other);
+    m_dSumN += other.m_dSumN;
+}
@@ -12,8 +12,20 @@
 
 #include "Eigen/Core"
 
+#include <span>
+#include <vector>
+
 namespace Ponca
 {
+    /*!
+     * \brief Convergence of an MLS projection, optionally reported by MLSEvaluationScheme::computeWithTree
+     */
+    struct MLSConvergence
+    {
+        unsigned int nbIterations{0}; ///< Number of fits computed
+        bool converged{false};        ///< Did the evaluation position converge before the maximum number of iterations
+    };
+
     /*!
      * \brief Computes the fit using the Moving Least Squares approach.
      * The projection operator can be customized, see \cite Alexa:2004:projection.
@@ -93,6 +105,67 @@ namespace Ponca
             return computeMLSImpl(_co, [&]() { return _co.computeWithIds(_range, _container); }, _p);
         }
 
+        /**
+         * \copydoc computeMLSImpl
+         *
+         * The neighborhood of the evaluation point `_i` stored in a NeighborhoodCache is used at all the iterations,
+         * as with #computeWithIds. The cached weights are ignored, as the evaluation position moves between the
+         * iterations.
+         *
+         * \tparam ComputeObject ComputeObject type
+         * \tparam Cache NeighborhoodCache type
+         * \tparam PointContainer Point container (must provide random access)
+         * \tparam Project Projection functor type
+         *
+         * \param _co The fitting object
+         * \param _cache The neighborhoods
+         * \param _i The evaluation point in the cache
+         * \param _container The point container
+         * \param _p Projection functor
+         * \param _convergence If not null, receives the convergence of the projection
+         *
+         * \return The result of the fit
+         */
+        template <typename ComputeObject, typename Cache, typename PointContainer,
+                  typename Project = DirectProjectionOperator>
+        PONCA_MULTIARCH inline FIT_RESULT computeWithCache(ComputeObject& _co, const Cache& _cache, int _i,
+                                                           const PointContainer& _container,
+                                                           const Project& _p                  = Project{},
+                                                           MLSConvergence* const _convergence = nullptr) const
+        {
+            static_assert(Cache::template isCompatible<typename ComputeObject::NeighborFilter>,
+                          "The cache truncates the support of non-compact NeighborFilters");
+            return computeMLSImpl(
+                _co, [&]() { return _co.computeWithIds(_cache.neighbors(_i), _container); }, _p, _convergence);
+        }
+
+        /**
+         * \copydoc computeMLSImpl
+         *
+         * Unlike #computeWithIds, the neighbors are queried again in the spatial structure at each iteration, around
+         * the current evaluation position, with the support of the NeighborFilter (see ComputeObject::computeWithTree).
+         *
+         * \tparam ComputeObject ComputeObject type
+         * \tparam Tree Spatial structure providing `rangeNeighbors(VectorType, Scalar)` and `points()`, e.g. a KdTree
+         * \tparam Project Projection functor type
+         *
+         * \param _co The fitting object
+         * \param _tree The spatial structure storing the points
+         * \param _p Projection functor
+         * \param _convergence If not null, receives the convergence of the projection
+         *
+         * \return The result of the fit
+         *
+         * \see CachedMLSEvaluationScheme to reuse the neighborhoods between the iterations
+         */
+        template <typename ComputeObject, typename Tree, typename Project = DirectProjectionOperator>
+        PONCA_MULTIARCH inline FIT_RESULT computeWithTree(ComputeObject& _co, const Tree& _tree,
+                                                          const Project& _p                  = Project{},
+                                                          MLSConvergence* const _convergence = nullptr) const
+        {
+            return computeMLSImpl(_co, [&]() { return _co.computeWithTree(_tree); }, _p, _convergence);
+        }
+
         /// \brief Default epsilon value for stopping MLS iterations
         static constexpr Scalar epsDefault = Eigen::NumTraits<Scalar>::dummy_precision();
         /// \brief Default maximum number of MLS iterations
@@ -102,7 +175,7 @@ namespace Ponca
         /// \brief Maximum number of MLS iterations
         unsigned int nIter = nIterDefault;
 
-    private:
+    protected:
         /*!
          * \brief Computes the fit using the MLS iteration process.
          *
@@ -115,37 +188,121 @@ namespace Ponca
          * \param _co The fitting object
          * \param _compute The procedure to compute estimator
          * \param _p Projection functor
+         * \param _convergence If not null, receives the convergence of the projection
          *
          * \return The result of the fit
          */
         template <typename ComputeObject, typename Func, typename Project = DirectProjectionOperator>
         PONCA_MULTIARCH inline FIT_RESULT computeMLSImpl(ComputeObject& _co, Func&& _compute,
-                                                         const Project& _p = Project{}) const
+                                                         const Project& _p                  = Project{},
+                                                         MLSConvergence* const _convergence = nullptr) const
         {
             FIT_RESULT res = UNDEFINED;
             auto filter    = _co.getNeighborFilter();
             auto lastPos   = filter.evalPos();
 
+            MLSConvergence convergence;
             for (unsigned int mm = 0; mm < nIter; ++mm)
             {
                 filter.changeNeighborhoodFrame(lastPos);
                 _co.setNeighborFilter(filter);
                 res = _compute();
+                ++convergence.nbIterations;
 
-                if (_co.isStable())
-                {
-                    auto newPos = _p(_co, lastPos);
-                    if (newPos.isApprox(lastPos, eps))
-                        return res;
-                    lastPos = newPos;
-                }
-                else
+                if (!_co.isStable())
+                    break;
+
+                auto newPos = _p(_co, lastPos);
+                if (newPos.isApprox(lastPos, eps))
                 {
-                    return res;
+                    convergence.converged = true;
+                    break;
                 }
+                lastPos = newPos;
             }
 
+            if (_convergence)
+                *_convergence = convergence;
             return res;
         }
     };
+
+    /*!
+     * \brief MLSEvaluationScheme reusing the neighborhoods between the MLS iterations
+     *
+     * The projected point usually moves by a small fraction of the scale between two iterations, while
+     * MLSEvaluationScheme::computeWithTree queries the neighbors again at each of them. This scheme gathers the
+     * neighbors in an enlarged ball of radius \f$ t(1 + \text{margin}) \f$, and reuses them while the ball of
+     * radius \f$ t \f$ around the evaluation position stays inside it. The NeighborFilter then discards the cached
+     * neighbors that are outside of its support, so the fits use the same neighbors as with
+     * MLSEvaluationScheme::computeWithTree, up to their order.
+     *
+     * A larger margin saves more queries, but each fit iterates over more cached neighbors.
+     *
+     * \warning The scheme stores the cached neighborhood: use one instance per thread.
+     *
+     * \tparam Scalar scalar type
+     */
+    template <typename Scalar>
+    struct CachedMLSEvaluationScheme : public MLSEvaluationScheme<Scalar>
+    {
+        using Base = MLSEvaluationScheme<Scalar>;
+
+        CachedMLSEvaluationScheme(unsigned int _nIter = Base::nIterDefault, Scalar _eps = Base::epsDefault,
+                                  Scalar _margin = marginDefault)
+            : Base(_nIter, _eps), margin(_margin)
+        {
+        }
+
+        /**
+         * \copydoc MLSEvaluationScheme::computeWithTree
+         *
+         * The neighbors are queried again only when the evaluation position leaves the cached neighborhood.
+         */
+        template <typename ComputeObject, typename Tree, typename Project = DirectProjectionOperator>
+        inline FIT_RESULT computeWithTree(ComputeObject& _co, const Tree& _tree, const Project& _p = Project{},
+                                          MLSConvergence* const _convergence = nullptr)
+        {
+            using VectorType = typename ComputeObject::VectorType;
+
+            VectorType cacheCenter;
+            Scalar cacheRadius = Scalar(-1);
+            m_nbQueries        = 0;
+
+            return Base::computeMLSImpl(
+                _co,
+                [&]() {
+                    const auto& filter  = _co.getNeighborFilter();
+                    const VectorType& x = filter.evalPos();
+                    const Scalar t      = filter.evalScale();
+
+                    // The cached ball must contain the support of the filter
+                    if (cacheRadius < Scalar(0) || (x - cacheCenter).norm() + t > cacheRadius)
+                    {
+                        cacheCenter = x;
+                        cacheRadius = t * (Scalar(1) + margin);
+                        m_neighbors.clear();
+                        using TreeScalar = typename Tree::Scalar;
+                        for (int j : _tree.rangeNeighbors(cacheCenter.template cast<TreeScalar>().eval(),
+                                                          TreeScalar(cacheRadius)))
+                            m_neighbors.push_back(j);
+                        ++m_nbQueries;
+                    }
+                    return _co.computeWithIds(std::span<const int>(m_neighbors), _tree.points());
+                },
+                _p, _convergence);
+        }
+
+        /// \brief Number of range queries performed during the last call to #computeWithTree
+        [[nodiscard]] inline int nbQueries() const { return m_nbQueries; }
+
+        /// \brief Default margin, relative to the scale of the NeighborFilter
+        static constexpr Scalar marginDefault = Scalar(0.1);
+        /// \brief Enlargement of the cached neighborhoods, relative to the scale of the NeighborFilter
+        Scalar margin = marginDefault;
+
+    private:
+        std::vector<int> m_neighbors; ///< Cached neighborhood, kept to reuse its capacity
+        int m_nbQueries{0};
+    };
 } // namespace Ponca
@@ -17,6 +17,9 @@ namespace Ponca
      *
      * The differentiation is determined by a previous basket elements that must
      * provides first order derivatives of the algebraic sphere parameters.
+     *
+     * The second order derivatives are only needed by #dNormal: when the derivative outputs are restricted to
+     * FitPotentialDer, their accumulation and computation are skipped.
      */
     template <class DataPoint, class _NFilter, int DiffType, typename T>
     class MlsSphereFitDer : public T
@@ -92,6 +95,7 @@ namespace Ponca
         PONCA_EXPLICIT_CAST_OPERATORS_DER(MlsSphereFitDer, mlsSphereFitDer)
 
         PONCA_FITTING_DECLARE_INIT_ADDDER_FINALIZE
+        PONCA_FITTING_DECLARE_MERGE(MlsSphereFitDer)
 
         //! \brief Returns the derivatives of the scalar field at the evaluation point
         //! \see method `#isSigned` of the fit to check if the sign is reliable
@@ -8,6 +8,9 @@ template <class DataPoint, class _NFilter, int DiffType, typename T>
 void MlsSphereFitDer<DataPoint, _NFilter, DiffType, T>::init()
 {
     Base::init();
+    // The second-order derivatives are only needed by dNormal
+    if constexpr (!Base::isNormalDer())
+        return;
 
     m_d2Uc = Matrix::Zero(), m_d2Uq = Matrix::Zero();
     m_d2Ul = MatrixArray::Zero();
@@ -25,6 +28,8 @@ void MlsSphereFitDer<DataPoint, _NFilter, DiffType, T>::addLocalNeighbor(Scalar
                                                                          const DataPoint& attributes, ScalarArray& dw)
 {
     Base::addLocalNeighbor(w, localQ, attributes, dw);
+    if constexpr (!Base::isNormalDer())
+        return;
     // compute weight derivatives
     Matrix d2w = Matrix::Zero();
 
@@ -51,10 +56,27 @@ void MlsSphereFitDer<DataPoint, _NFilter, DiffType, T>::addLocalNeighbor(Scalar
     }
 }
 
+template <class DataPoint, class _NFilter, int DiffType, typename T>
+void MlsSphereFitDer<DataPoint, _NFilter, DiffType, T>::merge(const MlsSphereFitDer& other)
+{
+    Base::merge(other);
+    if constexpr (!Base::isNormalDer())
+        return;
+
+    m_d2SumDotPN += other.m_d2SumDotPN;
+    m_d2SumDotPP += other.m_d2SumDotPP;
+    m_d2SumW += other.m_d2SumW;
+
+    m_d2SumP += other.m_d2SumP;
+    m_d2SumN += other.m_d2SumN;
+}
+
 template <class DataPoint, class _NFilter, int DiffType, typename T>
 FIT_RESULT MlsSphereFitDer<DataPoint, _NFilter, DiffType, T>::finalize()
 {
     Base::finalize();
+    if constexpr (!Base::isNormalDer())
+        return Base::m_eCurrentState;
 
     if (this->isReady())
     {
@@ -152,6 +174,7 @@ typename MlsSphereFitDer<DataPoint, _NFilter, DiffType, T>::ScalarArray MlsSpher
     // In a centered basis (x=0), we obtain:
     //   the scale derivative:   d_t(s)(t,0) = d_t(uc)(t,0)
     //   the spatial derivative: d_x(s)(t,0) = d_x(uc)(t,0) + ul(t,0)
+    static_assert(Base::isPotentialDer(), "dPotential is not in the requested derivative outputs");
     ScalarArray result = Base::m_dUc;
 
     if (Base::isSpaceDer())
@@ -180,6 +203,7 @@ typename MlsSphereFitDer<DataPoint, _NFilter, DiffType, T>::VectorArray MlsSpher
     // Where in a centered basis (x=0), we have:
     //   d2_tx(s) = d2_tx(uc) + d_t(ul)
     //   d2_x2(s) = d2_x2(uc) + d_x(ul) + d_x(ul)^T + 2 uq I
+    static_assert(Base::isNormalDer(), "dNormal is not in the requested derivative outputs");
     VectorArray result = VectorArray::Zero();
 
     VectorType grad = Base::m_dUc.template tail<Dim>().transpose() + Base::m_ul;
@@ -14,7 +14,6 @@
 #include PONCA_MULTIARCH_INCLUDE_STD(cmath)
 
 #include <Eigen/Dense>
-#include <Eigen/SVD>
 #include <Eigen/Geometry>
 
 namespace Ponca
@@ -150,13 +149,14 @@ namespace Ponca
         };
 
     public:
-        // we need to use dynamic matric to use ThinU, ThinV for solving
-        using SampleMatrix                     = Eigen::Matrix<Scalar, Eigen::Dynamic, Eigen::Dynamic>;
         using QuadraticHeightFieldCoefficients = typename Base::HeightFieldCoefficients;
+        /// \brief Fixed-size matrix of the normal equations, so that fitting does not allocate on the heap
+        using SampleMatrix = Eigen::Matrix<Scalar, QuadraticHeightFieldCoefficients::RowsAtCompileTime,
+                                          QuadraticHeightFieldCoefficients::RowsAtCompileTime>;
 
         // protected:
     public:               // temporary DO NOT MERGE THIS
-        SampleMatrix m_A; /*!< \brief Quadric input samples */
+        SampleMatrix m_A{SampleMatrix::Zero()}; /*!< \brief Quadric input samples */
         QuadraticHeightFieldCoefficients m_b{QuadraticHeightFieldCoefficients::Zero()}; /*!< \brief Observations */
 
         bool m_planeIsReady{false};
@@ -164,6 +164,7 @@ namespace Ponca
     public:
         PONCA_EXPLICIT_CAST_OPERATORS(MongePatchQuadraticFitImpl, mongePatchQuadraticFit)
         PONCA_FITTING_DECLARE_INIT_ADD_FINALIZE
+        PONCA_FITTING_DECLARE_MERGE(MongePatchQuadraticFitImpl)
     }; // MongePatchQuadraticFitImpl
     /*!
      * \brief Extension to compute the best fit restricted quadric on 3d points expressed as \f$f(u,v)=h\f$
@@ -185,12 +186,13 @@ namespace Ponca
         };
 
     public:
-        // we need to use dynamic matric to use ThinU, ThinV for solving
-        using SampleMatrix                     = Eigen::Matrix<Scalar, Eigen::Dynamic, Eigen::Dynamic>;
         using QuadraticHeightFieldCoefficients = typename Base::HeightFieldCoefficients;
+        /// \brief Fixed-size matrix of the normal equations, so that fitting does not allocate on the heap
+        using SampleMatrix = Eigen::Matrix<Scalar, QuadraticHeightFieldCoefficients::RowsAtCompileTime,
+                                          QuadraticHeightFieldCoefficients::RowsAtCompileTime>;
 
     protected:
-        SampleMatrix m_A; /*!< \brief Quadric input samples */
+        SampleMatrix m_A{SampleMatrix::Zero()}; /*!< \brief Quadric input samples */
         QuadraticHeightFieldCoefficients m_b{QuadraticHeightFieldCoefficients::Zero()}; /*!< \brief Observations */
 
         bool m_planeIsReady{false};
@@ -198,6 +200,7 @@ namespace Ponca
     public:
         PONCA_EXPLICIT_CAST_OPERATORS(MongePatchRestrictedQuadraticFitImpl, mongePatchQuadraticFit)
         PONCA_FITTING_DECLARE_INIT_ADD_FINALIZE
+        PONCA_FITTING_DECLARE_MERGE(MongePatchRestrictedQuadraticFitImpl)
     }; // MongePatchRestrictedQuadraticFitImpl
 
     template <class DataPoint, class _NFilter, typename T>
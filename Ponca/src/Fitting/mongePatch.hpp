@@ -4,7 +4,6 @@ void MongePatchQuadraticFitImpl<DataPoint, _NFilter, T>::init()
 {
     Base::init();
 
-    m_A = SampleMatrix(6, 6);
     m_A.setZero();
     m_b.setZero();
     m_planeIsReady = false;
@@ -33,6 +32,20 @@ void MongePatchQuadraticFitImpl<DataPoint, _NFilter, T>::addLocalNeighbor(Scalar
     }
 }
 
+template <class DataPoint, class _NFilter, typename T>
+void MongePatchQuadraticFitImpl<DataPoint, _NFilter, T>::merge(const MongePatchQuadraticFitImpl& other)
+{
+    if (!m_planeIsReady)
+    {
+        Base::merge(other);
+    }
+    else // both fits accumulate the patch around the same plane
+    {
+        m_A += other.m_A;
+        m_b += other.m_b;
+    }
+}
+
 template <class DataPoint, class _NFilter, typename T>
 FIT_RESULT MongePatchQuadraticFitImpl<DataPoint, _NFilter, T>::finalize()
 {
@@ -52,10 +65,9 @@ FIT_RESULT MongePatchQuadraticFitImpl<DataPoint, _NFilter, T>::finalize()
     // end of the monge patch fitting process
     else
     {
-        // we use BDCSVD as the matrix size is 36
-        // http://eigen.tuxfamily.org/dox/classEigen_1_1BDCSVD.html
-        Base::quadraticHeightField().setQuadric(
-            m_A.bdcSvd(Eigen::ComputeThinU | Eigen::ComputeThinV | Eigen::NoQRPreconditioner).solve(m_b));
+        // m_A is symmetric positive semi-definite: solve the normal equations with a robust Cholesky decomposition,
+        // which only needs fixed-size storage
+        Base::quadraticHeightField().setQuadric(m_A.ldlt().solve(m_b));
 
         return Base::m_eCurrentState = STABLE;
     }
@@ -66,7 +78,6 @@ void MongePatchRestrictedQuadraticFitImpl<DataPoint, _NFilter, T>::init()
 {
     Base::init();
 
-    m_A = SampleMatrix(4, 4);
     m_A.setZero();
     m_b.setZero();
     m_planeIsReady = false;
@@ -95,6 +106,20 @@ void MongePatchRestrictedQuadraticFitImpl<DataPoint, _NFilter, T>::addLocalNeigh
     }
 }
 
+template <class DataPoint, class _NFilter, typename T>
+void MongePatchRestrictedQuadraticFitImpl<DataPoint, _NFilter, T>::merge(const MongePatchRestrictedQuadraticFitImpl& other)
+{
+    if (!m_planeIsReady)
+    {
+        Base::merge(other);
+    }
+    else // both fits accumulate the patch around the same plane
+    {
+        m_A += other.m_A;
+        m_b += other.m_b;
+    }
+}
+
 template <class DataPoint, class _NFilter, typename T>
 FIT_RESULT MongePatchRestrictedQuadraticFitImpl<DataPoint, _NFilter, T>::finalize()
 {
@@ -114,9 +139,8 @@ FIT_RESULT MongePatchRestrictedQuadraticFitImpl<DataPoint, _NFilter, T>::finaliz
     // end of the monge patch fitting process
     else
     {
-        // we use SVD as the matrix size is 4x4, and skip preconditioner as it is squared
-        Base::quadraticHeightField().setQuadric(
-            m_A.jacobiSvd(Eigen::ComputeThinU | Eigen::ComputeThinV | Eigen::NoQRPreconditioner).solve(m_b));
+        // m_A is symmetric positive semi-definite, see MongePatchQuadraticFitImpl::finalize
+        Base::quadraticHeightField().setQuadric(m_A.ldlt().solve(m_b));
 
         return Base::m_eCurrentState = STABLE;
     }
@@ -0,0 +1,244 @@
+/*
+ This Source Code Form is subject to the terms of the Mozilla Public
+ License, v. 2.0. If a copy of the MPL was not distributed with this
+ file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+#pragma once
+
+#include "defines.h"
+#include "enums.h"
+#include "compute.h"
+#include "../Common/Assert.h"
+
+#include <algorithm>
+#include <concepts>
+#include <vector>
+
+namespace Ponca
+{
+    /*!
+     * \brief Compute object evaluating the same fit at several scales in a single traversal of the neighborhood
+     *
+     * Scale-space analysis usually runs a range query and a fit for each scale. This class holds one fit per scale,
+     * all sharing the same evaluation position, and feeds them from a single neighborhood collected at the largest
+     * scale (see #maxScale), e.g.
+     * \code
+     * MultiScaleFit<GlsFit> msFit({0.1, 0.2, 0.4, 0.8});
+     * msFit.setEvalPos(pos);
+     * msFit.computeWithIds(tree.rangeNeighbors(pos, msFit.maxScale()), tree.points());
+     * for (int s = 0; s < msFit.size(); ++s)
+     *     std::cout << msFit.scale(s) << ": " << msFit[s].kappa() << std::endl;
+     * \endcode
+     *
+     * Each fit uses its own NeighborFilter, built from the evaluation position and its scale. The squared distance
+     * of a neighbor to the evaluation position is computed once, and with compact kernels the neighbor is only
+     * dispatched to the scales that contain it. When the NeighborFilter can weight a neighbor from its squared
+     * distance (see DistWeightFunc::weightFromSquaredDistance), the fits receive the weight and the local
+     * coordinates directly, instead of evaluating their NeighborFilter. Each scale is finalized independently, and
+     * traversals are repeated as long as one of the scales needs another pass.
+     *
+     * \tparam Fit Fitting type, whose NeighborFilter is constructible from an evaluation position and a scale
+     * (e.g. DistWeightFunc)
+     */
+    template <typename Fit>
+    class MultiScaleFit : public ComputeObject<MultiScaleFit<Fit>>
+    {
+    public:
+        using DataPoint      = typename Fit::DataPoint;        ///< Point type used for computation
+        using NeighborFilter = typename Fit::NeighborFilter;   ///< Filter used at each scale
+        using Scalar         = typename DataPoint::Scalar;     ///< Scalar type used for computation
+        using VectorType     = typename DataPoint::VectorType; ///< Vector type used for computation
+
+    private:
+        std::vector<Scalar> m_scales;        ///< Scales, sorted in increasing order
+        std::vector<Scalar> m_squaredScales; ///< Squared scales, to skip the scales from squared distances
+        std::vector<Fit> m_fits;      ///< Fit of each scale
+        std::vector<bool> m_active;   ///< Scales that need to accumulate neighbors during the current pass
+        VectorType m_evalPos{VectorType::Zero()}; ///< Evaluation position shared by all the scales
+
+        /// \brief Are the neighbors farther than the scale ignored by the NeighborFilter ?
+        static constexpr bool isCompact = requires { requires NeighborFilter::isCompact; };
+
+        /// \brief Can the fits be fed with weights computed from the squared distances to the evaluation position ?
+        static constexpr bool hasSharedWeights =
+            requires(const NeighborFilter& _f, const Scalar& _d2, Fit& _fit, const DataPoint& _nei) {
+                { _f.weightFromSquaredDistance(_d2) } -> std::convertible_to<Scalar>;
+                _fit.addWeightedNeighbor(_nei, _d2, _nei.pos());
+            };
+
+    public:
+        using ComputeObject<MultiScaleFit>::compute;
+
+        /// \brief Set the scales, which are sorted in increasing order
+        /// \warning The scales must be strictly positive
+        explicit MultiScaleFit(std::vector<Scalar> _scales = {}) { setScales(std::move(_scales)); }
+
+        /// \brief Set the scales, which are sorted in increasing order. The evaluation position is kept.
+        inline void setScales(std::vector<Scalar> _scales)
+        {
+            m_scales = std::move(_scales);
+            std::sort(m_scales.begin(), m_scales.end());
+            PONCA_ASSERT(m_scales.empty() || m_scales.front() > Scalar(0));
+            m_squaredScales.resize(m_scales.size());
+            std::transform(m_scales.begin(), m_scales.end(), m_squaredScales.begin(),
+                           [](Scalar _s) { return _s * _s; });
+            m_fits.resize(m_scales.size());
+            m_active.assign(m_scales.size(), true);
+            setEvalPos(m_evalPos);
+        }
+
+        /// \brief Set the evaluation position of the fits of all the scales
+        inline void setEvalPos(const VectorType& _evalPos)
+        {
+            m_evalPos = _evalPos;
+            for (int s = 0; s < size(); ++s)
+                m_fits[s].setNeighborFilter(NeighborFilter(m_evalPos, m_scales[s]));
+        }
+
+        /// \brief Evaluation position shared by all the scales
+        [[nodiscard]] inline const VectorType& evalPos() const { return m_evalPos; }
+
+        /// \brief Number of scales
+        [[nodiscard]] inline int size() const { return int(m_scales.size()); }
+
+        /// \brief Scale of the fit `s`
+        [[nodiscard]] inline Scalar scale(int s) const { return m_scales[s]; }
+
+        /// \brief Largest scale, to be used to collect the neighbors
+        /// \warning There must be at least one scale
+        [[nodiscard]] inline Scalar maxScale() const
+        {
+            PONCA_ASSERT(!m_scales.empty());
+            return m_scales.back();
+        }
+
+        /// \brief Read access to the fit of the scale `s`
+        [[nodiscard]] inline const Fit& operator[](int s) const { return m_fits[s]; }
+
+        /// \brief Read/write access to the fit of the scale `s`
+        [[nodiscard]] inline Fit& operator[](int s) { return m_fits[s]; }
+
+        /// \brief Reset the internal states of the fits of all the scales
+        inline void init()
+        {
+            for (auto& fit : m_fits)
+                fit.init();
+            m_active.assign(m_scales.size(), true);
+        }
+
+        /// \brief Start a new pass for the scales that requested it
+        inline void startNewPass()
+        {
+            for (int s = 0; s < size(); ++s)
+                if (m_active[s])
+                    m_fits[s].startNewPass();
+        }
+
+        /// \brief Add a neighbor to the scales of the current pass
+        /// \return false if param nei is not a valid neighbor for any scale (weight = 0)
+        inline bool addNeighbor(const DataPoint& _nei)
+        {
+            // The scales share the evaluation position, hence the frame of their NeighborFilter
+            const Scalar d2 = (_nei.pos() - m_evalPos).squaredNorm();
+            VectorType localQ;
+            if constexpr (hasSharedWeights)
+                if (!m_fits.empty())
+                    localQ = m_fits.front().getNeighborFilter().convertToLocalBasis(_nei.pos());
+
+            bool added = false;
+            for (int s = size() - 1; s >= 0; --s)
+            {
+                // Scales are sorted: with compact kernels the neighbor is outside of all the scales below its distance
+                if constexpr (isCompact)
+                    if (d2 > m_squaredScales[s])
+                        break;
+                if (!m_active[s])
+                    continue;
+                if constexpr (hasSharedWeights)
+                {
+                    const Scalar w = m_fits[s].getNeighborFilter().weightFromSquaredDistance(d2);
+                    if (w > Scalar(0))
+                    {
+                        m_fits[s].addWeightedNeighbor(_nei, w, localQ);
+                        added = true;
+                    }
+                }
+                else
+                    added |= m_fits[s].addNeighbor(_nei);
+            }
+            return added;
+        }
+
+        /*!
+         * \brief Finalize the scales of the current pass
+         *
+         * Scales returning #NEED_OTHER_PASS stay active for the next pass.
+         * \return #NEED_OTHER_PASS if at least one scale needs another pass, otherwise the worst state of the scales
+         * (#STABLE < #UNSTABLE < #UNDEFINED < #CONFLICT_ERROR_FOUND)
+         */
+        inline FIT_RESULT finalize()
+        {
+            bool needOtherPass = false;
+            for (int s = 0; s < size(); ++s)
+                if (m_active[s])
+                {
+                    m_active[s] = (m_fits[s].finalize() == NEED_OTHER_PASS);
+                    needOtherPass |= m_active[s];
+                }
+            return needOtherPass ? NEED_OTHER_PASS : getCurrentState();
+        }
+
+        /// \brief Worst state of the scales (#STABLE < #UNSTABLE < #UNDEFINED < #CONFLICT_ERROR_FOUND)
+        [[nodiscard]] inline FIT_RESULT getCurrentState() const
+        {
+            FIT_RESULT res = STABLE;
+            for (const auto& fit : m_fits)
+                res = std::max(res, fit.getCurrentState());
+            return res;
+        }
+
+        /*!
+         * \brief Convenience function for STL-like iterators
+         * Add neighbors stored in a container using STL-like iterators, and call finalize at the end.
+         * The range is traversed again while some of the scales need another pass.
+         */
+        template <typename IteratorBegin, typename IteratorEnd>
+        inline FIT_RESULT compute(const IteratorBegin& begin, const IteratorEnd& end)
+        {
+            init();
+            FIT_RESULT res = UNDEFINED;
+
+            do
+            {
+                startNewPass();
+                for (auto it = begin; it != end; ++it)
+                    addNeighbor(*it);
+                res = finalize();
+            } while (res == NEED_OTHER_PASS);
+
+            return res;
+        }
+
+        /*!
+         * \brief Convenience function to iterate over a subset of samples in a PointContainer
+         * \see #compute(const IteratorBegin& begin, const IteratorEnd& end)
+         */
+        template <typename IndexRange, typename PointContainer>
+        inline FIT_RESULT computeWithIds(IndexRange ids, const PointContainer& points)
+        {
+            init();
+            FIT_RESULT res = UNDEFINED;
+
+            do
+            {
+                startNewPass();
+                for (const auto& i : ids)
+                    addNeighbor(points[i]);
+                res = finalize();
+            } while (res == NEED_OTHER_PASS);
+
+            return res;
+        }
+    };
+} // namespace Ponca
@@ -0,0 +1,133 @@
+/*
+ This Source Code Form is subject to the terms of the Mozilla Public
+ License, v. 2.0. If a copy of the MPL was not distributed with this
+ file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+#pragma once
+
+#include "defines.h"
+#include <Eigen/Dense>
+
+namespace Ponca
+{
+    /*!
+     * \brief Fixed-size block of filtered neighbors, stored as a structure of arrays
+     *
+     * Used by Basket to feed several neighbors at once to the fitting extensions providing `addLocalNeighbors`. The
+     * block is always processed as a whole: the unused slots have a null weight and a null position, so that the
+     * extensions can accumulate over the `BlockSize` columns with Eigen vectorized expressions without branching.
+     *
+     * \tparam DataPoint Point type
+     * \tparam _BlockSize Maximum number of neighbors in the block
+     */
+    template <class DataPoint, int _BlockSize>
+    struct NeighborBlock
+    {
+        enum
+        {
+            BlockSize = _BlockSize, /*!< \brief Maximum number of neighbors in the block */
+            Dim       = DataPoint::Dim
+        };
+        using Scalar      = typename DataPoint::Scalar;
+        using VectorType  = typename DataPoint::VectorType;
+        using WeightArray = Eigen::Matrix<Scalar, BlockSize, 1>;   /*!< \brief One weight per neighbor */
+        using VectorBlock = Eigen::Matrix<Scalar, Dim, BlockSize>; /*!< \brief One vector per neighbor (column) */
+
+        //! \brief Does DataPoint provide normals ? If so, they are gathered in #normals
+        static constexpr bool hasNormal = requires(const DataPoint& p) { p.normal(); };
+
+        WeightArray weights{WeightArray::Zero()}; ///< Weight of each neighbor
+        VectorBlock localQ{VectorBlock::Zero()};  ///< Neighbors positions, expressed in the NeighborFilter frame
+        VectorBlock normals{VectorBlock::Zero()}; ///< Neighbors normals, left to zero if not provided by DataPoint
+        const DataPoint* attributes[BlockSize]{}; ///< Neighbors, to access the other attributes
+        int size{0};                              ///< Number of neighbors in the block
+
+        PONCA_MULTIARCH [[nodiscard]] inline bool full() const { return size == BlockSize; }
+
+        /// \brief Append a neighbor to the block, which must not be full
+        PONCA_MULTIARCH inline void push(Scalar w, const VectorType& q, const DataPoint& nei)
+        {
+            weights(size)    = w;
+            localQ.col(size) = q;
+            if constexpr (hasNormal)
+                normals.col(size) = nei.normal();
+            attributes[size] = &nei;
+            ++size;
+        }
+
+        /// \brief Empty the block, resetting the weights and positions of the used slots
+        PONCA_MULTIARCH inline void clear()
+        {
+            weights.head(size).setZero();
+            localQ.leftCols(size).setZero();
+            if constexpr (hasNormal)
+                normals.leftCols(size).setZero();
+            size = 0;
+        }
+    };
+
+#ifndef PARSED_WITH_DOXYGEN
+    namespace internal
+    {
+        /// \brief Class owning the member function pointer `R (C::*)(Args...)`
+        template <class C, class R, class... Args>
+        C memberOwner(R (C::*)(Args...));
+
+        /*!
+         * \brief Can the fitting extension `Layer` accumulate a whole Block of neighbors ?
+         *
+         * True if `Layer` does not declare its own `addLocalNeighbor`, or if it also declares `addLocalNeighbors`.
+         */
+        template <class Layer, class Block>
+        constexpr bool isBlockCompatibleLayer()
+        {
+            if constexpr (!requires { internal::memberOwner(&Layer::addLocalNeighbor); })
+                return false; // overloaded or hidden: use the scalar path
+            else if constexpr (!std::is_same_v<decltype(internal::memberOwner(&Layer::addLocalNeighbor)), Layer>)
+                return true;
+            else if constexpr (!requires {
+                                   internal::memberOwner(&Layer::template addLocalNeighbors<Block::BlockSize>);
+                               })
+                return false;
+            else
+                return std::is_same_v<
+                    decltype(internal::memberOwner(&Layer::template addLocalNeighbors<Block::BlockSize>)), Layer>;
+        }
+
+        /*!
+         * \brief Unrolls the CRTP chain of fitting extensions to check that they are all block compatible
+         *
+         * Extensions that do not follow the `Ext<DataPoint, NeighborFilter, Base>` pattern are considered as not
+         * compatible.
+         */
+        template <class Layer, class Block>
+        struct IsBlockCompatible
+        {
+            static constexpr bool value = false;
+        };
+
+        template <template <class, class, typename> class Ext, class P, class NF, typename T, class Block>
+        struct IsBlockCompatible<Ext<P, NF, T>, Block>
+        {
+            static constexpr bool value =
+                isBlockCompatibleLayer<Ext<P, NF, T>, Block>() && IsBlockCompatible<T, Block>::value;
+        };
+
+        /// \brief Extensions taking an additional policy, e.g. CovarianceFitBase
+        template <template <class, class, typename, typename> class Ext, class P, class NF, typename T, typename Policy,
+                  class Block>
+        struct IsBlockCompatible<Ext<P, NF, T, Policy>, Block>
+        {
+            static constexpr bool value =
+                isBlockCompatibleLayer<Ext<P, NF, T, Policy>, Block>() && IsBlockCompatible<T, Block>::value;
+        };
+
+        template <class Block>
+        struct IsBlockCompatible<void, Block>
+        {
+            static constexpr bool value = true;
+        };
+    } // namespace internal
+#endif
+} // namespace Ponca
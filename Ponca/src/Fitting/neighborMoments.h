@@ -0,0 +1,108 @@
+/*
+ This Source Code Form is subject to the terms of the Mozilla Public
+ License, v. 2.0. If a copy of the MPL was not distributed with this
+ file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+#pragma once
+
+#include "defines.h"
+#include "neighborBlock.h"
+#include <Eigen/Dense>
+
+namespace Ponca
+{
+    /*!
+     * \brief Weighted moments of a group of neighbors sharing the same weight, expressed in the NeighborFilter frame
+     *
+     * Used by Basket to feed a whole subtree of a spatial structure at once to the fitting extensions providing
+     * `addLocalMoments`, see Basket::computeWithMoments. The sums are the ones the extensions would accumulate by
+     * calling `addLocalNeighbor` on each neighbor, e.g. #sumQQt is \f$ \sum_i w \mathbf{q}_i \mathbf{q}_i^T \f$.
+     *
+     * \tparam DataPoint Point type
+     */
+    template <class DataPoint>
+    struct NeighborMoments
+    {
+        using Scalar     = typename DataPoint::Scalar;
+        using VectorType = typename DataPoint::VectorType;
+        using MatrixType = Eigen::Matrix<Scalar, DataPoint::Dim, DataPoint::Dim>;
+
+        int count{0};                          ///< Number of neighbors
+        Scalar sumW{0};                        ///< \f$ \sum_i w \f$
+        VectorType sumQ{VectorType::Zero()};   ///< \f$ \sum_i w \mathbf{q}_i \f$
+        MatrixType sumQQt{MatrixType::Zero()}; ///< \f$ \sum_i w \mathbf{q}_i \mathbf{q}_i^T \f$
+        Scalar sumDotQQ{0};                    ///< \f$ \sum_i w \mathbf{q}_i \cdot \mathbf{q}_i \f$
+        VectorType sumN{VectorType::Zero()};   ///< \f$ \sum_i w \mathbf{n}_i \f$
+        Scalar sumDotQN{0};                    ///< \f$ \sum_i w \mathbf{q}_i \cdot \mathbf{n}_i \f$
+
+        /*!
+         * \brief Set the moments from the aggregates of a group of samples, see KdTreeNodeMoments
+         * \param m Aggregates, storing their second order moments relatively to their centroid
+         * \param w Weight shared by all the samples
+         * \param localCentroid Centroid of the samples, expressed in the NeighborFilter frame
+         */
+        template <class Aggregates>
+        PONCA_MULTIARCH inline void set(const Aggregates& m, Scalar w, const VectorType& localCentroid)
+        {
+            const Scalar n = Scalar(m.count);
+            count          = m.count;
+            sumW           = w * n;
+            sumQ           = sumW * localCentroid;
+            sumQQt         = w * (m.scatter + n * localCentroid * localCentroid.transpose());
+            sumDotQQ       = w * (m.scatter.trace() + n * localCentroid.squaredNorm());
+            sumN           = w * m.sumN;
+            sumDotQN       = w * (m.sumDotPN + localCentroid.dot(m.sumN));
+        }
+    };
+
+#ifndef PARSED_WITH_DOXYGEN
+    namespace internal
+    {
+        /*!
+         * \brief Can the fitting extension `Layer` accumulate NeighborMoments ?
+         *
+         * True if `Layer` does not declare its own `addLocalNeighbor`, or if it also declares `addLocalMoments`.
+         */
+        template <class Layer>
+        constexpr bool isMomentCompatibleLayer()
+        {
+            if constexpr (!requires { internal::memberOwner(&Layer::addLocalNeighbor); })
+                return false; // overloaded or hidden: use the scalar path
+            else if constexpr (!std::is_same_v<decltype(internal::memberOwner(&Layer::addLocalNeighbor)), Layer>)
+                return true;
+            else if constexpr (!requires { internal::memberOwner(&Layer::addLocalMoments); })
+                return false;
+            else
+                return std::is_same_v<decltype(internal::memberOwner(&Layer::addLocalMoments)), Layer>;
+        }
+
+        /// \brief Unrolls the CRTP chain of fitting extensions to check that they all accept NeighborMoments
+        template <class Layer>
+        struct IsMomentCompatible
+        {
+            static constexpr bool value = false;
+        };
+
+        template <template <class, class, typename> class Ext, class P, class NF, typename T>
+        struct IsMomentCompatible<Ext<P, NF, T>>
+        {
+            static constexpr bool value = isMomentCompatibleLayer<Ext<P, NF, T>>() && IsMomentCompatible<T>::value;
+        };
+
+        /// \brief Extensions taking an additional policy, e.g. CovarianceFitBase
+        template <template <class, class, typename, typename> class Ext, class P, class NF, typename T, typename Policy>
+        struct IsMomentCompatible<Ext<P, NF, T, Policy>>
+        {
+            static constexpr bool value =
+                isMomentCompatibleLayer<Ext<P, NF, T, Policy>>() && IsMomentCompatible<T>::value;
+        };
+
+        template <>
+        struct IsMomentCompatible<void>
+        {
+            static constexpr bool value = true;
+        };
+    } // namespace internal
+#endif
+} // namespace Ponca
@@ -0,0 +1,175 @@
+/*
+ This Source Code Form is subject to the terms of the Mozilla Public
+ License, v. 2.0. If a copy of the MPL was not distributed with this
+ file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+#pragma once
+
+#include "defines.h"
+#include "weightKernel.h"
+#include "../Common/Assert.h"
+
+#include <cmath>
+#include <span>
+#include <vector>
+
+namespace Ponca
+{
+    /*!
+     * \brief Neighborhoods of a set of evaluation points, queried once and stored in compressed sparse rows (CSR)
+     *
+     * For each evaluation point `i`, the cache stores the ids of its neighbors and their squared distances to the
+     * evaluation point, and optionally their weights (see #computeWeights). The neighborhoods are stored contiguously,
+     * and the neighbors of `i` are in the range `[offsets[i], offsets[i+1])`.
+     *
+     * The cache is consumed through ComputeObject::computeWithCache, by Basket, BasketDiff and CNC, and through
+     * MLSEvaluationScheme::computeWithCache. Multi-pass fits, like MongePatch, iterate over the cached neighborhood at
+     * each pass instead of running the tree search again. Several fits of the same neighborhoods can share a cache.
+     *
+     * Only the neighbors within the query radius are stored, which would truncate the support of non-compact kernels
+     * (e.g. GaussianWeightKernel). The cache is thus restricted to compact NeighborFilters and kernels, see
+     * #isCompatible.
+     *
+     * \snippet neighborhood_cache.cpp NeighborhoodCache
+     *
+     * \tparam _Scalar Scalar type of the squared distances and weights
+     */
+    template <typename _Scalar>
+    class NeighborhoodCache
+    {
+    public:
+        using Scalar = _Scalar; ///< Scalar type of the squared distances and weights
+
+        /// \brief Can the neighborhoods be fitted with `NeighborFilter`, i.e. is its support bounded by the scale
+        template <typename NeighborFilter>
+        static constexpr bool isCompatible = requires { requires NeighborFilter::isCompact; };
+
+        /*!
+         * \brief Query and store the neighborhoods of the evaluation points
+         *
+         * \tparam Tree Spatial structure providing `rangeNeighbors(VectorType, Scalar)` and `points()`, e.g. a KdTree
+         * \tparam EvalContainer Random-access container of positions (`VectorType`) or points (providing `pos()`)
+         * \tparam ScalePolicy Functor returning the scale of the evaluation point `i`, e.g. ConstantScale or
+         * PerPointScale
+         *
+         * \param _tree Spatial structure storing the input points
+         * \param _evalPoints Evaluation points
+         * \param _scale Scale policy, giving the query radius of each evaluation point
+         *
+         * \note The weights computed by a previous call to #computeWeights are cleared.
+         */
+        template <typename Tree, typename EvalContainer, typename ScalePolicy>
+        inline void build(const Tree& _tree, const EvalContainer& _evalPoints, const ScalePolicy& _scale)
+        {
+            using TreeScalar     = typename Tree::Scalar;
+            using TreeVectorType = typename Tree::VectorType;
+            const int nbEval     = int(_evalPoints.size());
+            const auto& points   = _tree.points();
+
+            m_offsets.resize(nbEval + 1);
+            m_scales.resize(nbEval);
+            m_indices.clear();
+            m_squaredDistances.clear();
+            m_weights.clear();
+            m_hasWeights = false;
+
+            m_offsets[0] = 0;
+            for (int i = 0; i < nbEval; ++i)
+            {
+                TreeVectorType pos;
+                if constexpr (requires { _evalPoints[i].pos(); })
+                    pos = _evalPoints[i].pos().template cast<TreeScalar>();
+                else
+                    pos = _evalPoints[i].template cast<TreeScalar>();
+                m_scales[i] = Scalar(_scale(i));
+
+                for (int j : _tree.rangeNeighbors(pos, TreeScalar(m_scales[i])))
+                {
+                    m_indices.push_back(j);
+                    m_squaredDistances.push_back(Scalar((points[j].pos() - pos).squaredNorm()));
+                }
+                m_offsets[i + 1] = int(m_indices.size());
+            }
+        }
+
+        /*!
+         * \brief Compute and store the weights of the neighbors, as computed by DistWeightFunc at the evaluation points
+         *
+         * The weights are evaluated from the squared distances when the kernel allows it, see
+         * #hasSquaredDistanceEvaluation. Once computed, Basket::computeWithCache uses them instead of evaluating the
+         * NeighborFilter.
+         *
+         * \warning The fits consuming the weights must use a DistWeightFunc with the same kernel, evaluation positions
+         * and scales as the cache.
+         */
+        template <typename WeightKernel>
+        inline void computeWeights(const WeightKernel& _kernel = WeightKernel())
+        {
+            static_assert(isCompatible<WeightKernel>, "The cache truncates the support of non-compact kernels");
+            m_weights.resize(m_indices.size());
+            for (int i = 0; i < size(); ++i)
+            {
+                const Scalar t  = m_scales[i];
+                const Scalar t2 = t * t;
+                for (int k = m_offsets[i]; k < m_offsets[i + 1]; ++k)
+                {
+                    const Scalar d2 = m_squaredDistances[k];
+                    if (d2 > t2)
+                        m_weights[k] = Scalar(0);
+                    else if constexpr (hasSquaredDistanceEvaluation<WeightKernel>)
+                        m_weights[k] = _kernel.fSquared(d2 / t2);
+                    else
+                        m_weights[k] = _kernel.f(std::sqrt(d2) / t);
+                }
+            }
+            m_hasWeights = true;
+        }
+
+        /// \brief Number of evaluation points
+        [[nodiscard]] inline int size() const { return int(m_scales.size()); }
+
+        /// \brief Total number of stored neighbors, over all the evaluation points
+        [[nodiscard]] inline int nbEntries() const { return int(m_indices.size()); }
+
+        /// \brief Did #computeWeights store the weights of the current neighborhoods
+        [[nodiscard]] inline bool hasWeights() const { return m_hasWeights; }
+
+        /// \brief Query radius of the evaluation point `_i`
+        [[nodiscard]] inline Scalar scale(int _i) const { return m_scales[_i]; }
+
+        /// \brief Ids of the neighbors of the evaluation point `_i`
+        [[nodiscard]] inline std::span<const int> neighbors(int _i) const { return row(m_indices, _i); }
+
+        /// \brief Squared distances of the neighbors of the evaluation point `_i`, in the same order as #neighbors
+        [[nodiscard]] inline std::span<const Scalar> squaredDistances(int _i) const
+        {
+            return row(m_squaredDistances, _i);
+        }
+
+        /// \brief Weights of the neighbors of the evaluation point `_i`, in the same order as #neighbors
+        /// \warning Requires #computeWeights
+        [[nodiscard]] inline std::span<const Scalar> weights(int _i) const
+        {
+            PONCA_ASSERT(hasWeights());
+            return row(m_weights, _i);
+        }
+
+        /// \brief Offsets of the neighborhoods in the CSR arrays, of size #size + 1
+        [[nodiscard]] inline const std::vector<int>& offsets() const { return m_offsets; }
+
+    private:
+        template <typename T>
+        [[nodiscard]] inline std::span<const T> row(const std::vector<T>& _values, int _i) const
+        {
+            return std::span<const T>(_values).subspan(m_offsets[_i], m_offsets[_i + 1] - m_offsets[_i]);
+        }
+
+        std::vector<int> m_offsets;             ///< Start of the neighborhood of each evaluation point, and total size
+        std::vector<int> m_indices;             ///< Ids of the neighbors
+        std::vector<Scalar> m_squaredDistances; ///< Squared distances between the neighbors and the evaluation points
+        std::vector<Scalar> m_weights;          ///< Weights of the neighbors, empty until #computeWeights is called
+        std::vector<Scalar> m_scales;           ///< Query radius of each evaluation point
+        bool m_hasWeights{false};               ///< Are the weights up to date with the neighborhoods
+    };
+} // namespace Ponca
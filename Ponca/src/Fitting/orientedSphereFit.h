@@ -40,7 +40,9 @@ namespace Ponca
 
     public:
         PONCA_EXPLICIT_CAST_OPERATORS(OrientedSphereFitImpl, orientedSphereFit)
-        PONCA_FITTING_DECLARE_INIT_ADD_FINALIZE
+        PONCA_FITTING_DECLARE_INIT_ADDS_FINALIZE
+        PONCA_FITTING_DECLARE_ADDMOMENTS
+        PONCA_FITTING_DECLARE_MERGE(OrientedSphereFitImpl)
         PONCA_FITTING_IS_SIGNED(true)
     }; // class OrientedSphereFitImpl
 
@@ -89,6 +91,7 @@ namespace Ponca
         PONCA_EXPLICIT_CAST_OPERATORS_DER(OrientedSphereDerImpl, orientedSphereDer)
 
         PONCA_FITTING_DECLARE_INIT_ADDDER_FINALIZE
+        PONCA_FITTING_DECLARE_MERGE(OrientedSphereDerImpl)
 
         /*! \brief Returns the derivatives of the scalar field at the evaluation point */
         PONCA_MULTIARCH [[nodiscard]] inline ScalarArray dPotential() const;
@@ -25,6 +25,31 @@ void OrientedSphereFitImpl<DataPoint, _NFilter, T>::addLocalNeighbor(Scalar w, c
     m_sumDotPP += w * localQ.squaredNorm();
 }
 
+template <class DataPoint, class _NFilter, typename T>
+template <int BlockSize>
+void OrientedSphereFitImpl<DataPoint, _NFilter, T>::addLocalNeighbors(const NeighborBlock<DataPoint, BlockSize>& block)
+{
+    Base::addLocalNeighbors(block);
+    m_sumDotPN += (block.normals.cwiseProduct(block.localQ).colwise().sum() * block.weights).value();
+    m_sumDotPP += (block.localQ.colwise().squaredNorm() * block.weights).value();
+}
+
+template <class DataPoint, class _NFilter, typename T>
+void OrientedSphereFitImpl<DataPoint, _NFilter, T>::addLocalMoments(const NeighborMoments<DataPoint>& moments)
+{
+    Base::addLocalMoments(moments);
+    m_sumDotPN += moments.sumDotQN;
+    m_sumDotPP += moments.sumDotQQ;
+}
+
+template <class DataPoint, class _NFilter, typename T>
+void OrientedSphereFitImpl<DataPoint, _NFilter, T>::merge(const OrientedSphereFitImpl& other)
+{
+    Base::merge(other);
+    m_sumDotPN += other.m_sumDotPN;
+    m_sumDotPP += other.m_sumDotPP;
+}
+
 template <class DataPoint, class _NFilter, typename T>
 FIT_RESULT OrientedSphereFitImpl<DataPoint, _NFilter, T>::finalize()
 {
@@ -103,6 +128,15 @@ void OrientedSphereDerImpl<DataPoint, _NFilter, DiffType, T>::addLocalNeighbor(S
     m_dSumDotPP += dw * localQ.squaredNorm();
 }
 
+template <class DataPoint, class _NFilter, int DiffType, typename T>
+void OrientedSphereDerImpl<DataPoint, _NFilter, DiffType, T>::merge(const OrientedSphereDerImpl& other)
+{
+    Base::merge(other);
+    m_dSumN += other.m_dSumN;
+    m_dSumDotPN += other.m_dSumDotPN;
+    m_dSumDotPP += other.m_dSumDotPP;
+}
+
 template <class DataPoint, class _NFilter, int DiffType, typename T>
 FIT_RESULT OrientedSphereDerImpl<DataPoint, _NFilter, DiffType, T>::finalize()
 {
@@ -10,6 +10,8 @@
 
 #include "defines.h"
 #include "enums.h"
+#include "neighborBlock.h"
+#include "neighborMoments.h"
 #include <Eigen/Dense>
 
 namespace Ponca
@@ -109,6 +111,28 @@ namespace Ponca
             ++(m_nbNeighbors);
         }
 
+        PONCA_FITTING_APIDOC_ADDNEIGHBORS
+        template <int BlockSize>
+        PONCA_MULTIARCH inline void addLocalNeighbors(const NeighborBlock<DataPoint, BlockSize>& block)
+        {
+            m_sumW += block.weights.sum();
+            m_nbNeighbors += block.size;
+        }
+
+        PONCA_FITTING_APIDOC_ADDMOMENTS
+        PONCA_MULTIARCH inline void addLocalMoments(const NeighborMoments<DataPoint>& moments)
+        {
+            m_sumW += moments.sumW;
+            m_nbNeighbors += moments.count;
+        }
+
+        PONCA_FITTING_APIDOC_MERGE
+        PONCA_MULTIARCH inline void merge(const PrimitiveBase& other)
+        {
+            m_sumW += other.m_sumW;
+            m_nbNeighbors += other.m_nbNeighbors;
+        }
+
         PONCA_FITTING_APIDOC_FINALIZE
         PONCA_MULTIARCH inline FIT_RESULT finalize()
         {
@@ -138,6 +162,10 @@ namespace Ponca
         derDimension(), and the differentiation type by isScaleDer() and
         isSpaceDer().
 
+        The derivative outputs can be restricted by adding FitPotentialDer and/or
+        FitNormalDer to Type. The extensions check isPotentialDer() and
+        isNormalDer() to skip the computations needed only by the other outputs.
+
         Thanks to the BasketDiff definition, we know that PrimitiveDer has Primitive
         as base class (through the Basket). As a result, this class first asks to
         compute the Fit, and if it works properly, compute the weight derivatives.
@@ -203,6 +231,13 @@ namespace Ponca
             m_dSumW += dw;
         }
 
+        PONCA_FITTING_APIDOC_MERGE
+        PONCA_MULTIARCH inline void merge(const PrimitiveDer& other)
+        {
+            Base::merge(other);
+            m_dSumW += other.m_dSumW;
+        }
+
         /**************************************************************************/
         /* Use results                                                            */
         /**************************************************************************/
@@ -212,6 +247,16 @@ namespace Ponca
         PONCA_MULTIARCH [[nodiscard]] static inline constexpr bool isSpaceDer() { return bool(Type & FitSpaceDer); }
         /*! \brief Number of dimensions used for the differentiation */
         PONCA_MULTIARCH [[nodiscard]] static inline constexpr unsigned int derDimension() { return NbDerivatives; }
+        /*! \brief State specified at compilation time to compute the derivatives of the potential */
+        PONCA_MULTIARCH [[nodiscard]] static inline constexpr bool isPotentialDer()
+        {
+            return !(Type & FitAllOutputsDer) || bool(Type & FitPotentialDer);
+        }
+        /*! \brief State specified at compilation time to compute the derivatives of the normal */
+        PONCA_MULTIARCH [[nodiscard]] static inline constexpr bool isNormalDer()
+        {
+            return !(Type & FitAllOutputsDer) || bool(Type & FitNormalDer);
+        }
     };
 
 } // namespace Ponca
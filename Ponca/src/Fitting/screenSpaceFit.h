@@ -0,0 +1,359 @@
+/*
+ This Source Code Form is subject to the terms of the Mozilla Public
+ License, v. 2.0. If a copy of the MPL was not distributed with this
+ file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+#pragma once
+
+#include "defines.h"
+#include "neighborMoments.h"
+#include "weightFunc.h"
+#include "weightKernel.h"
+#include "../Common/Assert.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <utility>
+#include <vector>
+
+namespace Ponca
+{
+    /*!
+     * \brief Point of a position and normal buffer, rendered in screen space
+     *
+     * The pixels without normal are background, see #valid.
+     */
+    template <typename _Scalar>
+    class ScreenSpacePoint
+    {
+    public:
+        enum
+        {
+            Dim = 3
+        };
+        using Scalar           = _Scalar;
+        using VectorType       = Eigen::Matrix<Scalar, Dim, 1>;
+        using ScreenVectorType = Eigen::Matrix<Scalar, 2, 1>;
+        using MatrixType       = Eigen::Matrix<Scalar, Dim, Dim>;
+
+        inline ScreenSpacePoint(const VectorType& _pos        = VectorType::Zero(),
+                                const VectorType& _normal     = VectorType::Zero(),
+                                const ScreenVectorType& _spos = ScreenVectorType::Zero())
+            : m_pos(_pos), m_normal(_normal), m_spos(_spos)
+        {
+        }
+
+        [[nodiscard]] inline const VectorType& pos() const { return m_pos; }
+        [[nodiscard]] inline const VectorType& normal() const { return m_normal; }
+        /// \brief Pixel coordinates
+        [[nodiscard]] inline const ScreenVectorType& spos() const { return m_spos; }
+        /// \brief Is the pixel covered by the surface: the background pixels have a null normal
+        [[nodiscard]] inline bool valid() const { return m_normal.squaredNorm() != Scalar(0); }
+
+    private:
+        VectorType m_pos, m_normal;
+        ScreenVectorType m_spos;
+    };
+
+    /*!
+     * \brief Weight the neighbors from their distance in pixels to the evaluation point
+     *
+     * The background pixels get a null weight, and so do the pixels whose depth in the frame of the evaluation point
+     * differs by more than a threshold, to stop the neighborhoods at the depth discontinuities.
+     *
+     * \tparam DataPoint Point type providing `spos()` and `valid()`, e.g. ScreenSpacePoint
+     * \tparam _WeightKernel Compact 1D kernel, applied to the distances in pixels
+     */
+    template <class DataPoint, class _WeightKernel>
+    class ScreenSpaceWeightFunc : public DistWeightFunc<DataPoint, _WeightKernel>
+    {
+    public:
+        using Base             = DistWeightFunc<DataPoint, _WeightKernel>;
+        using WeightKernel     = _WeightKernel;
+        using Scalar           = typename Base::Scalar;
+        using VectorType       = typename Base::VectorType;
+        using WeightReturnType = typename Base::WeightReturnType;
+        using ScreenVectorType = typename DataPoint::ScreenVectorType;
+        static_assert(WeightKernel::isCompact, "The screen-space windows bound the support of the kernel");
+
+        /*!
+         * \param _evalPoint Evaluation point
+         * \param _t Scale, in pixels
+         * \param _dz Maximal depth difference to the evaluation point, disabled when null
+         */
+        inline ScreenSpaceWeightFunc(const DataPoint& _evalPoint = DataPoint(), const Scalar& _t = Scalar(1),
+                                     const Scalar _dz = Scalar(0))
+            : Base(_evalPoint.pos(), _t), m_refScreenPos(_evalPoint.spos()), m_dz(_dz)
+        {
+        }
+
+        /// \brief Weight of the query from its distance in pixels, and the query expressed in the local frame
+        inline WeightReturnType operator()(const DataPoint& _q) const
+        {
+            const VectorType localQ = Base::convertToLocalBasis(_q.pos());
+            const Scalar d2         = (_q.spos() - m_refScreenPos).squaredNorm();
+            const Scalar t2         = Base::m_t * Base::m_t;
+            if (!_q.valid() || d2 > t2 || (m_dz != Scalar(0) && std::abs(localQ[2]) > m_dz))
+                return {Scalar(0), localQ};
+            if constexpr (hasSquaredDistanceEvaluation<WeightKernel>)
+                return {Base::m_wk.fSquared(d2 / t2), localQ};
+            else
+                return {Base::m_wk.f(std::sqrt(d2) / Base::m_t), localQ};
+        }
+
+        /// \brief Maximal depth difference to the evaluation point, null when disabled
+        [[nodiscard]] inline Scalar maxDepthDifference() const { return m_dz; }
+
+    private:
+        ScreenVectorType m_refScreenPos;
+        Scalar m_dz;
+    };
+
+    /*!
+     * \brief Position and normal buffers of an image, stored as one point per pixel and as structures of arrays
+     *
+     * The points are stored in raster order: the point of the pixel `(x, y)` has the index `y * width + x`. The
+     * coordinates of the positions and normals are also stored in one array per coordinate, so that the moments of the
+     * neighbors can be summed over the rows of the screen-space windows with vectorized expressions, see
+     * #windowMoments.
+     *
+     * \tparam DataPoint Point type providing `spos()` and `valid()`, e.g. ScreenSpacePoint
+     */
+    template <class DataPoint>
+    class ScreenSpaceBuffers
+    {
+    public:
+        using Scalar     = typename DataPoint::Scalar;
+        using VectorType = typename DataPoint::VectorType;
+        static_assert(DataPoint::Dim == 3, "The screen-space buffers store 3D positions and normals");
+
+        /// \brief Maximal width of the windows, so that their rows are stored on the stack
+        static constexpr int MaxWindowWidth = 257;
+
+        /// \param _points Points of the pixels, in raster order
+        inline ScreenSpaceBuffers(int _width, int _height, std::vector<DataPoint> _points)
+            : m_width(_width), m_height(_height), m_points(std::move(_points))
+        {
+            PONCA_ASSERT(m_points.size() == size_t(m_width) * size_t(m_height));
+            for (int k = 0; k < 3; ++k)
+            {
+                m_positions[k].resize(m_points.size());
+                m_normals[k].resize(m_points.size());
+            }
+            m_valid.resize(m_points.size());
+            for (size_t i = 0; i < m_points.size(); ++i)
+            {
+                for (int k = 0; k < 3; ++k)
+                {
+                    m_positions[k][i] = m_points[i].pos()[k];
+                    m_normals[k][i]   = m_points[i].normal()[k];
+                }
+                m_valid[i] = m_points[i].valid() ? Scalar(1) : Scalar(0);
+            }
+        }
+
+        [[nodiscard]] inline int width() const { return m_width; }
+        [[nodiscard]] inline int height() const { return m_height; }
+        /// \brief Points of the pixels, in raster order
+        [[nodiscard]] inline const std::vector<DataPoint>& points() const { return m_points; }
+
+        /*!
+         * \brief Weights of the pixels of the window of size \f$ (2 scale + 1)^2 \f$, as computed by
+         * ScreenSpaceWeightFunc from the pixel offsets
+         */
+        template <class WeightKernel>
+        [[nodiscard]] static inline std::vector<Scalar> windowWeights(int _scale)
+        {
+            const WeightKernel kernel;
+            const int size  = 2 * _scale + 1;
+            const Scalar t2 = Scalar(_scale) * Scalar(_scale);
+            std::vector<Scalar> weights(size_t(size) * size, Scalar(0));
+            for (int dy = -_scale; dy <= _scale; ++dy)
+                for (int dx = -_scale; dx <= _scale; ++dx)
+                {
+                    const Scalar d2 = Scalar(dx) * Scalar(dx) + Scalar(dy) * Scalar(dy);
+                    if (d2 > t2)
+                        continue;
+                    if constexpr (hasSquaredDistanceEvaluation<WeightKernel>)
+                        weights[(dy + _scale) * size + dx + _scale] = kernel.fSquared(d2 / t2);
+                    else
+                        weights[(dy + _scale) * size + dx + _scale] = kernel.f(std::sqrt(d2) / Scalar(_scale));
+                }
+            return weights;
+        }
+
+        /*!
+         * \brief Moments of the neighbors of the pixel `(_x, _y)`, summed over the rows of its window
+         *
+         * The neighbors are weighted as by ScreenSpaceWeightFunc, with the weights precomputed by #windowWeights, and
+         * are expressed relatively to the position of the pixel.
+         *
+         * \tparam withScatter Sum the second order moments NeighborMoments::sumQQt, which are only used by the
+         * covariance fits
+         * \param _stencil Weights of the window, see #windowWeights
+         * \param _maxDepthDiff Maximal depth difference to the pixel, disabled when null
+         * \warning The window must be at most #MaxWindowWidth pixels wide
+         */
+        template <bool withScatter = true>
+        [[nodiscard]] inline NeighborMoments<DataPoint> windowMoments(const std::vector<Scalar>& _stencil, int _x,
+                                                                      int _y, int _scale, Scalar _maxDepthDiff) const
+        {
+            using Row       = Eigen::Map<const Eigen::Array<Scalar, Eigen::Dynamic, 1>>;
+            using WindowRow = Eigen::Array<Scalar, Eigen::Dynamic, 1, Eigen::ColMajor, MaxWindowWidth, 1>;
+            PONCA_ASSERT(2 * _scale + 1 <= MaxWindowWidth);
+
+            const VectorType& p = m_points[_y * m_width + _x].pos();
+            const int dx0       = std::max(-_scale, -_x);
+            const int dx1       = std::min(_scale, m_width - 1 - _x);
+            const int n         = dx1 - dx0 + 1;
+            // The depth threshold is disabled when null
+            const Scalar depthLimit =
+                _maxDepthDiff != Scalar(0) ? _maxDepthDiff : std::numeric_limits<Scalar>::infinity();
+            NeighborMoments<DataPoint> m;
+
+            for (int dy = std::max(-_scale, -_y); dy <= std::min(_scale, m_height - 1 - _y); ++dy)
+            {
+                const int first = (_y + dy) * m_width + _x + dx0;
+                const Row px(m_positions[0].data() + first, n), py(m_positions[1].data() + first, n),
+                    pz(m_positions[2].data() + first, n);
+                const Row nx(m_normals[0].data() + first, n), ny(m_normals[1].data() + first, n),
+                    nz(m_normals[2].data() + first, n);
+                const WindowRow qx = px - p.x();
+                const WindowRow qy = py - p.y();
+                const WindowRow qz = pz - p.z();
+
+                const Row stencil(_stencil.data() + (dy + _scale) * (2 * _scale + 1) + dx0 + _scale, n);
+                const Row valid(m_valid.data() + first, n);
+                const WindowRow wr = (qz.abs() > depthLimit).select(Scalar(0), stencil * valid);
+
+                m.count += int((wr > Scalar(0)).count());
+                m.sumW += wr.sum();
+                m.sumQ += VectorType((wr * qx).sum(), (wr * qy).sum(), (wr * qz).sum());
+                m.sumN += VectorType((wr * nx).sum(), (wr * ny).sum(), (wr * nz).sum());
+                m.sumDotQQ += (wr * (qx.square() + qy.square() + qz.square())).sum();
+                m.sumDotQN += (wr * (qx * nx + qy * ny + qz * nz)).sum();
+
+                if constexpr (withScatter)
+                {
+                    const WindowRow wqx = wr * qx, wqy = wr * qy;
+                    m.sumQQt(0, 0) += (wqx * qx).sum();
+                    m.sumQQt(0, 1) += (wqx * qy).sum();
+                    m.sumQQt(0, 2) += (wqx * qz).sum();
+                    m.sumQQt(1, 1) += (wqy * qy).sum();
+                    m.sumQQt(1, 2) += (wqy * qz).sum();
+                    m.sumQQt(2, 2) += (wr * qz.square()).sum();
+                }
+            }
+            if constexpr (withScatter)
+                m.sumQQt.template triangularView<Eigen::StrictlyLower>() = m.sumQQt.transpose();
+            return m;
+        }
+
+    private:
+        int m_width{0}, m_height{0};
+        std::vector<DataPoint> m_points;
+        std::vector<Scalar> m_positions[3], m_normals[3]; ///< Coordinates of the points, one array per coordinate
+        std::vector<Scalar> m_valid;                      ///< 1 for the valid pixels, 0 for the background
+    };
+
+    /// \brief How the neighbors of a pixel are accumulated by #screenSpaceFit
+    enum class ScreenSpaceAccumulation
+    {
+        OneByOne,  ///< Basket::computeWithIds over the pixels of the window
+        Blocks,    ///< Basket::computeWithIdsByBlocks over the pixels of the window
+        WindowRows ///< ScreenSpaceBuffers::windowMoments, accumulated at once by Basket::addLocalMoments
+    };
+
+    /*!
+     * \brief Fit a primitive at each valid pixel, from the pixels of its circular screen-space window
+     *
+     * The image is split in tiles of `_tileSize`^2 pixels, scheduled dynamically across the OpenMP threads, and each
+     * thread reuses the same fitting object for all its pixels. The neighbors of each pixel are accumulated as selected
+     * by `accumulation`: with ScreenSpaceAccumulation::WindowRows, the weights only depend on the pixel offsets and are
+     * precomputed once for the whole image.
+     *
+     * \tparam accumulation How the neighbors are accumulated
+     * \tparam FitType Basket type, whose NeighborFilter is a ScreenSpaceWeightFunc. With
+     * ScreenSpaceAccumulation::WindowRows, its extensions must accept moments (see Basket::isMomentCompatible)
+     * \tparam Functor Called as `_f(pixel, fit)` after the fit of each valid pixel, possibly from several threads
+     *
+     * \param _buffers Position and normal buffers
+     * \param _scale Scale, in pixels
+     * \param _maxDepthDiff Maximal depth difference between a pixel and its neighbors, disabled when null
+     * \param _tileSize Size of the tiles, in pixels
+     * \param _f Functor receiving the fits
+     * \param _prototype Fitting object copied in each thread, for instance to configure some of its parameters
+     */
+    template <ScreenSpaceAccumulation accumulation, typename FitType, typename Functor>
+    void screenSpaceFit(const ScreenSpaceBuffers<typename FitType::DataPoint>& _buffers, int _scale,
+                        typename FitType::Scalar _maxDepthDiff, int _tileSize, const Functor& _f,
+                        const FitType& _prototype = FitType())
+    {
+        using Scalar         = typename FitType::Scalar;
+        using DataPoint      = typename FitType::DataPoint;
+        using NeighborFilter = typename FitType::NeighborFilter;
+        if constexpr (accumulation == ScreenSpaceAccumulation::WindowRows)
+            static_assert(FitType::isMomentCompatible, "The window rows are accumulated as moments");
+        // Only the covariance fits use the second order moments
+        constexpr bool withScatter = requires(const FitType& _fit) { _fit.covarianceFit(); };
+        PONCA_ASSERT(_scale >= 1 && _tileSize >= 1);
+
+        const int w        = _buffers.width();
+        const int h        = _buffers.height();
+        const int nbTileX  = (w + _tileSize - 1) / _tileSize;
+        const int nbTileY  = (h + _tileSize - 1) / _tileSize;
+        const auto& points = _buffers.points();
+
+        std::vector<Scalar> stencil;
+        if constexpr (accumulation == ScreenSpaceAccumulation::WindowRows)
+            stencil = ScreenSpaceBuffers<DataPoint>::template windowWeights<typename NeighborFilter::WeightKernel>(
+                _scale);
+
+#pragma omp parallel
+        {
+            FitType fit = _prototype;
+            // Ids of the pixels in the screen-space window, reused between the pixels of a thread
+            std::vector<int> ids;
+            ids.reserve(size_t(2 * _scale + 1) * (2 * _scale + 1));
+
+#pragma omp for schedule(dynamic)
+            for (int tile = 0; tile < nbTileX * nbTileY; ++tile)
+            {
+                const int x0 = (tile % nbTileX) * _tileSize;
+                const int y0 = (tile / nbTileX) * _tileSize;
+                for (int y = y0; y < std::min(y0 + _tileSize, h); ++y)
+                    for (int x = x0; x < std::min(x0 + _tileSize, w); ++x)
+                    {
+                        const DataPoint& p = points[y * w + x];
+                        if (!p.valid())
+                            continue;
+
+                        fit.setNeighborFilter(NeighborFilter(p, Scalar(_scale), _maxDepthDiff));
+                        if constexpr (accumulation == ScreenSpaceAccumulation::WindowRows)
+                        {
+                            fit.init();
+                            fit.addLocalMoments(
+                                _buffers.template windowMoments<withScatter>(stencil, x, y, _scale, _maxDepthDiff));
+                            fit.finalize();
+                        }
+                        else
+                        {
+                            // The filter rejects the pixels out of the disk
+                            ids.clear();
+                            for (int ny = std::max(y - _scale, 0); ny <= std::min(y + _scale, h - 1); ++ny)
+                                for (int nx = std::max(x - _scale, 0); nx <= std::min(x + _scale, w - 1); ++nx)
+                                    ids.push_back(ny * w + nx);
+
+                            if constexpr (accumulation == ScreenSpaceAccumulation::Blocks)
+                                fit.computeWithIdsByBlocks(ids, points);
+                            else
+                                fit.computeWithIds(ids, points);
+                        }
+                        _f(y * w + x, static_cast<const FitType&>(fit));
+                    }
+            }
+        }
+    }
+} // namespace Ponca
@@ -7,6 +7,7 @@ file, You can obtain one at http://mozilla.org/MPL/2.0/.
 #pragma once
 
 #include "./algebraicSphere.h"
+#include "./eigenSolverPolicy.h"
 
 namespace Ponca
 {
@@ -51,9 +52,15 @@ namespace Ponca
 
         \inherit Concept::FittingProcedureConcept
 
+        \tparam SolverPolicy Policy used to solve the eigenvalue problem. With DirectEigenSolverPolicy, it is rewritten
+        as the self-adjoint problem \f$ L^{-1}CL^{-T}\mathbf{y} = \frac{1}{\lambda}\mathbf{y} \f$, with \f$ A = LL^T \f$
+        and \f$ \mathbf{y} = L^T\mathbf{u} \f$. When \f$ A \f$ is nearly singular (e.g. neighbors lying exactly on a
+        sphere), \f$ \lambda \approx 0 \f$ and the solution is taken as the eigenvector of \f$ A \f$ with the smallest
+        eigenvalue satisfying the Pratt constraint.
+
         \see AlgebraicSphere
     */
-    template <class DataPoint, class _NFilter, typename T>
+    template <class DataPoint, class _NFilter, typename T, typename SolverPolicy = IterativeEigenSolverPolicy>
     class SphereFitImpl : public T
     {
         PONCA_FITTING_DECLARE_DEFAULT_TYPES
@@ -69,7 +76,8 @@ namespace Ponca
         using MatrixA = Eigen::Matrix<Scalar, DataPoint::Dim + 2, DataPoint::Dim + 2>;
 
     public:
-        using Solver = Eigen::EigenSolver<MatrixA>;
+        using Solver = std::conditional_t<SolverPolicy::isSelfAdjointGeneralized,
+                                          Eigen::SelfAdjointEigenSolver<MatrixA>, Eigen::EigenSolver<MatrixA>>;
 
     protected:
         // computation data
@@ -79,7 +87,8 @@ namespace Ponca
 
     public:
         PONCA_EXPLICIT_CAST_OPERATORS(SphereFitImpl, sphereFit)
-        PONCA_FITTING_DECLARE_INIT_ADD_FINALIZE
+        PONCA_FITTING_DECLARE_INIT_ADDS_FINALIZE
+        PONCA_FITTING_DECLARE_MERGE(SphereFitImpl)
         PONCA_FITTING_IS_SIGNED(false)
 
         PONCA_MULTIARCH inline const Solver& solver() const { return m_solver; }
@@ -4,16 +4,16 @@
  file, You can obtain one at http://mozilla.org/MPL/2.0/.
 */
 
-template <class DataPoint, class _NFilter, typename T>
-void SphereFitImpl<DataPoint, _NFilter, T>::init()
+template <class DataPoint, class _NFilter, typename T, typename SolverPolicy>
+void SphereFitImpl<DataPoint, _NFilter, T, SolverPolicy>::init()
 {
     Base::init();
     m_matA.setZero();
 }
 
-template <class DataPoint, class _NFilter, typename T>
-void SphereFitImpl<DataPoint, _NFilter, T>::addLocalNeighbor(Scalar w, const VectorType& localQ,
-                                                             const DataPoint& attributes)
+template <class DataPoint, class _NFilter, typename T, typename SolverPolicy>
+void SphereFitImpl<DataPoint, _NFilter, T, SolverPolicy>::addLocalNeighbor(Scalar w, const VectorType& localQ,
+                                                                           const DataPoint& attributes)
 {
     Base::addLocalNeighbor(w, localQ, attributes);
     VectorA a;
@@ -27,8 +27,29 @@ void SphereFitImpl<DataPoint, _NFilter, T>::addLocalNeighbor(Scalar w, const Vec
     m_matA += w * a * a.transpose();
 }
 
-template <class DataPoint, class _NFilter, typename T>
-FIT_RESULT SphereFitImpl<DataPoint, _NFilter, T>::finalize()
+template <class DataPoint, class _NFilter, typename T, typename SolverPolicy>
+template <int BlockSize>
+void SphereFitImpl<DataPoint, _NFilter, T, SolverPolicy>::addLocalNeighbors(
+    const NeighborBlock<DataPoint, BlockSize>& block)
+{
+    Base::addLocalNeighbors(block);
+    // One column [1, p, p^2] per neighbor, the unused columns have a null weight
+    Eigen::Matrix<Scalar, DataPoint::Dim + 2, BlockSize> a;
+    a.row(0).setOnes();
+    a.template middleRows<DataPoint::Dim>(1) = block.localQ;
+    a.row(DataPoint::Dim + 1)                = block.localQ.colwise().squaredNorm();
+    m_matA += a * block.weights.asDiagonal() * a.transpose();
+}
+
+template <class DataPoint, class _NFilter, typename T, typename SolverPolicy>
+void SphereFitImpl<DataPoint, _NFilter, T, SolverPolicy>::merge(const SphereFitImpl& other)
+{
+    Base::merge(other);
+    m_matA += other.m_matA;
+}
+
+template <class DataPoint, class _NFilter, typename T, typename SolverPolicy>
+FIT_RESULT SphereFitImpl<DataPoint, _NFilter, T, SolverPolicy>::finalize()
 {
     // Compute status
     if (Base::finalize() != STABLE)
@@ -47,35 +68,84 @@ FIT_RESULT SphereFitImpl<DataPoint, _NFilter, T>::finalize()
     matC.template topLeftCorner<1, 1>() << 0;
     matC.template bottomRightCorner<1, 1>() << 0;
 
-    MatrixA invCpratt;
-    invCpratt.setIdentity();
-    invCpratt.template topRightCorner<1, 1>() << -0.5;
-    invCpratt.template bottomLeftCorner<1, 1>() << -0.5;
-    invCpratt.template topLeftCorner<1, 1>() << 0;
-    invCpratt.template bottomRightCorner<1, 1>() << 0;
+    VectorA vecU;
+    if constexpr (SolverPolicy::isSelfAdjointGeneralized)
+    {
+        // Remarks:
+        //   A is positive semi-definite: when it is definite, with A = LL^T, C u = (1/lambda) A u amounts to
+        //   L^{-1}CL^{-T}y = (1/lambda) y with y = L^T u, and the minimal positive eigenvalue lambda is the maximal
+        //   eigenvalue 1/lambda
+        //   a tiny pivot, relatively to its column, means that A is nearly singular, e.g. when the neighbors lie
+        //   exactly on a sphere: the solution is then close to the eigenvector of A with the minimal eigenvalue
+        //   satisfying the Pratt constraint, which is computed instead
+        PONCA_MULTIARCH_STD_MATH(sqrt);
+        Eigen::LLT<MatrixA> llt(m_matA);
+        const Scalar tolerance = sqrt(Eigen::NumTraits<Scalar>::epsilon());
+        const bool isSingular =
+            llt.info() != Eigen::Success ||
+            (llt.matrixLLT().diagonal().cwiseAbs2().array() <= tolerance * m_matA.diagonal().array()).any();
+        if (!isSingular)
+        {
+            MatrixA matM = llt.matrixL().solve(matC);
+            matM         = llt.matrixL().solve(matM.transpose()).eval();
+            SolverPolicy::computeSelfAdjoint(m_solver, matM);
+
+            // Eigenvalues are sorted in increasing order
+            vecU = llt.matrixU().solve(m_solver.eigenvectors().col(DataPoint::Dim + 1)).normalized();
+        }
+        else
+        {
+            // Eigenvalues are sorted in increasing order, the solution satisfies the Pratt constraint u^T C u > 0
+            SolverPolicy::computeSelfAdjoint(m_solver, m_matA);
+            int minId = 0;
+            for (; minId < DataPoint::Dim + 2; ++minId)
+            {
+                vecU = m_solver.eigenvectors().col(minId);
+                if (vecU.dot(matC * vecU) > Scalar(0))
+                    break;
+            }
+            if (minId == DataPoint::Dim + 2)
+                return Base::m_eCurrentState = UNDEFINED;
+        }
+    }
+    else
+    {
+        MatrixA invCpratt;
+        invCpratt.setIdentity();
+        invCpratt.template topRightCorner<1, 1>() << -0.5;
+        invCpratt.template bottomLeftCorner<1, 1>() << -0.5;
+        invCpratt.template topLeftCorner<1, 1>() << 0;
+        invCpratt.template bottomRightCorner<1, 1>() << 0;
 
-    // Remarks:
-    //   A and C are symmetric so all eigenvalues and eigenvectors are real
-    //   we look for the minimal positive eigenvalue (eigenvalues may be negative)
-    //   C^{-1}A is not symmetric
-    //   calling Eigen::GeneralizedEigenSolver on (A,C) and Eigen::EigenSolver on C^{-1}A is equivalent
-    //   C is not positive definite so Eigen::GeneralizedSelfAdjointEigenSolver cannot be used
+        // Remarks:
+        //   A and C are symmetric so all eigenvalues and eigenvectors are real
+        //   we look for the minimal positive eigenvalue (eigenvalues may be negative)
+        //   C^{-1}A is not symmetric
+        //   calling Eigen::GeneralizedEigenSolver on (A,C) and Eigen::EigenSolver on C^{-1}A is equivalent
+        //   C is not positive definite so Eigen::GeneralizedSelfAdjointEigenSolver cannot be used
 #ifdef __CUDACC__
-    m_solver.computeDirect(invCpratt * m_matA);
+        m_solver.computeDirect(invCpratt * m_matA);
 #else
-    m_solver.compute(invCpratt * m_matA);
+        m_solver.compute(invCpratt * m_matA);
 #endif
-    VectorA eivals = m_solver.eigenvalues().real();
-    int minId      = -1;
-    for (int i = 0; i < DataPoint::Dim + 2; ++i)
-    {
-        Scalar ev = eivals(i);
-        if ((ev > 0) && (minId == -1 || ev < eivals(minId)))
-            minId = i;
-    }
+        // The eigenvalues are the residuals u^T A u of the eigenvectors normalized by u^T C u: the solution is the
+        // eigenvector satisfying the Pratt constraint (u^T C u > 0) with the minimal residual, which may be slightly
+        // negative due to rounding when the neighbors lie exactly on a sphere
+        VectorA eivals = m_solver.eigenvalues().real();
+        int minId      = -1;
+        for (int i = 0; i < DataPoint::Dim + 2; ++i)
+        {
+            const VectorA u = m_solver.eigenvectors().col(i).real();
+            Scalar ev       = eivals(i);
+            if (u.dot(matC * u) > 0 && (minId == -1 || ev < eivals(minId)))
+                minId = i;
+        }
+        if (minId == -1)
+            return Base::m_eCurrentState = UNDEFINED;
 
-    // mLambda = eivals(minId);
-    VectorA vecU = m_solver.eigenvectors().col(minId).real();
+        // mLambda = eivals(minId);
+        vecU = m_solver.eigenvectors().col(minId).real();
+    }
     Base::m_uq   = vecU[1 + DataPoint::Dim];
     Base::m_ul   = vecU.template segment<DataPoint::Dim>(1);
     Base::m_uc   = vecU[0];
@@ -9,6 +9,7 @@
 #pragma once
 
 #include "./algebraicSphere.h"
+#include "./eigenSolverPolicy.h"
 #include "./mean.h" // used to define UnorientedSphereFit
 
 #include <Eigen/Dense>
@@ -42,9 +43,13 @@ namespace Ponca
 
         \inherit Concept::FittingProcedureConcept
 
+        \tparam SolverPolicy Policy used to solve the eigenvalue problem. With DirectEigenSolverPolicy, it is rewritten
+        as the self-adjoint problem \f$ L^{-1}AL^{-T}\mathbf{y} = \lambda\mathbf{y} \f$, with \f$ Q = LL^T \f$ and
+        \f$ \mathbf{y} = L^T\mathbf{u} \f$.
+
         \see class AlgebraicSphere, class OrientedSphereFit
     */
-    template <class DataPoint, class _NFilter, typename T>
+    template <class DataPoint, class _NFilter, typename T, typename SolverPolicy = IterativeEigenSolverPolicy>
     class UnorientedSphereFitImpl : public T
     {
         PONCA_FITTING_DECLARE_DEFAULT_TYPES
@@ -59,7 +64,8 @@ namespace Ponca
         using MatrixBB = Eigen::Matrix<Scalar, DataPoint::Dim + 1, DataPoint::Dim + 1>;
 
     public:
-        using Solver = Eigen::EigenSolver<MatrixBB>;
+        using Solver = std::conditional_t<SolverPolicy::isSelfAdjointGeneralized,
+                                          Eigen::SelfAdjointEigenSolver<MatrixBB>, Eigen::EigenSolver<MatrixBB>>;
 
         MatrixBB m_matA{MatrixBB::Zero()}; /*!< \brief The accumulated covariance matrix */
         MatrixBB m_matQ{MatrixBB::Zero()}; /*!< \brief The constraint matrix */
@@ -69,7 +75,8 @@ namespace Ponca
 
     public:
         PONCA_EXPLICIT_CAST_OPERATORS(UnorientedSphereFitImpl, unorientedSphereFit)
-        PONCA_FITTING_DECLARE_INIT_ADD_FINALIZE
+        PONCA_FITTING_DECLARE_INIT_ADDS_FINALIZE
+        PONCA_FITTING_DECLARE_MERGE(UnorientedSphereFitImpl)
         PONCA_FITTING_IS_SIGNED(false)
 
     }; // class UnorientedSphereFitImpl
@@ -114,6 +121,7 @@ namespace Ponca
         PONCA_EXPLICIT_CAST_OPERATORS_DER(UnorientedSphereDerImpl, unorientedSphereDer)
 
         PONCA_FITTING_DECLARE_INIT_ADDDER_FINALIZE
+        PONCA_FITTING_DECLARE_MERGE(UnorientedSphereDerImpl)
 
         PONCA_MULTIARCH inline ScalarArray dPotential() const;
         PONCA_MULTIARCH inline VectorArray dNormal() const;
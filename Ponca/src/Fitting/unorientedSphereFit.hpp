@@ -7,8 +7,8 @@
 namespace Ponca
 {
 
-    template <class DataPoint, class _NFilter, typename T>
-    void UnorientedSphereFitImpl<DataPoint, _NFilter, T>::init()
+    template <class DataPoint, class _NFilter, typename T, typename SolverPolicy>
+    void UnorientedSphereFitImpl<DataPoint, _NFilter, T, SolverPolicy>::init()
     {
         Base::init();
         m_matA.setZero();
@@ -16,9 +16,9 @@ namespace Ponca
         m_sumDotPP = Scalar(0.0);
     }
 
-    template <class DataPoint, class _NFilter, typename T>
-    void UnorientedSphereFitImpl<DataPoint, _NFilter, T>::addLocalNeighbor(Scalar w, const VectorType& localQ,
-                                                                           const DataPoint& attributes)
+    template <class DataPoint, class _NFilter, typename T, typename SolverPolicy>
+    void UnorientedSphereFitImpl<DataPoint, _NFilter, T, SolverPolicy>::addLocalNeighbor(
+        Scalar w, const VectorType& localQ, const DataPoint& attributes)
     {
         Base::addLocalNeighbor(w, localQ, attributes);
         VectorB basis;
@@ -28,8 +28,30 @@ namespace Ponca
         m_sumDotPP += w * localQ.squaredNorm();
     }
 
-    template <class DataPoint, class _NFilter, typename T>
-    FIT_RESULT UnorientedSphereFitImpl<DataPoint, _NFilter, T>::finalize()
+    template <class DataPoint, class _NFilter, typename T, typename SolverPolicy>
+    template <int BlockSize>
+    void UnorientedSphereFitImpl<DataPoint, _NFilter, T, SolverPolicy>::addLocalNeighbors(
+        const NeighborBlock<DataPoint, BlockSize>& block)
+    {
+        Base::addLocalNeighbors(block);
+        Eigen::Matrix<Scalar, DataPoint::Dim + 1, BlockSize> basis;
+        basis.template topRows<DataPoint::Dim>() = block.normals;
+        basis.row(DataPoint::Dim)                = block.normals.cwiseProduct(block.localQ).colwise().sum();
+
+        m_matA += basis * block.weights.asDiagonal() * basis.transpose();
+        m_sumDotPP += (block.localQ.colwise().squaredNorm() * block.weights).value();
+    }
+
+    template <class DataPoint, class _NFilter, typename T, typename SolverPolicy>
+    void UnorientedSphereFitImpl<DataPoint, _NFilter, T, SolverPolicy>::merge(const UnorientedSphereFitImpl& other)
+    {
+        Base::merge(other);
+        m_matA += other.m_matA;
+        m_sumDotPP += other.m_sumDotPP;
+    }
+
+    template <class DataPoint, class _NFilter, typename T, typename SolverPolicy>
+    FIT_RESULT UnorientedSphereFitImpl<DataPoint, _NFilter, T, SolverPolicy>::finalize()
     {
         PONCA_MULTIARCH_STD_MATH(sqrt);
         constexpr int Dim = DataPoint::Dim;
@@ -52,13 +74,30 @@ namespace Ponca
         m_matQ.row(Dim).template head<Dim>() = Base::m_sumP * invSumW;
         m_matQ(Dim, Dim)                     = m_sumDotPP * invSumW;
 
-        MatrixBB M = m_matQ.inverse() * m_matA;
-        m_solver.compute(M);
-        VectorB eivals = m_solver.eigenvalues().real();
-        int maxId      = 0;
-        eivals.maxCoeff(&maxId);
+        VectorB eivec;
+        if constexpr (SolverPolicy::isSelfAdjointGeneralized)
+        {
+            // Q = LL^T is positive definite: solve L^{-1} A L^{-T} y = lambda y, with y = L^T u
+            Eigen::LLT<MatrixBB> llt(m_matQ);
+            if (llt.info() != Eigen::Success)
+                return Base::m_eCurrentState = UNDEFINED;
+            MatrixBB M = llt.matrixL().solve(m_matA);
+            M          = llt.matrixL().solve(M.transpose()).eval();
+            SolverPolicy::computeSelfAdjoint(m_solver, M);
+
+            // Eigenvalues are sorted in increasing order
+            eivec = llt.matrixU().solve(m_solver.eigenvectors().col(Dim)).normalized();
+        }
+        else
+        {
+            MatrixBB M = m_matQ.inverse() * m_matA;
+            m_solver.compute(M);
+            VectorB eivals = m_solver.eigenvalues().real();
+            int maxId      = 0;
+            eivals.maxCoeff(&maxId);
 
-        VectorB eivec = m_solver.eigenvectors().col(maxId).real();
+            eivec = m_solver.eigenvectors().col(maxId).real();
+        }
 
         // integrate
         Base::m_ul = eivec.template head<Dim>();
@@ -100,6 +139,15 @@ namespace Ponca
         }
     }
 
+    template <class DataPoint, class _NFilter, int DiffType, typename T>
+    void UnorientedSphereDerImpl<DataPoint, _NFilter, DiffType, T>::merge(const UnorientedSphereDerImpl& other)
+    {
+        Base::merge(other);
+        m_dSumDotPP += other.m_dSumDotPP;
+        for (int dim = 0; dim < Base::NbDerivatives; ++dim)
+            m_dmatA[dim] += other.m_dmatA[dim];
+    }
+
     template <class DataPoint, class _NFilter, int DiffType, typename T>
     FIT_RESULT UnorientedSphereDerImpl<DataPoint, _NFilter, DiffType, T>::finalize()
     {
@@ -8,6 +8,7 @@
 
 #include "../Common/Assert.h"
 #include "./defines.h"
+#include "./weightKernel.h"
 #include PONCA_MULTIARCH_INCLUDE_CU_STD(utility)
 
 namespace Ponca
@@ -218,11 +219,23 @@ namespace Ponca
 
             \f$ w(\frac{\left|\mathbf{q}_\mathsf{x}\right|}{t}) \f$
 
+            When the kernel can be evaluated from the squared distance (see #hasSquaredDistanceEvaluation), the weight is
+            computed from \f$ \frac{\left|\mathbf{q}_\mathsf{x}\right|^2}{t^2} \f$, without square root.
+
             \see convertToLocalBasis
             \return The computed weight + the point expressed in local basis
         */
         PONCA_MULTIARCH inline WeightReturnType operator()(const DataPoint& q) const;
 
+        /*!
+            \brief Weight of a query at the squared distance `_d2` from the evaluation position, as computed by
+            #operator()
+
+            Allows to weight a query for several filters sharing the same evaluation position from a single distance
+            computation (see MultiScaleFit).
+        */
+        PONCA_MULTIARCH [[nodiscard]] inline Scalar weightFromSquaredDistance(const Scalar& _d2) const;
+
         /*!
             \brief First order derivative in space (for each spatial dimension \f$\mathsf{x})\f$
 
@@ -328,6 +341,13 @@ namespace Ponca
         /*! \brief Access to the evaluation scale set during the initialization */
         PONCA_MULTIARCH [[nodiscard]] inline Scalar evalScale() const { return m_t; }
 
+        /// \brief Do all the neighbors in the support of the filter have the same weight ? (see
+        /// WeightKernel::isConstant)
+        static constexpr bool hasUniformWeight = requires { requires WeightKernel::isConstant; };
+
+        /*! \brief Weight of the neighbors in the support of the filter \warning Valid only if #hasUniformWeight */
+        PONCA_MULTIARCH [[nodiscard]] inline Scalar uniformWeight() const { return m_wk.f(Scalar(0)); }
+
     protected:
         Scalar m_t;        /*!< \brief Evaluation scale */
         WeightKernel m_wk; /*!< \brief 1D function applied to weight queries */
@@ -369,6 +389,12 @@ namespace Ponca
             ///! \copydoc NoWeightFuncBase
             PONCA_MULTIARCH inline NoWeightFuncBase(const DataPoint& v, Scalar = 0) : NeighborhoodFrame(v.pos()) {}
 
+            /// \brief All the neighbors have the same weight
+            static constexpr bool hasUniformWeight = true;
+
+            /*! \brief Weight of the neighbors, which is always $1$ */
+            PONCA_MULTIARCH [[nodiscard]] inline Scalar uniformWeight() const { return Scalar(1); }
+
             /*!
                 \brief Compute the weight of the given query, which is always $1$
                 \param _q Query in global coordinate system
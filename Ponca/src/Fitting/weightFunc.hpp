@@ -11,11 +11,30 @@ typename DistWeightFunc<DataPoint, WeightKernel>::WeightReturnType DistWeightFun
     const DataPoint& _q) const
 {
     const auto lq = NeighborhoodFrame::convertToLocalBasis(_q.pos());
-    Scalar d      = lq.norm();
-    if (isCompact) // compile-time branching
-        return {(d <= m_t) ? m_wk.f(d / m_t) : Scalar(0.), lq};
+    return {weightFromSquaredDistance(lq.squaredNorm()), lq};
+}
+
+template <class DataPoint, class WeightKernel>
+typename DistWeightFunc<DataPoint, WeightKernel>::Scalar DistWeightFunc<
+    DataPoint, WeightKernel>::weightFromSquaredDistance(const Scalar& _d2) const
+{
+    if constexpr (hasSquaredDistanceEvaluation<WeightKernel>)
+    { // sqrt-free evaluation
+        const Scalar t2 = m_t * m_t;
+        if (isCompact) // compile-time branching
+            return (_d2 <= t2) ? m_wk.fSquared(_d2 / t2) : Scalar(0.);
+        else
+            return m_wk.fSquared(_d2 / t2);
+    }
     else
-        return {m_wk.f(d / m_t), lq};
+    {
+        PONCA_MULTIARCH_STD_MATH(sqrt);
+        Scalar d = sqrt(_d2);
+        if (isCompact) // compile-time branching
+            return (d <= m_t) ? m_wk.f(d / m_t) : Scalar(0.);
+        else
+            return m_wk.f(d / m_t);
+    }
 }
 
 template <class DataPoint, class WeightKernel>
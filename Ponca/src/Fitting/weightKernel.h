@@ -14,6 +14,37 @@
 
 namespace Ponca
 {
+    namespace internal
+    {
+        /// \brief Compute \f$ x^N \f$ by exponentiation by squaring, with \f$ N \geq 0 \f$ known at compile-time
+        template <int N, typename Scalar>
+        PONCA_MULTIARCH [[nodiscard]] constexpr inline Scalar ipow(const Scalar& _x)
+        {
+            static_assert(N >= 0, "Negative exponents are not supported");
+            if constexpr (N == 0)
+                return Scalar(1.);
+            else if constexpr (N == 1)
+                return _x;
+            else if constexpr (N % 2 == 0)
+            {
+                const Scalar h = ipow<N / 2>(_x);
+                return h * h;
+            }
+            else
+                return _x * ipow<N - 1>(_x);
+        }
+    } // namespace internal
+
+    /*!
+        \brief Trait indicating if a WeightKernel can be evaluated from the squared normalized distance
+
+        Such kernels provide `fSquared(x2)`, which is equal to `f(x)` with \f$ x2 = x^2 \f$. It allows DistWeightFunc to
+        compute the weights from the squared distances to the evaluation position, thus without square roots.
+    */
+    template <typename WeightKernel>
+    constexpr bool hasSquaredDistanceEvaluation =
+        requires(const WeightKernel& _k, const typename WeightKernel::Scalar& _x2) { _k.fSquared(_x2); };
+
     /*!
         \brief Concept::WeightKernelConcept returning a constant value
 
@@ -30,6 +61,9 @@ namespace Ponca
         /// \see #NoWeightFunc and #NoWeightFuncGlobal for alternative way to use uniform weight.
         static constexpr bool isCompact = true;
 
+        /// \brief The kernel returns the same value everywhere, see DistWeightFunc::hasUniformWeight
+        static constexpr bool isConstant = true;
+
         // Init
         //! \brief Default constructor that could be used to set the returned value
         PONCA_MULTIARCH inline ConstantWeightKernel(const Scalar& _value = Scalar(1.)) : m_y(_value) {}
@@ -39,6 +73,8 @@ namespace Ponca
         // Functor
         //! \brief Return the constant value
         PONCA_MULTIARCH [[nodiscard]] inline Scalar f(const Scalar&) const { return m_y; }
+        //! \brief Return the constant value
+        PONCA_MULTIARCH [[nodiscard]] inline Scalar fSquared(const Scalar&) const { return m_y; }
         //! \brief Return \f$ 0 \f$
         PONCA_MULTIARCH [[nodiscard]] inline Scalar df(const Scalar&) const { return Scalar(0.); }
         //! \brief Return \f$ 0 \f$
@@ -73,7 +109,12 @@ namespace Ponca
         /*! \brief Defines the smooth weighting function \f$ w(x) = (x^2-1)^2 \f$ */
         PONCA_MULTIARCH [[nodiscard]] inline Scalar f(const Scalar& _x) const
         {
-            Scalar v = _x * _x - Scalar(1.);
+            return fSquared(_x * _x);
+        }
+        /*! \brief Defines the smooth weighting function from \f$ x^2 \f$: \f$ w(x) = (x^2-1)^2 \f$ */
+        PONCA_MULTIARCH [[nodiscard]] inline Scalar fSquared(const Scalar& _x2) const
+        {
+            Scalar v = _x2 - Scalar(1.);
             return v * v;
         }
         /*! \brief Defines the smooth first order weighting function \f$ \nabla w(x) = 4x(x^2-1) \f$ */
@@ -111,25 +152,34 @@ namespace Ponca
         /*! \brief Defines the smooth weighting function \f$  w(x)=(x^n-1)^m \f$ */
         PONCA_MULTIARCH [[nodiscard]] inline Scalar f(const Scalar& _x) const
         {
-            PONCA_MULTIARCH_STD_MATH(pow);
-            return pow(pow(_x, Scalar(n)) - Scalar(1.), Scalar(m));
+            return internal::ipow<m, Scalar>(internal::ipow<n>(_x) - Scalar(1.));
+        }
+        /*! \brief Defines the smooth weighting function from \f$ x^2 \f$ when \f$ n \f$ is even:
+         * \f$ w(x)=((x^2)^{n/2}-1)^m \f$ */
+        PONCA_MULTIARCH [[nodiscard]] inline Scalar fSquared(const Scalar& _x2) const
+            requires(n % 2 == 0)
+        {
+            return internal::ipow<m, Scalar>(internal::ipow<n / 2>(_x2) - Scalar(1.));
         }
         /*! \brief Defines the smooth first order weighting function \f$ \nabla w(x) = m n x^{n-1}
          * \left(x^n-1\right)^{m-1} \f$ */
         PONCA_MULTIARCH [[nodiscard]] inline Scalar df(const Scalar& _x) const
         {
-            PONCA_MULTIARCH_STD_MATH(pow);
-            return pow(Scalar(m * n) * _x, Scalar(n - 1)) * pow(pow(_x, Scalar(n)) - 1, Scalar(m - 1));
+            return Scalar(m * n) * internal::ipow<n - 1>(_x) *
+                   internal::ipow<m - 1, Scalar>(internal::ipow<n>(_x) - Scalar(1.));
         }
         /*! \brief Defines the smooth second order weighting function \f$ \nabla^2 w(x) = (m-1) m n^2 x^{2 n-2}
          * \left(x^n-1\right)^{m-2}+m (n-1) n x^{n-2} \left(x^n-1\right)^{m-1} \f$ */
         PONCA_MULTIARCH [[nodiscard]] inline Scalar ddf(const Scalar& _x) const
         {
-            PONCA_MULTIARCH_STD_MATH(pow);
-            return Scalar((m - 1) * m * n * n) * pow(_x, Scalar(2 * n - 2)) *
-                       pow(pow(_x, Scalar(n)) - Scalar(1), Scalar(m - 2)) +
-                   Scalar(m * (n - 1) * n) * pow(_x, Scalar(n - 2)) *
-                       pow(pow(_x, Scalar(n)) - Scalar(1), Scalar(m - 1));
+            const Scalar v = internal::ipow<n>(_x) - Scalar(1.);
+            Scalar res(0.);
+            // The terms are null when their coefficient is, and their exponents could then be negative
+            if constexpr (m > 1)
+                res += Scalar((m - 1) * m * n * n) * internal::ipow<2 * n - 2>(_x) * internal::ipow<m - 2>(v);
+            if constexpr (n > 1)
+                res += Scalar(m * (n - 1) * n) * internal::ipow<n - 2>(_x) * internal::ipow<m - 1>(v);
+            return res;
         }
         //! \brief #df is defined and valid on the definition interval
         static constexpr bool isDValid = true;
@@ -200,7 +250,9 @@ namespace Ponca
 
         // Functor
         /*! \brief Defines the Singular weighting function \f$ w(x) = 1 / (x^2) \f$ */
-        PONCA_MULTIARCH [[nodiscard]] inline Scalar f(const Scalar& _x) const { return Scalar(1.) / (_x * _x); }
+        PONCA_MULTIARCH [[nodiscard]] inline Scalar f(const Scalar& _x) const { return fSquared(_x * _x); }
+        /*! \brief Defines the Singular weighting function from \f$ x^2 \f$: \f$ w(x) = 1 / (x^2) \f$ */
+        PONCA_MULTIARCH [[nodiscard]] inline Scalar fSquared(const Scalar& _x2) const { return Scalar(1.) / _x2; }
         /*! \brief Defines the Singular first order weighting function \f$ \nabla w(x) = -2 / (x^3) \f$ */
         PONCA_MULTIARCH [[nodiscard]] inline Scalar df(const Scalar& _x) const { return Scalar(-2.) / (_x * _x * _x); }
         /*! \brief Defines the Singular second order weighting function \f$ \nabla^2 w(x) = 6 / (x^4) \f$ */
@@ -240,10 +292,14 @@ namespace Ponca
          * https://www.wolframalpha.com/input?i=e%5E%28-x%5E2%2F%281+-+x%5E2%29%29&assumption=%22ClashPrefs%22+-%3E+%7B%22Math%22%7D
          */
         PONCA_MULTIARCH [[nodiscard]] inline Scalar f(const Scalar& _x) const
+        {
+            return fSquared(_x * _x);
+        }
+        /*! \brief Defines the smooth weighting function from \f$ x^2 \f$: \f$ w(x) = e^{-\frac{x^2}{1 - x^2}} \f$ */
+        PONCA_MULTIARCH [[nodiscard]] inline Scalar fSquared(const Scalar& _x2) const
         {
             PONCA_MULTIARCH_STD_MATH(exp);
-            Scalar v = _x * _x;
-            return exp(-v / (Scalar(1) - v));
+            return exp(-_x2 / (Scalar(1) - _x2));
         }
         /*! \brief Defines the smooth first order weighting function \f$ \nabla w(x) = -\frac{2 x e^{\frac{x^2}{x^2 -
          * 1}}}{(1 - x^2)^2} \f$
@@ -314,9 +370,14 @@ namespace Ponca
          * down to \f$e^{\frac{-x^2}{2}}\f$.
          */
         PONCA_MULTIARCH [[nodiscard]] inline Scalar f(const Scalar& _x) const
+        {
+            return fSquared(_x * _x);
+        }
+        /// \brief Defines the Gaussian weighting function from \f$ x^2 \f$: \f$e^{\frac{-x^2}{2}}\f$.
+        PONCA_MULTIARCH [[nodiscard]] inline Scalar fSquared(const Scalar& _x2) const
         {
             PONCA_MULTIARCH_STD_MATH(exp);
-            return exp((-_x * _x) / Scalar(2));
+            return exp(-_x2 / Scalar(2));
         }
 
         /// \brief Defines the Gaussian weighting function first order derivative \f$-e^{\frac{-x^2}{2\sigma^2}}x\f$.
@@ -0,0 +1,92 @@
+/*
+ This Source Code Form is subject to the terms of the Mozilla Public
+ License, v. 2.0. If a copy of the MPL was not distributed with this
+ file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+#pragma once
+
+#include <Eigen/Core>
+
+#include <cstddef>
+#include <iterator>
+
+namespace Ponca
+{
+
+    /*!
+     *  \brief Input iterator to read the `HashGridRangeQueryBase` object.
+     *
+     *  As this is an input iterator, we don't guarantee anything other than reading the values with it.
+     *  If you need to operate on the values of this iterator with algorithms that relies on forward iterator
+     * functionalities, you should copy the index values in an STL-like container.
+     *
+     *  \note The increment logic resides in `HashGridRangeQueryBase::advance(Iterator& it)`.
+     *  The iterator stores the row of cells being scanned and its remaining entries, so this iterator object can be
+     *  duplicated without causing issues.
+     *
+     *  \see HashGridRangeQueryBase
+     */
+    template <typename Index, typename DataPoint, typename QueryT_>
+    class HashGridRangeIterator
+    {
+    protected:
+        friend QueryT_;
+
+    public:
+        using iterator_category = std::input_iterator_tag;
+        using difference_type   = std::ptrdiff_t;
+        using value_type        = Index;
+        using pointer           = Index*;
+        using reference         = const Index&;
+
+        using Scalar    = typename DataPoint::Scalar;
+        using QueryType = QueryT_;
+        using CellType  = Eigen::Matrix<int, DataPoint::Dim, 1>;
+
+        PONCA_MULTIARCH inline HashGridRangeIterator() = default;
+        PONCA_MULTIARCH inline HashGridRangeIterator(QueryType* query, Index index = -1)
+            : m_query(query), m_index(index), m_start(0), m_end(0)
+        {
+        }
+
+        /// \brief Inequality operand
+        PONCA_MULTIARCH inline bool operator!=(const HashGridRangeIterator& other) const
+        {
+            return m_index != other.m_index;
+        }
+
+        /// \brief Equality operand
+        PONCA_MULTIARCH inline bool operator==(const HashGridRangeIterator& other) const
+        {
+            return m_index == other.m_index;
+        }
+
+        /// \brief Prefix increment
+        /// \see HashGridRangeQueryBase::advance(Iterator& it) for the iteration logic
+        PONCA_MULTIARCH inline HashGridRangeIterator& operator++()
+        {
+            m_query->advance(*this);
+            return *this;
+        }
+
+        /// \brief Postfix increment
+        /// \see HashGridRangeQueryBase::advance(Iterator& it) for the iteration logic
+        PONCA_MULTIARCH inline HashGridRangeIterator operator++(int)
+        {
+            HashGridRangeIterator tmp = *this;
+            m_query->advance(*this);
+            return tmp;
+        }
+
+        /// \brief Dereference operator
+        PONCA_MULTIARCH inline reference operator*() const { return const_cast<reference>(m_index); }
+
+    protected:
+        QueryType* m_query{nullptr};
+        Index m_index{-1};
+        CellType m_cell{CellType::Zero()}; ///< First cell of the row being scanned
+        Index m_start{0};                  ///< Next entry of the row of #m_cell
+        Index m_end{0};                    ///< End of the entries of the row of #m_cell
+    };
+} // namespace Ponca
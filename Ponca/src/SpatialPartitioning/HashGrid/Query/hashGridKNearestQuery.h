@@ -0,0 +1,224 @@
+/*
+ This Source Code Form is subject to the terms of the Mozilla Public
+ License, v. 2.0. If a copy of the MPL was not distributed with this
+ file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+#pragma once
+
+#include "../../query.h"
+#include "../../KdTree/Iterator/kdTreeKNearestIterator.h"
+
+#include <algorithm>
+#include <limits>
+
+namespace Ponca
+{
+    template <typename Traits>
+    class StaticHashGridBase; // Need forward declaration to avoid mutual inclusion
+
+    /*!
+     * \brief Extension of the Query class that allows to read the result of a k-nearest neighbors search on the
+     * HashGrid.
+     *
+     * Output result of a `HashGridBase::kNearestNeighbors` query request.
+     *
+     * The cells are scanned by rings of increasing size around the cell of the query, until the k-th neighbor is
+     * closer than the cells of the next ring. The cells of a ring are read by segments of rows (see
+     * StaticHashGridBase::rowEntries). Less than k neighbors are returned when the grid stores less than k
+     * candidates.
+     *
+     * \see StaticHashGridBase
+     */
+    template <typename Traits, typename QueryType>
+    class HashGridKNearestQueryBase : public QueryType
+    {
+    public:
+        using DataPoint  = typename Traits::DataPoint;
+        using IndexType  = typename Traits::IndexType;
+        using Scalar     = typename DataPoint::Scalar;
+        using VectorType = typename DataPoint::VectorType;
+        using Iterator   = KdTreeKNearestIterator<IndexType, DataPoint, Traits::MAX_KNN_SIZE>;
+        using Self       = HashGridKNearestQueryBase<Traits, QueryType>;
+        using CellType   = Eigen::Matrix<int, DataPoint::Dim, 1>;
+
+        PONCA_MULTIARCH inline HashGridKNearestQueryBase(const StaticHashGridBase<Traits>* grid, IndexType k,
+                                                         typename QueryType::InputType input)
+            : QueryType(k, input), m_grid(grid)
+        {
+        }
+
+        /// \brief Call the k-nearest neighbors query with new input and neighbor number parameters.
+        PONCA_MULTIARCH inline Self& operator()(typename QueryType::InputType input, IndexType k)
+        {
+            return QueryType::template operator()<Self>(input, k);
+        }
+        /// \brief Call the k-nearest neighbors query with new input parameter.
+        PONCA_MULTIARCH inline Self& operator()(typename QueryType::InputType input)
+        {
+            return QueryType::template operator()<Self>(input);
+        }
+
+        /// \brief Returns an iterator to the beginning of the k-nearest neighbors query.
+        PONCA_MULTIARCH inline Iterator begin()
+        {
+            // The queue is not initialized with a sentinel, as the grid may contain less than k candidates
+            QueryType::m_queue.clear();
+            this->search();
+            return Iterator(QueryType::m_queue.begin());
+        }
+
+        /// \brief Returns an iterator to the end of the k-nearest neighbors query.
+        PONCA_MULTIARCH inline Iterator end() { return Iterator(QueryType::m_queue.end()); }
+
+    protected:
+        PONCA_MULTIARCH inline void search()
+        {
+            if (m_grid->pointCount() == 0 || QueryType::m_queue.capacity() == 0)
+                return;
+
+            const auto& points      = m_grid->points();
+            const VectorType& point = QueryType::template getInputPosition<VectorType>(points);
+            const CellType counts   = m_grid->cellCounts();
+            // The query cell is clamped to the cells surrounding the grid
+            const CellType center = m_grid->cellCoordinates(point);
+
+            for (int s = 0;; ++s)
+            {
+                const CellType ringMin = (center - CellType::Constant(s)).cwiseMax(0);
+                const CellType ringMax = (center + CellType::Constant(s)).cwiseMin(counts - CellType::Ones());
+                if ((ringMin.array() <= ringMax.array()).all())
+                    searchRing(point, center, s, ringMin, ringMax);
+
+                // Distance between the query and the cells outside of the ring box, infinite when all the cells have
+                // been scanned
+                Scalar ringDistance = std::numeric_limits<Scalar>::infinity();
+                for (int d = 0; d < DataPoint::Dim; ++d)
+                {
+                    if (center[d] - s > 0)
+                        ringDistance = std::min(ringDistance, point[d] - cellBound(center[d] - s, d));
+                    if (center[d] + s < counts[d] - 1)
+                        ringDistance = std::min(ringDistance, cellBound(center[d] + s + 1, d) - point[d]);
+                }
+                if (ringDistance == std::numeric_limits<Scalar>::infinity())
+                    return;
+                // The next rings are farther than the k-th neighbor
+                if (QueryType::m_queue.full() &&
+                    QueryType::m_queue.bottom().squared_distance <= ringDistance * ringDistance)
+                    return;
+            }
+        }
+
+        /// \brief Push the points of the cells of the ring `_s` (at a Chebyshev distance `_s` of `_center`)
+        ///
+        /// The rows of cells are enumerated along the dimensions `1..Dim-1`: along the first dimension, the whole row
+        /// segment is scanned at once when the row is on a face of the ring, and only its two ends otherwise. Once k
+        /// candidates are found, the cells farther than the k-th one are skipped.
+        PONCA_MULTIARCH inline void searchRing(const VectorType& _point, const CellType& _center, int _s,
+                                               const CellType& _ringMin, const CellType& _ringMax)
+        {
+            CellType cell = _ringMin;
+            do
+            {
+                bool onFace = false;
+                // Squared distance between the query and the slab of cells along the first dimension
+                Scalar rowDistance = 0;
+                for (int d = 1; d < DataPoint::Dim; ++d)
+                {
+                    onFace             = onFace || (cell[d] - _center[d] == _s || _center[d] - cell[d] == _s);
+                    const Scalar delta = axisDistance(_point, cell[d], d);
+                    rowDistance += delta * delta;
+                }
+
+                if (onFace)
+                    searchRow(_point, cell, _ringMax[0], rowDistance);
+                else
+                {
+                    cell[0] = _center[0] - _s;
+                    if (_s > 0 && cell[0] >= _ringMin[0] && cell[0] <= _ringMax[0])
+                        searchRow(_point, cell, cell[0], rowDistance);
+                    cell[0] = _center[0] + _s;
+                    if (_s > 0 && cell[0] >= _ringMin[0] && cell[0] <= _ringMax[0])
+                        searchRow(_point, cell, cell[0], rowDistance);
+                }
+                cell[0] = _ringMin[0];
+            } while (nextCell(cell, _ringMin, _ringMax));
+        }
+
+        /// \brief Lower bound of the cells of coordinate `_c` along the dimension `_d`
+        PONCA_MULTIARCH [[nodiscard]] inline Scalar cellBound(int _c, int _d) const
+        {
+            return m_grid->origin()[_d] + Scalar(_c) * m_grid->cellSize();
+        }
+
+        /// \brief Distance between the query and the cells of coordinate `_c`, along the dimension `_d`
+        PONCA_MULTIARCH [[nodiscard]] inline Scalar axisDistance(const VectorType& _point, int _c, int _d) const
+        {
+            const Scalar lower = cellBound(_c, _d);
+            return std::max({Scalar(0), lower - _point[_d], _point[_d] - lower - m_grid->cellSize()});
+        }
+
+        /// \brief Push the points of the cells `_cell` to `_last` along the first dimension, unless these cells are
+        /// farther than the k-th candidate
+        /// \param _rowDistance Squared distance between the query and the cells, along the dimensions `1..Dim-1`
+        PONCA_MULTIARCH inline void searchRow(const VectorType& _point, const CellType& _cell, int _last,
+                                              Scalar _rowDistance)
+        {
+            const Scalar delta =
+                std::max({Scalar(0), cellBound(_cell[0], 0) - _point[0], _point[0] - cellBound(_last + 1, 0)});
+            if (QueryType::m_queue.full() &&
+                _rowDistance + delta * delta >= QueryType::m_queue.bottom().squared_distance)
+                return;
+
+            const auto& points  = m_grid->points();
+            const auto& indices = m_grid->samples();
+            IndexType start, end;
+            m_grid->rowEntries(_cell, _last, start, end);
+            for (IndexType e = start; e < end; ++e)
+            {
+                const IndexType idx = indices[e];
+                if (QueryType::skipIndexFunctor(idx))
+                    continue;
+                const Scalar d = (points[idx].pos() - _point).squaredNorm();
+                if (!QueryType::m_queue.full() || d < QueryType::m_queue.bottom().squared_distance)
+                    QueryType::m_queue.push({idx, d});
+            }
+        }
+
+        /// \brief Move to the next cell of a box along the dimensions `1..Dim-1`, in lexicographic order
+        /// \return false when all the cells have been visited
+        PONCA_MULTIARCH static inline bool nextCell(CellType& _cell, const CellType& _min, const CellType& _max)
+        {
+            for (int d = 1; d < DataPoint::Dim; ++d)
+            {
+                if (++_cell[d] <= _max[d])
+                    return true;
+                _cell[d] = _min[d];
+            }
+            return false;
+        }
+
+    protected:
+        const StaticHashGridBase<Traits>* m_grid{nullptr};
+    };
+
+    /*!
+     * \copybrief HashGridKNearestQueryBase
+     *
+     * Output result of a `HashGridBase::kNearestNeighbors` query made with the **index** of the point to evaluate.
+     * \see KNearestIndexQuery
+     */
+    template <typename Traits>
+    using HashGridKNearestIndexQuery =
+        HashGridKNearestQueryBase<Traits, KNearestIndexQuery<typename Traits::IndexType,
+                                                             typename Traits::DataPoint::Scalar, Traits::MAX_KNN_SIZE>>;
+    /*!
+     * \copybrief HashGridKNearestQueryBase
+     *
+     * Output result of a `HashGridBase::kNearestNeighbors` query made with the **position** of the point to evaluate.
+     * \see KNearestPointQuery
+     */
+    template <typename Traits>
+    using HashGridKNearestPointQuery = HashGridKNearestQueryBase<
+        Traits, KNearestPointQuery<typename Traits::IndexType, typename Traits::DataPoint, Traits::MAX_KNN_SIZE>>;
+} // namespace Ponca
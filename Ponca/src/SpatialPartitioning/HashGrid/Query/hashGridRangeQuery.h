@@ -0,0 +1,161 @@
+/*
+ This Source Code Form is subject to the terms of the Mozilla Public
+ License, v. 2.0. If a copy of the MPL was not distributed with this
+ file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+#pragma once
+
+#include "../../query.h"
+#include "../Iterator/hashGridRangeIterator.h"
+
+namespace Ponca
+{
+    template <typename Traits>
+    class StaticHashGridBase; // Need forward declaration to avoid mutual inclusion
+
+    /*!
+     * \brief Extension of the Query class that allows to read the result of a range neighbors search on the HashGrid.
+     *
+     * Output result of a `HashGridBase::rangeNeighbors` query request.
+     *
+     * The rows of cells overlapping the bounding box of the query ball are scanned one after the other: the points of
+     * the cells of a row are contiguous (see StaticHashGridBase::rowEntries), and are tested from their distance.
+     *
+     * \see StaticHashGridBase
+     */
+    template <typename Traits, typename QueryType>
+    class HashGridRangeQueryBase : public QueryType
+    {
+    public:
+        using DataPoint  = typename Traits::DataPoint;
+        using IndexType  = typename Traits::IndexType;
+        using Scalar     = typename DataPoint::Scalar;
+        using VectorType = typename DataPoint::VectorType;
+        using Self       = HashGridRangeQueryBase<Traits, QueryType>;
+        using Iterator   = HashGridRangeIterator<IndexType, DataPoint, Self>;
+        using CellType   = typename Iterator::CellType;
+
+    protected:
+        friend Iterator;
+
+    public:
+        PONCA_MULTIARCH inline HashGridRangeQueryBase(const StaticHashGridBase<Traits>* grid, Scalar radius,
+                                                      typename QueryType::InputType input)
+            : QueryType(radius, input), m_grid(grid)
+        {
+        }
+
+        /// \brief Call the range neighbors query with new input and radius parameters.
+        PONCA_MULTIARCH inline Self& operator()(typename QueryType::InputType input, Scalar radius)
+        {
+            return QueryType::template operator()<Self>(input, radius);
+        }
+
+        /// \brief Call the range neighbors query with new input parameter.
+        PONCA_MULTIARCH inline Self& operator()(typename QueryType::InputType input)
+        {
+            return QueryType::template operator()<Self>(input);
+        }
+
+        /// \brief Returns an iterator to the beginning of the Range Query.
+        PONCA_MULTIARCH inline Iterator begin()
+        {
+            PONCA_MULTIARCH_STD_MATH(sqrt);
+            QueryType::reset();
+            Iterator it(this);
+            if (m_grid->pointCount() == 0)
+                return end();
+
+            // Margin protecting the cell bounds against rounding errors
+            const VectorType& point = QueryType::template getInputPosition<VectorType>(m_grid->points());
+            const Scalar radius =
+                sqrt(QueryType::squaredRadius()) * (Scalar(1) + Scalar(16) * Eigen::NumTraits<Scalar>::epsilon());
+            m_cellMin = m_grid->cellCoordinates(point - VectorType::Constant(radius)).cwiseMax(0);
+            m_cellMax = m_grid->cellCoordinates(point + VectorType::Constant(radius)).cwiseMin(m_grid->cellCounts() -
+                                                                                               CellType::Ones());
+            if ((m_cellMin.array() > m_cellMax.array()).any())
+                return end();
+
+            it.m_cell = m_cellMin;
+            enterRow(it);
+            this->advance(it);
+            return it;
+        }
+
+        /// \brief Returns an iterator to the end of the Range Query.
+        PONCA_MULTIARCH inline Iterator end() { return Iterator(this, m_grid->pointCount()); }
+
+    protected:
+        /// \brief Set the iterator to the first entry of the cells of the query box, in its current row
+        PONCA_MULTIARCH inline void enterRow(Iterator& it) const
+        {
+            m_grid->rowEntries(it.m_cell, m_cellMax[0], it.m_start, it.m_end);
+        }
+
+        /// \brief Move the iterator to the next row of the query box, in lexicographic order
+        /// \return false when all the rows have been scanned
+        PONCA_MULTIARCH inline bool nextRow(Iterator& it) const
+        {
+            for (int d = 1; d < DataPoint::Dim; ++d)
+            {
+                if (++it.m_cell[d] <= m_cellMax[d])
+                    return true;
+                it.m_cell[d] = m_cellMin[d];
+            }
+            return false;
+        }
+
+        PONCA_MULTIARCH inline void advance(Iterator& it)
+        {
+            const auto& points      = m_grid->points();
+            const auto& indices     = m_grid->samples();
+            const VectorType& point = QueryType::template getInputPosition<VectorType>(points);
+
+            do
+            {
+                for (; it.m_start < it.m_end; ++it.m_start)
+                {
+                    const IndexType idx = indices[it.m_start];
+                    if (QueryType::skipIndexFunctor(idx))
+                        continue;
+                    const VectorType& pos = points[idx].pos();
+                    if ((pos - point).squaredNorm() < QueryType::descentDistanceThreshold())
+                    {
+                        it.m_index = idx;
+                        ++it.m_start;
+                        return;
+                    }
+                }
+                if (!nextRow(it))
+                    break;
+                enterRow(it);
+            } while (true);
+            it = end();
+        }
+
+    protected:
+        const StaticHashGridBase<Traits>* m_grid{nullptr};
+        CellType m_cellMin{CellType::Zero()}; ///< First cell of the query box, clamped to the grid
+        CellType m_cellMax{CellType::Zero()}; ///< Last cell of the query box, clamped to the grid
+    };
+
+    /*!
+     * \copybrief HashGridRangeQueryBase
+     *
+     * Output result of a `HashGridBase::rangeNeighbors` query made with the **index** of the point to evaluate.
+     * \see RangeIndexQuery
+     */
+    template <typename Traits>
+    using HashGridRangeIndexQuery =
+        HashGridRangeQueryBase<Traits, RangeIndexQuery<typename Traits::IndexType, typename Traits::DataPoint::Scalar>>;
+    /*!
+     * \copybrief HashGridRangeQueryBase
+     *
+     * Output result of a `HashGridBase::rangeNeighbors` query made with the **position** of the point to evaluate.
+     * \see RangePointQuery
+     */
+    template <typename Traits>
+    using HashGridRangePointQuery =
+        HashGridRangeQueryBase<Traits, RangePointQuery<typename Traits::IndexType, typename Traits::DataPoint>>;
+} // namespace Ponca
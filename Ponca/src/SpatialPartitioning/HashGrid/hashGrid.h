@@ -0,0 +1,577 @@
+/*
+ This Source Code Form is subject to the terms of the Mozilla Public
+ License, v. 2.0. If a copy of the MPL was not distributed with this
+ file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+#pragma once
+
+#include "./hashGridTraits.h"
+
+#include "Query/hashGridKNearestQuery.h"
+#include "Query/hashGridRangeQuery.h"
+
+#include "../../Common/Assert.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <numeric>
+#include <utility>
+#include <vector>
+
+namespace Ponca
+{
+
+    template <typename Traits>
+    class HashGridBase;
+
+    /*!
+     * \brief Public interface for HashGrid datastructure.
+     *
+     * Provides default implementation of the HashGrid
+     *
+     * \see HashGridDefaultTraits for the default trait interface documentation.
+     * \see HashGridBase for complete API
+     */
+    template <typename DataPoint>
+    using HashGrid = HashGridBase<HashGridDefaultTraits<DataPoint>>;
+
+    /*!
+     * \brief Uniform grid spatial index, with cells stored in a hash table
+     *
+     * The bounding box of the points is split in cubic cells of size #cellSize, identified by their linear key (see
+     * #cellKey). Only the non-empty cells are materialized: each row of cells (the cells sharing their coordinates
+     * along the dimensions `1..Dim-1`) is hashed to one of the #bucketCount buckets, and the points of a bucket are
+     * stored contiguously in #samples, between `bucketOffsets()[b]` and `bucketOffsets()[b + 1]`, sorted by cell key.
+     * The key of each entry is stored in #cellKeys, so that the points of a segment of row are found by a binary
+     * search on contiguous keys. The memory footprint is thus linear in the number of points, whatever the extent of
+     * the grid.
+     *
+     * The range queries scan the rows of cells overlapping the query ball, and the k-nearest neighbors queries scan
+     * rings of cells around the query until the k-th neighbor is found. When the cell size matches the query radius, a
+     * range query only looks up \f$3^{Dim-1}\f$ rows, without the tree descent of the KdTree: the HashGrid is suited
+     * to fixed-radius workloads, on point clouds with a roughly uniform density.
+     *
+     * The queries follow the Query/Iterator interface of the other datastructures, so that the fits can be computed
+     * with `fit.computeWithIds(grid.rangeNeighbors(p, r), grid.points())`.
+     *
+     * \warning The query time grows with the number of points per cell: the cell size must be adapted to the density
+     * of the points and to the query radius.
+     *
+     * \see HashGridDefaultTraits for the trait interface documentation.
+     */
+    template <typename Traits>
+    class StaticHashGridBase
+    {
+    public:
+#define WRITE_TRAITS                                                                                                   \
+    using DataPoint      = typename Traits::DataPoint;      /*!< DataPoint given by user via Traits                */  \
+    using Scalar         = typename DataPoint::Scalar;      /*!< Scalar given by user via DataPoint                */  \
+    using VectorType     = typename DataPoint::VectorType;  /*!< VectorType given by user via DataPoint            */  \
+    using IndexType      = typename Traits::IndexType;      /*!< Type used to index points into the PointContainer */  \
+    using KeyType        = typename Traits::KeyType;        /*!< Type of the linear keys of the cells              */  \
+    using PointContainer = typename Traits::PointContainer; /*!< Container for DataPoint used inside the grid      */  \
+    using IndexContainer = typename Traits::IndexContainer; /*!< Container for indices used inside the grid        */  \
+    using KeyContainer   = typename Traits::KeyContainer;   /*!< Container for cell keys used inside the grid      */  \
+    using CellType       = Eigen::Matrix<int, DataPoint::Dim, 1>; /*!< Integer coordinates of a cell               */
+        WRITE_TRAITS
+
+        using KNearestIndexQuery = HashGridKNearestIndexQuery<Traits>;
+        using KNearestPointQuery = HashGridKNearestPointQuery<Traits>;
+        using RangeIndexQuery    = HashGridRangeIndexQuery<Traits>;
+        using RangePointQuery    = HashGridRangePointQuery<Traits>;
+
+        /// \brief Number of bits of the index of a row in its tile (see #bucketIndex)
+        static constexpr int TileBits = DataPoint::Dim > 1 ? 4 : 0;
+
+        /// \brief Internal structure storing all the buffers used by the HashGrid
+        struct Buffers
+        {
+            PointContainer points;  ///< Buffer storing the input points (read only)
+            IndexContainer indices; ///< Buffer storing the indices of the points, sorted by bucket and by cell key
+            KeyContainer keys;      ///< Buffer storing the cell key of each entry of `indices`
+            IndexContainer offsets; ///< Buffer storing the first entry of each bucket in `indices`, plus the end
+
+            size_t points_size{0};
+            size_t indices_size{0};
+            size_t offsets_size{0};
+            VectorType origin{VectorType::Zero()}; ///< Lower corner of the first cell
+            Scalar cellSize{1};                    ///< Size of the cells
+            CellType cellCounts{CellType::Zero()}; ///< Number of cells along each axis
+
+            PONCA_MULTIARCH inline Buffers() = default;
+
+            PONCA_MULTIARCH inline Buffers(PointContainer _points, IndexContainer _indices, KeyContainer _keys,
+                                           IndexContainer _offsets, const size_t _points_size,
+                                           const size_t _indices_size, const size_t _offsets_size,
+                                           const VectorType& _origin, const Scalar _cellSize,
+                                           const CellType& _cellCounts)
+                : points(_points), indices(_indices), keys(_keys), offsets(_offsets), points_size(_points_size),
+                  indices_size(_indices_size), offsets_size(_offsets_size), origin(_origin), cellSize(_cellSize),
+                  cellCounts(_cellCounts)
+            {
+            }
+        };
+
+    protected:
+        PONCA_MULTIARCH inline StaticHashGridBase() = default;
+
+    public:
+        /*! \brief Constructor that allows the use of prebuilt HashGrid containers.
+         *
+         * Each internal values of a HashGrid can be extracted using \ref `HashGrid::buffers()`
+         *
+         * \note This constructor can be used to avoid the building process, which is useful to transfer directly the
+         * HashGrid to the device in CUDA.
+         *
+         * \param _bufs Internal buffers of the HashGrid
+         */
+        PONCA_MULTIARCH inline StaticHashGridBase(Buffers& _bufs) : m_bufs(_bufs) {}
+
+        // Query -------------------------------------------------------------------
+    public:
+        /// \brief Computes a Query object to iterate over the k-nearest neighbors of a point.
+        ///
+        /// The returned object can be reset and reused with the () operator, to compute a new result
+        /// (also takes a position and a number of neighbors as parameters).
+        ///
+        /// \param point Position from where the query is evaluated
+        /// \param k Number of requested neighbors
+        /// \return The \ref KNearestPointQuery mutable object to iterate over the search results.
+        PONCA_MULTIARCH [[nodiscard]] inline KNearestPointQuery kNearestNeighbors(const VectorType& point,
+                                                                                  IndexType k) const
+        {
+            return KNearestPointQuery(this, k, point);
+        }
+
+        /// \copybrief StaticHashGridBase::kNearestNeighbors
+        /// \param index Index of the point from where the query is evaluated
+        /// \param k Number of requested neighbors
+        /// \return The \ref KNearestIndexQuery mutable object to iterate over the search results.
+        PONCA_MULTIARCH [[nodiscard]] inline KNearestIndexQuery kNearestNeighbors(IndexType index, IndexType k) const
+        {
+            return KNearestIndexQuery(this, k, index);
+        }
+
+        /// \brief Convenience function that provides an empty k-nearest neighbors Query object.
+        ///
+        /// The returned object can be called with the arguments `(p, k)` to fetch the k-nearest neighbors of the
+        /// position `p`.
+        ///
+        /// Same as `HashGridBase::kNearestNeighbors (VectorType::Zero(), 0)`.
+        ///
+        /// \return The empty \ref KNearestPointQuery mutable object
+        PONCA_MULTIARCH [[nodiscard]] inline KNearestPointQuery kNearestNeighborsQuery() const
+        {
+            return KNearestPointQuery(this, 0, VectorType::Zero());
+        }
+
+        /// \copybrief StaticHashGridBase::kNearestNeighborsQuery
+        ///
+        /// The returned object can be called with the arguments `(i, k)` to fetch the k-nearest neighbors of the point
+        /// of index `i`.
+        ///
+        /// Same as `HashGridBase::kNearestNeighbors (0, 0)`.
+        ///
+        /// \return The empty \ref KNearestIndexQuery mutable object
+        PONCA_MULTIARCH [[nodiscard]] inline KNearestIndexQuery kNearestNeighborsIndexQuery() const
+        {
+            return KNearestIndexQuery(this, 0, 0);
+        }
+
+        /// \brief Computes a Query object to iterate over the neighbors that are inside a given radius.
+        ///
+        /// The returned object can be reset and reused with the () operator, to compute a new result
+        /// (also takes a position and a radius as parameters).
+        ///
+        /// \param point Position from where the query is evaluated
+        /// \param r Radius around where to search the neighbors
+        /// \return The \ref RangePointQuery mutable object to iterate over the search results.
+        PONCA_MULTIARCH [[nodiscard]] inline RangePointQuery rangeNeighbors(const VectorType& point, Scalar r) const
+        {
+            return RangePointQuery(this, r, point);
+        }
+
+        /// \copybrief StaticHashGridBase::rangeNeighbors
+        /// \param index Index of the point from where the query is evaluated
+        /// \param r Radius around where to search the neighbors
+        /// \return The \ref RangeIndexQuery mutable object to iterate over the search results.
+        PONCA_MULTIARCH [[nodiscard]] inline RangeIndexQuery rangeNeighbors(IndexType index, Scalar r) const
+        {
+            return RangeIndexQuery(this, r, index);
+        }
+
+        /// \brief Convenience function that provides an empty range neighbors Query object.
+        ///
+        /// The returned object can be called with the arguments `(p, r)` to fetch the neighbors
+        /// that are in range `r` of the position `p`.
+        ///
+        /// Same as `HashGridBase::rangeNeighbors (VectorType::Zero(), 0)`.
+        ///
+        /// \return The empty \ref RangePointQuery mutable object
+        PONCA_MULTIARCH [[nodiscard]] inline RangePointQuery rangeNeighborsQuery() const
+        {
+            return RangePointQuery(this, 0, VectorType::Zero());
+        }
+
+        /// \copybrief StaticHashGridBase::rangeNeighborsQuery
+        ///
+        /// The returned object can be called with the arguments `(i, r)` to fetch the neighbors
+        /// that are in range `r` of the point of index `i`.
+        ///
+        /// Same as `HashGridBase::rangeNeighbors (0, 0)`.
+        ///
+        /// \return The empty \ref RangeIndexQuery mutable object
+        PONCA_MULTIARCH [[nodiscard]] inline RangeIndexQuery rangeNeighborsIndexQuery() const
+        {
+            return RangeIndexQuery(this, 0, 0);
+        }
+
+        // Accessors ---------------------------------------------------------------
+    public:
+        /// \brief Size of the cells
+        ///
+        /// The size given at construction is enlarged when the keys of the cells would not be representable by
+        /// #KeyType, which only happens for tiny cells compared to the extent of the points.
+        PONCA_MULTIARCH [[nodiscard]] inline Scalar cellSize() const { return m_bufs.cellSize; }
+        /// \brief Lower corner of the first cell
+        PONCA_MULTIARCH [[nodiscard]] inline const VectorType& origin() const { return m_bufs.origin; }
+        /// \brief Number of cells along each axis
+        PONCA_MULTIARCH [[nodiscard]] inline const CellType& cellCounts() const { return m_bufs.cellCounts; }
+        /// \brief Number of buckets of the hash table
+        PONCA_MULTIARCH [[nodiscard]] inline IndexType bucketCount() const
+        {
+            return m_bufs.offsets_size > 0 ? IndexType(m_bufs.offsets_size - 1) : IndexType(0);
+        }
+
+        /// \brief Integer coordinates of the cell containing a position
+        ///
+        /// The coordinates are clamped to `[-1, cellCounts()]`, so that the positions outside of the grid are mapped
+        /// to the layer of cells surrounding it.
+        PONCA_MULTIARCH [[nodiscard]] inline CellType cellCoordinates(const VectorType& _p) const
+        {
+            const Scalar invCellSize = Scalar(1) / m_bufs.cellSize;
+            CellType cell;
+            for (int d = 0; d < DataPoint::Dim; ++d)
+            {
+                // The negative coordinates are clamped: the truncation gives the floor of the others, without the
+                // cost of a call to `floor`. Written to also map NaN to the first cell.
+                const Scalar c = (_p[d] - m_bufs.origin[d]) * invCellSize;
+                cell[d] = c >= Scalar(0) ? (c < Scalar(m_bufs.cellCounts[d]) ? int(c) : m_bufs.cellCounts[d])
+                                         : (c < Scalar(0) ? -1 : 0);
+            }
+            return cell;
+        }
+
+        /// \brief Linear key of a cell of the grid, the last coordinate being the most significant
+        ///
+        /// The keys follow the lexicographic order of the cells, and the cells of a row have consecutive keys.
+        PONCA_MULTIARCH [[nodiscard]] inline KeyType cellKey(const CellType& _cell) const
+        {
+            KeyType key = 0;
+            for (int d = DataPoint::Dim - 1; d >= 0; --d)
+                key = key * KeyType(m_bufs.cellCounts[d]) + KeyType(_cell[d]);
+            return key;
+        }
+
+        /// \brief Bucket storing the points of the row of cells containing `_cell`
+        ///
+        /// Only the coordinates along the dimensions `1..Dim-1` are used, so that the cells of a row share their
+        /// bucket. The rows are grouped in tiles of \f$2^{TileBits}\f$ rows: the tiles are hashed, and the rows of a
+        /// tile are stored in consecutive buckets, so that the neighboring rows scanned by a query are close in memory.
+        PONCA_MULTIARCH [[nodiscard]] inline IndexType bucketIndex(const CellType& _cell) const
+        {
+            constexpr int axisBits = DataPoint::Dim > 1 ? TileBits / (DataPoint::Dim - 1) : 0;
+            std::uint64_t h = 0, row = 0;
+            for (int d = 1; d < DataPoint::Dim; ++d)
+            {
+                h   = (h ^ std::uint64_t(std::uint32_t(_cell[d]) >> axisBits)) * std::uint64_t(0x9E3779B97F4A7C15ull);
+                row = (row << axisBits) | (std::uint64_t(_cell[d]) & ((std::uint64_t(1) << axisBits) - 1));
+            }
+            h ^= h >> 32;
+            // The bucket count is a power of two
+            return IndexType(((h << (axisBits * (DataPoint::Dim - 1))) | row) & std::uint64_t(bucketCount() - 1));
+        }
+
+        /// \brief Range `[_start, _end)` of the entries of #samples storing the points of the cells `_cell` to
+        /// `_last`, along the first dimension
+        ///
+        /// The entries of a bucket are sorted by cell key, and the cells of the segment have consecutive keys: the
+        /// range is the whole bucket when it only stores the segment, and is found by binary search on #cellKeys
+        /// otherwise. The queries can thus test the points of the range from their distance only.
+        ///
+        /// \warning The cells of the segment must be inside the grid, and `_last` must not be lower than `_cell[0]`.
+        PONCA_MULTIARCH inline void rowEntries(const CellType& _cell, int _last, IndexType& _start,
+                                               IndexType& _end) const
+        {
+            const IndexType bucket = bucketIndex(_cell);
+            _start                 = m_bufs.offsets[bucket];
+            _end                   = m_bufs.offsets[bucket + 1];
+            if (_start == _end)
+                return;
+            const auto& keys    = m_bufs.keys;
+            const KeyType first = cellKey(_cell);
+            const KeyType last  = first + KeyType(_last - _cell[0]);
+            if (keys[_start] > last || keys[_end - 1] < first)
+            {
+                _end = _start;
+                return;
+            }
+
+            // First entry whose key is not lower than `first`, then first entry whose key is greater than `last`. The
+            // binary searches are written without branches, which are hardly predictable here
+            if (keys[_start] < first)
+            {
+                IndexType base = _start;
+                for (IndexType n = _end - _start; n > 1; n -= n / 2)
+                    base = keys[base + n / 2] < first ? base + n / 2 : base;
+                _start = base + 1;
+            }
+            if (keys[_end - 1] > last)
+            {
+                IndexType base = _start;
+                for (IndexType n = _end - _start; n > 1; n -= n / 2)
+                    base = keys[base + n / 2] <= last ? base + n / 2 : base;
+                _end = keys[base] <= last ? base + 1 : base;
+            }
+        }
+
+        /// \brief Range `[_start, _end)` of the entries of #samples storing the points of a cell
+        ///
+        /// The range is empty for the cells outside of the grid.
+        /// \see rowEntries
+        PONCA_MULTIARCH inline void cellEntries(const CellType& _cell, IndexType& _start, IndexType& _end) const
+        {
+            if ((_cell.array() < 0).any() || (_cell.array() >= m_bufs.cellCounts.array()).any())
+            {
+                _start = _end = 0;
+                return;
+            }
+            rowEntries(_cell, _cell[0], _start, _end);
+        }
+
+        //! \brief Get the number of indexed points
+        PONCA_MULTIARCH [[nodiscard]] inline IndexType sampleCount() const { return (IndexType)m_bufs.indices_size; }
+        //! \brief Get the number of points
+        PONCA_MULTIARCH [[nodiscard]] inline IndexType pointCount() const { return (IndexType)m_bufs.points_size; }
+        //! \brief Get the internal point container
+        PONCA_MULTIARCH [[nodiscard]] inline const PointContainer& points() const { return m_bufs.points; };
+        //! \brief Get the indices of the points, sorted by bucket and by cell key
+        PONCA_MULTIARCH [[nodiscard]] inline const IndexContainer& samples() const { return m_bufs.indices; };
+        //! \brief Get the cell key of each entry of #samples
+        PONCA_MULTIARCH [[nodiscard]] inline const KeyContainer& cellKeys() const { return m_bufs.keys; };
+        //! \brief Get the first entry of each bucket in #samples, followed by the number of samples
+        PONCA_MULTIARCH [[nodiscard]] inline const IndexContainer& bucketOffsets() const { return m_bufs.offsets; };
+        //! \brief Get access to the internal buffer, for instance to prepare GPU binding
+        PONCA_MULTIARCH [[nodiscard]] inline const Buffers& buffers() const { return m_bufs; }
+
+        // Data --------------------------------------------------------------------
+    protected:
+        Buffers m_bufs; ///< Buffers used to store the HashGrid
+    };
+
+    /*!
+     * \brief Customizable base class for HashGrid datastructure
+     *
+     * \see Ponca::HashGrid
+     *
+     * \tparam Traits Traits type providing the types and constants used by the HashGrid. Must have the
+     * same interface as the default traits type.
+     *
+     * \see HashGridDefaultTraits for the trait interface documentation.
+     */
+    template <typename Traits>
+    class HashGridBase : public StaticHashGridBase<Traits>
+    {
+    public:
+        WRITE_TRAITS
+    private:
+        using Base = StaticHashGridBase<Traits>;
+
+    public:
+        /// \brief Build a HashGrid from a set of points
+        ///
+        /// The points are sorted by bucket with a radix sort, run in parallel when OpenMP is enabled.
+        ///
+        /// \param _points Input points
+        /// \param _cellSize Size of the cells, typically the radius of the range queries
+        ///
+        /// \warning Stores a copy of the points
+        PONCA_MULTIARCH_HOST inline HashGridBase(PointContainer _points, const Scalar _cellSize)
+        {
+            PONCA_ASSERT(_cellSize > Scalar(0));
+            const int size = int(_points.size());
+
+            Base::m_bufs.points      = std::move(_points);
+            Base::m_bufs.points_size = size;
+            Base::m_bufs.cellSize    = _cellSize;
+
+            // Bounding box of the points
+            const auto& points = Base::m_bufs.points;
+            VectorType aabbMin = VectorType::Zero(), aabbMax = VectorType::Zero();
+            if (size > 0)
+            {
+                aabbMin = aabbMax = points[0].pos();
+                for (int i = 1; i < size; ++i)
+                {
+                    aabbMin = aabbMin.cwiseMin(points[i].pos());
+                    aabbMax = aabbMax.cwiseMax(points[i].pos());
+                }
+            }
+            // The cells are enlarged until their coordinates and their keys are representable
+            const Scalar maxCount = Scalar(1 << 30), maxKeys = std::ldexp(Scalar(1), 62);
+            for (;;)
+            {
+                Scalar nbCells = Scalar(1);
+                bool fits      = true;
+                for (int d = 0; d < DataPoint::Dim; ++d)
+                {
+                    const Scalar count = std::floor((aabbMax[d] - aabbMin[d]) / Base::m_bufs.cellSize) + Scalar(1);
+                    fits               = fits && !(count > maxCount);
+                    nbCells *= count;
+                }
+                if (fits && !(nbCells > maxKeys))
+                    break;
+                Base::m_bufs.cellSize *= Scalar(2);
+            }
+            Base::m_bufs.origin = aabbMin;
+            for (int d = 0; d < DataPoint::Dim; ++d)
+                Base::m_bufs.cellCounts[d] =
+                    int(std::floor((aabbMax[d] - aabbMin[d]) / Base::m_bufs.cellSize) + Scalar(1));
+
+            buildBuckets();
+        }
+
+        /*! \brief Permute the stored points so that their memory layout follows the cells of the grid
+         *
+         * The points are stored in the order of #samples, i.e. by bucket and by cell: the points of a row of cells end
+         * up contiguous in memory, so that the queries read their candidates sequentially, and consecutive indices are
+         * spatially close, so that consecutive queries reuse the cached points.
+         *
+         * \warning Indices computed before this call are invalidated: use the returned permutation to convert
+         * them, or to reorder user-side attributes.
+         *
+         * \return The permutation `perm` such that `points()[i]` was stored at position `perm[i]` before the call
+         */
+        PONCA_MULTIARCH_HOST inline IndexContainer reorderPoints()
+        {
+            auto& bufs               = Base::m_bufs;
+            const IndexType nbPoints = Base::pointCount();
+
+            // The buckets and the cell keys are unchanged, and the samples become the identity
+            IndexContainer permutation = bufs.indices;
+            PointContainer points;
+            points.reserve(nbPoints);
+            for (IndexType i = 0; i < nbPoints; ++i)
+                points.push_back(bufs.points[permutation[i]]);
+            bufs.points = std::move(points);
+            std::iota(std::begin(bufs.indices), std::end(bufs.indices), IndexType(0));
+            return permutation;
+        }
+
+    private:
+        /// \brief Cell of the grid containing a point, robust to the rounding errors on the upper bound of the grid
+        PONCA_MULTIARCH_HOST [[nodiscard]] inline CellType gridCell(const VectorType& _p) const
+        {
+            return Base::cellCoordinates(_p).cwiseMax(0).cwiseMin(Base::m_bufs.cellCounts - CellType::Ones());
+        }
+
+        /// \brief Sort the points by bucket and by cell key, filling the `indices`, `keys` and `offsets` buffers
+        ///
+        /// The points are sorted by bucket with a stable radix sort, whose passes run in parallel when OpenMP is
+        /// enabled: each chunk of points counts its digits in its own histogram, so that the chunks are scattered
+        /// without synchronization, in the same order whatever the number of threads. The entries of each bucket are
+        /// then sorted by cell key and by index.
+        PONCA_MULTIARCH_HOST inline void buildBuckets()
+        {
+            auto& bufs           = Base::m_bufs;
+            const IndexType size = Base::pointCount();
+
+            // Power of two number of buckets, at least as large as the number of points
+            IndexType bucketCount = 1;
+            int bucketBits        = 0;
+            for (; bucketCount < size; ++bucketBits)
+                bucketCount *= 2;
+            bufs.offsets.assign(bucketCount + 1, 0);
+            bufs.offsets_size = bucketCount + 1;
+
+            std::vector<KeyType> keys(size);
+            std::vector<IndexType> buckets(size);
+#pragma omp parallel for
+            for (IndexType i = 0; i < size; ++i)
+            {
+                const CellType cell = gridCell(bufs.points[i].pos());
+                keys[i]             = Base::cellKey(cell);
+                buckets[i]          = Base::bucketIndex(cell);
+            }
+
+            // Radix sort of the points by bucket, by digits of RadixBits bits
+            constexpr int RadixBits   = 11;
+            constexpr IndexType Radix = IndexType(1) << RadixBits;
+            const IndexType nbChunks  = std::clamp(size / IndexType(1 << 14), IndexType(1), IndexType(64));
+            const IndexType chunkSize = (size + nbChunks - 1) / nbChunks;
+            std::vector<IndexType> histograms(size_t(nbChunks) * Radix);
+            IndexContainer indices(size), sorted(size);
+            std::iota(std::begin(indices), std::end(indices), IndexType(0));
+            for (int shift = 0; shift < bucketBits; shift += RadixBits)
+            {
+                std::fill(histograms.begin(), histograms.end(), IndexType(0));
+#pragma omp parallel for
+                for (IndexType c = 0; c < nbChunks; ++c)
+                {
+                    IndexType* histogram = histograms.data() + size_t(c) * Radix;
+                    for (IndexType i = c * chunkSize; i < std::min(size, (c + 1) * chunkSize); ++i)
+                        ++histogram[(buckets[indices[i]] >> shift) & (Radix - 1)];
+                }
+                // Exclusive prefix sum by digit, then by chunk: each chunk gets its own range of slots per digit
+                IndexType sum = 0;
+                for (IndexType digit = 0; digit < Radix; ++digit)
+                    for (IndexType c = 0; c < nbChunks; ++c)
+                    {
+                        IndexType& slot   = histograms[size_t(c) * Radix + digit];
+                        const IndexType n = slot;
+                        slot              = sum;
+                        sum += n;
+                    }
+#pragma omp parallel for
+                for (IndexType c = 0; c < nbChunks; ++c)
+                {
+                    IndexType* slots = histograms.data() + size_t(c) * Radix;
+                    for (IndexType i = c * chunkSize; i < std::min(size, (c + 1) * chunkSize); ++i)
+                        sorted[slots[(buckets[indices[i]] >> shift) & (Radix - 1)]++] = indices[i];
+                }
+                std::swap(indices, sorted);
+            }
+
+            // First entry of each bucket, from the bucket changes between consecutive entries
+            auto& offsets = bufs.offsets;
+#pragma omp parallel for
+            for (IndexType e = 0; e <= size; ++e)
+            {
+                const IndexType previous = e == 0 ? IndexType(-1) : buckets[indices[e - 1]];
+                const IndexType current  = e == size ? bucketCount : buckets[indices[e]];
+                for (IndexType b = previous + 1; b <= current; ++b)
+                    offsets[b] = e;
+            }
+
+#pragma omp parallel for schedule(dynamic, 1024)
+            for (IndexType b = 0; b < bucketCount; ++b)
+                std::sort(indices.begin() + offsets[b], indices.begin() + offsets[b + 1],
+                          [&keys](IndexType _a, IndexType _b) {
+                              return keys[_a] < keys[_b] || (keys[_a] == keys[_b] && _a < _b);
+                          });
+
+            bufs.keys.resize(size);
+#pragma omp parallel for
+            for (IndexType e = 0; e < size; ++e)
+                bufs.keys[e] = keys[indices[e]];
+            bufs.indices      = std::move(indices);
+            bufs.indices_size = size;
+        }
+    };
+
+} // namespace Ponca
+
+#undef WRITE_TRAITS
@@ -0,0 +1,68 @@
+/*
+ This Source Code Form is subject to the terms of the Mozilla Public
+ License, v. 2.0. If a copy of the MPL was not distributed with this
+ file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+#pragma once
+
+#include "../defines.h"
+
+#include <Eigen/Core>
+
+#include <cstdint>
+#include <vector>
+
+namespace Ponca
+{
+    /*!
+     * \brief The default traits type used by the HashGrid.
+     */
+    template <typename _DataPoint>
+    struct HashGridDefaultTraits
+    {
+        enum
+        {
+            MAX_KNN_SIZE = 128 //!< The maximum size of a knn query
+        };
+        /*!
+         * \brief The type used to store point data.
+         *
+         * Must provide `Scalar` and `VectorType` aliases, a `Dim` constant and a `pos()` function.
+         */
+        using DataPoint = _DataPoint;
+
+        // Containers
+        using IndexType      = int;
+        using KeyType        = std::uint64_t; //!< Type of the linear keys of the cells
+        using PointContainer = std::vector<DataPoint>;
+        using IndexContainer = std::vector<IndexType>;
+        using KeyContainer   = std::vector<KeyType>;
+    };
+
+    /*!
+     * \brief Variant to the HashGrid Traits type that uses pointers as internal storage instead of an STL-like
+     * container.
+     */
+    template <typename _DataPoint>
+    struct HashGridPointerTraits
+    {
+        enum
+        {
+            MAX_KNN_SIZE = 128 //!< The maximum size of a knn query
+        };
+        /*!
+         * \brief The type used to store point data.
+         *
+         * Must provide `Scalar` and `VectorType` aliases, a `Dim` constant and a `pos()` function.
+         */
+        using DataPoint = _DataPoint;
+
+        // Containers
+        using IndexType      = int;
+        using KeyType        = std::uint64_t; //!< Type of the linear keys of the cells
+        using PointContainer = DataPoint*;
+        using IndexContainer = IndexType*;
+        using KeyContainer   = KeyType*;
+    };
+} // namespace Ponca
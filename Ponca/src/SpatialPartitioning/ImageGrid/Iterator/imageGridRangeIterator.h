@@ -0,0 +1,85 @@
+/*
+ This Source Code Form is subject to the terms of the Mozilla Public
+ License, v. 2.0. If a copy of the MPL was not distributed with this
+ file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+#pragma once
+
+#include <cstddef>
+#include <iterator>
+
+namespace Ponca
+{
+    template <typename Traits>
+    class ImageGridRangeQuery;
+
+    /*!
+     *  \brief Input iterator to read the `ImageGridRangeQuery` object.
+     *
+     *  As this is an input iterator, we don't guarantee anything other than reading the values with it.
+     *  If you need to operate on the values of this iterator with algorithms that relies on forward iterator
+     * functionalities, you should copy the index values in an STL-like container.
+     *
+     *  \note The increment logic resides in `ImageGridRangeQuery::advance(Iterator& it)`. The scan of the window
+     *  restarts from the current pixel, so this iterator object can be duplicated without causing issues.
+     *
+     *  \see ImageGridRangeQuery
+     */
+    template <typename Traits>
+    class ImageGridRangeIterator
+    {
+    protected:
+        friend class ImageGridRangeQuery<Traits>;
+        using Index = typename Traits::IndexType;
+
+    public:
+        using iterator_category = std::input_iterator_tag;
+        using difference_type   = std::ptrdiff_t;
+        using value_type        = Index;
+        using pointer           = Index*;
+        using reference         = const Index&;
+
+        PONCA_MULTIARCH inline ImageGridRangeIterator() = default;
+        PONCA_MULTIARCH inline ImageGridRangeIterator(ImageGridRangeQuery<Traits>* query, Index index = Index(-1))
+            : m_query(query), m_index(index)
+        {
+        }
+
+        /// \brief Inequality operand
+        PONCA_MULTIARCH inline bool operator!=(const ImageGridRangeIterator& other) const
+        {
+            return m_index != other.m_index;
+        }
+
+        /// \brief Equality operand
+        PONCA_MULTIARCH inline bool operator==(const ImageGridRangeIterator& other) const
+        {
+            return m_index == other.m_index;
+        }
+
+        /// \brief Prefix increment
+        /// \see ImageGridRangeQuery::advance(Iterator& it) for the iteration logic
+        PONCA_MULTIARCH inline ImageGridRangeIterator& operator++()
+        {
+            m_query->advance(*this);
+            return *this;
+        }
+
+        /// \brief Postfix increment
+        /// \see ImageGridRangeQuery::advance(Iterator& it) for the iteration logic
+        PONCA_MULTIARCH inline ImageGridRangeIterator operator++(int)
+        {
+            ImageGridRangeIterator tmp = *this;
+            m_query->advance(*this);
+            return tmp;
+        }
+
+        /// \brief Dereference operator
+        PONCA_MULTIARCH inline reference operator*() const { return const_cast<reference>(m_index); }
+
+    protected:
+        ImageGridRangeQuery<Traits>* m_query{nullptr};
+        Index m_index{-1}; ///< Current pixel, or -1 before the first pixel of the window
+    };
+} // namespace Ponca
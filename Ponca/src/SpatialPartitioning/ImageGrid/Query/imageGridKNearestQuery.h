@@ -0,0 +1,108 @@
+/*
+ This Source Code Form is subject to the terms of the Mozilla Public
+ License, v. 2.0. If a copy of the MPL was not distributed with this
+ file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+#pragma once
+
+#include "../../query.h"
+#include "../../KdTree/Iterator/kdTreeKNearestIterator.h"
+
+namespace Ponca
+{
+    template <typename Traits>
+    class StaticImageGridBase; // Need forward declaration to avoid mutual inclusion
+
+    /*!
+     * \brief Extension of the Query class that allows to read the result of a k-nearest neighbors search on the
+     * ImageGrid.
+     *
+     * Output result of a `ImageGrid::kNearestNeighbors` query request.
+     *
+     * The candidates are the pixels of the window scanned by ImageGridRangeQuery: the k-nearest neighbors are searched
+     * among the valid pixels of the window whose depth is close to the depth of the query. Less than k neighbors are
+     * returned when the window does not contain enough candidates.
+     *
+     * \see StaticImageGridBase
+     */
+    template <typename Traits>
+    class ImageGridKNearestQuery : public KNearestIndexQuery<typename Traits::IndexType,
+                                                             typename Traits::DataPoint::Scalar, Traits::MAX_KNN_SIZE>
+    {
+    public:
+        using DataPoint  = typename Traits::DataPoint;
+        using IndexType  = typename Traits::IndexType;
+        using Scalar     = typename DataPoint::Scalar;
+        using VectorType = typename DataPoint::VectorType;
+        using QueryType  = KNearestIndexQuery<IndexType, Scalar, Traits::MAX_KNN_SIZE>;
+        using Iterator   = KdTreeKNearestIterator<IndexType, DataPoint, Traits::MAX_KNN_SIZE>;
+        using Self       = ImageGridKNearestQuery<Traits>;
+
+        PONCA_MULTIARCH inline ImageGridKNearestQuery(const StaticImageGridBase<Traits>* grid, IndexType k, int index,
+                                                      int windowRadius)
+            : QueryType(k, index), m_grid(grid), m_windowRadius(windowRadius)
+        {
+        }
+
+        /// \brief Call the k-nearest neighbors query with new input and neighbor number parameters.
+        PONCA_MULTIARCH inline Self& operator()(int index, IndexType k)
+        {
+            return QueryType::template operator()<Self>(index, k);
+        }
+        /// \brief Call the k-nearest neighbors query with new input parameter.
+        PONCA_MULTIARCH inline Self& operator()(int index) { return QueryType::template operator()<Self>(index); }
+
+        /// \brief Half-size of the scanned window, in pixels
+        PONCA_MULTIARCH [[nodiscard]] inline int windowRadius() const { return m_windowRadius; }
+
+        /// \brief Set the half-size of the scanned window, in pixels
+        PONCA_MULTIARCH inline void setWindowRadius(int windowRadius) { m_windowRadius = windowRadius; }
+
+        /// \brief Returns an iterator to the beginning of the k-nearest neighbors query.
+        PONCA_MULTIARCH inline Iterator begin()
+        {
+            // The queue is not initialized with a sentinel, as the window may contain less than k candidates
+            QueryType::m_queue.clear();
+            this->search();
+            return Iterator(QueryType::m_queue.begin());
+        }
+
+        /// \brief Returns an iterator to the end of the k-nearest neighbors query.
+        PONCA_MULTIARCH inline Iterator end() { return Iterator(QueryType::m_queue.end()); }
+
+    protected:
+        PONCA_MULTIARCH inline void search()
+        {
+            PONCA_MULTIARCH_STD_MATH(abs);
+            const IndexType input = QueryType::input();
+            if (!m_grid->isValid(input))
+                return;
+
+            const auto& points    = m_grid->points();
+            const auto& depths    = m_grid->depths();
+            const VectorType& pos = points[input].pos();
+            const Scalar depth    = depths[input];
+            const Scalar maxDepth = m_grid->maxDepthDifference();
+            const int w           = m_grid->width();
+            const int h           = m_grid->height();
+            const int x           = input % w;
+            const int y           = input / w;
+
+            for (int ny = (y > m_windowRadius ? y - m_windowRadius : 0);
+                 ny <= (y + m_windowRadius < h ? y + m_windowRadius : h - 1); ++ny)
+                for (int nx = (x > m_windowRadius ? x - m_windowRadius : 0);
+                     nx <= (x + m_windowRadius < w ? x + m_windowRadius : w - 1); ++nx)
+                {
+                    const IndexType idx = ny * w + nx;
+                    if (idx == input || !m_grid->isValid(idx) || abs(depths[idx] - depth) > maxDepth)
+                        continue;
+                    QueryType::m_queue.push({idx, (points[idx].pos() - pos).squaredNorm()});
+                }
+        }
+
+    protected:
+        const StaticImageGridBase<Traits>* m_grid{nullptr};
+        int m_windowRadius{0}; ///< Half-size of the scanned window, in pixels
+    };
+} // namespace Ponca
@@ -0,0 +1,141 @@
+/*
+ This Source Code Form is subject to the terms of the Mozilla Public
+ License, v. 2.0. If a copy of the MPL was not distributed with this
+ file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+#pragma once
+
+#include "../../query.h"
+#include "../Iterator/imageGridRangeIterator.h"
+
+namespace Ponca
+{
+    template <typename Traits>
+    class StaticImageGridBase; // Need forward declaration to avoid mutual inclusion
+
+    /*!
+     * \brief Extension of the Query class that allows to read the result of a range or window neighbors search on the
+     * ImageGrid.
+     *
+     * Output result of the `ImageGrid::rangeNeighbors` and `ImageGrid::windowNeighbors` query requests.
+     *
+     * The pixels of the square window of half-size #windowRadius centered on the query pixel are scanned row by row,
+     * and the valid pixels whose depth differs from the depth of the query by at most
+     * StaticImageGridBase::maxDepthDifference, and that are closer than the query radius, are returned in raster order.
+     * The query pixel itself is not included, and an invalid query pixel has no neighbor.
+     *
+     * \see StaticImageGridBase
+     */
+    template <typename Traits>
+    class ImageGridRangeQuery : public RangeIndexQuery<typename Traits::IndexType, typename Traits::DataPoint::Scalar>
+    {
+    protected:
+        using QueryType = RangeIndexQuery<typename Traits::IndexType, typename Traits::DataPoint::Scalar>;
+        friend class ImageGridRangeIterator<Traits>; // This type must be equal to ImageGridRangeQuery::Iterator
+
+    public:
+        using DataPoint  = typename Traits::DataPoint;
+        using IndexType  = typename Traits::IndexType;
+        using Scalar     = typename DataPoint::Scalar;
+        using VectorType = typename DataPoint::VectorType;
+        using Iterator   = ImageGridRangeIterator<Traits>;
+        using Self       = ImageGridRangeQuery<Traits>;
+
+    public:
+        PONCA_MULTIARCH inline ImageGridRangeQuery(const StaticImageGridBase<Traits>* grid, Scalar radius, int index,
+                                                   int windowRadius)
+            : QueryType(radius, index), m_grid(grid), m_windowRadius(windowRadius)
+        {
+        }
+
+        /// \brief Call the range neighbors query with new input and radius parameters.
+        PONCA_MULTIARCH inline Self& operator()(int index, Scalar radius)
+        {
+            return QueryType::template operator()<Self>(index, radius);
+        }
+
+        /// \brief Call the range neighbors query with new input parameter.
+        PONCA_MULTIARCH inline Self& operator()(int index) { return QueryType::template operator()<Self>(index); }
+
+        /// \brief Half-size of the scanned window, in pixels
+        PONCA_MULTIARCH [[nodiscard]] inline int windowRadius() const { return m_windowRadius; }
+
+        /// \brief Set the half-size of the scanned window, in pixels
+        PONCA_MULTIARCH inline void setWindowRadius(int windowRadius) { m_windowRadius = windowRadius; }
+
+        /// \brief Returns an iterator to the beginning of the range neighbors query.
+        PONCA_MULTIARCH inline Iterator begin()
+        {
+            QueryType::reset();
+            Iterator it(this);
+            this->initialize();
+            this->advance(it);
+            return it;
+        }
+
+        /// \brief Returns an iterator to the end of the range neighbors query.
+        PONCA_MULTIARCH inline Iterator end() { return Iterator(this, m_grid->pointCount()); }
+
+    protected:
+        /// \brief Clamp the window to the image, and read the position and depth of the query pixel
+        PONCA_MULTIARCH inline void initialize()
+        {
+            const int w = m_grid->width();
+            const int x = QueryType::input() % w;
+            const int y = QueryType::input() / w;
+            m_x0        = x > m_windowRadius ? x - m_windowRadius : 0;
+            m_y0        = y > m_windowRadius ? y - m_windowRadius : 0;
+            m_x1        = x + m_windowRadius < w ? x + m_windowRadius : w - 1;
+            m_y1        = y + m_windowRadius < m_grid->height() ? y + m_windowRadius : m_grid->height() - 1;
+            m_depth     = m_grid->depth(QueryType::input());
+        }
+
+        /*! \brief Helper function for the ImageGridRangeIterator that scans the window up to the next neighbor
+         *
+         * \param it The ImageGridRangeIterator from where the advance request is made
+         * \see ImageGridRangeIterator
+         */
+        PONCA_MULTIARCH inline void advance(Iterator& it)
+        {
+            PONCA_MULTIARCH_STD_MATH(abs);
+            const auto& points    = m_grid->points();
+            const auto& depths    = m_grid->depths();
+            const VectorType& pos = points[QueryType::input()].pos();
+            const Scalar maxDepth = m_grid->maxDepthDifference();
+            const int w           = m_grid->width();
+
+            if (!m_grid->isValid(QueryType::input()))
+            {
+                it = end();
+                return;
+            }
+
+            // Resume the scan after the current pixel
+            int x = it.m_index < 0 ? m_x0 : it.m_index % w + 1;
+            int y = it.m_index < 0 ? m_y0 : it.m_index / w;
+            for (; y <= m_y1; ++y, x = m_x0)
+            {
+                for (; x <= m_x1; ++x)
+                {
+                    const IndexType idx = y * w + x;
+                    if (idx == QueryType::input() || !m_grid->isValid(idx) || abs(depths[idx] - m_depth) > maxDepth)
+                        continue;
+                    if ((points[idx].pos() - pos).squaredNorm() < QueryType::descentDistanceThreshold())
+                    {
+                        it.m_index = idx;
+                        return;
+                    }
+                }
+            }
+            it = end();
+        }
+
+    protected:
+        const StaticImageGridBase<Traits>* m_grid{nullptr};
+        int m_windowRadius{0}; ///< Half-size of the scanned window, in pixels
+        int m_x0{0}, m_y0{0};  ///< First pixel of the window, clamped to the image
+        int m_x1{0}, m_y1{0};  ///< Last pixel of the window, clamped to the image
+        Scalar m_depth{0};     ///< Depth of the query pixel
+    };
+} // namespace Ponca
@@ -0,0 +1,305 @@
+/*
+ This Source Code Form is subject to the terms of the Mozilla Public
+ License, v. 2.0. If a copy of the MPL was not distributed with this
+ file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+#pragma once
+
+#include "./imageGridTraits.h"
+
+#include "Query/imageGridKNearestQuery.h"
+#include "Query/imageGridRangeQuery.h"
+
+#include "../../Common/Assert.h"
+
+#include <cmath>
+#include <limits>
+#include <utility>
+
+namespace Ponca
+{
+
+    template <typename Traits>
+    class ImageGridBase;
+
+    /*!
+     * \brief Public interface for ImageGrid datastructure.
+     *
+     * Provides default implementation of the ImageGrid
+     *
+     * \see ImageGridDefaultTraits for the default trait interface documentation.
+     * \see ImageGridBase for complete API
+     */
+    template <typename DataPoint>
+    using ImageGrid = ImageGridBase<ImageGridDefaultTraits<DataPoint>>;
+
+    /*!
+     * \brief Neighbor queries in organized point clouds (depth images, range images), from their image grid
+     *
+     * The points are stored in raster order: the point of the pixel `(x, y)` has the index `y * width + x`. Instead of
+     * a tree descent, the neighbors of a pixel are searched in the square window of half-size #windowRadius centered on
+     * it, and the pixels whose depth differs from the depth of the query pixel by more than #maxDepthDifference are
+     * discarded, so that the neighborhoods do not cross depth discontinuities. The invalid pixels (e.g., missing
+     * measurements) are never returned, and are not listed in #samples.
+     *
+     * The queries follow the Query/Iterator interface of the other datastructures, so that the fits can be computed
+     * with `fit.computeWithIds(grid.rangeNeighbors(i, r), grid.points())`.
+     *
+     * \note By construction, the ImageGrid can be queried only from an index.
+     * \warning The range queries only return the neighbors that are located in the window: the window must be large
+     * enough to contain the projection of the query ball.
+     *
+     * \see ImageGridDefaultTraits for the trait interface documentation.
+     */
+    template <typename Traits>
+    class StaticImageGridBase
+    {
+    public:
+#define WRITE_TRAITS                                                                                                   \
+    using DataPoint       = typename Traits::DataPoint;       /*!< DataPoint given by user via Traits               */ \
+    using Scalar          = typename DataPoint::Scalar;       /*!< Scalar given by user via DataPoint               */ \
+    using VectorType      = typename DataPoint::VectorType;   /*!< VectorType given by user via DataPoint           */ \
+    using IndexType       = typename Traits::IndexType;       /*!< Type used to index points into the PointContainer*/ \
+    using PointContainer  = typename Traits::PointContainer;  /*!< Container for DataPoint used inside the grid     */ \
+    using IndexContainer  = typename Traits::IndexContainer;  /*!< Container for indices used inside the grid       */ \
+    using ScalarContainer = typename Traits::ScalarContainer; /*!< Container for the per-pixel depths               */
+        WRITE_TRAITS
+
+        using KNearestIndexQuery = ImageGridKNearestQuery<Traits>;
+        using RangeIndexQuery    = ImageGridRangeQuery<Traits>;
+
+        /// \brief Internal structure storing all the buffers used by the ImageGrid
+        struct Buffers
+        {
+            PointContainer points;  ///< Buffer storing the input points, in raster order (read only)
+            IndexContainer indices; ///< Buffer storing the indices of the valid pixels
+            ScalarContainer depths; ///< Buffer storing the depth of each pixel, NaN for the invalid pixels
+            /// Buffer storing, for each pixel, its position in `indices`, or -1 for the invalid pixels
+            IndexContainer sampleFromPixel;
+
+            size_t points_size{0};
+            size_t indices_size{0};
+            int width{0};
+            int height{0};
+            int windowRadius{0};
+            Scalar maxDepthDifference{PONCA_MULTIARCH_CU_STD_NAMESPACE(numeric_limits)<Scalar>::infinity()};
+
+            PONCA_MULTIARCH inline Buffers() = default;
+
+            PONCA_MULTIARCH inline Buffers(PointContainer _points, IndexContainer _indices, ScalarContainer _depths,
+                                           IndexContainer _sampleFromPixel, const size_t _points_size,
+                                           const size_t _indices_size, const int _width, const int _height,
+                                           const int _windowRadius, const Scalar _maxDepthDifference)
+                : points(_points), indices(_indices), depths(_depths), sampleFromPixel(_sampleFromPixel),
+                  points_size(_points_size), indices_size(_indices_size), width(_width), height(_height),
+                  windowRadius(_windowRadius), maxDepthDifference(_maxDepthDifference)
+            {
+            }
+        };
+
+    protected:
+        PONCA_MULTIARCH inline StaticImageGridBase() = default;
+
+    public:
+        /*! \brief Constructor that allows the use of prebuilt ImageGrid containers.
+         *
+         * Each internal values of an ImageGrid can be extracted using \ref `ImageGrid::buffers()`
+         *
+         * \note This constructor can be used to avoid the building process, which is useful to transfer directly the
+         * ImageGrid to the device in CUDA.
+         *
+         * \param _bufs Internal buffers of the ImageGrid
+         */
+        PONCA_MULTIARCH inline StaticImageGridBase(Buffers& _bufs) : m_bufs(_bufs) {}
+
+        // Query -------------------------------------------------------------------
+    public:
+        /// \brief Computes a Query object to iterate over the k-nearest neighbors of a pixel, found in its window.
+        ///
+        /// The returned object can be reset and reused with the () operator, to compute a new result
+        /// (also takes an index as parameter).
+        ///
+        /// \param index Index of the pixel that the query evaluates
+        /// \param k Number of requested neighbors
+        /// \return The \ref KNearestIndexQuery mutable object to iterate over the search results.
+        PONCA_MULTIARCH inline KNearestIndexQuery kNearestNeighbors(int index, IndexType k) const
+        {
+            return KNearestIndexQuery(this, k, index, windowRadius());
+        }
+
+        /// \brief Computes a Query object to iterate over the neighbors of a pixel that are inside a given radius,
+        /// found in its window.
+        ///
+        /// The returned object can be reset and reused with the () operator, to compute a new result
+        /// (also takes an index and a radius as parameters).
+        ///
+        /// \param index Index of the pixel that the query evaluates
+        /// \param r Radius around where to search the neighbors
+        /// \return The \ref RangeIndexQuery mutable object to iterate over the search results.
+        PONCA_MULTIARCH inline RangeIndexQuery rangeNeighbors(int index, Scalar r) const
+        {
+            return RangeIndexQuery(this, r, index, windowRadius());
+        }
+
+        /// \brief Computes a Query object to iterate over all the neighbors of a pixel found in a window of a given
+        /// half-size, as in screen-space methods.
+        ///
+        /// The neighbors are only selected by the depth threshold, see #maxDepthDifference.
+        ///
+        /// \param index Index of the pixel that the query evaluates
+        /// \param halfSize Half-size of the window, in pixels: the window contains `(2 * halfSize + 1)^2` pixels
+        /// \return The \ref RangeIndexQuery mutable object, with an infinite radius, to iterate over the results.
+        PONCA_MULTIARCH inline RangeIndexQuery windowNeighbors(int index, int halfSize) const
+        {
+            return RangeIndexQuery(this, PONCA_MULTIARCH_CU_STD_NAMESPACE(numeric_limits)<Scalar>::infinity(), index,
+                                   halfSize);
+        }
+
+        /// \brief Convenience function that provides an empty k-nearest neighbors Query object.
+        ///
+        /// The returned object can be called with the arguments `(i, k)` to fetch the k-nearest neighbors of the pixel
+        /// of index `i`.
+        ///
+        /// Same as `ImageGridBase::kNearestNeighbors (0, 0)`.
+        ///
+        /// \return The empty \ref KNearestIndexQuery mutable object
+        /// \see #kNearestNeighbors
+        PONCA_MULTIARCH inline KNearestIndexQuery kNearestNeighborsIndexQuery() const
+        {
+            return KNearestIndexQuery(this, 0, 0, windowRadius());
+        }
+
+        /// \brief Convenience function that provides an empty range neighbors Query object.
+        ///
+        /// The returned object can be called with the arguments `(i, r)` to fetch the neighbors
+        /// that are in range `r` of the pixel of index `i`.
+        ///
+        /// Same as `ImageGridBase::rangeNeighbors (0, 0)`.
+        ///
+        /// \return The empty \ref RangeIndexQuery mutable object
+        /// \see #rangeNeighbors
+        PONCA_MULTIARCH inline RangeIndexQuery rangeNeighborsIndexQuery() const
+        {
+            return RangeIndexQuery(this, 0, 0, windowRadius());
+        }
+
+        // Accessors ---------------------------------------------------------------
+    public:
+        /// \brief Width of the image, in pixels
+        PONCA_MULTIARCH [[nodiscard]] inline int width() const { return m_bufs.width; }
+        /// \brief Height of the image, in pixels
+        PONCA_MULTIARCH [[nodiscard]] inline int height() const { return m_bufs.height; }
+        /// \brief Index of the pixel `(x, y)`
+        PONCA_MULTIARCH [[nodiscard]] inline IndexType pixelIndex(int x, int y) const
+        {
+            return IndexType(y * m_bufs.width + x);
+        }
+        /// \brief Half-size of the window scanned by the range and k-nearest neighbors queries, in pixels
+        PONCA_MULTIARCH [[nodiscard]] inline int windowRadius() const { return m_bufs.windowRadius; }
+        /// \brief Maximum depth difference between a pixel and its neighbors (infinite when disabled)
+        PONCA_MULTIARCH [[nodiscard]] inline Scalar maxDepthDifference() const { return m_bufs.maxDepthDifference; }
+        /// \brief Tell if the pixel `index` stores a valid point
+        PONCA_MULTIARCH [[nodiscard]] inline bool isValid(int index) const
+        {
+            return m_bufs.sampleFromPixel[index] >= 0;
+        }
+        /// \brief Depth of the pixel `index`
+        PONCA_MULTIARCH [[nodiscard]] inline Scalar depth(int index) const { return m_bufs.depths[index]; }
+        //! \brief Get the number of valid pixels
+        PONCA_MULTIARCH [[nodiscard]] inline IndexType sampleCount() const { return (IndexType)m_bufs.indices_size; }
+        //! \brief Get the number of pixels
+        PONCA_MULTIARCH [[nodiscard]] inline IndexType pointCount() const { return (IndexType)m_bufs.points_size; }
+        //! \brief Get the internal point container, in raster order
+        PONCA_MULTIARCH [[nodiscard]] inline const PointContainer& points() const { return m_bufs.points; };
+        //! \brief Get the indices of the valid pixels
+        PONCA_MULTIARCH [[nodiscard]] inline const IndexContainer& samples() const { return m_bufs.indices; };
+        //! \brief Get the internal per-pixel depth container
+        PONCA_MULTIARCH [[nodiscard]] inline const ScalarContainer& depths() const { return m_bufs.depths; };
+        //! \brief Get access to the internal buffer, for instance to prepare GPU binding
+        PONCA_MULTIARCH [[nodiscard]] inline const Buffers& buffers() const { return m_bufs; }
+
+        /// \brief Set the half-size of the window scanned by the range and k-nearest neighbors queries, in pixels
+        ///
+        /// \note The window only needs to contain the projection of the largest query ball: it can be estimated from
+        /// the camera intrinsics, the query radius and the smallest depth.
+        PONCA_MULTIARCH inline void setWindowRadius(int _windowRadius) { m_bufs.windowRadius = _windowRadius; }
+        /// \brief Set the maximum depth difference between a pixel and its neighbors (infinite to disable the test)
+        PONCA_MULTIARCH inline void setMaxDepthDifference(Scalar _maxDepthDifference)
+        {
+            m_bufs.maxDepthDifference = _maxDepthDifference;
+        }
+
+        // Data --------------------------------------------------------------------
+    protected:
+        Buffers m_bufs; ///< Buffers used to store the ImageGrid
+    };
+
+    /*!
+     * \brief Customizable base class for ImageGrid datastructure
+     *
+     * \see Ponca::ImageGrid
+     *
+     * \tparam Traits Traits type providing the types and constants used by the ImageGrid. Must have the
+     * same interface as the default traits type.
+     *
+     * \see ImageGridDefaultTraits for the trait interface documentation.
+     */
+    template <typename Traits>
+    class ImageGridBase : public StaticImageGridBase<Traits>
+    {
+    public:
+        WRITE_TRAITS
+    private:
+        using Base = StaticImageGridBase<Traits>;
+
+    public:
+        /// \brief Build an ImageGrid from an organized point cloud
+        ///
+        /// \param _points Points of the image, in raster order, of size `_width * _height`
+        /// \param _width Width of the image, in pixels
+        /// \param _height Height of the image, in pixels
+        /// \param _windowRadius Half-size of the window scanned by the range and k-nearest neighbors queries
+        /// \param _maxDepthDifference Maximum depth difference between a pixel and its neighbors (infinite to disable
+        /// the test)
+        /// \param _depth Functor computing the depth of a point, or a non-finite value for the invalid pixels, e.g.
+        /// ImageGridCameraDepth for depth images and ImageGridRangeDepth for range images
+        ///
+        /// \warning Stores a copy of the points
+        template <typename DepthFunctor = ImageGridCameraDepth>
+        PONCA_MULTIARCH_HOST inline ImageGridBase(
+            PointContainer _points, const int _width, const int _height, const int _windowRadius = 4,
+            const Scalar _maxDepthDifference = std::numeric_limits<Scalar>::infinity(),
+            const DepthFunctor& _depth = DepthFunctor())
+        {
+            PONCA_ASSERT(_width > 0 && _height > 0 && _points.size() == size_t(_width) * size_t(_height));
+            const int size = _width * _height;
+
+            Base::m_bufs.points             = std::move(_points);
+            Base::m_bufs.points_size        = size;
+            Base::m_bufs.width              = _width;
+            Base::m_bufs.height             = _height;
+            Base::m_bufs.windowRadius       = _windowRadius;
+            Base::m_bufs.maxDepthDifference = _maxDepthDifference;
+
+            Base::m_bufs.depths.resize(size);
+            Base::m_bufs.sampleFromPixel.resize(size, -1);
+            Base::m_bufs.indices.clear();
+            for (int i = 0; i < size; ++i)
+            {
+                const Scalar d         = Scalar(_depth(Base::m_bufs.points[i]));
+                const bool valid       = std::isfinite(d);
+                Base::m_bufs.depths[i] = valid ? d : std::numeric_limits<Scalar>::quiet_NaN();
+                if (valid)
+                {
+                    Base::m_bufs.sampleFromPixel[i] = IndexType(Base::m_bufs.indices.size());
+                    Base::m_bufs.indices.push_back(i);
+                }
+            }
+            Base::m_bufs.indices_size = Base::m_bufs.indices.size();
+        }
+    };
+
+} // namespace Ponca
+
+#undef WRITE_TRAITS
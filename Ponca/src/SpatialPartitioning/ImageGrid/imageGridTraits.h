@@ -0,0 +1,112 @@
+/*
+ This Source Code Form is subject to the terms of the Mozilla Public
+ License, v. 2.0. If a copy of the MPL was not distributed with this
+ file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+#pragma once
+
+#include "../defines.h"
+
+#include PONCA_MULTIARCH_INCLUDE_STD(cmath)
+#include PONCA_MULTIARCH_INCLUDE_CU_STD(limits)
+
+#include <vector>
+
+namespace Ponca
+{
+    /*!
+     * \brief Depth of the points of a depth image: coordinate along the viewing axis, i.e. the last coordinate of the
+     * positions expressed in the camera frame
+     *
+     * Pixels with a non-finite position, or with a null or negative depth (a common encoding of missing measurements),
+     * are invalid.
+     */
+    struct ImageGridCameraDepth
+    {
+        template <typename DataPoint>
+        PONCA_MULTIARCH inline typename DataPoint::Scalar operator()(const DataPoint& _p) const
+        {
+            using Scalar = typename DataPoint::Scalar;
+            if (_p.pos().allFinite() && _p.pos()(DataPoint::Dim - 1) > Scalar(0))
+                return _p.pos()(DataPoint::Dim - 1);
+            return PONCA_MULTIARCH_CU_STD_NAMESPACE(numeric_limits)<Scalar>::quiet_NaN();
+        }
+    };
+
+    /*!
+     * \brief Depth of the points of a range image (e.g., a LiDAR scan): distance to the sensor, i.e. the norm of the
+     * positions expressed in the sensor frame
+     *
+     * Pixels with a non-finite position, or with a null range, are invalid.
+     */
+    struct ImageGridRangeDepth
+    {
+        template <typename DataPoint>
+        PONCA_MULTIARCH inline typename DataPoint::Scalar operator()(const DataPoint& _p) const
+        {
+            using Scalar       = typename DataPoint::Scalar;
+            const Scalar range = _p.pos().norm();
+            if (_p.pos().allFinite() && range > Scalar(0))
+                return range;
+            return PONCA_MULTIARCH_CU_STD_NAMESPACE(numeric_limits)<Scalar>::quiet_NaN();
+        }
+    };
+
+    /*!
+     * \brief The default traits type used by the ImageGrid.
+     */
+    template <typename _DataPoint>
+    struct ImageGridDefaultTraits
+    {
+        enum
+        {
+            MAX_KNN_SIZE = 128 //!< The maximum size of a knn query
+        };
+        /*!
+         * \brief The type used to store point data.
+         *
+         * Must provide `Scalar` and `VectorType` aliases, and a `pos()` function.
+         */
+        using DataPoint = _DataPoint;
+
+    private:
+        using Scalar = typename DataPoint::Scalar;
+
+    public:
+        // Containers
+        using IndexType       = int;
+        using PointContainer  = std::vector<DataPoint>;
+        using IndexContainer  = std::vector<IndexType>;
+        using ScalarContainer = std::vector<Scalar>; //!< Container for the per-pixel depths
+    };
+
+    /*!
+     * \brief Variant to the ImageGrid Traits type that uses pointers as internal storage instead of an STL-like
+     * container.
+     */
+    template <typename _DataPoint>
+    struct ImageGridPointerTraits
+    {
+        enum
+        {
+            MAX_KNN_SIZE = 128 //!< The maximum size of a knn query
+        };
+        /*!
+         * \brief The type used to store point data.
+         *
+         * Must provide `Scalar` and `VectorType` aliases, and a `pos()` function.
+         */
+        using DataPoint = _DataPoint;
+
+    private:
+        using Scalar = typename DataPoint::Scalar;
+
+    public:
+        // Containers
+        using IndexType       = int;
+        using PointContainer  = DataPoint*;
+        using IndexContainer  = IndexType*;
+        using ScalarContainer = Scalar*; //!< Container for the per-pixel depths
+    };
+} // namespace Ponca
@@ -77,6 +77,9 @@ namespace Ponca
         /// \brief Dereference operator
         PONCA_MULTIARCH inline reference operator*() const { return const_cast<reference>(m_iterator->index); }
 
+        /// \brief Squared distance between the query and the current neighbor, as computed during the search
+        PONCA_MULTIARCH [[nodiscard]] inline Scalar squaredDistance() const { return m_iterator->squared_distance; }
+
     protected:
         Iterator m_iterator;
     };
@@ -490,6 +490,23 @@ namespace Ponca
             build(std::forward<PointUserContainer>(points), DefaultConverter());
         }
 
+        /*! \brief Permute the stored points so that their memory layout follows the leaves of the tree
+         *
+         * The leaves are traversed in depth-first order, which defines a space-filling curve over the point cloud:
+         * points that are close in space end up close in memory. After this call the sample `i` is stored at
+         * position `i` (i.e. `pointFromSample(i) == i`), and the points that are not sampled (for KdTreeSparse)
+         * are stored after the samples, in their original relative order. The nodes are left untouched.
+         *
+         * A KnnGraph built from the reordered tree inherits this layout, so graph walks and fits performed on
+         * the neighborhoods access memory-local data.
+         *
+         * \warning Indices computed before this call are invalidated: use the returned permutation to convert
+         * them, or to reorder user-side attributes.
+         *
+         * \return The permutation `perm` such that `points()[i]` was stored at position `perm[i]` before the call
+         */
+        PONCA_MULTIARCH_HOST inline IndexContainer reorderPoints();
+
         // Internal ----------------------------------------------------------------
     protected:
         /// Generate a tree sampled from a custom contained type converted using a `Converter`
@@ -155,6 +155,12 @@ PONCA_MULTIARCH_HOST inline void KdTreeBase<Traits>::buildRec(NodeIndexType node
                      static_cast<NodeIndexType>(Base::m_bufs.nodes.size()) > Base::MAX_NODE_COUNT - 2);
 
     node.configure_range(start, end - start, aabb);
+    // Optional hooks for nodes storing information computed from their samples (e.g. KdTreeMomentNode). Inner nodes
+    // able to aggregate the information of their children do so once they are built, instead of visiting the samples
+    constexpr bool aggregatesChildren = requires { node.configure_children_samples(node, node); };
+    if constexpr (requires { node.configure_samples(Base::m_bufs.points, Base::m_bufs.indices, start, end - start); })
+        if (node.is_leaf() || !aggregatesChildren)
+            node.configure_samples(Base::m_bufs.points, Base::m_bufs.indices, start, end - start);
     if (node.is_leaf())
     {
         ++Base::m_leaf_count;
@@ -170,6 +176,14 @@ PONCA_MULTIARCH_HOST inline void KdTreeBase<Traits>::buildRec(NodeIndexType node
         IndexType mid_id = this->partition(start, end, split_dim, node.inner_split_value());
         buildRec(node.inner_first_child_id(), start, mid_id, level + 1);
         buildRec(node.inner_first_child_id() + 1, mid_id, end, level + 1);
+
+        if constexpr (aggregatesChildren)
+        {
+            // The nodes buffer may have been reallocated by the children
+            auto& nodes               = Base::m_bufs.nodes;
+            const NodeIndexType first = nodes[node_id].inner_first_child_id();
+            nodes[node_id].configure_children_samples(nodes[first], nodes[first + 1]);
+        }
     }
 }
 
@@ -186,3 +200,35 @@ PONCA_MULTIARCH_HOST [[nodiscard]] inline auto KdTreeBase<Traits>::partition(Ind
 
     return static_cast<IndexType>(distance);
 }
+
+template <typename Traits>
+PONCA_MULTIARCH_HOST inline auto KdTreeBase<Traits>::reorderPoints() -> IndexContainer
+{
+    auto& bufs                = Base::m_bufs;
+    const IndexType nbPoints  = Base::pointCount();
+    const IndexType nbSamples = Base::sampleCount();
+
+    // Samples are already sorted by leaf, then come the points that are not used by the tree
+    IndexContainer permutation(nbPoints);
+    std::vector<bool> isSample(nbPoints, false);
+    for (IndexType i = 0; i < nbSamples; ++i)
+    {
+        permutation[i]            = bufs.indices[i];
+        isSample[bufs.indices[i]] = true;
+    }
+    IndexType next = nbSamples;
+    for (IndexType i = 0; i < nbPoints; ++i)
+        if (!isSample[i])
+            permutation[next++] = i;
+
+    PointContainer points;
+    points.reserve(nbPoints);
+    for (IndexType i = 0; i < nbPoints; ++i)
+        points.push_back(bufs.points[permutation[i]]);
+    bufs.points = std::move(points);
+
+    std::iota(std::begin(bufs.indices), std::begin(bufs.indices) + nbSamples, IndexType(0));
+
+    PONCA_DEBUG_ASSERT(this->valid());
+    return permutation;
+}
@@ -0,0 +1,144 @@
+/*
+ This Source Code Form is subject to the terms of the Mozilla Public
+ License, v. 2.0. If a copy of the MPL was not distributed with this
+ file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+#pragma once
+
+#include "./kdTreeTraits.h"
+
+namespace Ponca
+{
+    /*!
+     * \brief Moments of the samples stored in a subtree of the kd-tree
+     *
+     * The moments are stored relatively to the centroid \f$ \mathbf{c} \f$ of the samples, i.e. using
+     * \f$ \mathbf{q}_i = \mathbf{p}_i - \mathbf{c} \f$, which preserves the accuracy when they are later expressed
+     * relatively to an evaluation position.
+     */
+    template <typename DataPoint>
+    struct KdTreeNodeMoments
+    {
+        using Scalar     = typename DataPoint::Scalar;
+        using VectorType = typename DataPoint::VectorType;
+        using MatrixType = Eigen::Matrix<Scalar, DataPoint::Dim, DataPoint::Dim>;
+
+        //! \brief Does DataPoint provide normals ? If not, #sumN and #sumDotPN are left to zero
+        static constexpr bool hasNormal = requires(const DataPoint& p) { p.normal(); };
+
+        int count{0};                            ///< Number of samples
+        VectorType centroid{VectorType::Zero()}; ///< Centroid \f$ \mathbf{c} \f$ of the samples
+        MatrixType scatter{MatrixType::Zero()};  ///< \f$ \sum_i \mathbf{q}_i \mathbf{q}_i^T \f$
+        VectorType sumN{VectorType::Zero()};     ///< \f$ \sum_i \mathbf{n}_i \f$
+        Scalar sumDotPN{0};                      ///< \f$ \sum_i \mathbf{q}_i \cdot \mathbf{n}_i \f$
+
+        /// \brief Compute the moments of the samples `[start, start+size[`
+        template <typename PointContainer, typename IndexContainer, typename Index>
+        inline void compute(const PointContainer& points, const IndexContainer& indices, Index start, Index size)
+        {
+            *this = KdTreeNodeMoments();
+            count = int(size);
+            if (count == 0)
+                return;
+
+            for (Index i = start; i < start + size; ++i)
+                centroid += points[indices[i]].pos();
+            centroid /= Scalar(count);
+
+            for (Index i = start; i < start + size; ++i)
+            {
+                const auto& p      = points[indices[i]];
+                const VectorType q = p.pos() - centroid;
+                scatter += q * q.transpose();
+                if constexpr (hasNormal)
+                {
+                    sumN += p.normal();
+                    sumDotPN += q.dot(p.normal());
+                }
+            }
+        }
+
+        /// \brief Add the moments of another set of samples, disjoint from the samples of this one
+        ///
+        /// The moments are moved to the centroid of the union (parallel axis theorem), without visiting the samples.
+        inline void merge(const KdTreeNodeMoments& other)
+        {
+            if (other.count == 0)
+                return;
+            if (count == 0)
+            {
+                *this = other;
+                return;
+            }
+
+            const int n         = count + other.count;
+            const VectorType c  = (Scalar(count) * centroid + Scalar(other.count) * other.centroid) / Scalar(n);
+            const VectorType da = centroid - c;
+            const VectorType db = other.centroid - c;
+            scatter += other.scatter + Scalar(count) * da * da.transpose() + Scalar(other.count) * db * db.transpose();
+            sumDotPN += other.sumDotPN + da.dot(sumN) + db.dot(other.sumN);
+            sumN += other.sumN;
+            centroid = c;
+            count    = n;
+        }
+    };
+
+    /*!
+     * \brief Kd-tree node storing the bounding box and the moments of the samples of its subtree
+     *
+     * Allows to consume whole subtrees during a fit, see Basket::computeWithMoments:
+     * \code
+     * using MomentKdTree = KdTreeDenseBase<KdTreeDefaultTraits<DataPoint, KdTreeMomentNode>>;
+     * \endcode
+     *
+     * The moments are computed during the construction, from the samples of the leaves, and by merging the moments of
+     * the two children of the inner nodes: the construction cost is linear in the number of samples. They do not
+     * depend on the order of the points, and thus stay valid after KdTreeBase::reorderPoints.
+     */
+    template <typename Index, typename NodeIndex, typename DataPoint, typename LeafSize = Index>
+    struct KdTreeMomentNode : public KdTreeDefaultNode<Index, NodeIndex, DataPoint, LeafSize>
+    {
+        using Base     = KdTreeDefaultNode<Index, NodeIndex, DataPoint, LeafSize>;
+        using AabbType = typename Base::AabbType;
+        using Moments  = KdTreeNodeMoments<DataPoint>;
+
+        /// \copydoc KdTreeCustomizableNode::configure_range
+        PONCA_MULTIARCH void configure_range(Index start, Index size, const AabbType& aabb)
+        {
+            Base::configure_range(start, size, aabb);
+            m_aabb = aabb;
+        }
+
+        /// \brief Compute the moments of the samples of a leaf
+        ///
+        /// Called after \ref configure_range during kd-tree construction, for the leaves only since the node provides
+        /// \ref configure_children_samples.
+        template <typename PointContainer, typename IndexContainer>
+        PONCA_MULTIARCH_HOST void configure_samples(const PointContainer& points, const IndexContainer& indices,
+                                                    Index start, Index size)
+        {
+            m_moments.compute(points, indices, start, size);
+        }
+
+        /// \brief Compute the moments of an inner node from the moments of its children
+        ///
+        /// Called during kd-tree construction, once the children of the node are built.
+        PONCA_MULTIARCH_HOST void configure_children_samples(const KdTreeMomentNode& first,
+                                                             const KdTreeMomentNode& second)
+        {
+            m_moments = first.m_moments;
+            m_moments.merge(second.m_moments);
+        }
+
+        /// \brief Bounding box of the samples of the node
+        PONCA_MULTIARCH [[nodiscard]] inline const AabbType& aabb() const { return m_aabb; }
+
+        /// \brief Moments of the samples of the node
+        PONCA_MULTIARCH [[nodiscard]] inline const Moments& moments() const { return m_moments; }
+
+    private:
+        AabbType m_aabb;
+        Moments m_moments;
+    };
+} // namespace Ponca
@@ -7,6 +7,7 @@
 #pragma once
 
 #include "../../query.h"
+#include "../../indexSquaredDistance.h"
 #include "../Iterator/knnGraphRangeIterator.h"
 #include "../../../Common/Containers/stack.h"
 
@@ -91,7 +92,7 @@ namespace Ponca
             m_flag.insert(QueryType::input());
 
             PONCA_DEBUG_ASSERT(m_stack.empty());
-            m_stack.push(QueryType::input());
+            m_stack.push({QueryType::input(), Scalar(0)});
 
             iterator.m_index = -1;
         }
@@ -99,11 +100,16 @@ namespace Ponca
         /*! \brief Helper function for the KnnGraphRangeIterator that advances the range neighbors search using the
          * k-nearest neighbors known by the KnnGraph
          *
+         * When the graph stores its edge lengths (see StaticKnnGraphBase::hasEdgeDistances), the distance of the
+         * direct neighbors of the query is read from the graph, and the triangle inequality is used to discard the
+         * neighbors that are out of range without reading their position.
+         *
          * \param iterator The KnnGraphRangeIterator from where the advance request is made
          * \see KnnGraphRangeIterator
          */
         PONCA_MULTIARCH inline void advance(Iterator& iterator)
         {
+            PONCA_MULTIARCH_STD_MATH(sqrt);
             const auto& points = m_graph->points();
             const auto& point  = points[QueryType::input()].pos();
 
@@ -116,23 +122,49 @@ namespace Ponca
             }
             else
             {
-                int idx_current = m_stack.top();
+                const auto current = m_stack.top();
                 m_stack.pop();
 
-                PONCA_DEBUG_ASSERT((point - points[idx_current].pos()).squaredNorm() < QueryType::squaredRadius());
+                PONCA_DEBUG_ASSERT(current.squared_distance < QueryType::squaredRadius());
+
+                iterator.m_index = current.index;
 
-                iterator.m_index = idx_current;
+                const Scalar threshold   = QueryType::descentDistanceThreshold();
+                const bool useEdges      = m_graph->hasEdgeDistances();
+                const bool isInput       = current.index == QueryType::input();
+                const Scalar currentDist = useEdges && !isInput ? sqrt(current.squared_distance) : Scalar(0);
+                // Margin protecting the pruning test against rounding errors
+                const Scalar pruneDist =
+                    sqrt(threshold) * (Scalar(1) + Scalar(16) * Eigen::NumTraits<Scalar>::epsilon());
 
-                for (int idx_nei : m_graph->kNearestNeighbors(idx_current))
+                const int k     = m_graph->k();
+                const int begin = current.index * k;
+                for (int j = 0; j < k; ++j)
                 {
+                    const int idx_nei = m_graph->samples()[begin + j];
                     PONCA_DEBUG_ASSERT(idx_nei >= 0);
-                    Scalar d  = (point - points[idx_nei].pos()).squaredNorm();
-                    Scalar th = QueryType::descentDistanceThreshold();
 
-                    if ((point - points[idx_nei].pos()).squaredNorm() < QueryType::descentDistanceThreshold() &&
-                        m_flag.insert(idx_nei))
+                    Scalar d;
+                    if (useEdges)
+                    {
+                        const Scalar edge = m_graph->edgeSquaredDistances()[begin + j];
+                        if (isInput)
+                            d = edge; // exact: the edge starts at the query
+                        else
+                        {
+                            // |d(query, current) - d(current, nei)| is a lower bound of d(query, nei)
+                            const Scalar lowerBound = currentDist - sqrt(edge);
+                            if (lowerBound > pruneDist || -lowerBound > pruneDist)
+                                continue;
+                            d = (point - points[idx_nei].pos()).squaredNorm();
+                        }
+                    }
+                    else
+                        d = (point - points[idx_nei].pos()).squaredNorm();
+
+                    if (d < threshold && m_flag.insert(idx_nei))
                     {
-                        m_stack.push(idx_nei);
+                        m_stack.push({idx_nei, d});
                     }
                 }
                 if (iterator.m_index == QueryType::input())
@@ -143,7 +175,8 @@ namespace Ponca
     protected:
         const StaticKnnGraphBase<Traits>* m_graph{nullptr};
         IndexSet m_flag;                                      ///< Stores every visited neighbor ids
-        Stack<int, Traits::MAX_RANGE_NEIGHBORS_SIZE> m_stack; ///< Holds the next ids the Query should visit
+        /// Holds the next ids the Query should visit, with their squared distance to the query
+        Stack<IndexSquaredDistance<IndexType, Scalar>, Traits::MAX_RANGE_NEIGHBORS_SIZE> m_stack;
     };
 
 } // namespace Ponca
@@ -45,9 +45,10 @@ namespace Ponca
         using AabbType = Eigen::AlignedBox<Scalar, DataPoint::Dim>;
 
         // Containers
-        using IndexType      = int;
-        using PointContainer = std::vector<DataPoint>;
-        using IndexContainer = std::vector<IndexType>;
+        using IndexType       = int;
+        using PointContainer  = std::vector<DataPoint>;
+        using IndexContainer  = std::vector<IndexType>;
+        using ScalarContainer = std::vector<Scalar>; //!< Container for the optional per-edge squared distances
     };
     /*!
      * \brief Variant to the KnnGraph Traits type that uses pointers as internal storage instead of an STL-like
@@ -84,8 +85,9 @@ namespace Ponca
         using AabbType = Eigen::AlignedBox<Scalar, DataPoint::Dim>;
 
         // Containers
-        using IndexType      = int;
-        using PointContainer = DataPoint*;
-        using IndexContainer = IndexType*;
+        using IndexType       = int;
+        using PointContainer  = DataPoint*;
+        using IndexContainer  = IndexType*;
+        using ScalarContainer = Scalar*; //!< Container for the optional per-edge squared distances
     };
 } // namespace Ponca
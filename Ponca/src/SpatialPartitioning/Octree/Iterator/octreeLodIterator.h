@@ -0,0 +1,83 @@
+/*
+ This Source Code Form is subject to the terms of the Mozilla Public
+ License, v. 2.0. If a copy of the MPL was not distributed with this
+ file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+#pragma once
+
+#include <cstddef>
+#include <iterator>
+
+namespace Ponca
+{
+
+    /*!
+     *  \brief Input iterator to read the `OctreeLodQuery` object.
+     *
+     *  As this is an input iterator, we don't guarantee anything other than reading the values with it.
+     *  If you need to operate on the values of this iterator with algorithms that relies on forward iterator
+     * functionalities, you should copy the index values in an STL-like container.
+     *
+     *  \note The increment logic resides in `OctreeLodQuery::advance(Iterator& it)`, and the traversal stack is stored
+     *  in the query: the iterators of a query cannot be incremented independently.
+     *
+     *  \see OctreeLodQuery
+     */
+    template <typename Index, typename QueryT_>
+    class OctreeLodIterator
+    {
+    protected:
+        friend QueryT_;
+
+    public:
+        using iterator_category = std::input_iterator_tag;
+        using difference_type   = std::ptrdiff_t;
+        using value_type        = Index;
+        using pointer           = Index*;
+        using reference         = const Index&;
+
+        using QueryType = QueryT_;
+
+        PONCA_MULTIARCH inline OctreeLodIterator() = default;
+        PONCA_MULTIARCH inline OctreeLodIterator(QueryType* query, Index index = -1) : m_query(query), m_index(index)
+        {
+        }
+
+        /// \brief Inequality operand
+        PONCA_MULTIARCH inline bool operator!=(const OctreeLodIterator& other) const
+        {
+            return m_index != other.m_index;
+        }
+
+        /// \brief Equality operand
+        PONCA_MULTIARCH inline bool operator==(const OctreeLodIterator& other) const
+        {
+            return m_index == other.m_index;
+        }
+
+        /// \brief Prefix increment
+        /// \see OctreeLodQuery::advance(Iterator& it) for the iteration logic
+        PONCA_MULTIARCH inline OctreeLodIterator& operator++()
+        {
+            m_query->advance(*this);
+            return *this;
+        }
+
+        /// \brief Postfix increment
+        /// \see OctreeLodQuery::advance(Iterator& it) for the iteration logic
+        PONCA_MULTIARCH inline OctreeLodIterator operator++(int)
+        {
+            OctreeLodIterator tmp = *this;
+            m_query->advance(*this);
+            return tmp;
+        }
+
+        /// \brief Dereference operator, returning the index of the current node
+        PONCA_MULTIARCH inline reference operator*() const { return const_cast<reference>(m_index); }
+
+    protected:
+        QueryType* m_query{nullptr};
+        Index m_index{-1}; ///< Index of the current node
+    };
+} // namespace Ponca
@@ -0,0 +1,129 @@
+/*
+ This Source Code Form is subject to the terms of the Mozilla Public
+ License, v. 2.0. If a copy of the MPL was not distributed with this
+ file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+#pragma once
+
+#include "../../query.h"
+#include "../../../Common/Containers/stack.h"
+#include "../Iterator/octreeLodIterator.h"
+
+namespace Ponca
+{
+    template <typename Traits>
+    class StaticOctreeBase; // Need forward declaration to avoid mutual inclusion
+
+    /*!
+     * \brief Extension of the Query class that allows to read the result of a level of detail search on the Octree.
+     *
+     * Output result of a `OctreeBase::lodNeighbors` query request: iterates over the indices of the **nodes**
+     * intersecting the query ball, selected at the requested level of detail. The octree is traversed from its root,
+     * and the descent stops at the first node that satisfies one of these conditions:
+     *  - its depth reaches #maxDepth,
+     *  - its error (see OctreeNode::error) is lower than or equal to #maxError,
+     *  - it is a leaf.
+     *
+     * The selected nodes are disjoint, and their samples cover the samples of the octree lying in the query ball.
+     * Their moments can be fitted directly, see Basket::computeWithNodes.
+     *
+     * \see StaticOctreeBase
+     */
+    template <typename Traits>
+    class OctreeLodQuery : public RangePointQuery<typename Traits::IndexType, typename Traits::DataPoint>
+    {
+    public:
+        using DataPoint  = typename Traits::DataPoint;
+        using IndexType  = typename Traits::IndexType;
+        using Scalar     = typename DataPoint::Scalar;
+        using VectorType = typename DataPoint::VectorType;
+        using QueryType  = RangePointQuery<IndexType, DataPoint>;
+        using Self       = OctreeLodQuery<Traits>;
+        using Iterator   = OctreeLodIterator<IndexType, Self>;
+
+    protected:
+        friend Iterator;
+
+    public:
+        PONCA_MULTIARCH inline OctreeLodQuery(const StaticOctreeBase<Traits>* octree, Scalar radius,
+                                              const VectorType& point, int maxDepth, Scalar maxError)
+            : QueryType(radius, point), m_octree(octree), m_maxDepth(maxDepth), m_maxError(maxError)
+        {
+        }
+
+        /// \brief Call the query with new input and radius parameters.
+        PONCA_MULTIARCH inline Self& operator()(const VectorType& point, Scalar radius)
+        {
+            return QueryType::template operator()<Self>(point, radius);
+        }
+
+        /// \brief Call the query with new input parameter.
+        PONCA_MULTIARCH inline Self& operator()(const VectorType& point)
+        {
+            return QueryType::template operator()<Self>(point);
+        }
+
+        /// \brief Maximal depth of the selected nodes
+        PONCA_MULTIARCH [[nodiscard]] inline int maxDepth() const { return m_maxDepth; }
+        /// \brief Error below which a node is selected without descending to its children
+        PONCA_MULTIARCH [[nodiscard]] inline Scalar maxError() const { return m_maxError; }
+        /// \brief Set the maximal depth of the selected nodes
+        PONCA_MULTIARCH inline void setMaxDepth(int maxDepth) { m_maxDepth = maxDepth; }
+        /// \brief Set the error below which a node is selected without descending to its children (negative to only
+        /// select the nodes from their depth)
+        PONCA_MULTIARCH inline void setMaxError(Scalar maxError) { m_maxError = maxError; }
+
+        /// \brief Returns an iterator to the beginning of the query.
+        PONCA_MULTIARCH inline Iterator begin()
+        {
+            QueryType::reset();
+            m_stack.clear();
+            if (m_octree->nodeCount() > 0)
+                m_stack.push(0);
+            Iterator it(this);
+            this->advance(it);
+            return it;
+        }
+
+        /// \brief Returns an iterator to the end of the query.
+        PONCA_MULTIARCH inline Iterator end() { return Iterator(this, m_octree->nodeCount()); }
+
+    protected:
+        PONCA_MULTIARCH inline void advance(Iterator& it)
+        {
+            const auto& nodes       = m_octree->nodes();
+            const VectorType& point = QueryType::input();
+
+            while (!m_stack.empty())
+            {
+                const IndexType id = m_stack.top();
+                const auto& node   = nodes[id];
+                m_stack.pop();
+
+                // Squared distance between the query and the bounding box of the node
+                const Scalar d = node.aabb().squaredExteriorDistance(point);
+                if (node.sample_size() == 0 || d > QueryType::descentDistanceThreshold())
+                    continue;
+
+                if (node.is_leaf() || node.depth() >= m_maxDepth || node.error() <= m_maxError)
+                {
+                    it.m_index = id;
+                    return;
+                }
+
+                // Pushed in reverse order, so that the children are visited in their storage order
+                for (int c = node.child_count() - 1; c >= 0; --c)
+                    m_stack.push(node.first_child_id() + c);
+            }
+            it = end();
+        }
+
+    protected:
+        const StaticOctreeBase<Traits>* m_octree{nullptr};
+        int m_maxDepth{0};   ///< Maximal depth of the selected nodes
+        Scalar m_maxError{0}; ///< Error below which a node is selected
+        /// Nodes to visit: at most \f$ 2^{Dim} - 1 \f$ siblings are pending at each level
+        Stack<IndexType, Traits::MAX_DEPTH*((1 << DataPoint::Dim) - 1) + 1> m_stack;
+    };
+} // namespace Ponca
@@ -0,0 +1,317 @@
+/*
+ This Source Code Form is subject to the terms of the Mozilla Public
+ License, v. 2.0. If a copy of the MPL was not distributed with this
+ file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+#pragma once
+
+#include "./octreeTraits.h"
+
+#include "Query/octreeLodQuery.h"
+
+#include "../../Common/Assert.h"
+
+#include <algorithm>
+#include <array>
+#include <limits>
+#include <numeric>
+#include <vector>
+
+namespace Ponca
+{
+
+    template <typename Traits>
+    class OctreeBase;
+
+    /*!
+     * \brief Public interface for Octree datastructure.
+     *
+     * Provides default implementation of the Octree
+     *
+     * \see OctreeDefaultTraits for the default trait interface documentation.
+     * \see OctreeBase for complete API
+     */
+    template <typename DataPoint>
+    using Octree = OctreeBase<OctreeDefaultTraits<DataPoint>>;
+
+    /*!
+     * \brief Octree storing the aggregated moments of its nodes, for level of detail queries
+     *
+     * The bounding cube of the points is recursively split in \f$ 2^{Dim} \f$ cubes of half size. Each node stores the
+     * bounding box of its samples, their aggregated position and normal moments (see KdTreeNodeMoments), and the
+     * error made when approximating them by a plane (see OctreeNode::error).
+     *
+     * The level of detail queries (see #lodNeighbors) select a cut of the tree: the descent stops at a user-given
+     * depth, or as soon as the samples of a node are well approximated by its moments. The selected nodes can then be
+     * fitted directly from their moments with Basket::computeWithNodes, at a cost that depends on the number of nodes
+     * instead of the number of samples.
+     *
+     * \see OctreeDefaultTraits for the trait interface documentation.
+     */
+    template <typename Traits>
+    class StaticOctreeBase
+    {
+    public:
+#define WRITE_TRAITS                                                                                                   \
+    using DataPoint      = typename Traits::DataPoint;      /*!< DataPoint given by user via Traits                */  \
+    using Scalar         = typename DataPoint::Scalar;      /*!< Scalar given by user via DataPoint                */  \
+    using VectorType     = typename DataPoint::VectorType;  /*!< VectorType given by user via DataPoint            */  \
+    using IndexType      = typename Traits::IndexType;      /*!< Type used to index points into the PointContainer */  \
+    using NodeIndexType  = typename Traits::IndexType;      /*!< Type used to index nodes into the NodeContainer   */  \
+    using NodeType       = typename Traits::NodeType;       /*!< Type of nodes used inside the Octree              */  \
+    using PointContainer = typename Traits::PointContainer; /*!< Container for DataPoint used inside the Octree    */  \
+    using IndexContainer = typename Traits::IndexContainer; /*!< Container for indices used inside the Octree      */  \
+    using NodeContainer  = typename Traits::NodeContainer;  /*!< Container for nodes used inside the Octree        */
+        WRITE_TRAITS
+
+        using LodQuery = OctreeLodQuery<Traits>;
+
+        enum
+        {
+            MAX_DEPTH = Traits::MAX_DEPTH
+        };
+
+        /// \brief Internal structure storing all the buffers used by the Octree
+        struct Buffers
+        {
+            PointContainer points;  ///< Buffer storing the input points (read only)
+            IndexContainer indices; ///< Buffer storing the indices of the points, sorted by node
+            NodeContainer nodes;    ///< Buffer storing the nodes, the root being the first one
+
+            size_t points_size{0};
+            size_t indices_size{0};
+            size_t nodes_size{0};
+
+            PONCA_MULTIARCH inline Buffers() = default;
+
+            PONCA_MULTIARCH inline Buffers(PointContainer _points, IndexContainer _indices, NodeContainer _nodes,
+                                           const size_t _points_size, const size_t _indices_size,
+                                           const size_t _nodes_size)
+                : points(_points), indices(_indices), nodes(_nodes), points_size(_points_size),
+                  indices_size(_indices_size), nodes_size(_nodes_size)
+            {
+            }
+        };
+
+    protected:
+        PONCA_MULTIARCH inline StaticOctreeBase() = default;
+
+    public:
+        /*! \brief Constructor that allows the use of prebuilt Octree containers.
+         *
+         * Each internal values of an Octree can be extracted using \ref `Octree::buffers()`
+         *
+         * \note This constructor can be used to avoid the building process, which is useful to transfer directly the
+         * Octree to the device in CUDA.
+         *
+         * \param _bufs Internal buffers of the Octree
+         */
+        PONCA_MULTIARCH inline StaticOctreeBase(Buffers& _bufs) : m_bufs(_bufs) {}
+
+        // Query -------------------------------------------------------------------
+    public:
+        /// \brief Computes a Query object to iterate over the nodes selecting the samples that are inside a given
+        /// radius, at a given level of detail.
+        ///
+        /// The returned object can be reset and reused with the () operator, to compute a new result
+        /// (also takes a position and a radius as parameters).
+        ///
+        /// \param point Position from where the query is evaluated
+        /// \param r Radius around where to search the nodes
+        /// \param maxDepth Maximal depth of the selected nodes
+        /// \param maxError Error below which a node is selected without descending to its children, see
+        /// OctreeNode::error. A negative value selects the nodes from their depth only.
+        /// \return The \ref LodQuery mutable object to iterate over the indices of the selected nodes.
+        PONCA_MULTIARCH [[nodiscard]] inline LodQuery lodNeighbors(const VectorType& point, Scalar r,
+                                                                   int maxDepth = MAX_DEPTH,
+                                                                   Scalar maxError = Scalar(-1)) const
+        {
+            return LodQuery(this, r, point, maxDepth, maxError);
+        }
+
+        /// \brief Computes a Query object to iterate over the nodes of a cut of the whole tree, at a given level of
+        /// detail.
+        ///
+        /// Same as #lodNeighbors with an infinite radius: the samples of the selected nodes are all the samples of
+        /// the Octree.
+        PONCA_MULTIARCH [[nodiscard]] inline LodQuery lodNodes(int maxDepth = MAX_DEPTH,
+                                                               Scalar maxError = Scalar(-1)) const
+        {
+            return LodQuery(this, std::numeric_limits<Scalar>::infinity(), VectorType::Zero(), maxDepth, maxError);
+        }
+
+        /// \brief Convenience function that provides an empty level of detail Query object.
+        ///
+        /// The returned object can be called with the arguments `(p, r)` to fetch the nodes selecting the samples
+        /// that are in range `r` of the position `p`, once its level of detail is set with LodQuery::setMaxDepth and
+        /// LodQuery::setMaxError.
+        ///
+        /// Same as `OctreeBase::lodNeighbors (VectorType::Zero(), 0)`.
+        ///
+        /// \return The empty \ref LodQuery mutable object
+        PONCA_MULTIARCH [[nodiscard]] inline LodQuery lodNeighborsQuery() const
+        {
+            return LodQuery(this, 0, VectorType::Zero(), MAX_DEPTH, Scalar(-1));
+        }
+
+        // Accessors ---------------------------------------------------------------
+    public:
+        //! \brief Get the number of nodes
+        PONCA_MULTIARCH [[nodiscard]] inline NodeIndexType nodeCount() const
+        {
+            return (NodeIndexType)m_bufs.nodes_size;
+        }
+        //! \brief Get the number of indexed points
+        PONCA_MULTIARCH [[nodiscard]] inline IndexType sampleCount() const { return (IndexType)m_bufs.indices_size; }
+        //! \brief Get the number of points
+        PONCA_MULTIARCH [[nodiscard]] inline IndexType pointCount() const { return (IndexType)m_bufs.points_size; }
+        //! \brief Get the internal point container
+        PONCA_MULTIARCH [[nodiscard]] inline const PointContainer& points() const { return m_bufs.points; };
+        //! \brief Get the internal node container
+        PONCA_MULTIARCH [[nodiscard]] inline const NodeContainer& nodes() const { return m_bufs.nodes; };
+        //! \brief Get the indices of the points, sorted by node
+        PONCA_MULTIARCH [[nodiscard]] inline const IndexContainer& samples() const { return m_bufs.indices; };
+        //! \brief Get the point of a sample
+        PONCA_MULTIARCH [[nodiscard]] inline const DataPoint& pointDataFromSample(IndexType sample_index) const
+        {
+            return m_bufs.points[m_bufs.indices[sample_index]];
+        }
+        //! \brief Get access to the internal buffer, for instance to prepare GPU binding
+        PONCA_MULTIARCH [[nodiscard]] inline const Buffers& buffers() const { return m_bufs; }
+
+        // Data --------------------------------------------------------------------
+    protected:
+        Buffers m_bufs; ///< Buffers used to store the Octree
+    };
+
+    /*!
+     * \brief Customizable base class for Octree datastructure
+     *
+     * \see Ponca::Octree
+     *
+     * \tparam Traits Traits type providing the types and constants used by the Octree. Must have the
+     * same interface as the default traits type.
+     *
+     * \see OctreeDefaultTraits for the trait interface documentation.
+     */
+    template <typename Traits>
+    class OctreeBase : public StaticOctreeBase<Traits>
+    {
+    public:
+        WRITE_TRAITS
+    private:
+        using Base = StaticOctreeBase<Traits>;
+
+        static constexpr int ChildCount = 1 << DataPoint::Dim;
+
+    public:
+        /// \brief Build an Octree from a set of points
+        ///
+        /// The nodes are split until they store at most `_leafSize` samples, or reach the depth `MAX_DEPTH`. Only the
+        /// non-empty children of a node are created.
+        ///
+        /// \param _points Input points
+        /// \param _leafSize Maximal number of samples of the leaves, except at the maximal depth
+        ///
+        /// \warning Stores a copy of the points
+        PONCA_MULTIARCH_HOST inline OctreeBase(PointContainer _points, IndexType _leafSize = 16)
+        {
+            PONCA_ASSERT(_leafSize > 0);
+            const IndexType size = IndexType(_points.size());
+
+            auto& bufs       = Base::m_bufs;
+            bufs.points      = std::move(_points);
+            bufs.points_size = size;
+            bufs.indices.resize(size);
+            bufs.indices_size = size;
+            std::iota(std::begin(bufs.indices), std::end(bufs.indices), IndexType(0));
+            bufs.nodes.clear();
+
+            if (size > 0)
+            {
+                // Bounding cube of the points
+                VectorType aabbMin = bufs.points[0].pos(), aabbMax = bufs.points[0].pos();
+                for (IndexType i = 1; i < size; ++i)
+                {
+                    aabbMin = aabbMin.cwiseMin(bufs.points[i].pos());
+                    aabbMax = aabbMax.cwiseMax(bufs.points[i].pos());
+                }
+                const Scalar halfSize = Scalar(0.5) * (aabbMax - aabbMin).maxCoeff();
+
+                bufs.nodes.emplace_back();
+                bufs.nodes[0].configure_range(0, size, 0);
+                std::vector<IndexType> buffer(size);
+                buildRec(0, Scalar(0.5) * (aabbMin + aabbMax), halfSize, _leafSize, buffer);
+            }
+            bufs.nodes_size = bufs.nodes.size();
+        }
+
+    private:
+        /// \brief Split a node in the octants of its cube, and compute its aggregates from its samples if it is a leaf,
+        /// or from its children otherwise
+        /// \param _center Center of the cube of the node
+        /// \param _halfSize Half the size of the cube of the node
+        PONCA_MULTIARCH_HOST inline void buildRec(NodeIndexType _nodeId, const VectorType& _center, Scalar _halfSize,
+                                                  IndexType _leafSize, std::vector<IndexType>& _buffer)
+        {
+            auto& bufs            = Base::m_bufs;
+            const IndexType start = bufs.nodes[_nodeId].sample_start();
+            const IndexType size  = bufs.nodes[_nodeId].sample_size();
+            const int depth       = bufs.nodes[_nodeId].depth();
+            if (size <= _leafSize || depth >= Base::MAX_DEPTH)
+            {
+                bufs.nodes[_nodeId].configure_samples(bufs.points, bufs.indices);
+                return;
+            }
+
+            // Counting sort of the samples by octant: bit `d` of the octant is set when the sample is above the
+            // center along the dimension `d`
+            const auto octant = [&](IndexType _i) {
+                const VectorType& p = bufs.points[bufs.indices[_i]].pos();
+                int o               = 0;
+                for (int d = 0; d < DataPoint::Dim; ++d)
+                    o |= int(p[d] > _center[d]) << d;
+                return o;
+            };
+            std::array<IndexType, ChildCount + 1> offsets{};
+            for (IndexType i = start; i < start + size; ++i)
+                ++offsets[octant(i) + 1];
+            for (int o = 0; o < ChildCount; ++o)
+                offsets[o + 1] += offsets[o];
+            std::array<IndexType, ChildCount> cursor;
+            std::copy(offsets.begin(), offsets.end() - 1, cursor.begin());
+            for (IndexType i = start; i < start + size; ++i)
+                _buffer[cursor[octant(i)]++] = bufs.indices[i];
+            std::copy(_buffer.begin(), _buffer.begin() + size, std::begin(bufs.indices) + start);
+
+            // The non-empty children are stored contiguously
+            const NodeIndexType firstChild = NodeIndexType(bufs.nodes.size());
+            std::array<int, ChildCount> octants;
+            int childCount = 0;
+            for (int o = 0; o < ChildCount; ++o)
+            {
+                if (offsets[o + 1] == offsets[o])
+                    continue;
+                octants[childCount] = o;
+                bufs.nodes.emplace_back();
+                bufs.nodes.back().configure_range(start + offsets[o], offsets[o + 1] - offsets[o], depth + 1);
+                ++childCount;
+            }
+            bufs.nodes[_nodeId].configure_inner(firstChild, childCount);
+
+            const Scalar childHalfSize = Scalar(0.5) * _halfSize;
+            for (int c = 0; c < childCount; ++c)
+            {
+                VectorType childCenter = _center;
+                for (int d = 0; d < DataPoint::Dim; ++d)
+                    childCenter[d] += (octants[c] >> d) & 1 ? childHalfSize : -childHalfSize;
+                buildRec(firstChild + c, childCenter, childHalfSize, _leafSize, _buffer);
+            }
+            bufs.nodes[_nodeId].configure_children_samples(bufs.points, bufs.indices, bufs.nodes);
+        }
+    };
+
+} // namespace Ponca
+
+#undef WRITE_TRAITS
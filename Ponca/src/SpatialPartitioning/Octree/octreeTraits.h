@@ -0,0 +1,228 @@
+/*
+ This Source Code Form is subject to the terms of the Mozilla Public
+ License, v. 2.0. If a copy of the MPL was not distributed with this
+ file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+#pragma once
+
+#include "../defines.h"
+#include "../KdTree/kdTreeMomentNode.h"
+
+#include <Eigen/Eigenvalues>
+#include <Eigen/Geometry>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+namespace Ponca
+{
+    /*!
+     * \brief Octree node storing the range of its samples, their bounding box and their aggregated moments
+     *
+     * The samples of a node are stored contiguously in the samples of the Octree, and its children are stored
+     * contiguously in its nodes. Only the non-empty children of a node are created.
+     *
+     * The aggregates of the leaves are computed from their samples (see #configure_samples), and the ones of the
+     * inner nodes from the aggregates of their children (see #configure_children_samples): the construction cost of
+     * the aggregates is linear in the number of samples.
+     *
+     * \tparam Index Type used to index the samples and the nodes
+     * \tparam DataPoint Point type
+     */
+    template <typename Index, typename DataPoint>
+    class OctreeNode
+    {
+    public:
+        using Scalar     = typename DataPoint::Scalar;
+        using VectorType = typename DataPoint::VectorType;
+        using AabbType   = Eigen::AlignedBox<Scalar, DataPoint::Dim>;
+        using Moments    = KdTreeNodeMoments<DataPoint>;
+
+        /// \brief Is the node a leaf ?
+        PONCA_MULTIARCH [[nodiscard]] inline bool is_leaf() const { return m_childCount == 0; }
+        /// \brief Index of the first sample of the node
+        PONCA_MULTIARCH [[nodiscard]] inline Index sample_start() const { return m_start; }
+        /// \brief Number of samples of the node
+        PONCA_MULTIARCH [[nodiscard]] inline Index sample_size() const { return m_size; }
+        /// \brief Index of the first child of the node, the others follow it
+        PONCA_MULTIARCH [[nodiscard]] inline Index first_child_id() const { return m_firstChild; }
+        /// \brief Number of children of the node, between 0 for the leaves and \f$ 2^{Dim} \f$
+        PONCA_MULTIARCH [[nodiscard]] inline int child_count() const { return m_childCount; }
+        /// \brief Depth of the node, 0 for the root
+        PONCA_MULTIARCH [[nodiscard]] inline int depth() const { return m_depth; }
+        /// \brief Bounding box of the samples of the node
+        PONCA_MULTIARCH [[nodiscard]] inline const AabbType& aabb() const { return m_aabb; }
+        /// \brief Moments of the samples of the node
+        PONCA_MULTIARCH [[nodiscard]] inline const Moments& moments() const { return m_moments; }
+        /// \brief Root mean square distance between the samples and their least-squares hyperplane
+        ///
+        /// Measures the error made when the samples of the node are approximated by a planar patch.
+        PONCA_MULTIARCH [[nodiscard]] inline Scalar error() const { return m_error; }
+        /// \brief Index of a sample close to the centroid of the node, used as its representative
+        ///
+        /// The sample closest to the centroid for the leaves, and the representative of a child closest to the
+        /// centroid for the inner nodes.
+        PONCA_MULTIARCH [[nodiscard]] inline Index representative() const { return m_representative; }
+
+        /// \brief Set the range of samples of the node and their depth, see OctreeBase
+        PONCA_MULTIARCH inline void configure_range(Index start, Index size, int depth)
+        {
+            m_start = start;
+            m_size  = size;
+            m_depth = depth;
+        }
+
+        /// \brief Set the range of the children of an inner node, see OctreeBase
+        ///
+        /// Called during the construction, before the children are built.
+        PONCA_MULTIARCH inline void configure_inner(Index firstChild, int childCount)
+        {
+            m_firstChild = firstChild;
+            m_childCount = childCount;
+        }
+
+        /// \brief Compute the bounding box, the moments, the error and the representative of the samples of a leaf
+        ///
+        /// Called during the construction, for the leaves only.
+        template <typename PointContainer, typename IndexContainer>
+        PONCA_MULTIARCH_HOST void configure_samples(const PointContainer& points, const IndexContainer& indices)
+        {
+            m_moments.compute(points, indices, m_start, m_size);
+            m_aabb.setEmpty();
+            m_representative = m_start;
+
+            Scalar closest = std::numeric_limits<Scalar>::infinity();
+            for (Index i = m_start; i < m_start + m_size; ++i)
+            {
+                const VectorType& p = points[indices[i]].pos();
+                m_aabb.extend(p);
+                const Scalar d = (p - m_moments.centroid).squaredNorm();
+                if (d < closest)
+                {
+                    closest          = d;
+                    m_representative = i;
+                }
+            }
+            configure_error();
+        }
+
+        /// \brief Compute the bounding box, the moments, the error and the representative of an inner node from the
+        /// ones of its children
+        ///
+        /// Called during the construction, once the children of the node are built.
+        /// \param points Points of the Octree
+        /// \param indices Samples of the Octree
+        /// \param nodes Nodes of the Octree, storing the children of the node
+        template <typename PointContainer, typename IndexContainer, typename NodeContainer>
+        PONCA_MULTIARCH_HOST void configure_children_samples(const PointContainer& points,
+                                                             const IndexContainer& indices, const NodeContainer& nodes)
+        {
+            m_moments = Moments();
+            m_aabb.setEmpty();
+            for (int c = 0; c < m_childCount; ++c)
+            {
+                const OctreeNode& child = nodes[m_firstChild + c];
+                m_moments.merge(child.m_moments);
+                m_aabb.extend(child.m_aabb);
+            }
+
+            Scalar closest = std::numeric_limits<Scalar>::infinity();
+            for (int c = 0; c < m_childCount; ++c)
+            {
+                const OctreeNode& child = nodes[m_firstChild + c];
+                const Scalar d = (points[indices[child.m_representative]].pos() - m_moments.centroid).squaredNorm();
+                if (d < closest)
+                {
+                    closest          = d;
+                    m_representative = child.m_representative;
+                }
+            }
+            configure_error();
+        }
+
+    private:
+        /// \brief Compute the error of the node from its moments: the eigenvalues of the scatter matrix are sorted in
+        /// increasing order
+        PONCA_MULTIARCH_HOST void configure_error()
+        {
+            m_error = Scalar(0);
+            if (m_size == 0)
+                return;
+            Eigen::SelfAdjointEigenSolver<typename Moments::MatrixType> solver(m_moments.scatter,
+                                                                               Eigen::EigenvaluesOnly);
+            m_error = std::sqrt(std::max(solver.eigenvalues()(0), Scalar(0)) / Scalar(m_size));
+        }
+
+        AabbType m_aabb;
+        Moments m_moments;
+        Scalar m_error{0};
+        Index m_start{0};
+        Index m_size{0};
+        Index m_firstChild{0};
+        Index m_representative{0};
+        int m_childCount{0};
+        int m_depth{0};
+    };
+
+    /*!
+     * \brief The default traits type used by the Octree.
+     */
+    template <typename _DataPoint>
+    struct OctreeDefaultTraits
+    {
+        enum
+        {
+            /*!
+             * \brief The maximum depth of the octree: the nodes of this depth are leaves, whatever their number of
+             * samples.
+             */
+            MAX_DEPTH = 21
+        };
+        /*!
+         * \brief The type used to store point data.
+         *
+         * Must provide `Scalar` and `VectorType` aliases, a `Dim` constant and a `pos()` function.
+         */
+        using DataPoint = _DataPoint;
+
+        // Containers
+        using IndexType      = int;
+        using NodeType       = OctreeNode<IndexType, DataPoint>;
+        using PointContainer = std::vector<DataPoint>;
+        using IndexContainer = std::vector<IndexType>;
+        using NodeContainer  = std::vector<NodeType>;
+    };
+
+    /*!
+     * \brief Variant to the Octree Traits type that uses pointers as internal storage instead of an STL-like
+     * container.
+     */
+    template <typename _DataPoint>
+    struct OctreePointerTraits
+    {
+        enum
+        {
+            /*!
+             * \brief The maximum depth of the octree: the nodes of this depth are leaves, whatever their number of
+             * samples.
+             */
+            MAX_DEPTH = 21
+        };
+        /*!
+         * \brief The type used to store point data.
+         *
+         * Must provide `Scalar` and `VectorType` aliases, a `Dim` constant and a `pos()` function.
+         */
+        using DataPoint = _DataPoint;
+
+        // Containers
+        using IndexType      = int;
+        using NodeType       = OctreeNode<IndexType, DataPoint>;
+        using PointContainer = DataPoint*;
+        using IndexContainer = IndexType*;
+        using NodeContainer  = NodeType*;
+    };
+} // namespace Ponca
@@ -0,0 +1,127 @@
+/*
+ This Source Code Form is subject to the terms of the Mozilla Public
+ License, v. 2.0. If a copy of the MPL was not distributed with this
+ file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+#pragma once
+
+#include "../../query.h"
+#include "../../KdTree/Iterator/kdTreeKNearestIterator.h"
+
+#include <functional>
+#include <queue>
+#include <utility>
+#include <vector>
+
+namespace Ponca
+{
+    template <typename Traits>
+    class TiledKdTreeBase; // Need forward declaration to avoid mutual inclusion
+
+    /*!
+     * \brief Extension of the Query class that allows to read the result of a k-nearest neighbors search on the
+     * TiledKdTree.
+     *
+     * Output result of a `TiledKdTreeBase::kNearestNeighbors` query request: iterates over the global indices of the
+     * neighbors (see TiledKdTreeBase::pointData).
+     *
+     * The tiles are visited by increasing distance to the query, each one being searched with its own KdTree, until
+     * the next tile is farther than the k-th neighbor: only the tiles that may contain one of the neighbors are loaded.
+     * Less than k neighbors are returned when the TiledKdTree stores less than k points.
+     *
+     * \see TiledKdTreeBase
+     */
+    template <typename Traits>
+    class TiledKdTreeKNearestQuery
+        : public KNearestPointQuery<typename Traits::IndexType, typename Traits::DataPoint, Traits::MAX_KNN_SIZE>
+    {
+    public:
+        using DataPoint  = typename Traits::DataPoint;
+        using IndexType  = typename Traits::IndexType;
+        using Scalar     = typename DataPoint::Scalar;
+        using VectorType = typename DataPoint::VectorType;
+        using QueryType  = KNearestPointQuery<IndexType, DataPoint, Traits::MAX_KNN_SIZE>;
+        using Self       = TiledKdTreeKNearestQuery<Traits>;
+        using Iterator   = KdTreeKNearestIterator<IndexType, DataPoint, Traits::MAX_KNN_SIZE>;
+
+        PONCA_MULTIARCH_HOST inline TiledKdTreeKNearestQuery(const TiledKdTreeBase<Traits>* tree, IndexType k,
+                                                             const VectorType& point)
+            : QueryType(k, point), m_tree(tree)
+        {
+        }
+
+        /// \brief Call the k-nearest neighbors query with new input and neighbor number parameters.
+        PONCA_MULTIARCH_HOST inline Self& operator()(const VectorType& point, IndexType k)
+        {
+            return QueryType::template operator()<Self>(point, k);
+        }
+
+        /// \brief Call the k-nearest neighbors query with new input parameter.
+        PONCA_MULTIARCH_HOST inline Self& operator()(const VectorType& point)
+        {
+            return QueryType::template operator()<Self>(point);
+        }
+
+        /// \brief Returns an iterator to the beginning of the k-nearest neighbors query.
+        PONCA_MULTIARCH_HOST inline Iterator begin()
+        {
+            // The queue is not initialized with a sentinel, as the tiles may store less than k points
+            QueryType::m_queue.clear();
+            search();
+            return Iterator(QueryType::m_queue.begin());
+        }
+
+        /// \brief Returns an iterator to the end of the k-nearest neighbors query.
+        PONCA_MULTIARCH_HOST inline Iterator end() { return Iterator(QueryType::m_queue.end()); }
+
+    protected:
+        PONCA_MULTIARCH_HOST inline void search()
+        {
+            const auto& nodes = m_tree->tileNodes();
+            auto& queue       = QueryType::m_queue;
+            if (nodes.empty() || queue.capacity() == 0)
+                return;
+
+            // Nodes of the tree over the tiles, sorted by increasing distance to the query
+            using Candidate         = std::pair<Scalar, int>;
+            const VectorType& point = QueryType::input();
+            std::priority_queue<Candidate, std::vector<Candidate>, std::greater<Candidate>> candidates;
+            candidates.push({nodes[0].aabb.squaredExteriorDistance(point), 0});
+            while (!candidates.empty())
+            {
+                const auto [distance, id] = candidates.top();
+                candidates.pop();
+                // The remaining tiles are farther than the k-th neighbor
+                if (queue.full() && distance >= queue.bottom().squared_distance)
+                    return;
+
+                const auto& node = nodes[id];
+                if (node.isLeaf())
+                {
+                    const auto tile        = m_tree->tile(node.tile);
+                    const IndexType offset = m_tree->tileFirstIndex(node.tile);
+                    auto local             = tile->tree().kNearestNeighbors(point, int(queue.capacity()));
+                    for (auto it = local.begin(); it != local.end(); ++it)
+                    {
+                        // The KdTree query returns a sentinel when the tile stores less than k points
+                        if (*it < 0)
+                            continue;
+                        const Scalar d = it.squaredDistance();
+                        if (!queue.full() || d < queue.bottom().squared_distance)
+                            queue.push({offset + IndexType(*it), d});
+                    }
+                }
+                else
+                {
+                    for (int c = 0; c < 2; ++c)
+                        candidates.push(
+                            {nodes[node.firstChild + c].aabb.squaredExteriorDistance(point), node.firstChild + c});
+                }
+            }
+        }
+
+    protected:
+        const TiledKdTreeBase<Traits>* m_tree{nullptr};
+    };
+} // namespace Ponca
@@ -0,0 +1,111 @@
+/*
+ This Source Code Form is subject to the terms of the Mozilla Public
+ License, v. 2.0. If a copy of the MPL was not distributed with this
+ file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+#pragma once
+
+#include "../../query.h"
+#include "../../../Common/Containers/stack.h"
+
+#include <vector>
+
+namespace Ponca
+{
+    template <typename Traits>
+    class TiledKdTreeBase; // Need forward declaration to avoid mutual inclusion
+
+    /*!
+     * \brief Extension of the Query class that allows to read the result of a range neighbors search on the
+     * TiledKdTree.
+     *
+     * Output result of a `TiledKdTreeBase::rangeNeighbors` query request: iterates over the global indices of the
+     * neighbors (see TiledKdTreeBase::pointData).
+     *
+     * The tree over the tiles selects the tiles intersecting the query ball, which are loaded through the tile cache
+     * and searched with their own KdTree. The neighbors are gathered when the iteration begins, so that the tiles are
+     * not kept in memory while the results are read.
+     *
+     * \see TiledKdTreeBase
+     */
+    template <typename Traits>
+    class TiledKdTreeRangeQuery : public RangePointQuery<typename Traits::IndexType, typename Traits::DataPoint>
+    {
+    public:
+        using DataPoint  = typename Traits::DataPoint;
+        using IndexType  = typename Traits::IndexType;
+        using Scalar     = typename DataPoint::Scalar;
+        using VectorType = typename DataPoint::VectorType;
+        using QueryType  = RangePointQuery<IndexType, DataPoint>;
+        using Self       = TiledKdTreeRangeQuery<Traits>;
+        using Iterator   = typename std::vector<IndexType>::const_iterator;
+
+        PONCA_MULTIARCH_HOST inline TiledKdTreeRangeQuery(const TiledKdTreeBase<Traits>* tree, Scalar radius,
+                                                          const VectorType& point)
+            : QueryType(radius, point), m_tree(tree)
+        {
+        }
+
+        /// \brief Call the range neighbors query with new input and radius parameters.
+        PONCA_MULTIARCH_HOST inline Self& operator()(const VectorType& point, Scalar radius)
+        {
+            return QueryType::template operator()<Self>(point, radius);
+        }
+
+        /// \brief Call the range neighbors query with new input parameter.
+        PONCA_MULTIARCH_HOST inline Self& operator()(const VectorType& point)
+        {
+            return QueryType::template operator()<Self>(point);
+        }
+
+        /// \brief Returns an iterator to the beginning of the range neighbors query.
+        PONCA_MULTIARCH_HOST inline Iterator begin()
+        {
+            QueryType::reset();
+            m_results.clear();
+            search();
+            return m_results.cbegin();
+        }
+
+        /// \brief Returns an iterator to the end of the range neighbors query.
+        PONCA_MULTIARCH_HOST inline Iterator end() const { return m_results.cend(); }
+
+    protected:
+        PONCA_MULTIARCH_HOST inline void search()
+        {
+            const auto& nodes = m_tree->tileNodes();
+            if (nodes.empty())
+                return;
+
+            const VectorType& point = QueryType::input();
+            const Scalar radius     = QueryType::radius();
+            Stack<int, 2 * Traits::MAX_DEPTH> stack;
+            stack.push(0);
+            while (!stack.empty())
+            {
+                const auto& node = nodes[stack.top()];
+                stack.pop();
+                if (node.aabb.squaredExteriorDistance(point) > QueryType::squaredRadius())
+                    continue;
+
+                if (node.isLeaf())
+                {
+                    const auto tile        = m_tree->tile(node.tile);
+                    const IndexType offset = m_tree->tileFirstIndex(node.tile);
+                    for (const auto i : tile->tree().rangeNeighbors(point, radius))
+                        m_results.push_back(offset + IndexType(i));
+                }
+                else
+                {
+                    stack.push(node.firstChild);
+                    stack.push(node.firstChild + 1);
+                }
+            }
+        }
+
+    protected:
+        const TiledKdTreeBase<Traits>* m_tree{nullptr};
+        std::vector<IndexType> m_results; ///< Global indices of the neighbors
+    };
+} // namespace Ponca
@@ -0,0 +1,233 @@
+/*
+ This Source Code Form is subject to the terms of the Mozilla Public
+ License, v. 2.0. If a copy of the MPL was not distributed with this
+ file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+#pragma once
+
+#include "../KdTree/kdTree.h"
+
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+
+#if defined(_WIN32)
+#    include <vector>
+#else
+#    include <fcntl.h>
+#    include <sys/mman.h>
+#    include <sys/stat.h>
+#    include <unistd.h>
+#endif
+
+namespace Ponca
+{
+#ifndef PARSED_WITH_DOXYGEN
+    namespace internal
+    {
+        /// \brief Header of a tile file, followed by the points, the nodes and the indices of its KdTree
+        struct KdTreeTileHeader
+        {
+            char magic[8];
+            std::uint32_t version;
+            std::uint32_t dim;
+            std::uint32_t pointBytes;
+            std::uint32_t nodeBytes;
+            std::uint32_t indexBytes;
+            std::uint32_t reserved;
+            std::uint64_t pointsSize;
+            std::uint64_t nodesSize;
+            std::uint64_t indicesSize;
+        };
+
+        inline constexpr char KdTreeTileMagic[8]           = {'P', 'O', 'N', 'C', 'A', 'K', 'D', 'T'};
+        inline constexpr std::uint32_t KdTreeTileVersion   = 1;
+        /// The buffers are aligned in the file, so that they are aligned in the mapped memory
+        inline constexpr std::uint64_t KdTreeTileAlignment = 64;
+
+        inline std::uint64_t alignTileOffset(std::uint64_t _offset)
+        {
+            return (_offset + KdTreeTileAlignment - 1) / KdTreeTileAlignment * KdTreeTileAlignment;
+        }
+
+        /// \brief Can the objects of type `T` be written to a file and read back as raw bytes ?
+        ///
+        /// The Eigen fixed-size types are not trivially copyable since they declare their copy constructors, but they
+        /// own no resource: the types with a trivial destructor are accepted.
+        template <typename T>
+        inline constexpr bool isRawStorable = std::is_trivially_copyable_v<T> || std::is_trivially_destructible_v<T>;
+    } // namespace internal
+#endif
+
+    /*!
+     * \brief KdTree of a tile of a TiledKdTree, read from a memory-mapped file
+     *
+     * The file stores the buffers of the KdTree (see StaticKdTreeBase::buffers) as raw bytes: the tile is used in place
+     * by a StaticKdTreeBase using pointer traits, and the operating system only loads the pages that are read by the
+     * queries. On platforms without `mmap`, the file is read into memory.
+     *
+     * \see writeKdTreeTile to write the file of a tile
+     * \tparam Traits Traits type of the TiledKdTree, see TiledKdTreeDefaultTraits
+     */
+    template <typename Traits>
+    class KdTreeTile
+    {
+    public:
+        using DataPoint = typename Traits::DataPoint;
+        using TreeType  = StaticKdTreeBase<typename Traits::TileTraits>;
+        using NodeType  = typename TreeType::NodeType;
+        using IndexType = typename TreeType::IndexType;
+
+        /// \brief Map the file of a tile
+        /// \throw std::runtime_error when the file cannot be read, or was not written for the same types
+        PONCA_MULTIARCH_HOST inline explicit KdTreeTile(const std::string& _path)
+        {
+#if defined(_WIN32)
+            std::ifstream file(_path, std::ios::binary | std::ios::ate);
+            if (!file)
+                throw std::runtime_error("KdTreeTile: cannot open " + _path);
+            m_size = std::size_t(file.tellg());
+            m_buffer.resize((m_size + sizeof(std::max_align_t) - 1) / sizeof(std::max_align_t));
+            file.seekg(0);
+            file.read(reinterpret_cast<char*>(m_buffer.data()), std::streamsize(m_size));
+            m_data = reinterpret_cast<char*>(m_buffer.data());
+#else
+            const int fd = ::open(_path.c_str(), O_RDONLY);
+            if (fd < 0)
+                throw std::runtime_error("KdTreeTile: cannot open " + _path);
+            struct stat status;
+            if (::fstat(fd, &status) != 0 || status.st_size == 0)
+            {
+                ::close(fd);
+                throw std::runtime_error("KdTreeTile: invalid file " + _path);
+            }
+            m_size       = std::size_t(status.st_size);
+            void* mapped = ::mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            ::close(fd); // The mapping keeps a reference to the file
+            if (mapped == MAP_FAILED)
+                throw std::runtime_error("KdTreeTile: cannot map " + _path);
+            m_data = static_cast<char*>(mapped);
+#endif
+            try
+            {
+                setupTree(_path);
+            }
+            catch (...)
+            {
+                unmap();
+                throw;
+            }
+        }
+
+        PONCA_MULTIARCH_HOST inline ~KdTreeTile() { unmap(); }
+
+        KdTreeTile(const KdTreeTile&)            = delete;
+        KdTreeTile& operator=(const KdTreeTile&) = delete;
+
+        /// \brief KdTree of the tile, whose buffers point to the mapped file
+        PONCA_MULTIARCH_HOST [[nodiscard]] inline const TreeType& tree() const { return *m_tree; }
+        /// \brief Size of the file of the tile, in bytes
+        PONCA_MULTIARCH_HOST [[nodiscard]] inline std::size_t byteSize() const { return m_size; }
+
+    private:
+        PONCA_MULTIARCH_HOST inline void setupTree(const std::string& _path)
+        {
+            internal::KdTreeTileHeader header;
+            if (m_size < sizeof(header))
+                throw std::runtime_error("KdTreeTile: invalid file " + _path);
+            std::memcpy(&header, m_data, sizeof(header));
+            if (std::memcmp(header.magic, internal::KdTreeTileMagic, sizeof(header.magic)) != 0 ||
+                header.version != internal::KdTreeTileVersion || header.dim != std::uint32_t(DataPoint::Dim) ||
+                header.pointBytes != sizeof(DataPoint) || header.nodeBytes != sizeof(NodeType) ||
+                header.indexBytes != sizeof(IndexType))
+                throw std::runtime_error("KdTreeTile: incompatible file " + _path);
+
+            using internal::alignTileOffset;
+            const std::uint64_t pointsOffset  = alignTileOffset(sizeof(header));
+            const std::uint64_t nodesOffset   = alignTileOffset(pointsOffset + header.pointsSize * sizeof(DataPoint));
+            const std::uint64_t indicesOffset = alignTileOffset(nodesOffset + header.nodesSize * sizeof(NodeType));
+            if (indicesOffset + header.indicesSize * sizeof(IndexType) > m_size)
+                throw std::runtime_error("KdTreeTile: truncated file " + _path);
+
+            typename TreeType::Buffers buffers(
+                reinterpret_cast<DataPoint*>(m_data + pointsOffset), reinterpret_cast<NodeType*>(m_data + nodesOffset),
+                reinterpret_cast<IndexType*>(m_data + indicesOffset), std::size_t(header.pointsSize),
+                std::size_t(header.nodesSize), std::size_t(header.indicesSize));
+            m_tree.emplace(buffers);
+        }
+
+        PONCA_MULTIARCH_HOST inline void unmap()
+        {
+#if !defined(_WIN32)
+            if (m_data != nullptr)
+                ::munmap(m_data, m_size);
+#endif
+            m_data = nullptr;
+        }
+
+        char* m_data{nullptr};
+        std::size_t m_size{0};
+#if defined(_WIN32)
+        std::vector<std::max_align_t> m_buffer;
+#endif
+        std::optional<TreeType> m_tree; ///< Set once the header is checked
+    };
+
+    /*!
+     * \brief Write the buffers of a KdTree to a tile file, read back by KdTreeTile
+     *
+     * \param _path Path of the file
+     * \param _tree KdTree of the tile, whose node type must be the one of `Traits::TileTraits`
+     * \throw std::runtime_error when the file cannot be written
+     */
+    template <typename Traits, typename Tree>
+    PONCA_MULTIARCH_HOST inline void writeKdTreeTile(const std::string& _path, const Tree& _tree)
+    {
+        using DataPoint = typename Traits::DataPoint;
+        using NodeType  = typename KdTreeTile<Traits>::NodeType;
+        using IndexType = typename KdTreeTile<Traits>::IndexType;
+        static_assert(std::is_same_v<typename Tree::NodeType, NodeType>,
+                      "The tile KdTree must use the node type of the TileTraits");
+        static_assert(internal::isRawStorable<DataPoint>,
+                      "The points of the tiles are written as raw bytes, and must own no resource");
+
+        const auto& buffers = _tree.buffers();
+        internal::KdTreeTileHeader header{};
+        std::memcpy(header.magic, internal::KdTreeTileMagic, sizeof(header.magic));
+        header.version     = internal::KdTreeTileVersion;
+        header.dim         = DataPoint::Dim;
+        header.pointBytes  = sizeof(DataPoint);
+        header.nodeBytes   = sizeof(NodeType);
+        header.indexBytes  = sizeof(IndexType);
+        header.pointsSize  = buffers.points_size;
+        header.nodesSize   = buffers.nodes_size;
+        header.indicesSize = buffers.indices_size;
+
+        std::ofstream file(_path, std::ios::binary | std::ios::trunc);
+        if (!file)
+            throw std::runtime_error("writeKdTreeTile: cannot open " + _path);
+
+        std::uint64_t offset = 0;
+        const auto write     = [&file, &offset](const void* _data, std::uint64_t _bytes) {
+            // Pad up to the aligned offset of the buffer
+            static const char padding[internal::KdTreeTileAlignment] = {};
+            const std::uint64_t aligned = internal::alignTileOffset(offset);
+            file.write(padding, std::streamsize(aligned - offset));
+            file.write(static_cast<const char*>(_data), std::streamsize(_bytes));
+            offset = aligned + _bytes;
+        };
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        offset = sizeof(header);
+        write(buffers.points.data(), header.pointsSize * sizeof(DataPoint));
+        write(buffers.nodes.data(), header.nodesSize * sizeof(NodeType));
+        write(buffers.indices.data(), header.indicesSize * sizeof(IndexType));
+        if (!file)
+            throw std::runtime_error("writeKdTreeTile: cannot write " + _path);
+    }
+} // namespace Ponca
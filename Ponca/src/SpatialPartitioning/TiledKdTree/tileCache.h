@@ -0,0 +1,165 @@
+/*
+ This Source Code Form is subject to the terms of the Mozilla Public
+ License, v. 2.0. If a copy of the MPL was not distributed with this
+ file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+#pragma once
+
+#include "../defines.h"
+
+#include <cstddef>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+
+namespace Ponca
+{
+    /*!
+     * \brief Least recently used cache of tiles, bounded by a memory budget
+     *
+     * The tiles are loaded on demand by a user-given loader, and the least recently used ones are released once the
+     * total size of the cached tiles exceeds the budget. The most recently used tile is always kept, even when it is
+     * larger than the budget.
+     *
+     * The tiles are shared with the callers: a released tile stays valid until the last handle to it is destroyed, so
+     * that the queries running in other threads are not affected by the evictions. The cache is thread safe, and the
+     * tiles are loaded outside of its lock: the requests for the other tiles are not blocked by a loading tile.
+     *
+     * \tparam Tile Type of the tiles, providing a `byteSize()` function, e.g. KdTreeTile
+     */
+    template <typename Tile>
+    class TileCache
+    {
+    public:
+        using TileHandle = std::shared_ptr<const Tile>;
+
+        /// \param _budget Maximal total size of the cached tiles, in bytes
+        PONCA_MULTIARCH_HOST inline explicit TileCache(std::size_t _budget) : m_budget(_budget) {}
+
+        /*!
+         * \brief Get a tile, loading it when it is not cached
+         *
+         * The loader runs without holding the lock of the cache, once per tile: the concurrent requests for the same
+         * tile wait for its loading, and are counted as hits. When the loader throws, the exception is propagated and
+         * the next request for the tile loads it again.
+         *
+         * \param _id Identifier of the tile
+         * \param _load Functor returning a `std::shared_ptr<Tile>` to the loaded tile
+         */
+        template <typename Loader>
+        PONCA_MULTIARCH_HOST inline TileHandle get(std::size_t _id, Loader&& _load)
+        {
+            std::shared_ptr<Slot> slot;
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                const auto found = m_entries.find(_id);
+                if (found != m_entries.end())
+                {
+                    ++m_hits;
+                    // Move the tile to the front of the recency list
+                    m_recency.splice(m_recency.begin(), m_recency, found->second);
+                    slot = found->second->second;
+                }
+                else
+                {
+                    ++m_misses;
+                    slot = std::make_shared<Slot>();
+                    m_recency.emplace_front(_id, slot);
+                    m_entries.emplace(_id, m_recency.begin());
+                }
+            }
+
+            bool loaded = false;
+            std::call_once(slot->once, [&]() {
+                slot->tile = _load();
+                loaded     = true;
+            });
+            if (!loaded)
+                return slot->tile;
+
+            std::lock_guard<std::mutex> lock(m_mutex);
+            // The tile is only accounted for when it was not released while loading
+            const auto found = m_entries.find(_id);
+            if (found != m_entries.end() && found->second->second == slot)
+            {
+                slot->bytes = slot->tile->byteSize();
+                m_residentBytes += slot->bytes;
+                while (m_residentBytes > m_budget && m_recency.size() > 1)
+                {
+                    const auto& last = m_recency.back();
+                    m_residentBytes -= last.second->bytes;
+                    m_entries.erase(last.first);
+                    m_recency.pop_back();
+                    ++m_evictions;
+                }
+            }
+            return slot->tile;
+        }
+
+        /// \brief Release all the cached tiles
+        PONCA_MULTIARCH_HOST inline void clear()
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_entries.clear();
+            m_recency.clear();
+            m_residentBytes = 0;
+        }
+
+        /// \brief Maximal total size of the cached tiles, in bytes
+        PONCA_MULTIARCH_HOST [[nodiscard]] inline std::size_t budget() const { return m_budget; }
+        /// \brief Total size of the cached tiles, in bytes
+        PONCA_MULTIARCH_HOST [[nodiscard]] inline std::size_t residentBytes() const
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            return m_residentBytes;
+        }
+        /// \brief Number of cached tiles
+        PONCA_MULTIARCH_HOST [[nodiscard]] inline std::size_t size() const
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            return m_recency.size();
+        }
+        /// \brief Number of requests served from the cache
+        PONCA_MULTIARCH_HOST [[nodiscard]] inline std::size_t hits() const
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            return m_hits;
+        }
+        /// \brief Number of requests that loaded a tile
+        PONCA_MULTIARCH_HOST [[nodiscard]] inline std::size_t misses() const
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            return m_misses;
+        }
+        /// \brief Number of tiles released to respect the budget
+        PONCA_MULTIARCH_HOST [[nodiscard]] inline std::size_t evictions() const
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            return m_evictions;
+        }
+
+    private:
+        /// \brief Cached tile, loaded once by the first request
+        struct Slot
+        {
+            std::once_flag once;
+            TileHandle tile;
+            std::size_t bytes{0}; ///< Size accounted in the resident bytes, 0 while loading
+        };
+        using Entry = std::pair<std::size_t, std::shared_ptr<Slot>>;
+
+        std::size_t m_budget;
+        std::size_t m_residentBytes{0};
+        std::list<Entry> m_recency; ///< Cached tiles, the most recently used first
+        std::unordered_map<std::size_t, typename std::list<Entry>::iterator> m_entries;
+        mutable std::mutex m_mutex;
+
+        // Statistics
+        std::size_t m_hits{0};
+        std::size_t m_misses{0};
+        std::size_t m_evictions{0};
+    };
+} // namespace Ponca
@@ -0,0 +1,507 @@
+/*
+ This Source Code Form is subject to the terms of the Mozilla Public
+ License, v. 2.0. If a copy of the MPL was not distributed with this
+ file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+#pragma once
+
+#include "./tiledKdTreeTraits.h"
+#include "./kdTreeTile.h"
+#include "./tileCache.h"
+
+#include "Query/tiledKdTreeKNearestQuery.h"
+#include "Query/tiledKdTreeRangeQuery.h"
+
+#include "../KdTree/kdTree.h"
+
+#include <Eigen/Geometry>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace Ponca
+{
+    template <typename Traits>
+    class TiledKdTreeBase;
+    template <typename Traits>
+    class TiledKdTreeBuilderBase;
+
+    /*!
+     * \brief Public interface for TiledKdTree datastructure.
+     *
+     * Provides default implementation of the TiledKdTree
+     *
+     * \see TiledKdTreeDefaultTraits for the default trait interface documentation.
+     * \see TiledKdTreeBase for complete API
+     */
+    template <typename DataPoint>
+    using TiledKdTree = TiledKdTreeBase<TiledKdTreeDefaultTraits<DataPoint>>;
+
+    /*!
+     * \brief Public interface for the builder of the TiledKdTree datastructure.
+     *
+     * \see TiledKdTreeBuilderBase for complete API
+     */
+    template <typename DataPoint>
+    using TiledKdTreeBuilder = TiledKdTreeBuilderBase<TiledKdTreeDefaultTraits<DataPoint>>;
+
+#ifndef PARSED_WITH_DOXYGEN
+    namespace internal
+    {
+        inline constexpr char TiledKdTreeMagic[8]         = {'P', 'O', 'N', 'C', 'A', 'T', 'K', 'D'};
+        inline constexpr std::uint32_t TiledKdTreeVersion = 1;
+
+        /// \brief Header of the index file of a TiledKdTree, followed by the bounding box, the first global index and
+        /// the number of points of each tile
+        struct TiledKdTreeHeader
+        {
+            char magic[8];
+            std::uint32_t version;
+            std::uint32_t dim;
+            std::uint32_t scalarBytes;
+            std::uint32_t pointBytes;
+            std::uint64_t tileCount;
+        };
+    } // namespace internal
+#endif
+
+    /*!
+     * \brief Out-of-core KdTree, for point clouds larger than the memory
+     *
+     * The points are split in spatial tiles by a TiledKdTreeBuilderBase. Each tile is indexed by its own KdTree,
+     * stored in a file that is memory-mapped on demand (see KdTreeTile), and a binary tree over the bounding boxes of
+     * the tiles selects the tiles reached by the queries. The mapped tiles are kept in a least recently used cache
+     * bounded by a memory budget (see TileCache), so that only the tiles around the queries are resident.
+     *
+     * The range and k-nearest neighbors queries take a position, cross the tile boundaries transparently, and iterate
+     * over the **global indices** of the neighbors: the points of the tile `t` are numbered from `tileFirstIndex(t)`,
+     * in the order of the samples of the tile KdTree. Use #pointData to access a point from its global index, or
+     * #points to fit the neighbors with `fit.computeWithIds(tree.rangeNeighbors(p, r), tree.points())`.
+     *
+     * The queries can run concurrently: a tile evicted from the cache remains mapped until the queries using it end.
+     *
+     * \see TiledKdTreeDefaultTraits for the trait interface documentation.
+     */
+    template <typename Traits>
+    class TiledKdTreeBase
+    {
+    public:
+        using DataPoint  = typename Traits::DataPoint;     ///< DataPoint given by user via Traits
+        using Scalar     = typename DataPoint::Scalar;     ///< Scalar given by user via DataPoint
+        using VectorType = typename DataPoint::VectorType; ///< VectorType given by user via DataPoint
+        using IndexType  = typename Traits::IndexType;     ///< Type used for the global indices of the points
+        using AabbType   = Eigen::AlignedBox<Scalar, DataPoint::Dim>;
+        using Tile       = KdTreeTile<Traits>;
+        using TileHandle = typename TileCache<Tile>::TileHandle;
+
+        using KNearestPointQuery = TiledKdTreeKNearestQuery<Traits>;
+        using RangePointQuery    = TiledKdTreeRangeQuery<Traits>;
+
+        /// \brief Node of the binary tree over the tiles
+        struct TileNode
+        {
+            AabbType aabb;     ///< Bounding box of the points of the tiles of the node
+            int firstChild{0}; ///< Index of the first child, followed by the second one
+            int tile{-1};      ///< Index of the tile of a leaf, -1 for inner nodes
+
+            /// \brief Is the node a leaf storing a tile ?
+            [[nodiscard]] inline bool isLeaf() const { return tile >= 0; }
+        };
+
+        /*!
+         * \brief Open a TiledKdTree written by a TiledKdTreeBuilderBase
+         *
+         * Only the index of the tiles is read: the tiles are mapped when the queries reach them.
+         *
+         * \param _directory Directory storing the tiles
+         * \param _memoryBudget Maximal total size of the tiles kept in memory, in bytes
+         * \throw std::runtime_error when the index cannot be read, or was not written for the same types
+         */
+        PONCA_MULTIARCH_HOST inline TiledKdTreeBase(const std::string& _directory, std::size_t _memoryBudget)
+            : m_directory(_directory), m_cache(_memoryBudget)
+        {
+            std::ifstream file(indexPath(_directory), std::ios::binary);
+            internal::TiledKdTreeHeader header{};
+            file.read(reinterpret_cast<char*>(&header), sizeof(header));
+            if (!file || std::memcmp(header.magic, internal::TiledKdTreeMagic, sizeof(header.magic)) != 0 ||
+                header.version != internal::TiledKdTreeVersion || header.dim != std::uint32_t(DataPoint::Dim) ||
+                header.scalarBytes != sizeof(Scalar) || header.pointBytes != sizeof(DataPoint))
+                throw std::runtime_error("TiledKdTree: invalid index in " + _directory);
+
+            m_tiles.resize(header.tileCount);
+            for (auto& tile : m_tiles)
+            {
+                VectorType bounds[2];
+                std::int64_t range[2];
+                file.read(reinterpret_cast<char*>(bounds), sizeof(bounds));
+                file.read(reinterpret_cast<char*>(range), sizeof(range));
+                tile.aabb  = AabbType(bounds[0], bounds[1]);
+                tile.first = IndexType(range[0]);
+                tile.count = IndexType(range[1]);
+            }
+            if (!file)
+                throw std::runtime_error("TiledKdTree: truncated index in " + _directory);
+
+            if (!m_tiles.empty())
+            {
+                std::vector<int> order(m_tiles.size());
+                std::iota(order.begin(), order.end(), 0);
+                m_nodes.reserve(2 * m_tiles.size() - 1);
+                m_nodes.emplace_back();
+                buildNode(0, order.begin(), order.end(), 0);
+            }
+        }
+
+        // Query -------------------------------------------------------------------
+    public:
+        /// \brief Computes a Query object to iterate over the k-nearest neighbors of a position.
+        ///
+        /// The returned object can be reset and reused with the () operator, to compute a new result
+        /// (also takes a position and a number of neighbors as parameters).
+        ///
+        /// \param point Position from where the query is evaluated
+        /// \param k Number of requested neighbors
+        /// \return The \ref KNearestPointQuery mutable object to iterate over the search results.
+        PONCA_MULTIARCH_HOST [[nodiscard]] inline KNearestPointQuery kNearestNeighbors(const VectorType& point,
+                                                                                       IndexType k) const
+        {
+            return KNearestPointQuery(this, k, point);
+        }
+
+        /// \brief Convenience function that provides an empty k-nearest neighbors Query object.
+        ///
+        /// Same as `TiledKdTreeBase::kNearestNeighbors (VectorType::Zero(), 0)`.
+        PONCA_MULTIARCH_HOST [[nodiscard]] inline KNearestPointQuery kNearestNeighborsQuery() const
+        {
+            return KNearestPointQuery(this, 0, VectorType::Zero());
+        }
+
+        /// \brief Computes a Query object to iterate over the neighbors that are inside a given radius.
+        ///
+        /// The returned object can be reset and reused with the () operator, to compute a new result
+        /// (also takes a position and a radius as parameters).
+        ///
+        /// \param point Position from where the query is evaluated
+        /// \param r Radius around where to search the neighbors
+        /// \return The \ref RangePointQuery mutable object to iterate over the search results.
+        PONCA_MULTIARCH_HOST [[nodiscard]] inline RangePointQuery rangeNeighbors(const VectorType& point,
+                                                                                 Scalar r) const
+        {
+            return RangePointQuery(this, r, point);
+        }
+
+        /// \brief Convenience function that provides an empty range neighbors Query object.
+        ///
+        /// Same as `TiledKdTreeBase::rangeNeighbors (VectorType::Zero(), 0)`.
+        PONCA_MULTIARCH_HOST [[nodiscard]] inline RangePointQuery rangeNeighborsQuery() const
+        {
+            return RangePointQuery(this, 0, VectorType::Zero());
+        }
+
+        // Accessors ---------------------------------------------------------------
+    public:
+        /*!
+         * \brief Read-only access to the points from their global indices, e.g. for `Basket::computeWithIds`
+         *
+         * The accessor pins the tile of the last accessed point: the consecutive accesses to the points of a tile,
+         * such as the neighbors gathered by a query, resolve the tile once. The pinned tile stays mapped until the
+         * accessor moves to another tile or is destroyed. An accessor must not be shared between threads.
+         */
+        class PointAccessor
+        {
+        public:
+            explicit PointAccessor(const TiledKdTreeBase* _tree) : m_tree(_tree) {}
+            /// \brief Copy of the point of global index `_index`
+            inline DataPoint operator[](IndexType _index) const
+            {
+                if (_index < m_first || _index >= m_end)
+                    pin(m_tree->tileOfIndex(_index));
+                return m_tile->tree().points()[std::size_t(_index - m_first)];
+            }
+
+        private:
+            inline void pin(int _tile) const
+            {
+                m_tile  = m_tree->tile(_tile);
+                m_first = m_tree->tileFirstIndex(_tile);
+                m_end   = m_first + m_tree->tilePointCount(_tile);
+            }
+
+            const TiledKdTreeBase* m_tree;
+            mutable TileHandle m_tile;    ///< Pinned tile
+            mutable IndexType m_first{0}; ///< Global index of the first point of the pinned tile
+            mutable IndexType m_end{0};   ///< Global index past the last point of the pinned tile
+        };
+
+        /// \brief Get the number of points
+        PONCA_MULTIARCH_HOST [[nodiscard]] inline IndexType pointCount() const
+        {
+            return m_tiles.empty() ? IndexType(0) : m_tiles.back().first + m_tiles.back().count;
+        }
+        /// \brief Get the number of tiles
+        PONCA_MULTIARCH_HOST [[nodiscard]] inline int tileCount() const { return int(m_tiles.size()); }
+        /// \brief Bounding box of the points of a tile
+        PONCA_MULTIARCH_HOST [[nodiscard]] inline const AabbType& tileBounds(int _tile) const
+        {
+            return m_tiles[_tile].aabb;
+        }
+        /// \brief Global index of the first point of a tile
+        PONCA_MULTIARCH_HOST [[nodiscard]] inline IndexType tileFirstIndex(int _tile) const
+        {
+            return m_tiles[_tile].first;
+        }
+        /// \brief Number of points of a tile
+        PONCA_MULTIARCH_HOST [[nodiscard]] inline IndexType tilePointCount(int _tile) const
+        {
+            return m_tiles[_tile].count;
+        }
+        /// \brief Nodes of the binary tree over the tiles, the root being the first one
+        PONCA_MULTIARCH_HOST [[nodiscard]] inline const std::vector<TileNode>& tileNodes() const { return m_nodes; }
+
+        /// \brief Get a tile, mapping it when it is not in the cache
+        /// \throw std::runtime_error when the file of the tile cannot be read
+        PONCA_MULTIARCH_HOST [[nodiscard]] inline TileHandle tile(int _tile) const
+        {
+            return m_cache.get(std::size_t(_tile),
+                               [this, _tile]() { return std::make_shared<Tile>(tilePath(m_directory, _tile)); });
+        }
+
+        /// \brief Tile containing the point of global index `_index`
+        PONCA_MULTIARCH_HOST [[nodiscard]] inline int tileOfIndex(IndexType _index) const
+        {
+            const auto it = std::upper_bound(m_tiles.begin(), m_tiles.end(), _index,
+                                             [](IndexType _i, const TileInfo& _t) { return _i < _t.first; });
+            return int(it - m_tiles.begin()) - 1;
+        }
+
+        /// \brief Copy of the point of global index `_index`, mapping its tile when it is not in the cache
+        ///
+        /// The tile is looked up in the cache at each call: prefer #points to read several points.
+        PONCA_MULTIARCH_HOST [[nodiscard]] inline DataPoint pointData(IndexType _index) const
+        {
+            const int t = tileOfIndex(_index);
+            return tile(t)->tree().points()[std::size_t(_index - m_tiles[t].first)];
+        }
+
+        /// \brief Access to the points from their global indices
+        PONCA_MULTIARCH_HOST [[nodiscard]] inline PointAccessor points() const { return PointAccessor(this); }
+
+        /// \brief Cache of the mapped tiles
+        PONCA_MULTIARCH_HOST [[nodiscard]] inline const TileCache<Tile>& cache() const { return m_cache; }
+
+        /// \brief Path of the index file of a TiledKdTree
+        PONCA_MULTIARCH_HOST static inline std::string indexPath(const std::string& _directory)
+        {
+            return _directory + "/index.ptkd";
+        }
+        /// \brief Path of the file of a tile
+        PONCA_MULTIARCH_HOST static inline std::string tilePath(const std::string& _directory, int _tile)
+        {
+            return _directory + "/tile_" + std::to_string(_tile) + ".ptkd";
+        }
+
+    private:
+        struct TileInfo
+        {
+            AabbType aabb;
+            IndexType first{0};
+            IndexType count{0};
+        };
+
+        /// \brief Split the tiles at the median of their centers, along the largest axis of their bounding box
+        PONCA_MULTIARCH_HOST inline void buildNode(int _nodeId, std::vector<int>::iterator _begin,
+                                                   std::vector<int>::iterator _end, int _depth)
+        {
+            AabbType aabb;
+            for (auto it = _begin; it != _end; ++it)
+                aabb.extend(m_tiles[*it].aabb);
+            m_nodes[_nodeId].aabb = aabb;
+
+            if (_end - _begin == 1)
+            {
+                m_nodes[_nodeId].tile = *_begin;
+                return;
+            }
+            if (_depth + 1 >= Traits::MAX_DEPTH)
+                throw std::runtime_error("TiledKdTree: too many tiles for the maximal depth of the tree");
+
+            int axis;
+            aabb.sizes().maxCoeff(&axis);
+            const auto middle = _begin + (_end - _begin) / 2;
+            std::nth_element(_begin, middle, _end, [this, axis](int _a, int _b) {
+                return m_tiles[_a].aabb.center()[axis] < m_tiles[_b].aabb.center()[axis];
+            });
+
+            const int firstChild        = int(m_nodes.size());
+            m_nodes[_nodeId].firstChild = firstChild;
+            m_nodes.emplace_back();
+            m_nodes.emplace_back();
+            buildNode(firstChild, _begin, middle, _depth + 1);
+            buildNode(firstChild + 1, middle, _end, _depth + 1);
+        }
+
+        std::string m_directory;
+        std::vector<TileInfo> m_tiles;
+        std::vector<TileNode> m_nodes;
+        mutable TileCache<Tile> m_cache;
+    };
+
+    /*!
+     * \brief Builder of the tiles of a TiledKdTree, streaming the points from the disk
+     *
+     * The points are added by batches (see #addPoints) and appended to the temporary file of their tile, so that the
+     * whole cloud never has to fit in memory. The tiles are the cells of a uniform grid over the bounding box given at
+     * construction. #finalize then loads the tiles one by one, builds their KdTree, writes them (see writeKdTreeTile)
+     * and writes the index read by TiledKdTreeBase: the peak memory is the size of the largest tile.
+     *
+     * \code{.cpp}
+     * Ponca::TiledKdTreeBuilder<DataPoint> builder(directory, bounds, tileSize);
+     * while (readNextBatch(batch))
+     *     builder.addPoints(batch);
+     * builder.finalize();
+     * Ponca::TiledKdTree<DataPoint> tree(directory, memoryBudget);
+     * \endcode
+     */
+    template <typename Traits>
+    class TiledKdTreeBuilderBase
+    {
+    public:
+        using DataPoint  = typename Traits::DataPoint;
+        using Scalar     = typename DataPoint::Scalar;
+        using VectorType = typename DataPoint::VectorType;
+        using IndexType  = typename Traits::IndexType;
+        using AabbType   = Eigen::AlignedBox<Scalar, DataPoint::Dim>;
+        using CellType   = Eigen::Matrix<std::int64_t, DataPoint::Dim, 1>;
+
+        /*!
+         * \param _directory Existing directory where the tiles are written
+         * \param _bounds Bounding box of the points: the points outside are stored in the closest tile
+         * \param _tileSize Size of the tiles
+         */
+        PONCA_MULTIARCH_HOST inline TiledKdTreeBuilderBase(const std::string& _directory, const AabbType& _bounds,
+                                                           Scalar _tileSize)
+            : m_directory(_directory), m_origin(_bounds.min()), m_tileSize(_tileSize)
+        {
+            if (!(_tileSize > Scalar(0)) || _bounds.isEmpty())
+                throw std::invalid_argument("TiledKdTreeBuilder: invalid bounds or tile size");
+            for (int d = 0; d < DataPoint::Dim; ++d)
+                m_counts[d] = std::int64_t(std::floor(_bounds.sizes()[d] / _tileSize)) + 1;
+        }
+
+        /// \brief Append a batch of points to the temporary files of their tiles
+        /// \throw std::runtime_error when a temporary file cannot be written
+        template <typename PointContainer>
+        PONCA_MULTIARCH_HOST inline void addPoints(const PointContainer& _points)
+        {
+            static_assert(internal::isRawStorable<DataPoint>,
+                          "The points are written as raw bytes to the temporary files, and must own no resource");
+            std::map<std::int64_t, std::vector<DataPoint>> batches;
+            for (const auto& p : _points)
+                batches[tileKey(p.pos())].push_back(p);
+
+            for (const auto& [key, points] : batches)
+            {
+                // The first batch of a tile overwrites the file left by a previous build
+                const auto mode = m_sizes.find(key) == m_sizes.end() ? std::ios::trunc : std::ios::app;
+                std::ofstream file(rawPath(key), std::ios::binary | mode);
+                file.write(reinterpret_cast<const char*>(points.data()),
+                           std::streamsize(points.size() * sizeof(DataPoint)));
+                if (!file)
+                    throw std::runtime_error("TiledKdTreeBuilder: cannot write " + rawPath(key));
+                m_sizes[key] += IndexType(points.size());
+            }
+        }
+
+        /// \brief Build the KdTree of each tile, write the tiles and the index, and remove the temporary files
+        /// \throw std::runtime_error when a file cannot be read or written
+        PONCA_MULTIARCH_HOST inline void finalize()
+        {
+            using Base = TiledKdTreeBase<Traits>;
+            static_assert(internal::isRawStorable<DataPoint>,
+                          "The points are read as raw bytes from the temporary files, and must own no resource");
+
+            std::ofstream index(Base::indexPath(m_directory), std::ios::binary | std::ios::trunc);
+            internal::TiledKdTreeHeader header{};
+            std::memcpy(header.magic, internal::TiledKdTreeMagic, sizeof(header.magic));
+            header.version     = internal::TiledKdTreeVersion;
+            header.dim         = DataPoint::Dim;
+            header.scalarBytes = sizeof(Scalar);
+            header.pointBytes  = sizeof(DataPoint);
+            header.tileCount   = m_sizes.size();
+            index.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+            int tileId        = 0;
+            std::int64_t next = 0;
+            for (const auto& [key, size] : m_sizes)
+            {
+                std::vector<DataPoint> points(size);
+                {
+                    std::ifstream raw(rawPath(key), std::ios::binary);
+                    raw.read(reinterpret_cast<char*>(points.data()), std::streamsize(size * sizeof(DataPoint)));
+                    if (!raw)
+                        throw std::runtime_error("TiledKdTreeBuilder: cannot read " + rawPath(key));
+                }
+                std::remove(rawPath(key).c_str());
+
+                AabbType aabb;
+                for (const auto& p : points)
+                    aabb.extend(p.pos());
+
+                KdTreeDenseBase<typename Traits::BuildTraits> tree(std::move(points));
+                // The samples of the leaves are contiguous in the file: a query touches few pages
+                tree.reorderPoints();
+                writeKdTreeTile<Traits>(Base::tilePath(m_directory, tileId), tree);
+
+                const VectorType bounds[2]  = {aabb.min(), aabb.max()};
+                const std::int64_t range[2] = {next, std::int64_t(size)};
+                index.write(reinterpret_cast<const char*>(bounds), sizeof(bounds));
+                index.write(reinterpret_cast<const char*>(range), sizeof(range));
+                next += size;
+                ++tileId;
+            }
+            m_sizes.clear();
+            if (!index)
+                throw std::runtime_error("TiledKdTreeBuilder: cannot write " + Base::indexPath(m_directory));
+        }
+
+        /// \brief Number of tiles along each axis
+        PONCA_MULTIARCH_HOST [[nodiscard]] inline const CellType& tileCounts() const { return m_counts; }
+
+    private:
+        /// \brief Linear index of the tile containing a position
+        PONCA_MULTIARCH_HOST [[nodiscard]] inline std::int64_t tileKey(const VectorType& _p) const
+        {
+            std::int64_t key = 0;
+            for (int d = DataPoint::Dim - 1; d >= 0; --d)
+            {
+                const Scalar c       = std::floor((_p[d] - m_origin[d]) / m_tileSize);
+                const std::int64_t i = c < Scalar(0) ? 0 : std::min(std::int64_t(c), m_counts[d] - 1);
+                key                  = key * m_counts[d] + i;
+            }
+            return key;
+        }
+
+        /// \brief Path of the temporary file of a tile
+        PONCA_MULTIARCH_HOST [[nodiscard]] inline std::string rawPath(std::int64_t _key) const
+        {
+            return m_directory + "/tile_" + std::to_string(_key) + ".raw";
+        }
+
+        std::string m_directory;
+        VectorType m_origin;
+        Scalar m_tileSize;
+        CellType m_counts;
+        std::map<std::int64_t, IndexType> m_sizes; ///< Number of points of each non-empty tile, sorted by key
+    };
+} // namespace Ponca
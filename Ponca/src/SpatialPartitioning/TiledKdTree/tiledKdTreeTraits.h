@@ -0,0 +1,49 @@
+/*
+ This Source Code Form is subject to the terms of the Mozilla Public
+ License, v. 2.0. If a copy of the MPL was not distributed with this
+ file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+#pragma once
+
+#include "../KdTree/kdTreeTraits.h"
+
+#include <cstdint>
+
+namespace Ponca
+{
+    /*!
+     * \brief The default traits type used by the TiledKdTree.
+     *
+     * The tiles are built as KdTreeDense with `BuildTraits`, and read back from memory-mapped files as StaticKdTreeBase
+     * with `TileTraits`: both traits must use the same node type.
+     */
+    template <typename _DataPoint>
+    struct TiledKdTreeDefaultTraits
+    {
+        enum
+        {
+            /*!
+             * \brief The maximum depth of the tree over the tiles.
+             */
+            MAX_DEPTH    = 32,
+            MAX_KNN_SIZE = 128 //!< The maximum size of a knn query
+        };
+
+        /*!
+         * \brief The type used to store point data.
+         *
+         * The points are written to the tile files and mapped back to memory as raw bytes: the type must be trivially
+         * relocatable, as required to transfer the points to a GPU (e.g. Ponca::PointPositionNormal).
+         */
+        using DataPoint = _DataPoint;
+
+        /// \brief Type of the global indices of the points, 64 bits to index clouds larger than the memory
+        using IndexType = std::int64_t;
+
+        /// \brief Traits used to build the KdTree of each tile
+        using BuildTraits = KdTreeDefaultTraits<DataPoint>;
+        /// \brief Traits used to read the KdTree of each tile from its memory-mapped file
+        using TileTraits = KdTreePointerTraits<DataPoint>;
+    };
+} // namespace Ponca
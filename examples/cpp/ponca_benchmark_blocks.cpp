@@ -0,0 +1,105 @@
+/*
+ This Source Code Form is subject to the terms of the Mozilla Public
+ License, v. 2.0. If a copy of the MPL was not distributed with this
+ file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+/*!
+ * \file examples/cpp/ponca_benchmark_blocks.cpp
+ * \brief Compare the accumulation of the neighbors one by one (`Basket::computeWithIds`) and by blocks of 4, 8 and 16
+ * neighbors (`Basket::computeWithIdsByBlocks`)
+ *
+ * Fits are computed at every point of a noisy sphere, with neighbors collected beforehand, so that only the
+ * accumulation and the finalization of the fits are timed.
+ *
+ * Usage: `./ponca_benchmark_blocks [nbPoints] [scale]`
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <Ponca/Fitting>
+#include <Ponca/SpatialPartitioning>
+#include <Ponca/src/Common/pointTypes.h>
+
+using Scalar         = double;
+using DataPoint      = Ponca::PointPositionNormal<Scalar, 3>;
+using VectorType     = DataPoint::VectorType;
+using NeighborFilter = Ponca::DistWeightFunc<DataPoint, Ponca::SmoothWeightKernel<Scalar>>;
+
+/// Time to fit all the points (seconds), with neighbors accumulated by blocks of `BlockSize`, or one by one if 0
+template <typename Fit, int BlockSize>
+double run(const std::vector<DataPoint>& points, const std::vector<std::vector<int>>& neighbors, Scalar scale)
+{
+    const int n      = int(points.size());
+    int nbStable     = 0; // Prevents the fits from being optimized out
+    const auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < n; ++i)
+    {
+        Fit fit;
+        fit.setNeighborFilter({points[i].pos(), scale});
+        if constexpr (BlockSize == 0)
+            nbStable += fit.computeWithIds(neighbors[i], points) == Ponca::STABLE;
+        else
+            nbStable += fit.template computeWithIdsByBlocks<BlockSize>(neighbors[i], points) == Ponca::STABLE;
+    }
+    const double time = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    if (nbStable == 0)
+        std::cerr << "No stable fit\n";
+    return time;
+}
+
+template <typename Fit>
+void benchmark(const std::string& name, const std::vector<DataPoint>& points,
+               const std::vector<std::vector<int>>& neighbors, Scalar scale)
+{
+    static_assert(Fit::isBlockCompatible);
+    const double reference = run<Fit, 0>(points, neighbors, scale);
+    std::cout << std::left << std::setw(20) << name << std::right << std::setw(12) << reference;
+    for (const double time : {run<Fit, 4>(points, neighbors, scale), run<Fit, 8>(points, neighbors, scale),
+                              run<Fit, 16>(points, neighbors, scale)})
+        std::cout << std::setw(12) << time << " (" << std::setprecision(2) << reference / time << "x)"
+                  << std::setprecision(6);
+    std::cout << "\n";
+}
+
+int main(int argc, char** argv)
+{
+    const int n        = argc > 1 ? std::atoi(argv[1]) : 100000;
+    const Scalar scale = argc > 2 ? std::atof(argv[2]) : 0.05;
+
+    // Points sampled on a unit sphere with some noise
+    std::vector<DataPoint> points(n);
+    std::generate(points.begin(), points.end(), []() {
+        const VectorType dir = VectorType::Random().normalized();
+        return DataPoint(dir + VectorType::Random() * 0.001, dir);
+    });
+
+    Ponca::KdTreeDense<DataPoint> tree(points);
+    std::vector<std::vector<int>> neighbors(n);
+    double meanNeighbors = 0;
+    for (int i = 0; i < n; ++i)
+    {
+        for (int j : tree.rangeNeighbors(i, scale))
+            neighbors[i].push_back(j);
+        neighbors[i].push_back(i);
+        meanNeighbors += double(neighbors[i].size()) / n;
+    }
+
+    std::cout << n << " points, scale=" << scale << ", " << meanNeighbors << " neighbors on average\n";
+    std::cout << std::left << std::setw(20) << "fit (time in s)" << std::right << std::setw(12) << "one by one"
+              << std::setw(20) << "blocks of 4" << std::setw(20) << "blocks of 8" << std::setw(20) << "blocks of 16"
+              << "\n";
+    benchmark<Ponca::Basket<DataPoint, NeighborFilter, Ponca::CovariancePlaneFit>>("CovariancePlaneFit", points,
+                                                                                   neighbors, scale);
+    benchmark<Ponca::Basket<DataPoint, NeighborFilter, Ponca::OrientedSphereFit>>("OrientedSphereFit", points,
+                                                                                  neighbors, scale);
+    benchmark<Ponca::Basket<DataPoint, NeighborFilter, Ponca::SphereFit>>("SphereFit", points, neighbors, scale);
+    benchmark<Ponca::Basket<DataPoint, NeighborFilter, Ponca::UnorientedSphereFit>>("UnorientedSphereFit", points,
+                                                                                    neighbors, scale);
+    return 0;
+}
@@ -0,0 +1,200 @@
+/*
+ This Source Code Form is subject to the terms of the Mozilla Public
+ License, v. 2.0. If a copy of the MPL was not distributed with this
+ file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+/*!
+ * \file examples/cpp/ponca_benchmark_eigensolvers.cpp
+ * \brief Compare the accuracy and the speed of IterativeEigenSolverPolicy and DirectEigenSolverPolicy
+ *
+ * Covariance plane fits, sphere fits and unoriented sphere fits are computed at every point of a noisy sphere, in
+ * single and double precision, with both solver policies. The neighbors are accumulated once, and only the calls to
+ * `finalize`, where the eigenvalue problems are solved, are timed.
+ *
+ * The accuracy is measured against the same fit computed in long double with the iterative solvers: the reported
+ * error is the distance between the normalized gradients of the primitives at the evaluation points, up to their
+ * orientation.
+ *
+ * Usage: `./ponca_benchmark_eigensolvers [nbPoints] [scale]`
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <Ponca/Fitting>
+#include <Ponca/SpatialPartitioning>
+#include <Ponca/src/Common/pointTypes.h>
+
+template <typename Scalar>
+using DataPoint = Ponca::PointPositionNormal<Scalar, 3>;
+
+template <typename Scalar>
+using NeighborFilter = Ponca::DistWeightFunc<DataPoint<Scalar>, Ponca::SmoothWeightKernel<Scalar>>;
+
+template <typename Policy>
+struct Fits
+{
+    template <class P, class NF, typename T>
+    using Plane = Ponca::CovariancePlaneFitImpl<
+        P, NF, Ponca::CovarianceFitBase<P, NF, Ponca::MeanPosition<P, NF, Ponca::Plane<P, NF, T>>, Policy>>;
+
+    template <class P, class NF, typename T>
+    using Sphere = Ponca::SphereFitImpl<P, NF, Ponca::AlgebraicSphere<P, NF, T>, Policy>;
+
+    template <class P, class NF, typename T>
+    using UnorientedSphere =
+        Ponca::UnorientedSphereFitImpl<P, NF, Ponca::MeanPosition<P, NF, Ponca::AlgebraicSphere<P, NF, T>>, Policy>;
+};
+
+struct BenchmarkResult
+{
+    double time{0}; ///< Time spent in finalize (seconds)
+    double meanError{0};
+    double maxError{0};
+    int nbFailures{0}; ///< Fits that are stable in the reference but not with the tested solver
+};
+
+/// Fit at every point with the neighbors ids, and compare to the reference gradients
+template <typename Fit, typename Scalar>
+BenchmarkResult run(const std::vector<DataPoint<Scalar>>& points, const std::vector<std::vector<int>>& neighbors,
+                    Scalar scale, const std::vector<Eigen::Vector3d>& reference)
+{
+    const int n = int(points.size());
+    BenchmarkResult res;
+
+    // All the fits used in this benchmark need a single pass
+    std::vector<Fit> fits(n);
+    for (int i = 0; i < n; ++i)
+    {
+        fits[i].setNeighborFilter({points[i].pos(), scale});
+        fits[i].init();
+        fits[i].startNewPass();
+        for (int j : neighbors[i])
+            fits[i].addNeighbor(points[j]);
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    for (auto& fit : fits)
+        fit.finalize();
+    res.time = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    int nbCompared = 0;
+    for (int i = 0; i < n; ++i)
+    {
+        if (reference[i].hasNaN())
+            continue;
+        if (!fits[i].isStable())
+        {
+            ++res.nbFailures;
+            continue;
+        }
+        const Eigen::Vector3d g = fits[i].primitiveGradient().template cast<double>().normalized();
+        const double error      = std::min((g - reference[i]).norm(), (g + reference[i]).norm());
+        res.meanError += error;
+        res.maxError = std::max(res.maxError, error);
+        ++nbCompared;
+    }
+    res.meanError /= std::max(nbCompared, 1);
+    return res;
+}
+
+/// Compute the reference gradients in long double with the iterative solvers, NaN for unstable fits
+template <template <class, class, typename> class Ext>
+std::vector<Eigen::Vector3d> computeReference(const std::vector<DataPoint<long double>>& points,
+                                              const std::vector<std::vector<int>>& neighbors, long double scale)
+{
+    using Fit = Ponca::Basket<DataPoint<long double>, NeighborFilter<long double>, Ext>;
+    std::vector<Eigen::Vector3d> reference(points.size());
+    for (size_t i = 0; i < points.size(); ++i)
+    {
+        Fit fit;
+        fit.setNeighborFilter({points[i].pos(), scale});
+        if (fit.computeWithIds(neighbors[i], points) == Ponca::STABLE)
+            reference[i] = fit.primitiveGradient().template cast<double>().normalized();
+        else
+            reference[i].setConstant(std::numeric_limits<double>::quiet_NaN());
+    }
+    return reference;
+}
+
+template <typename Scalar>
+std::vector<DataPoint<Scalar>> convert(const std::vector<DataPoint<long double>>& points)
+{
+    std::vector<DataPoint<Scalar>> res;
+    res.reserve(points.size());
+    for (const auto& p : points)
+        res.emplace_back(p.pos().template cast<Scalar>(), p.normal().template cast<Scalar>());
+    return res;
+}
+
+void print(const std::string& name, const BenchmarkResult& iterative, const BenchmarkResult& direct)
+{
+    auto line = [](const std::string& policy, const BenchmarkResult& res) {
+        std::cout << "  " << std::left << std::setw(10) << policy << std::right << std::setw(12) << res.time << "s"
+                  << std::setw(14) << res.meanError << std::setw(14) << res.maxError << std::setw(10)
+                  << res.nbFailures << "\n";
+    };
+    std::cout << name << " (finalize time, mean error, max error, failures):\n";
+    line("iterative", iterative);
+    line("direct", direct);
+}
+
+template <typename Scalar, template <class, class, typename> class Iterative,
+          template <class, class, typename> class Direct>
+void benchmark(const std::string& name, const std::vector<DataPoint<long double>>& points,
+               const std::vector<std::vector<int>>& neighbors, long double scale,
+               const std::vector<Eigen::Vector3d>& reference)
+{
+    const auto scalarPoints = convert<Scalar>(points);
+    print(name,
+          run<Ponca::Basket<DataPoint<Scalar>, NeighborFilter<Scalar>, Iterative>>(scalarPoints, neighbors,
+                                                                                   Scalar(scale), reference),
+          run<Ponca::Basket<DataPoint<Scalar>, NeighborFilter<Scalar>, Direct>>(scalarPoints, neighbors,
+                                                                                Scalar(scale), reference));
+}
+
+int main(int argc, char** argv)
+{
+    using VectorType   = DataPoint<long double>::VectorType;
+    using Iterative    = Fits<Ponca::IterativeEigenSolverPolicy>;
+    using Direct       = Fits<Ponca::DirectEigenSolverPolicy>;
+    const int n        = argc > 1 ? std::atoi(argv[1]) : 50000;
+    const double scale = argc > 2 ? std::atof(argv[2]) : 0.05;
+
+    // Points sampled on a unit sphere with some noise
+    std::vector<DataPoint<long double>> points(n);
+    std::generate(points.begin(), points.end(), []() {
+        const VectorType dir = VectorType::Random().normalized();
+        return DataPoint<long double>(dir + VectorType::Random() * 0.001L, dir);
+    });
+
+    Ponca::KdTreeDense<DataPoint<long double>> tree(points);
+    std::vector<std::vector<int>> neighbors(n);
+    for (int i = 0; i < n; ++i)
+        for (int j : tree.rangeNeighbors(i, scale))
+            neighbors[i].push_back(j);
+    for (int i = 0; i < n; ++i)
+        neighbors[i].push_back(i);
+
+    std::cout << n << " points, scale=" << scale << "\n";
+
+    const auto planeRef = computeReference<Ponca::CovariancePlaneFit>(points, neighbors, scale);
+    benchmark<float, Iterative::Plane, Direct::Plane>("Plane (float)", points, neighbors, scale, planeRef);
+    benchmark<double, Iterative::Plane, Direct::Plane>("Plane (double)", points, neighbors, scale, planeRef);
+
+    const auto sphereRef = computeReference<Ponca::SphereFit>(points, neighbors, scale);
+    benchmark<float, Iterative::Sphere, Direct::Sphere>("Sphere (float)", points, neighbors, scale, sphereRef);
+    benchmark<double, Iterative::Sphere, Direct::Sphere>("Sphere (double)", points, neighbors, scale, sphereRef);
+
+    const auto unorientedRef = computeReference<Ponca::UnorientedSphereFit>(points, neighbors, scale);
+    benchmark<float, Iterative::UnorientedSphere, Direct::UnorientedSphere>("Unoriented sphere (float)", points,
+                                                                            neighbors, scale, unorientedRef);
+    benchmark<double, Iterative::UnorientedSphere, Direct::UnorientedSphere>("Unoriented sphere (double)", points,
+                                                                             neighbors, scale, unorientedRef);
+    return 0;
+}
@@ -0,0 +1,149 @@
+/*
+ This Source Code Form is subject to the terms of the Mozilla Public
+ License, v. 2.0. If a copy of the MPL was not distributed with this
+ file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+/*!
+ * \file examples/cpp/ponca_benchmark_hashgrid.cpp
+ * \brief Compare the KdTreeDense and the HashGrid on fixed-radius workloads
+ *
+ * Points sampled on a noisy sphere are indexed by a KdTreeDense and by HashGrids whose cell size matches the query
+ * radius, with the points in their input order and reordered by the structures (see `reorderPoints`). For each
+ * radius, the reported times are the building time and the time spent to iterate over the range neighbors and over
+ * the k-nearest neighbors of all the points. The neighborhoods found by the structures are compared, from their
+ * number of neighbors and their sum of squared distances.
+ *
+ * Usage: `./ponca_benchmark_hashgrid [nbPoints] [k]`
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <Ponca/SpatialPartitioning>
+#include <Ponca/src/Common/pointTypes.h>
+
+using Scalar     = double;
+using DataPoint  = Ponca::PointPositionNormal<Scalar, 3>;
+using VectorType = DataPoint::VectorType;
+
+/// Elapsed time since `_start`, in seconds
+double elapsed(const std::chrono::steady_clock::time_point& _start)
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - _start).count();
+}
+
+/// Iterate over the range neighbors of all the points, and returns the time spent
+template <typename Structure>
+double rangeQueries(const Structure& structure, Scalar radius, long long& nbNeighbors)
+{
+    long long count  = 0;
+    const auto start = std::chrono::steady_clock::now();
+#pragma omp parallel for reduction(+ : count)
+    for (int i = 0; i < structure.pointCount(); ++i)
+        for (int n : structure.rangeNeighbors(i, radius))
+        {
+            (void)n;
+            ++count;
+        }
+    nbNeighbors = count;
+    return elapsed(start);
+}
+
+/// Iterate over the k-nearest neighbors of all the points, and returns the time spent
+template <typename Structure>
+double kNearestQueries(const Structure& structure, int k, Scalar& sumDistances)
+{
+    Scalar sum       = 0;
+    const auto start = std::chrono::steady_clock::now();
+#pragma omp parallel for reduction(+ : sum)
+    for (int i = 0; i < structure.pointCount(); ++i)
+    {
+        auto query = structure.kNearestNeighbors(i, k);
+        for (auto it = query.begin(); it != query.end(); ++it)
+            sum += it.squaredDistance();
+    }
+    sumDistances = sum;
+    return elapsed(start);
+}
+
+/// Run the queries on a structure and print a line of the report
+/// \return false if the neighborhoods differ from the reference ones, which are set on the first call
+template <typename Structure>
+bool report(const std::string& radiusLabel, const std::string& name, double buildTime, const Structure& structure,
+            Scalar radius, int k, long long& refNeighbors, Scalar& refDistances)
+{
+    long long nbNeighbors     = 0;
+    Scalar sumDistances       = 0;
+    const double rangeTime    = rangeQueries(structure, radius, nbNeighbors);
+    const double kNearestTime = kNearestQueries(structure, k, sumDistances);
+
+    std::cout << std::left << std::setw(10) << radiusLabel << std::setw(24) << name << std::right << std::setw(12)
+              << buildTime << std::setw(12) << rangeTime << std::setw(16) << nbNeighbors << std::setw(12)
+              << kNearestTime << "\n";
+
+    if (refNeighbors < 0)
+    {
+        refNeighbors = nbNeighbors;
+        refDistances = sumDistances;
+    }
+    return nbNeighbors == refNeighbors &&
+           std::abs(sumDistances - refDistances) <= Scalar(1e-9) * std::max(Scalar(1), refDistances);
+}
+
+int main(int argc, char** argv)
+{
+    const int n = argc > 1 ? std::atoi(argv[1]) : 1000000;
+    const int k = argc > 2 ? std::atoi(argv[2]) : 16;
+
+    // Points sampled on a unit sphere with some noise
+    std::vector<DataPoint> points(n);
+    std::generate(points.begin(), points.end(), []() {
+        const VectorType dir = VectorType::Random().normalized();
+        return DataPoint(dir + VectorType::Random() * 0.001, dir);
+    });
+    std::cout << n << " points, k=" << k << "\n";
+
+    auto start = std::chrono::steady_clock::now();
+    const Ponca::KdTreeDense<DataPoint> tree(points);
+    const double treeBuildTime = elapsed(start);
+    Ponca::KdTreeDense<DataPoint> reorderedTree(points);
+    reorderedTree.reorderPoints();
+
+    std::cout << std::left << std::setw(10) << "radius" << std::setw(24) << "structure" << std::right << std::setw(12)
+              << "build (s)" << std::setw(12) << "range (s)" << std::setw(16) << "neighbors" << std::setw(12)
+              << "knn (s)" << "\n";
+    bool same = true;
+    for (const Scalar radius : {0.005, 0.01, 0.02, 0.04})
+    {
+        // Cells of the size of the query radius
+        start = std::chrono::steady_clock::now();
+        const Ponca::HashGrid<DataPoint> grid(points, radius);
+        const double gridBuildTime = elapsed(start);
+        Ponca::HashGrid<DataPoint> reorderedGrid(points, radius);
+        reorderedGrid.reorderPoints();
+
+        long long refNeighbors = -1;
+        Scalar refDistances    = 0;
+        const std::string label = std::to_string(radius).substr(0, 6);
+        same = report(label, "KdTreeDense", treeBuildTime, tree, radius, k, refNeighbors, refDistances) && same;
+        same = report("", "KdTreeDense (reordered)", treeBuildTime, reorderedTree, radius, k, refNeighbors,
+                      refDistances) &&
+               same;
+        same = report("", "HashGrid", gridBuildTime, grid, radius, k, refNeighbors, refDistances) && same;
+        same = report("", "HashGrid (reordered)", gridBuildTime, reorderedGrid, radius, k, refNeighbors,
+                      refDistances) &&
+               same;
+    }
+
+    if (!same)
+    {
+        std::cerr << "The KdTree and the HashGrid neighborhoods differ\n";
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
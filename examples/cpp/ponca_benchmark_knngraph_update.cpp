@@ -0,0 +1,114 @@
+/*
+ This Source Code Form is subject to the terms of the Mozilla Public
+ License, v. 2.0. If a copy of the MPL was not distributed with this
+ file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+/*!
+ * \file examples/cpp/ponca_benchmark_knngraph_update.cpp
+ * \brief Compare the incremental update of a KnnGraph with its full rebuild
+ *
+ * Points sampled on a noisy sphere are indexed by a KdTreeDense and a KnnGraph. At each frame, a fraction of the
+ * points moves slightly, as in a tracking pipeline, and the graph is either updated with `KnnGraphBase::update` from
+ * the KdTree of the first frame, or rebuilt from a new KdTree. The reported times are the update time, the number of
+ * updated adjacency lists, and the rebuild time (KdTree and KnnGraph). The updated and the rebuilt graphs are
+ * compared at the end of each frame.
+ *
+ * Usage: `./ponca_benchmark_knngraph_update [nbPoints] [k] [nbFrames]`
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+#include <Ponca/SpatialPartitioning>
+#include <Ponca/src/Common/pointTypes.h>
+
+using Scalar     = double;
+using DataPoint  = Ponca::PointPositionNormal<Scalar, 3>;
+using VectorType = DataPoint::VectorType;
+
+/// Elapsed time since `_start`, in seconds
+double elapsed(const std::chrono::steady_clock::time_point& _start)
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - _start).count();
+}
+
+/// Compare the adjacency lists of two graphs, up to the order of equidistant neighbors
+bool sameGraphs(const Ponca::KnnGraph<DataPoint>& _a, const Ponca::KnnGraph<DataPoint>& _b)
+{
+    bool same = _a.size() == _b.size();
+#pragma omp parallel for reduction(&& : same)
+    for (int i = 0; i < int(_a.size()); ++i)
+    {
+        std::vector<int> na, nb;
+        for (int n : _a.kNearestNeighbors(i))
+            na.push_back(n);
+        for (int n : _b.kNearestNeighbors(i))
+            nb.push_back(n);
+        std::sort(na.begin(), na.end());
+        std::sort(nb.begin(), nb.end());
+        same = same && na == nb;
+    }
+    return same;
+}
+
+int main(int argc, char** argv)
+{
+    const int n        = argc > 1 ? std::atoi(argv[1]) : 1000000;
+    const int k        = argc > 2 ? std::atoi(argv[2]) : 16;
+    const int nbFrames = argc > 3 ? std::atoi(argv[3]) : 3;
+
+    // Points sampled on a unit sphere with some noise: the mean spacing is about 0.002 for 1M points
+    std::vector<DataPoint> points(n);
+    std::generate(points.begin(), points.end(), []() {
+        const VectorType dir = VectorType::Random().normalized();
+        return DataPoint(dir + VectorType::Random() * 0.001, dir);
+    });
+    std::cout << n << " points, k=" << k << "\n";
+    std::cout << std::left << std::setw(10) << "moved" << std::setw(8) << "frame" << std::right << std::setw(12)
+              << "update (s)" << std::setw(16) << "lists updated" << std::setw(14) << "rebuild (s)" << std::setw(10)
+              << "speedup" << "\n";
+
+    bool same = true;
+    for (const double fraction : {0.001, 0.01, 0.05})
+    {
+        std::vector<DataPoint> frame = points;
+        const Ponca::KdTreeDense<DataPoint> kdtree(frame);
+        Ponca::KnnGraph<DataPoint> graph(kdtree, k);
+
+        for (int f = 0; f < nbFrames; ++f)
+        {
+            // Move a fraction of the points by about the point spacing
+            std::vector<int> changed;
+            for (int i = 0; i < n; ++i)
+                if (Eigen::internal::random<double>(0, 1) < fraction)
+                {
+                    frame[i].pos() += VectorType::Random() * 0.002;
+                    changed.push_back(i);
+                }
+
+            auto start              = std::chrono::steady_clock::now();
+            const int nbUpdated     = graph.update(kdtree, frame, changed);
+            const double updateTime = elapsed(start);
+
+            start = std::chrono::steady_clock::now();
+            const Ponca::KnnGraph<DataPoint> rebuilt(Ponca::KdTreeDense<DataPoint>(frame), k);
+            const double rebuildTime = elapsed(start);
+
+            std::cout << std::left << std::setw(10) << (std::to_string(fraction * 100).substr(0, 4) + "%")
+                      << std::setw(8) << f << std::right << std::setw(12) << updateTime << std::setw(16) << nbUpdated
+                      << std::setw(14) << rebuildTime << std::setw(9) << rebuildTime / updateTime << "x\n";
+            same = sameGraphs(graph, rebuilt) && same;
+        }
+    }
+
+    if (!same)
+    {
+        std::cerr << "The updated and the rebuilt graphs differ\n";
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,108 @@
+/*
+ This Source Code Form is subject to the terms of the Mozilla Public
+ License, v. 2.0. If a copy of the MPL was not distributed with this
+ file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+/*!
+ * \file examples/cpp/ponca_benchmark_mls.cpp
+ * \brief Measure the effect of reusing the neighborhoods between MLS iterations
+ *
+ * Points sampled on a noisy sphere are projected on the MLS surface defined by oriented sphere fits, starting from
+ * positions offset along the normals. The projections are computed with MLSEvaluationScheme::computeWithTree, which
+ * queries the neighbors at each iteration, and with CachedMLSEvaluationScheme for several margins. The reported
+ * distance is the largest one between the projections of the two schemes. The projections are finally computed in
+ * parallel with batchProject.
+ *
+ * Usage: `./ponca_benchmark_mls [nbPoints] [scale] [offset]`, with the offset relative to the scale
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+#include <Ponca/Fitting>
+#include <Ponca/SpatialPartitioning>
+#include <Ponca/src/Common/pointTypes.h>
+
+using Scalar     = double;
+using DataPoint  = Ponca::PointPositionNormal<Scalar, 3>;
+using VectorType = DataPoint::VectorType;
+using Fit        = Ponca::Basket<DataPoint, Ponca::DistWeightFunc<DataPoint, Ponca::SmoothWeightKernel<Scalar>>,
+                                 Ponca::OrientedSphereFit>;
+
+/// Project all the evaluation positions, and returns the time spent
+template <typename Scheme>
+double project(Scheme& scheme, const Ponca::KdTreeDense<DataPoint>& tree, const std::vector<VectorType>& positions,
+               Scalar scale, std::vector<VectorType>& projections, int& nbQueries)
+{
+    nbQueries        = 0;
+    const auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < positions.size(); ++i)
+    {
+        Fit fit;
+        fit.setNeighborFilter({positions[i], scale});
+        scheme.computeWithTree(fit, tree);
+        projections[i] = fit.getNeighborFilter().evalPos();
+        if constexpr (requires { scheme.nbQueries(); })
+            nbQueries += scheme.nbQueries();
+    }
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+int main(int argc, char** argv)
+{
+    const int n         = argc > 1 ? std::atoi(argv[1]) : 100000;
+    const Scalar scale  = argc > 2 ? std::atof(argv[2]) : 0.03;
+    const Scalar offset = argc > 3 ? std::atof(argv[3]) : 0.05;
+
+    // Points sampled on a unit sphere with some noise
+    std::vector<DataPoint> points(n);
+    std::generate(points.begin(), points.end(), []() {
+        const VectorType dir = VectorType::Random().normalized();
+        return DataPoint(dir + VectorType::Random() * 0.001, dir);
+    });
+    Ponca::KdTreeDense<DataPoint> tree(points);
+
+    std::vector<VectorType> positions(n);
+    for (int i = 0; i < n; ++i)
+        positions[i] = points[i].pos() + offset * scale * points[i].normal();
+
+    std::cout << n << " points, scale=" << scale << ", offset=" << offset << " (relative to the scale)\n";
+
+    std::vector<VectorType> reference(n), projections(n);
+    int nbQueries = 0;
+    Ponca::MLSEvaluationScheme<Scalar> mls;
+    const double referenceTime = project(mls, tree, positions, scale, reference, nbQueries);
+    std::cout << std::left << std::setw(16) << "re-query" << std::right << std::setw(12) << referenceTime << "s\n";
+
+    for (Scalar margin : {0.05, 0.1, 0.2, 0.5})
+    {
+        Ponca::CachedMLSEvaluationScheme<Scalar> cachedMls;
+        cachedMls.margin  = margin;
+        const double time = project(cachedMls, tree, positions, scale, projections, nbQueries);
+
+        Scalar maxDistance = 0;
+        for (int i = 0; i < n; ++i)
+            maxDistance = std::max(maxDistance, (projections[i] - reference[i]).norm());
+
+        std::cout << std::left << std::setw(16) << ("margin=" + std::to_string(margin)) << std::right << std::setw(12)
+                  << time << "s" << std::setw(12) << double(nbQueries) / n << " queries/point, max distance "
+                  << maxDistance << "\n";
+    }
+
+    std::vector<Ponca::MLSConvergence> convergence(n);
+    Ponca::BatchProjectOutput<Scalar> out;
+    out.convergence   = convergence.data();
+    projections       = positions;
+    const auto start  = std::chrono::steady_clock::now();
+    Ponca::batchProject<Fit>(tree, projections, Ponca::ConstantScale<Scalar>{scale}, out);
+    const double time = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    const auto nbConverged =
+        std::count_if(convergence.begin(), convergence.end(), [](const auto& c) { return c.converged; });
+    std::cout << std::left << std::setw(16) << "batchProject" << std::right << std::setw(12) << time << "s"
+              << std::setw(12) << nbConverged << " converged projections\n";
+    return 0;
+}
@@ -0,0 +1,162 @@
+/*
+ This Source Code Form is subject to the terms of the Mozilla Public
+ License, v. 2.0. If a copy of the MPL was not distributed with this
+ file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+/*!
+ * \file examples/cpp/ponca_benchmark_reordering.cpp
+ * \brief Measure the effect of KdTreeBase::reorderPoints on KnnGraph range queries and fits
+ *
+ * The input cloud is shuffled, so that neighboring points are spread over the whole memory. The same queries and fits
+ * are then run on the KnnGraph built from the original and from the reordered kdtree.
+ *
+ * Hardware counters are not portable, so the cache behavior is estimated by replaying the point accesses of the
+ * queries through a simulated direct-mapped cache, in addition to the wall-clock timings.
+ *
+ * Usage: `./ponca_benchmark_reordering [nbPoints] [radius]`
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include <Ponca/Fitting>
+#include <Ponca/SpatialPartitioning>
+#include <Ponca/src/Common/pointTypes.h>
+
+using DataPoint      = Ponca::PointPositionNormal<double, 3>;
+using Scalar         = DataPoint::Scalar;
+using VectorType     = DataPoint::VectorType;
+using NeighborFilter = Ponca::DistWeightFunc<DataPoint, Ponca::SmoothWeightKernel<Scalar>>;
+using FitType        = Ponca::Basket<DataPoint, NeighborFilter, Ponca::CovariancePlaneFit>;
+
+/// Direct-mapped cache simulation, counting the misses when reading points
+struct CacheSimulator
+{
+    static constexpr int lineSize  = 64;
+    static constexpr int lineCount = 16384; // 1MB
+
+    std::vector<std::uintptr_t> tags = std::vector<std::uintptr_t>(lineCount, ~std::uintptr_t(0));
+    long long accesses{0};
+    long long misses{0};
+
+    void read(const void* address, size_t size)
+    {
+        const auto first = reinterpret_cast<std::uintptr_t>(address) / lineSize;
+        const auto last  = (reinterpret_cast<std::uintptr_t>(address) + size - 1) / lineSize;
+        for (auto line = first; line <= last; ++line)
+        {
+            ++accesses;
+            auto& tag = tags[line % lineCount];
+            if (tag != line)
+            {
+                ++misses;
+                tag = line;
+            }
+        }
+    }
+};
+
+struct BenchmarkResult
+{
+    double queryTime{0};  ///< Time to run range queries from every point (seconds)
+    double fitTime{0};    ///< Time to fit a plane at every point (seconds)
+    long long cacheMisses{0};
+    long long cacheAccesses{0};
+    double meanJump{0};   ///< Mean distance between consecutive point indices visited by the queries
+    long long nbNeighbors{0};
+};
+
+template <typename Graph>
+BenchmarkResult run(const Graph& graph, Scalar radius)
+{
+    BenchmarkResult res;
+    const auto& points = graph.points();
+    const int n        = int(graph.size());
+
+    // Range queries only
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < n; ++i)
+        for (int j : graph.rangeNeighbors(i, radius))
+            res.nbNeighbors += j >= 0;
+    res.queryTime = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    // Range queries and fits
+    FitType fit;
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < n; ++i)
+    {
+        fit.setNeighborFilter({points[i].pos(), radius});
+        fit.computeWithIds(graph.rangeNeighbors(i, radius), points);
+    }
+    res.fitTime = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    // Replay the point accesses of the queries
+    CacheSimulator cache;
+    long long jumps{0}, nbJumps{0};
+    for (int i = 0; i < n; ++i)
+    {
+        int previous = i;
+        cache.read(&points[i], sizeof(DataPoint));
+        for (int j : graph.rangeNeighbors(i, radius))
+        {
+            cache.read(&points[j], sizeof(DataPoint));
+            jumps += std::abs(j - previous);
+            ++nbJumps;
+            previous = j;
+        }
+    }
+    res.cacheMisses   = cache.misses;
+    res.cacheAccesses = cache.accesses;
+    res.meanJump      = nbJumps == 0 ? 0. : double(jumps) / double(nbJumps);
+    return res;
+}
+
+void print(const std::string& name, const BenchmarkResult& res)
+{
+    std::cout << name << ":\n"
+              << "  range queries:     " << res.queryTime << "s\n"
+              << "  queries and fits:  " << res.fitTime << "s\n"
+              << "  simulated misses:  " << res.cacheMisses << " / " << res.cacheAccesses << " ("
+              << 100. * double(res.cacheMisses) / double(std::max(res.cacheAccesses, 1LL)) << "%)\n"
+              << "  mean index jump:   " << res.meanJump << "\n"
+              << "  neighbors visited: " << res.nbNeighbors << "\n";
+}
+
+int main(int argc, char** argv)
+{
+    const int n         = argc > 1 ? std::atoi(argv[1]) : 200000;
+    const Scalar radius = argc > 2 ? std::atof(argv[2]) : 0.02;
+    constexpr int k     = 12;
+
+    // Points sampled on a unit sphere, stored in random order
+    std::vector<DataPoint> points(n);
+    std::generate(points.begin(), points.end(), []() {
+        const VectorType p = VectorType::Random().normalized();
+        return DataPoint(p, p);
+    });
+    std::shuffle(points.begin(), points.end(), std::mt19937(0));
+
+    auto start = std::chrono::steady_clock::now();
+    Ponca::KdTreeDense<DataPoint> tree(points);
+    Ponca::KnnGraph<DataPoint> graph(tree, k);
+    const double buildTime = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    start = std::chrono::steady_clock::now();
+    Ponca::KdTreeDense<DataPoint> reorderedTree(points);
+    reorderedTree.reorderPoints();
+    Ponca::KnnGraph<DataPoint> reorderedGraph(reorderedTree, k);
+    const double reorderedBuildTime = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::cout << n << " points, k=" << k << ", radius=" << radius << "\n"
+              << "Build (kdtree + knngraph):            " << buildTime << "s\n"
+              << "Build (kdtree + reorder + knngraph):  " << reorderedBuildTime << "s\n";
+
+    print("Original order", run(graph, radius));
+    print("Reordered", run(reorderedGraph, radius));
+    return 0;
+}
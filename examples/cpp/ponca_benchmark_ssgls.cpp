@@ -0,0 +1,205 @@
+/*
+ This Source Code Form is subject to the terms of the Mozilla Public
+ License, v. 2.0. If a copy of the MPL was not distributed with this
+ file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+/*!
+ * \file examples/cpp/ponca_benchmark_ssgls.cpp
+ * \brief Screen space GLS on the CPU, and measure of the effect of the tile scheduling and of the accumulation
+ *
+ * CPU counterpart of examples/cuda/ssgls: the GLS curvature is computed at each pixel of a position and a normal
+ * buffer, from the pixels in a circular screen-space window, with Ponca::screenSpaceFit. The image is split in tiles,
+ * scheduled dynamically across the threads, and the neighbors of each pixel are accumulated one by one, by blocks, or
+ * by window rows (see Ponca::ScreenSpaceAccumulation).
+ *
+ * The reported difference is the largest one between the curvatures of an accumulation and the first one.
+ *
+ * Usage: `./ponca_benchmark_ssgls [positions.png] [normals.png] [scale] [tileSize] [output.png]`, with the scale in
+ * pixels. The default inputs are the samples of examples/python/data, copied in the build tree.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include <png.h>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#include <Ponca/src/Fitting/basket.h>
+#include <Ponca/src/Fitting/gls.h>
+#include <Ponca/src/Fitting/orientedSphereFit.h>
+#include <Ponca/src/Fitting/screenSpaceFit.h>
+#include <Ponca/src/Fitting/weightKernel.h>
+
+using Scalar           = float;
+using ScreenSpacePoint = Ponca::ScreenSpacePoint<Scalar>;
+using VectorType       = ScreenSpacePoint::VectorType;
+using ScreenVectorType = ScreenSpacePoint::ScreenVectorType;
+using NeighborFilter   = Ponca::ScreenSpaceWeightFunc<ScreenSpacePoint, Ponca::SmoothWeightKernel<Scalar>>;
+using ScreenSpaceFit   = Ponca::Basket<ScreenSpacePoint, NeighborFilter, Ponca::OrientedSphereFit, Ponca::GLSParam>;
+using ScreenBuffers    = Ponca::ScreenSpaceBuffers<ScreenSpacePoint>;
+using Accumulation     = Ponca::ScreenSpaceAccumulation;
+
+/// Read a RGB png image, with the channels remapped from [0:255] to [-1:1]
+bool readImage(const std::string& _filename, int& _width, int& _height, std::vector<float>& _values)
+{
+    png_image image{};
+    image.version = PNG_IMAGE_VERSION;
+    if (!png_image_begin_read_from_file(&image, _filename.c_str()))
+    {
+        std::cerr << "Cannot read " << _filename << ": " << image.message << "\n";
+        return false;
+    }
+    image.format = PNG_FORMAT_RGB;
+    std::vector<png_byte> buffer(PNG_IMAGE_SIZE(image));
+    if (!png_image_finish_read(&image, nullptr, buffer.data(), 0, nullptr))
+    {
+        std::cerr << "Cannot read " << _filename << ": " << image.message << "\n";
+        return false;
+    }
+    _width  = int(image.width);
+    _height = int(image.height);
+    _values.resize(buffer.size());
+    std::transform(buffer.begin(), buffer.end(), _values.begin(),
+                   [](png_byte v) { return float(v) / 255.f * 2.f - 1.f; });
+    return true;
+}
+
+/// Read the position and normal images, the black pixels of the normal map being background
+bool loadBuffers(const std::string& _positionsFilename, const std::string& _normalsFilename,
+                 std::optional<ScreenBuffers>& _buffers)
+{
+    int width = 0, height = 0, nw = 0, nh = 0;
+    std::vector<float> positions, normals;
+    if (!readImage(_positionsFilename, width, height, positions) || !readImage(_normalsFilename, nw, nh, normals))
+        return false;
+    if (nw != width || nh != height)
+    {
+        std::cerr << "The position and normal images must have the same size\n";
+        return false;
+    }
+
+    std::vector<ScreenSpacePoint> points(size_t(width) * height);
+    for (int y = 0; y < height; ++y)
+        for (int x = 0; x < width; ++x)
+        {
+            const int i = y * width + x;
+            VectorType n(normals.data() + 3 * i);
+            n         = n == VectorType::Constant(-1.f) ? VectorType::Zero() : n.normalized();
+            points[i] = {VectorType(positions.data() + 3 * i), n, ScreenVectorType(x, y)};
+        }
+    _buffers.emplace(width, height, std::move(points));
+    return true;
+}
+
+/// Compute the curvature of all the pixels with `_nbThreads` threads, and return the computation time
+template <Accumulation accumulation>
+double computeCurvature(const ScreenBuffers& _buffers, int _scale, Scalar _maxDepthDiff, int _tileSize, int _nbThreads,
+                        std::vector<Scalar>& _kappa)
+{
+#ifdef _OPENMP
+    omp_set_num_threads(_nbThreads);
+#endif
+    _kappa.assign(_buffers.points().size(), Scalar(0));
+    const auto start = std::chrono::steady_clock::now();
+    Ponca::screenSpaceFit<accumulation, ScreenSpaceFit>(_buffers, _scale, _maxDepthDiff, _tileSize,
+                                                        [&](int _i, const ScreenSpaceFit& _fit) {
+                                                            if (_fit.isStable())
+                                                                _kappa[_i] = _fit.kappa();
+                                                        });
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+/// Save the curvatures with a "seismic" like color map, as examples/cuda/ssgls
+bool saveCurvature(const std::string& _filename, int _width, int _height, const std::vector<Scalar>& _kappa)
+{
+    constexpr Scalar kmin = -10, kmax = 10;
+    std::vector<png_byte> buffer(size_t(3) * _width * _height, 255);
+    for (size_t i = 0; i < _kappa.size(); ++i)
+    {
+        if (_kappa[i] == Scalar(0) || std::isnan(_kappa[i]))
+            continue;
+        const Scalar v = (std::clamp(_kappa[i], kmin, kmax) - kmin) / (kmax - kmin);
+        const auto c   = png_byte(255 * (v < Scalar(0.5) ? 2 * v : 2 - 2 * v));
+        buffer[3 * i + 0] = v < Scalar(0.5) ? c : 255;
+        buffer[3 * i + 1] = c;
+        buffer[3 * i + 2] = v < Scalar(0.5) ? 255 : c;
+    }
+
+    png_image image{};
+    image.version = PNG_IMAGE_VERSION;
+    image.width   = png_uint_32(_width);
+    image.height  = png_uint_32(_height);
+    image.format  = PNG_FORMAT_RGB;
+    return png_image_write_to_file(&image, _filename.c_str(), 0, buffer.data(), 0, nullptr);
+}
+
+int main(int argc, char** argv)
+{
+    const std::string positionsFilename = argc > 1 ? argv[1] : "./data/ssgls_sample_wc.png";
+    const std::string normalsFilename   = argc > 2 ? argv[2] : "./data/ssgls_sample_normal.png";
+    const int scale                     = argc > 3 ? std::atoi(argv[3]) : 10;
+    const int tileSize                  = argc > 4 ? std::atoi(argv[4]) : 32;
+    const std::string resultFilename    = argc > 5 ? argv[5] : "./ssgls_cpu_results.png";
+    const Scalar maxDepthDiff           = 0;
+
+    if (scale < 1 || 2 * scale + 1 > ScreenBuffers::MaxWindowWidth)
+    {
+        std::cerr << "The scale must be in [1, " << (ScreenBuffers::MaxWindowWidth - 1) / 2 << "]" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    std::optional<ScreenBuffers> loaded;
+    if (!loadBuffers(positionsFilename, normalsFilename, loaded))
+        return EXIT_FAILURE;
+    const ScreenBuffers& buffers = *loaded;
+
+#ifdef _OPENMP
+    const int maxThreads = omp_get_max_threads();
+#else
+    const int maxThreads = 1;
+#endif
+    const double nbPixels = double(buffers.width()) * buffers.height();
+    std::cout << "Image size: " << buffers.width() << "*" << buffers.height() << ", scale=" << scale
+              << " pixels, tiles of " << tileSize << "*" << tileSize << " pixels\n";
+
+    std::vector<Scalar> reference, kappa;
+    const auto report = [&](const std::string& _name, int _nbThreads, double _time) {
+        Scalar maxDifference = 0;
+        for (size_t i = 0; i < kappa.size(); ++i)
+            maxDifference = std::max(maxDifference, std::abs(kappa[i] - reference[i]));
+        std::cout << std::left << std::setw(12) << _name << std::right << std::setw(3) << _nbThreads << " thread(s)"
+                  << std::setw(12) << _time << "s" << std::setw(12) << nbPixels / _time * 1e-6
+                  << " Mpixels/s, max difference " << maxDifference << "\n";
+    };
+
+    for (int nbThreads : {1, maxThreads})
+    {
+        double time =
+            computeCurvature<Accumulation::OneByOne>(buffers, scale, maxDepthDiff, tileSize, nbThreads, kappa);
+        reference   = kappa;
+        report("one by one", nbThreads, time);
+        time = computeCurvature<Accumulation::Blocks>(buffers, scale, maxDepthDiff, tileSize, nbThreads, kappa);
+        report("blocks", nbThreads, time);
+        time = computeCurvature<Accumulation::WindowRows>(buffers, scale, maxDepthDiff, tileSize, nbThreads, kappa);
+        report("window rows", nbThreads, time);
+        if (maxThreads == 1)
+            break;
+    }
+
+    if (!saveCurvature(resultFilename, buffers.width(), buffers.height(), kappa))
+    {
+        std::cerr << "Cannot save " << resultFilename << "\n";
+        return EXIT_FAILURE;
+    }
+    return 0;
+}
@@ -17,9 +17,14 @@
 #include <Ponca/src/Fitting/basket.h>
 #include <Ponca/src/Fitting/orientedSphereFit.h>
 #include <Ponca/src/Fitting/covariancePlaneFit.h>
+#include <Ponca/src/Fitting/mongePatch.h>
+#include <Ponca/src/Fitting/sphereFit.h>
+#include <Ponca/src/Fitting/unorientedSphereFit.h>
 #include <Ponca/src/Fitting/weightFunc.h>
 #include <Ponca/src/Fitting/weightKernel.h>
 #include <Ponca/src/SpatialPartitioning/KdTree/kdTree.h>
+#include <Ponca/src/SpatialPartitioning/HashGrid/hashGrid.h>
+#include <Ponca/src/SpatialPartitioning/KnnGraph/knnGraph.h>
 
 #include <vector>
 
@@ -119,6 +124,46 @@ void testBasicFunctionalities(const KdTree<typename Fit::DataPoint>& tree, typen
     }
 }
 
+/// Check that computeWithTree queries the whole support of the NeighborFilter, compact or not
+template <typename Fit>
+void testComputeWithTree(const KdTree<typename Fit::DataPoint>& tree, typename Fit::Scalar analysisScale)
+{
+    const auto& vectorPoints = tree.points();
+
+    // Quick testing is requested for coverage
+    int size = QUICK_TESTS ? 1 : int(vectorPoints.size());
+
+#ifdef NDEBUG
+#    pragma omp parallel for
+#endif
+    for (int i = 0; i < size; ++i)
+    {
+        const auto& fitInitPos = vectorPoints[i].pos();
+
+        // Compact filters only need the neighbors within the scale, other filters need all the points.
+        // Neighbors are added in the same order to get the same rounding errors
+        Fit fit;
+        fit.setNeighborFilter({fitInitPos, analysisScale});
+        if constexpr (Fit::NeighborFilter::isCompact)
+            fit.computeWithIds(tree.rangeNeighbors(fitInitPos, analysisScale), vectorPoints);
+        else
+            fit.computeWithIds(tree.samples(), vectorPoints);
+
+        //! [Fit computeWithTree]
+        Fit fit1;
+        fit1.computeWithTree(tree, {fitInitPos, analysisScale});
+        //! [Fit computeWithTree]
+
+        VERIFY(fit == fit1);
+        VERIFY(fit.getNumNeighbors() == fit1.getNumNeighbors());
+    }
+}
+
+// The samples of a KnnGraph are its adjacency lists, and it has no range query around a position
+static_assert(internal::PositionQueryableTree<KdTreeDense<PointPositionNormal<double, 3>>>);
+static_assert(internal::PositionQueryableTree<HashGrid<PointPositionNormal<double, 3>>>);
+static_assert(!internal::PositionQueryableTree<KnnGraph<PointPositionNormal<double, 3>>>);
+
 template <typename Fit1, typename Fit2, typename Functor>
 void testIsSame(const KdTree<typename Fit1::DataPoint>& tree, typename Fit1::Scalar analysisScale, Functor f)
 {
@@ -154,6 +199,42 @@ void testIsSame(const KdTree<typename Fit1::DataPoint>& tree, typename Fit1::Sca
     }
 }
 
+template <typename Fit, int BlockSize = Fit::DefaultBlockSize, typename Functor>
+void testByBlocks(const KdTree<typename Fit::DataPoint>& tree, typename Fit::Scalar analysisScale, Functor f)
+{
+    const auto& vectorPoints = tree.points();
+
+    // Quick testing is requested for coverage
+    int size = QUICK_TESTS ? 1 : int(vectorPoints.size());
+
+#ifdef NDEBUG
+#    pragma omp parallel for
+#endif
+    for (int i = 0; i < size; ++i)
+    {
+        const auto& fitInitPos = vectorPoints[i].pos();
+        auto neighborhoodRange = tree.rangeNeighbors(fitInitPos, analysisScale);
+
+        // use compute function
+        Fit fit, fitBlocks;
+        fit.setNeighborFilter({fitInitPos, analysisScale});
+        fitBlocks.setNeighborFilter({fitInitPos, analysisScale});
+        VERIFY(fit.compute(vectorPoints) ==
+               fitBlocks.template computeByBlocks<BlockSize>(vectorPoints.begin(), vectorPoints.end()));
+        VERIFY(fit.getNumNeighbors() == fitBlocks.getNumNeighbors());
+        f(fit, fitBlocks);
+
+        // use computeWithIds function
+        Fit fitIds, fitIdsBlocks;
+        fitIds.setNeighborFilter({fitInitPos, analysisScale});
+        fitIdsBlocks.setNeighborFilter({fitInitPos, analysisScale});
+        VERIFY(fitIds.computeWithIds(neighborhoodRange, vectorPoints) ==
+               fitIdsBlocks.template computeWithIdsByBlocks<BlockSize>(neighborhoodRange, vectorPoints));
+        VERIFY(fitIds.getNumNeighbors() == fitIdsBlocks.getNumNeighbors());
+        f(fitIds, fitIdsBlocks);
+    }
+}
+
 template <typename Scalar, int Dim>
 void callSubTests()
 {
@@ -178,6 +259,15 @@ void callSubTests()
                           OrientedSphereFitImpl,                         // sphere fitting
                           CovarianceFitBase, CovariancePlaneFitImpl>;    // plane fitting
     //! [HybridType]
+    using SimpleSphere     = Basket<Point, NeighborFilter, SphereFit>;
+    using UnorientedSphere = Basket<Point, NeighborFilter, UnorientedSphereFit>;
+    using Monge            = Basket<Point, NeighborFilter, MongePatchQuadraticFit>;
+    using GaussianSphere   = Basket<Point, DistWeightFunc<Point, GaussianWeightKernel<Scalar>>, OrientedSphereFit>;
+
+    // Extensions accumulating their neighbors by blocks, or one by one (MongePatch)
+    static_assert(TestPlane::isBlockCompatible && Sphere::isBlockCompatible && Hybrid::isBlockCompatible);
+    static_assert(SimpleSphere::isBlockCompatible && UnorientedSphere::isBlockCompatible);
+    static_assert(!Monge::isBlockCompatible);
 
     //! [PlaneFitDerTypes]
     using PlaneScaleDiff      = BasketDiff<TestPlane, FitScaleDer, CovariancePlaneDer>;
@@ -203,6 +293,10 @@ void callSubTests()
         CALL_SUBTEST((testBasicFunctionalities<PlaneScaleDiff>(tree, scale)));
         CALL_SUBTEST((testBasicFunctionalities<PlaneSpaceDiff>(tree, scale)));
         CALL_SUBTEST((testBasicFunctionalities<PlaneScaleSpaceDiff>(tree, scale)));
+        // Query radius derived from the NeighborFilter
+        CALL_SUBTEST((testComputeWithTree<Sphere>(tree, scale)));
+        CALL_SUBTEST((testComputeWithTree<GaussianSphere>(tree, scale)));
+        CALL_SUBTEST((testComputeWithTree<PlaneScaleSpaceDiff>(tree, scale)));
         // Hybrid diffs
         // TODO : Fix hybrid diffs (function calls are ambiguous on primitives)
         // CALL_SUBTEST((testBasicFunctionalities<HybridScaleDiff>(tree, scale) ));
@@ -230,6 +324,29 @@ void callSubTests()
         CALL_SUBTEST((testIsSame<PlaneScaleSpaceDiff, HybridSpaceDiff>(tree, scale, checkIsSamePlane)));
         CALL_SUBTEST((testIsSame<PlaneScaleSpaceDiff, HybridScaleSpaceDiff>(tree, scale, checkIsSamePlane)));
 
+        // Check that accumulating the neighbors by blocks gives the same fit. The rounding differs, and may flip the
+        // sign of the unoriented spheres: compare their geometry
+        auto checkIsSameGeometricSphere = [](const auto& f1, const auto& f2) {
+            const Scalar epsilon = std::sqrt(Eigen::NumTraits<Scalar>::dummy_precision());
+            VERIFY(f1.isPlane() == f2.isPlane());
+            if (!f1.isPlane())
+            {
+                VERIFY(f1.center().isApprox(f2.center(), epsilon));
+                VERIFY(std::abs(f1.radius() - f2.radius()) <= epsilon * f1.radius());
+            }
+        };
+        CALL_SUBTEST((testByBlocks<Sphere, 4>(tree, scale, checkIsSameGeometricSphere)));
+        CALL_SUBTEST((testByBlocks<Sphere, 8>(tree, scale, checkIsSameGeometricSphere)));
+        CALL_SUBTEST((testByBlocks<Sphere, 16>(tree, scale, checkIsSameGeometricSphere)));
+        CALL_SUBTEST((testByBlocks<Hybrid>(tree, scale, checkIsSameGeometricSphere)));
+        CALL_SUBTEST((testByBlocks<SimpleSphere, 4>(tree, scale, checkIsSameGeometricSphere)));
+        CALL_SUBTEST((testByBlocks<SimpleSphere, 16>(tree, scale, checkIsSameGeometricSphere)));
+        CALL_SUBTEST((testByBlocks<UnorientedSphere, 4>(tree, scale, checkIsSameGeometricSphere)));
+        CALL_SUBTEST((testByBlocks<UnorientedSphere, 16>(tree, scale, checkIsSameGeometricSphere)));
+        // MongePatch is not block compatible: its neighbors are added one by one, in the same order
+        CALL_SUBTEST((testByBlocks<Monge>(tree, scale,
+                                          [](const Monge& f1, const Monge& f2) { VERIFY(f1.kMean() == f2.kMean()); })));
+
         auto checkIsSamePlaneDerivative = [](const auto& f1, const auto& f2) {
             isSamePlane(f1, f2);
             hasSamePlaneDerivatives(f1, f2);
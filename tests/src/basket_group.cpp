@@ -0,0 +1,127 @@
+/*
+ This Source Code Form is subject to the terms of the Mozilla Public
+ License, v. 2.0. If a copy of the MPL was not distributed with this
+ file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+/*!
+ * \file tests/src/basket_group.cpp
+ * \brief Test that a BasketGroup gives the same results as its fits computed independently
+ */
+
+#include "../common/testing.h"
+#include "../common/testUtils.h"
+
+#include "../split_test_helper.h"
+
+#include <Ponca/src/Fitting/basket.h>
+#include <Ponca/src/Fitting/basketGroup.h>
+#include <Ponca/src/Fitting/covariancePlaneFit.h>
+#include <Ponca/src/Fitting/mongePatch.h>
+#include <Ponca/src/Fitting/orientedSphereFit.h>
+#include <Ponca/src/Fitting/weightFunc.h>
+#include <Ponca/src/Fitting/weightKernel.h>
+#include <Ponca/src/SpatialPartitioning/KdTree/kdTree.h>
+
+#include <vector>
+
+using namespace std;
+using namespace Ponca;
+
+template <typename Fit, typename Group>
+Fit computeAlone(const Group& group, const KdTreeDense<typename Fit::DataPoint>& tree,
+                 const typename Fit::VectorType& pos, typename Fit::Scalar scale)
+{
+    Fit fit;
+    fit.setNeighborFilter(group.getNeighborFilter());
+    fit.computeWithIds(tree.rangeNeighbors(pos, scale), tree.points());
+    return fit;
+}
+
+template <typename PlaneFit, typename SphereFit, typename MongeFit, typename PlaneDiff>
+void testBasketGroup(const KdTreeDense<typename PlaneFit::DataPoint>& tree, typename PlaneFit::Scalar scale)
+{
+    using Group = BasketGroup<PlaneFit, SphereFit, MongeFit, PlaneDiff>;
+    static_assert(Group::size() == 4);
+
+    const auto& points = tree.points();
+
+    // Quick testing is requested for coverage
+    int size = QUICK_TESTS ? 1 : int(points.size());
+
+#ifdef NDEBUG
+#    pragma omp parallel for
+#endif
+    for (int i = 0; i < size; ++i)
+    {
+        const auto& pos = points[i].pos();
+
+        Group group;
+        group.setNeighborFilter({pos, scale});
+        const FIT_RESULT res = group.computeWithIds(tree.rangeNeighbors(pos, scale), points);
+
+        const auto plane  = computeAlone<PlaneFit>(group, tree, pos, scale);
+        const auto sphere = computeAlone<SphereFit>(group, tree, pos, scale);
+        const auto monge  = computeAlone<MongeFit>(group, tree, pos, scale);
+        const auto diff   = computeAlone<PlaneDiff>(group, tree, pos, scale);
+
+        // MongePatch needs two passes, the other fits must not be affected by the second pass
+        VERIFY(group.template get<0>().getCurrentState() == plane.getCurrentState());
+        VERIFY(group.template get<1>().getCurrentState() == sphere.getCurrentState());
+        VERIFY(group.template get<2>().getCurrentState() == monge.getCurrentState());
+        VERIFY(group.template get<3>().getCurrentState() == diff.getCurrentState());
+        VERIFY(res != NEED_OTHER_PASS && res == group.getCurrentState());
+        VERIFY(group.isReady() == (plane.isReady() && sphere.isReady() && monge.isReady() && diff.isReady()));
+
+        VERIFY(group.template get<0>().getNumNeighbors() == plane.getNumNeighbors());
+        VERIFY(group.template get<2>().getNumNeighbors() == monge.getNumNeighbors());
+        if (!group.isReady())
+            continue;
+
+        // Same neighbors in the same order: the results are identical
+        VERIFY(group.template get<0>().primitiveGradient() == plane.primitiveGradient());
+        VERIFY(group.template get<1>().potential() == sphere.potential());
+        VERIFY(group.template get<1>().primitiveGradient() == sphere.primitiveGradient());
+        VERIFY(group.template get<2>().kMean() == monge.kMean());
+        VERIFY(group.template get<3>().dNormal() == diff.dNormal());
+    }
+}
+
+template <typename Scalar>
+void callSubTests()
+{
+    using Point          = PointPositionNormal<Scalar, 3>;
+    using NeighborFilter = DistWeightFunc<Point, SmoothWeightKernel<Scalar>>;
+    using PlaneFit       = Basket<Point, NeighborFilter, CovariancePlaneFit>;
+    using SphereFit      = Basket<Point, NeighborFilter, OrientedSphereFit>;
+    using MongeFit       = Basket<Point, NeighborFilter, MongePatchQuadraticFit>;
+    using PlaneDiff      = BasketDiff<PlaneFit, FitScaleSpaceDer, CovariancePlaneDer>;
+
+    const int nbPoints  = QUICK_TESTS ? 200 : 1000;
+    const Scalar radius = Eigen::internal::random<Scalar>(1, 10);
+    const Scalar scale  = Scalar(10) * std::sqrt(Scalar(4 * M_PI) * radius * radius / nbPoints);
+
+    std::vector<Point> points(nbPoints);
+    for (auto& p : points)
+        p = getPointOnSphere<Point>(radius, Point::VectorType::Zero(), false, false, false);
+    KdTreeDense<Point> tree(points);
+
+    for (int i = 0; i < g_repeat; ++i)
+    {
+        CALL_SUBTEST((testBasketGroup<PlaneFit, SphereFit, MongeFit, PlaneDiff>(tree, scale)));
+    }
+}
+
+int main(int argc, char** argv)
+{
+    if (!init_testing(argc, argv))
+    {
+        return EXIT_FAILURE;
+    }
+
+    cout << "Test BasketGroup..." << endl;
+    CALL_SUBTEST_1((callSubTests<float>()));
+    CALL_SUBTEST_2((callSubTests<double>()));
+    CALL_SUBTEST_3((callSubTests<long double>()));
+    cout << "Ok!" << endl;
+}
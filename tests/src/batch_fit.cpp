@@ -0,0 +1,131 @@
+/*
+ This Source Code Form is subject to the terms of the Mozilla Public
+ License, v. 2.0. If a copy of the MPL was not distributed with this
+ file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+/*!
+ * \file tests/src/batch_fit.cpp
+ * \brief Test that batchFit gives the same results as a sequential loop over the evaluation points
+ */
+
+#include "../common/testing.h"
+#include "../common/testUtils.h"
+
+#include "../split_test_helper.h"
+
+#include <Ponca/src/Fitting/basket.h>
+#include <Ponca/src/Fitting/batchFit.h>
+#include <Ponca/src/Fitting/covariancePlaneFit.h>
+#include <Ponca/src/Fitting/mongePatch.h>
+#include <Ponca/src/Fitting/weightFunc.h>
+#include <Ponca/src/Fitting/weightKernel.h>
+#include <Ponca/src/SpatialPartitioning/KdTree/kdTree.h>
+
+#include <vector>
+
+using namespace std;
+using namespace Ponca;
+
+//! \brief Compare two values written by batchFit, NaN being equal to NaN
+template <typename Scalar>
+bool isSameOutput(Scalar a, Scalar b)
+{
+    return (a == b) || (std::isnan(a) && std::isnan(b));
+}
+
+template <typename Fit, typename ScalePolicy>
+void testBatchFit(const KdTreeDense<typename Fit::DataPoint>& tree, const ScalePolicy& scale, bool withCurvature)
+{
+    using DataPoint  = typename Fit::DataPoint;
+    using Scalar     = typename DataPoint::Scalar;
+    using VectorType = typename DataPoint::VectorType;
+
+    const auto& points = tree.points();
+    const int n        = int(points.size());
+
+    std::vector<Scalar> normals(DataPoint::Dim * n), potentials(n), kmin(n), kmax(n);
+    std::vector<FIT_RESULT> status(n);
+    BatchFitOutput<Scalar> out;
+    out.normals    = normals.data();
+    out.potentials = potentials.data();
+    out.status     = status.data();
+    if (withCurvature)
+    {
+        out.kmin = kmin.data();
+        out.kmax = kmax.data();
+    }
+
+    batchFit<Fit>(tree, points, scale, out);
+
+    for (int i = 0; i < n; ++i)
+    {
+        const VectorType& pos = points[i].pos();
+        Fit fit;
+        fit.setNeighborFilter({pos, scale(i)});
+        VERIFY(fit.computeWithIds(tree.rangeNeighbors(pos, scale(i)), points) == status[i]);
+        if (!fit.isReady())
+        {
+            VERIFY(std::isnan(potentials[i]));
+            continue;
+        }
+
+        const VectorType normal = fit.primitiveGradient().normalized();
+        for (int d = 0; d < DataPoint::Dim; ++d)
+            VERIFY(isSameOutput(normals[DataPoint::Dim * i + d], normal[d]));
+        VERIFY(isSameOutput(potentials[i], Scalar(fit.potential())));
+        if constexpr (requires { fit.kmin(); })
+        {
+            if (withCurvature)
+            {
+                VERIFY(isSameOutput(kmin[i], Scalar(fit.kmin())));
+                VERIFY(isSameOutput(kmax[i], Scalar(fit.kmax())));
+            }
+        }
+    }
+}
+
+template <typename Scalar>
+void callSubTests()
+{
+    using Point          = PointPositionNormal<Scalar, 3>;
+    using NeighborFilter = DistWeightFunc<Point, SmoothWeightKernel<Scalar>>;
+    using PlaneFit       = Basket<Point, NeighborFilter, CovariancePlaneFit>;
+    using MongeFit       = Basket<Point, NeighborFilter, MongePatchQuadraticFit>;
+
+    const int nbPoints  = QUICK_TESTS ? 200 : 2000;
+    const Scalar radius = Eigen::internal::random<Scalar>(1, 10);
+    const Scalar scale  = Scalar(10) * std::sqrt(Scalar(4 * M_PI) * radius * radius / nbPoints);
+
+    std::vector<Point> points(nbPoints);
+    for (auto& p : points)
+        p = getPointOnSphere<Point>(radius, Point::VectorType::Zero(), false, false, false);
+    KdTreeDense<Point> tree(points);
+
+    // Some points get a scale that is too small to find enough neighbors
+    std::vector<Scalar> scales(nbPoints);
+    for (auto& s : scales)
+        s = Eigen::internal::random<Scalar>(Scalar(0.01), Scalar(1.5)) * scale;
+
+    for (int i = 0; i < g_repeat; ++i)
+    {
+        CALL_SUBTEST((testBatchFit<PlaneFit>(tree, ConstantScale<Scalar>{scale}, false)));
+        CALL_SUBTEST((testBatchFit<PlaneFit>(tree, PerPointScale<std::vector<Scalar>>{scales}, false)));
+        CALL_SUBTEST((testBatchFit<MongeFit>(tree, ConstantScale<Scalar>{scale}, true)));
+        CALL_SUBTEST((testBatchFit<MongeFit>(tree, PerPointScale<std::vector<Scalar>>{scales}, true)));
+    }
+}
+
+int main(int argc, char** argv)
+{
+    if (!init_testing(argc, argv))
+    {
+        return EXIT_FAILURE;
+    }
+
+    cout << "Test batchFit..." << endl;
+    CALL_SUBTEST_1((callSubTests<float>()));
+    CALL_SUBTEST_2((callSubTests<double>()));
+    CALL_SUBTEST_3((callSubTests<long double>()));
+    cout << "Ok!" << endl;
+}
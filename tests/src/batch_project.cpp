@@ -0,0 +1,145 @@
+/*
+ This Source Code Form is subject to the terms of the Mozilla Public
+ License, v. 2.0. If a copy of the MPL was not distributed with this
+ file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+/*!
+ * \file tests/src/batch_project.cpp
+ * \brief Test that batchProject gives the same projections as a sequential loop over the positions
+ */
+
+#include "../common/testing.h"
+#include "../common/testUtils.h"
+
+#include "../split_test_helper.h"
+
+#include <Ponca/src/Fitting/basket.h>
+#include <Ponca/src/Fitting/batchProject.h>
+#include <Ponca/src/Fitting/orientedSphereFit.h>
+#include <Ponca/src/Fitting/weightFunc.h>
+#include <Ponca/src/Fitting/weightKernel.h>
+#include <Ponca/src/SpatialPartitioning/KdTree/kdTree.h>
+
+#include <numeric>
+#include <vector>
+
+using namespace std;
+using namespace Ponca;
+
+template <typename Fit, typename Project>
+void testBatchProject(const KdTreeDense<typename Fit::DataPoint>& tree, typename Fit::Scalar scale,
+                      const Project& project)
+{
+    using DataPoint  = typename Fit::DataPoint;
+    using Scalar     = typename DataPoint::Scalar;
+    using VectorType = typename DataPoint::VectorType;
+
+    const auto& points   = tree.points();
+    const int n          = int(points.size());
+    const Scalar epsilon = testEpsilon<Scalar>();
+
+    // Start away from the surface, so that several MLS iterations are needed
+    std::vector<VectorType> positions(n);
+    for (int i = 0; i < n; ++i)
+        positions[i] = points[i].pos() + points[i].normal() * scale * Scalar(0.2);
+
+    std::vector<Scalar> normals(DataPoint::Dim * n);
+    std::vector<FIT_RESULT> status(n);
+    std::vector<MLSConvergence> convergence(n);
+    BatchProjectOutput<Scalar> out;
+    out.normals     = normals.data();
+    out.status      = status.data();
+    out.convergence = convergence.data();
+
+    // Compare to the sequential projection, with the same evaluation scheme
+    const MLSEvaluationScheme<Scalar> mls;
+    std::vector<VectorType> projections = positions;
+    batchProject<Fit>(tree, projections, ConstantScale<Scalar>{scale}, out, mls, project);
+
+    // Quick testing is requested for coverage
+    const int size = QUICK_TESTS ? 1 : n;
+
+#pragma omp parallel for
+    for (int i = 0; i < size; ++i)
+    {
+        Fit fit;
+        fit.setNeighborFilter({positions[i], scale});
+        MLSConvergence conv;
+        VERIFY(mls.computeWithTree(fit, tree, project, &conv) == status[i]);
+        VERIFY(conv.nbIterations == convergence[i].nbIterations && conv.converged == convergence[i].converged);
+        VERIFY(conv.nbIterations >= 1 && conv.nbIterations <= mls.nIter);
+
+        const Eigen::Map<const VectorType> normal(normals.data() + DataPoint::Dim * i);
+        if (fit.isStable())
+        {
+            const VectorType proj = project(fit, fit.getNeighborFilter().evalPos());
+            VERIFY(proj == projections[i]);
+            VERIFY(normal == fit.primitiveGradient(proj).normalized());
+        }
+        else
+        {
+            VERIFY(positions[i] == projections[i]);
+            VERIFY(normal.hasNaN());
+        }
+    }
+
+    // The default scheme reuses the neighborhoods, and gives the same projections up to the summation order
+    std::vector<VectorType> cachedProjections = positions;
+    std::vector<MLSConvergence> cachedConvergence(n);
+    batchProject<Fit>(tree, cachedProjections, ConstantScale<Scalar>{scale}, {.convergence = cachedConvergence.data()},
+                      CachedMLSEvaluationScheme<Scalar>(), project);
+    for (int i = 0; i < size; ++i)
+        VERIFY((cachedProjections[i] - projections[i]).norm() <= epsilon * scale);
+
+    // Projecting again warm-starts from the previous projections, which are already close to the surface
+    batchProject<Fit>(tree, cachedProjections, ConstantScale<Scalar>{scale}, {.convergence = convergence.data()},
+                      CachedMLSEvaluationScheme<Scalar>(), project);
+    auto sumIterations = [](const std::vector<MLSConvergence>& c) {
+        return std::accumulate(c.begin(), c.end(), 0,
+                               [](int sum, const MLSConvergence& conv) { return sum + int(conv.nbIterations); });
+    };
+    VERIFY(sumIterations(convergence) < sumIterations(cachedConvergence));
+    for (int i = 0; i < size; ++i)
+        if (cachedConvergence[i].converged)
+            VERIFY((cachedProjections[i] - projections[i]).norm() <= epsilon * scale);
+}
+
+template <typename Scalar>
+void callSubTests()
+{
+    using Point          = PointPositionNormal<Scalar, 3>;
+    using NeighborFilter = DistWeightFunc<Point, SmoothWeightKernel<Scalar>>;
+    using Fit            = Basket<Point, NeighborFilter, OrientedSphereFit>;
+
+    for (int i = 0; i < g_repeat; ++i)
+    {
+        const int nbPoints  = Eigen::internal::random<int>(500, 2000);
+        const Scalar radius = Eigen::internal::random<Scalar>(1, 10);
+        const Scalar scale  = Scalar(10) * std::sqrt(Scalar(4 * M_PI) * radius * radius / nbPoints);
+        const typename Point::VectorType center =
+            Point::VectorType::Random() * Eigen::internal::random<Scalar>(1, 100);
+
+        std::vector<Point> points(nbPoints);
+        for (auto& p : points)
+            p = getPointOnSphere<Point>(radius, center, true, true);
+        KdTreeDense<Point> tree(points);
+
+        CALL_SUBTEST((testBatchProject<Fit>(tree, scale, DirectProjectionOperator())));
+        CALL_SUBTEST((testBatchProject<Fit>(tree, scale, GradientDescentProjectionOperator())));
+    }
+}
+
+int main(int argc, char** argv)
+{
+    if (!init_testing(argc, argv))
+    {
+        return EXIT_FAILURE;
+    }
+
+    cout << "Test batchProject..." << endl;
+    CALL_SUBTEST_1((callSubTests<float>()));
+    CALL_SUBTEST_2((callSubTests<double>()));
+    CALL_SUBTEST_3((callSubTests<long double>()));
+    cout << "Ok!" << endl;
+}
@@ -13,6 +13,7 @@
 #include "../common/testUtils.h"
 
 #include <Ponca/src/Fitting/basket.h>
+#include <Ponca/src/Fitting/batchFit.h>
 #include <Ponca/src/Fitting/orientedSphereFit.h>
 #include <Ponca/src/Fitting/cnc.h>
 #include <Ponca/src/SpatialPartitioning/KdTree/kdTree.h>
@@ -186,6 +187,50 @@ void testCompareFit(const KdTree<typename Fit1::DataPoint>& tree, const Scalar a
     }
 }
 
+/*!
+ * \brief Test that batchFit gives the same curvatures as a sequential loop
+ *
+ * batchFit reseeds the random generator of the fit at each evaluation point, so the results must not depend on the
+ * number of threads nor on the order in which the points are processed.
+ */
+template <typename Fit, typename Scalar>
+void testBatch(const KdTree<typename Fit::DataPoint>& tree, const Scalar analysisScale)
+{
+    const auto& vectorPoints = tree.points();
+    const int n              = int(vectorPoints.size());
+
+    std::vector<Scalar> kmin(n), kmax(n);
+    std::vector<FIT_RESULT> status(n);
+    BatchFitOutput<Scalar> out;
+    out.kmin   = kmin.data();
+    out.kmax   = kmax.data();
+    out.status = status.data();
+
+    Fit prototype;
+    prototype.setSeed(Eigen::internal::random<int>(0, 1000));
+    batchFit(tree, vectorPoints, ConstantScale<Scalar>{analysisScale}, out, prototype);
+
+    auto isSameOutput = [](Scalar a, Scalar b) { return a == b || (std::isnan(a) && std::isnan(b)); };
+
+    // Quick testing is requested for coverage
+    const int size = QUICK_TESTS ? 1 : n;
+
+#ifdef NDEBUG
+#    pragma omp parallel for
+#endif
+    for (int i = 0; i < size; ++i)
+    {
+        Fit fit;
+        fit.setSeed(prototype.seed() + i);
+        fit.setNeighborFilter({vectorPoints[i], analysisScale});
+        VERIFY(fit.computeWithIds(tree.rangeNeighbors(vectorPoints[i].pos(), analysisScale), vectorPoints) ==
+               status[i]);
+        VERIFY(fit.isReady());
+        VERIFY(isSameOutput(fit.kmin(), kmin[i]));
+        VERIFY(isSameOutput(fit.kmax(), kmax[i]));
+    }
+}
+
 template <typename Scalar, int Dim>
 void callSubTests()
 {
@@ -222,6 +267,12 @@ void callSubTests()
     CALL_SUBTEST((testCompareFit<FitASODiff, FitCNCUniform>(tree, analysisScale)));
     CALL_SUBTEST((testCompareFit<FitASODiff, FitCNCHexagram, true>(tree, analysisScale, highEpsilon)));
     CALL_SUBTEST((testCompareFit<FitASODiff, FitCNCAvgHexagram, true>(tree, analysisScale, highEpsilon)));
+
+    // Parallel computation
+    CALL_SUBTEST((testBatch<FitCNCIndependent>(tree, analysisScale)));
+    CALL_SUBTEST((testBatch<FitCNCUniform>(tree, analysisScale)));
+    CALL_SUBTEST((testBatch<FitCNCHexagram>(tree, analysisScale)));
+    CALL_SUBTEST((testBatch<FitCNCAvgHexagram>(tree, analysisScale)));
 }
 
 int main(const int argc, char** argv)
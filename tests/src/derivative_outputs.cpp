@@ -0,0 +1,116 @@
+/*
+ This Source Code Form is subject to the terms of the Mozilla Public
+ License, v. 2.0. If a copy of the MPL was not distributed with this
+ file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+/*!
+ * \file tests/src/derivative_outputs.cpp
+ * \brief Test that restricting the derivative outputs of a BasketDiff does not change the requested derivatives
+ */
+
+#include "../common/testing.h"
+#include "../common/testUtils.h"
+
+#include "../split_test_helper.h"
+
+#include <Ponca/src/Fitting/basket.h>
+#include <Ponca/src/Fitting/covariancePlaneFit.h>
+#include <Ponca/src/Fitting/mlsSphereFitDer.h>
+#include <Ponca/src/Fitting/orientedSphereFit.h>
+#include <Ponca/src/Fitting/weightFunc.h>
+#include <Ponca/src/Fitting/weightKernel.h>
+
+#include <vector>
+
+using namespace std;
+using namespace Ponca;
+
+/// Compare the derivatives computed by a fit with all the outputs, and by fits restricted to dPotential or dNormal
+template <typename FullFit, typename PotentialFit, typename NormalFit>
+void testOutputs(const vector<typename FullFit::DataPoint>& points, typename FullFit::Scalar scale)
+{
+    static_assert(FullFit::isPotentialDer() && FullFit::isNormalDer());
+    static_assert(PotentialFit::isPotentialDer() && !PotentialFit::isNormalDer());
+    static_assert(!NormalFit::isPotentialDer() && NormalFit::isNormalDer());
+
+    // Quick testing is requested for coverage
+    const int size = QUICK_TESTS ? 1 : int(points.size());
+
+#pragma omp parallel for
+    for (int i = 0; i < size; ++i)
+    {
+        FullFit fit;
+        fit.setNeighborFilter({points[i].pos(), scale});
+        const FIT_RESULT res = fit.compute(points);
+
+        PotentialFit potentialFit;
+        potentialFit.setNeighborFilter({points[i].pos(), scale});
+        VERIFY(potentialFit.compute(points) == res);
+
+        NormalFit normalFit;
+        normalFit.setNeighborFilter({points[i].pos(), scale});
+        VERIFY(normalFit.compute(points) == res);
+
+        if (fit.isStable())
+        {
+            VERIFY(potentialFit.dPotential() == fit.dPotential());
+            VERIFY(potentialFit.primitiveGradient() == fit.primitiveGradient());
+            VERIFY(normalFit.dNormal() == fit.dNormal());
+        }
+    }
+}
+
+template <typename Scalar, int Type>
+void callSubTests()
+{
+    using Point          = PointPositionNormal<Scalar, 3>;
+    using NeighborFilter = DistWeightFunc<Point, SmoothWeightKernel<Scalar>>;
+
+    using Sphere = Basket<Point, NeighborFilter, OrientedSphereFit>;
+    using Plane  = Basket<Point, NeighborFilter, CovariancePlaneFit>;
+
+    //! [Derivative outputs]
+    // All the derivatives of the MLS surface
+    using MlsDiff = BasketDiff<Sphere, Type, OrientedSphereDer, MlsSphereFitDer>;
+    // Only dPotential and primitiveGradient: the second order derivatives are not computed
+    using MlsPotentialDiff = BasketDiff<Sphere, Type | FitPotentialDer, OrientedSphereDer, MlsSphereFitDer>;
+    //! [Derivative outputs]
+    using MlsNormalDiff = BasketDiff<Sphere, Type | FitNormalDer, OrientedSphereDer, MlsSphereFitDer>;
+
+    using PlaneDiff          = BasketDiff<Plane, Type, CovariancePlaneDer>;
+    using PlanePotentialDiff = BasketDiff<Plane, Type | FitPotentialDer, CovariancePlaneDer>;
+    using PlaneNormalDiff    = BasketDiff<Plane, Type | FitNormalDer, CovariancePlaneDer>;
+
+    // Setting both output flags is the same as setting none
+    static_assert(BasketDiff<Plane, Type | FitAllOutputsDer, CovariancePlaneDer>::isPotentialDer());
+    static_assert(BasketDiff<Plane, Type | FitAllOutputsDer, CovariancePlaneDer>::isNormalDer());
+
+    const int nbPoints  = QUICK_TESTS ? 200 : 1000;
+    const Scalar radius = Eigen::internal::random<Scalar>(1, 10);
+    const Scalar scale  = Scalar(10) * std::sqrt(Scalar(4 * M_PI) * radius * radius / nbPoints);
+
+    vector<Point> points(nbPoints);
+    for (auto& p : points)
+        p = getPointOnSphere<Point>(radius, Point::VectorType::Zero(), true, true);
+
+    for (int i = 0; i < g_repeat; ++i)
+    {
+        CALL_SUBTEST((testOutputs<MlsDiff, MlsPotentialDiff, MlsNormalDiff>(points, scale)));
+        CALL_SUBTEST((testOutputs<PlaneDiff, PlanePotentialDiff, PlaneNormalDiff>(points, scale)));
+    }
+}
+
+int main(int argc, char** argv)
+{
+    if (!init_testing(argc, argv))
+    {
+        return EXIT_FAILURE;
+    }
+
+    cout << "Test the restriction of the derivative outputs..." << endl;
+    CALL_SUBTEST_1((callSubTests<float, FitScaleSpaceDer>()));
+    CALL_SUBTEST_2((callSubTests<double, FitScaleSpaceDer>()));
+    CALL_SUBTEST_3((callSubTests<double, FitSpaceDer>()));
+    cout << "Ok!" << endl;
+}
@@ -0,0 +1,172 @@
+/*
+ This Source Code Form is subject to the terms of the Mozilla Public
+ License, v. 2.0. If a copy of the MPL was not distributed with this
+ file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+/*!
+ * \file tests/src/eigen_solver_policy.cpp
+ * \brief Test that the fitting extensions give the same results with the iterative and direct eigen solvers
+ */
+
+#include "../common/testing.h"
+#include "../common/testUtils.h"
+
+#include "../split_test_helper.h"
+
+#include <Ponca/src/Fitting/basket.h>
+#include <Ponca/src/Fitting/covariancePlaneFit.h>
+#include <Ponca/src/Fitting/sphereFit.h>
+#include <Ponca/src/Fitting/unorientedSphereFit.h>
+#include <Ponca/src/Fitting/weightFunc.h>
+#include <Ponca/src/Fitting/weightKernel.h>
+
+#include <vector>
+
+using namespace std;
+using namespace Ponca;
+
+template <class DataPoint, class _NFilter, typename T>
+using DirectCovariancePlaneFit = CovariancePlaneFitImpl<
+    DataPoint, _NFilter,
+    CovarianceFitBase<DataPoint, _NFilter, MeanPosition<DataPoint, _NFilter, Plane<DataPoint, _NFilter, T>>,
+                      DirectEigenSolverPolicy>>;
+
+template <class DataPoint, class _NFilter, typename T>
+using DirectSphereFit =
+    SphereFitImpl<DataPoint, _NFilter, AlgebraicSphere<DataPoint, _NFilter, T>, DirectEigenSolverPolicy>;
+
+template <class DataPoint, class _NFilter, typename T>
+using DirectUnorientedSphereFit =
+    UnorientedSphereFitImpl<DataPoint, _NFilter,
+                            MeanPosition<DataPoint, _NFilter, AlgebraicSphere<DataPoint, _NFilter, T>>,
+                            DirectEigenSolverPolicy>;
+
+template <typename Scalar>
+    requires std::is_floating_point_v<Scalar>
+bool isClose(Scalar a, Scalar b, Scalar epsilon)
+{
+    return std::abs(a - b) <= epsilon * std::max(Scalar(1), std::abs(b));
+}
+
+template <typename Derived1, typename Derived2>
+bool isClose(const Eigen::MatrixBase<Derived1>& a, const Eigen::MatrixBase<Derived2>& b,
+             typename Derived1::Scalar epsilon)
+{
+    return (a - b).norm() <= epsilon * std::max(typename Derived1::Scalar(1), b.norm());
+}
+
+/// Compare the fits computed with the iterative and the direct solvers, up to the orientation of the primitive
+template <typename Fit, typename DirectFit>
+void testFunction(const std::vector<typename Fit::DataPoint>& points, typename Fit::Scalar scale,
+                  typename Fit::Scalar epsilon)
+{
+    // Quick testing is requested for coverage
+    int size = QUICK_TESTS ? 1 : int(points.size());
+
+#pragma omp parallel for
+    for (int i = 0; i < size; ++i)
+    {
+        const auto& pos = points[i].pos();
+
+        Fit ref;
+        ref.setNeighborFilter({pos, scale});
+        const FIT_RESULT refRes = ref.compute(points);
+
+        DirectFit fit;
+        fit.setNeighborFilter({pos, scale});
+        const FIT_RESULT res = fit.compute(points);
+
+        VERIFY(res == refRes);
+        if (!ref.isStable())
+            continue;
+
+        const auto n1 = fit.primitiveGradient();
+        const auto n2 = ref.primitiveGradient();
+        VERIFY(isClose(n1, n2, epsilon) || isClose(n1, (-n2).eval(), epsilon));
+        VERIFY(isClose(std::abs(fit.potential()), std::abs(ref.potential()), epsilon));
+    }
+}
+
+/// On points sampled exactly on a sphere, the smallest eigenvalue of the Pratt fit is close to 0 and may be missed by
+/// the non self-adjoint solver: check the direct fit against the sphere itself
+template <typename DirectFit>
+void testExactSphere(const std::vector<typename DirectFit::DataPoint>& points, typename DirectFit::Scalar scale,
+                     typename DirectFit::Scalar radius, typename DirectFit::Scalar epsilon)
+{
+    // Quick testing is requested for coverage
+    int size = QUICK_TESTS ? 1 : int(points.size());
+
+#pragma omp parallel for
+    for (int i = 0; i < size; ++i)
+    {
+        DirectFit fit;
+        fit.setNeighborFilter({points[i].pos(), scale});
+        fit.compute(points);
+        if (!fit.isStable())
+            continue;
+
+        VERIFY(isClose(fit.radius(), radius, epsilon));
+        VERIFY(std::abs(fit.potential()) <= epsilon * radius);
+    }
+}
+
+template <typename Scalar>
+void callSubTests()
+{
+    using Point          = PointPositionNormal<Scalar, 3>;
+    using NeighborFilter = DistWeightFunc<Point, SmoothWeightKernel<Scalar>>;
+
+    using PlaneFit            = Basket<Point, NeighborFilter, CovariancePlaneFit>;
+    using DirectPlaneFit      = Basket<Point, NeighborFilter, DirectCovariancePlaneFit>;
+    using SphereFit           = Basket<Point, NeighborFilter, Ponca::SphereFit>;
+    using DirectSphere        = Basket<Point, NeighborFilter, DirectSphereFit>;
+    using UnorientedFit       = Basket<Point, NeighborFilter, UnorientedSphereFit>;
+    using DirectUnorientedFit = Basket<Point, NeighborFilter, DirectUnorientedSphereFit>;
+
+    // The solver policy does not change the way neighbors are accumulated
+    static_assert(DirectPlaneFit::isBlockCompatible && DirectPlaneFit::isMomentCompatible);
+    static_assert(DirectSphere::isBlockCompatible && DirectUnorientedFit::isBlockCompatible);
+
+    // The closed-form 3x3 solver is less accurate than the iterative one, especially in single precision
+    const Scalar epsilon = std::is_same_v<Scalar, float> ? Scalar(1e-2) : Scalar(1e-5);
+
+    for (int i = 0; i < g_repeat; ++i)
+    {
+        const int nbPoints  = Eigen::internal::random<int>(100, 1000);
+        const Scalar radius = Eigen::internal::random<Scalar>(Scalar(0.1), Scalar(10.));
+        const Scalar scale  = Scalar(10.) * std::sqrt(Scalar(4. * M_PI) * radius * radius / nbPoints);
+        const typename Point::VectorType center =
+            Point::VectorType::Random() * Eigen::internal::random<Scalar>(1, 10);
+
+        std::vector<Point> points(nbPoints), noisyPoints(nbPoints);
+        for (int j = 0; j < nbPoints; ++j)
+        {
+            points[j]      = getPointOnSphere<Point>(radius, center, false, false);
+            noisyPoints[j] = getPointOnSphere<Point>(radius, center, true, true);
+        }
+
+        CALL_SUBTEST((testFunction<PlaneFit, DirectPlaneFit>(points, scale, epsilon)));
+        CALL_SUBTEST((testFunction<PlaneFit, DirectPlaneFit>(noisyPoints, scale, epsilon)));
+        CALL_SUBTEST((testFunction<SphereFit, DirectSphere>(points, scale, epsilon)));
+        CALL_SUBTEST((testFunction<SphereFit, DirectSphere>(noisyPoints, scale, epsilon)));
+        CALL_SUBTEST((testFunction<UnorientedFit, DirectUnorientedFit>(points, scale, epsilon)));
+        CALL_SUBTEST((testFunction<UnorientedFit, DirectUnorientedFit>(noisyPoints, scale, epsilon)));
+        CALL_SUBTEST((testExactSphere<DirectSphere>(points, scale, radius, epsilon)));
+        CALL_SUBTEST((testExactSphere<DirectUnorientedFit>(points, scale, radius, epsilon)));
+    }
+}
+
+int main(int argc, char** argv)
+{
+    if (!init_testing(argc, argv))
+    {
+        return EXIT_FAILURE;
+    }
+
+    cout << "Test eigen solver policies..." << endl;
+    CALL_SUBTEST_1((callSubTests<float>()));
+    CALL_SUBTEST_2((callSubTests<double>()));
+    CALL_SUBTEST_3((callSubTests<long double>()));
+    cout << "Ok!" << endl;
+}
@@ -0,0 +1,143 @@
+/*
+ This Source Code Form is subject to the terms of the Mozilla Public
+ License, v. 2.0. If a copy of the MPL was not distributed with this
+ file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+/*!
+ * \file tests/src/fit_allocations.cpp
+ * \brief Test that fitting does not allocate on the heap once the neighborhoods are available
+ *
+ * Allocations through `operator new` are counted by replacing the global operators, and Eigen heap allocations, which
+ * use `malloc`, are forbidden with `EIGEN_RUNTIME_NO_MALLOC`.
+ */
+
+// Must be defined before including Eigen
+#define EIGEN_RUNTIME_NO_MALLOC
+
+#include "../common/testing.h"
+#include "../common/testUtils.h"
+
+#include "../split_test_helper.h"
+
+#include <Ponca/src/Fitting/basket.h>
+#include <Ponca/src/Fitting/cnc.h>
+#include <Ponca/src/Fitting/covariancePlaneFit.h>
+#include <Ponca/src/Fitting/mongePatch.h>
+#include <Ponca/src/Fitting/orientedSphereFit.h>
+#include <Ponca/src/Fitting/sphereFit.h>
+#include <Ponca/src/Fitting/unorientedSphereFit.h>
+#include <Ponca/src/Fitting/weightFunc.h>
+#include <Ponca/src/Fitting/weightKernel.h>
+#include <Ponca/src/SpatialPartitioning/KdTree/kdTree.h>
+
+#include <atomic>
+#include <new>
+#include <span>
+#include <vector>
+
+using namespace std;
+using namespace Ponca;
+
+static std::atomic<long long> g_allocations{0};
+
+void* operator new(std::size_t size)
+{
+    ++g_allocations;
+    if (void* ptr = std::malloc(size == 0 ? 1 : size))
+        return ptr;
+    throw std::bad_alloc();
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment)
+{
+    ++g_allocations;
+    const auto align = static_cast<std::size_t>(alignment);
+    if (void* ptr = std::aligned_alloc(align, (size + align - 1) / align * align))
+        return ptr;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* ptr) noexcept { std::free(ptr); }
+
+void operator delete(void* ptr, std::align_val_t) noexcept { std::free(ptr); }
+
+/// Fit at each point, and check that no allocation occurs once the fits have been computed a first time
+template <typename Fit>
+void testFunction(const std::vector<typename Fit::DataPoint>& points, const std::vector<std::vector<int>>& neighbors,
+                  typename Fit::Scalar scale)
+{
+    // Quick testing is requested for coverage
+    const int size = QUICK_TESTS ? 1 : int(points.size());
+
+    Fit fit;
+    auto fitAll = [&]() {
+        for (int i = 0; i < size; ++i)
+        {
+            fit.setNeighborFilter({points[i].pos(), scale});
+            fit.compute(points);
+            fit.setNeighborFilter({points[i].pos(), scale});
+            // IndexRange is taken by value: pass a view to avoid copying the ids
+            fit.computeWithIds(std::span<const int>(neighbors[i]), points);
+        }
+    };
+
+    // Warm-up
+    fitAll();
+
+    const long long allocations = g_allocations;
+    Eigen::internal::set_is_malloc_allowed(false);
+    fitAll();
+    Eigen::internal::set_is_malloc_allowed(true);
+    VERIFY(g_allocations == allocations);
+}
+
+template <typename Scalar>
+void callSubTests()
+{
+    using Point          = PointPositionNormal<Scalar, 3>;
+    using NeighborFilter = DistWeightFunc<Point, SmoothWeightKernel<Scalar>>;
+
+    const int nbPoints  = QUICK_TESTS ? 100 : 500;
+    const Scalar radius = Eigen::internal::random<Scalar>(1, 10);
+    const Scalar scale  = Scalar(10) * std::sqrt(Scalar(4 * M_PI) * radius * radius / nbPoints);
+
+    std::vector<Point> points(nbPoints);
+    for (auto& p : points)
+        p = getPointOnSphere<Point>(radius, Point::VectorType::Zero(), true, true);
+
+    KdTreeDense<Point> tree(points);
+    std::vector<std::vector<int>> neighbors(nbPoints);
+    for (int i = 0; i < nbPoints; ++i)
+        for (int j : tree.rangeNeighbors(points[i].pos(), scale))
+            neighbors[i].push_back(j);
+
+    for (int i = 0; i < g_repeat; ++i)
+    {
+        CALL_SUBTEST((testFunction<Basket<Point, NeighborFilter, MongePatchQuadraticFit>>(points, neighbors, scale)));
+        CALL_SUBTEST((testFunction<Basket<Point, NeighborFilter, MongePatchRestrictedQuadraticFit>>(points, neighbors,
+                                                                                                     scale)));
+        CALL_SUBTEST((testFunction<Basket<Point, NeighborFilter, CovariancePlaneFit>>(points, neighbors, scale)));
+        CALL_SUBTEST((testFunction<Basket<Point, NeighborFilter, OrientedSphereFit>>(points, neighbors, scale)));
+        CALL_SUBTEST((testFunction<Basket<Point, NeighborFilter, SphereFit>>(points, neighbors, scale)));
+        CALL_SUBTEST((testFunction<Basket<Point, NeighborFilter, UnorientedSphereFit>>(points, neighbors, scale)));
+        CALL_SUBTEST((testFunction<CNC<Point, UniformGeneration>>(points, neighbors, scale)));
+        CALL_SUBTEST((testFunction<CNC<Point, IndependentGeneration>>(points, neighbors, scale)));
+        CALL_SUBTEST((testFunction<CNC<Point, HexagramGeneration>>(points, neighbors, scale)));
+        CALL_SUBTEST((testFunction<CNC<Point, AvgHexagramGeneration>>(points, neighbors, scale)));
+    }
+}
+
+int main(int argc, char** argv)
+{
+    if (!init_testing(argc, argv))
+    {
+        return EXIT_FAILURE;
+    }
+
+    cout << "Test that fits do not allocate..." << endl;
+    CALL_SUBTEST_1((callSubTests<float>()));
+    CALL_SUBTEST_2((callSubTests<double>()));
+    CALL_SUBTEST_3((callSubTests<long double>()));
+    cout << "Ok!" << endl;
+}
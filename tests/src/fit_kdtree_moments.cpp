@@ -0,0 +1,211 @@
+/*
+ This Source Code Form is subject to the terms of the Mozilla Public
+ License, v. 2.0. If a copy of the MPL was not distributed with this
+ file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+/*!
+ * \file tests/src/fit_kdtree_moments.cpp
+ * \brief Test that fitting from the moments stored in the KdTree nodes gives the same results as a range query
+ */
+
+#include "../common/testing.h"
+#include "../common/testUtils.h"
+
+#include "../split_test_helper.h"
+
+#include <Ponca/src/Fitting/basket.h>
+#include <Ponca/src/Fitting/covariancePlaneFit.h>
+#include <Ponca/src/Fitting/mongePatch.h>
+#include <Ponca/src/Fitting/orientedSphereFit.h>
+#include <Ponca/src/Fitting/sphereFit.h>
+#include <Ponca/src/Fitting/weightFunc.h>
+#include <Ponca/src/Fitting/weightKernel.h>
+#include <Ponca/src/SpatialPartitioning/KdTree/kdTree.h>
+#include <Ponca/src/SpatialPartitioning/KdTree/kdTreeMomentNode.h>
+
+#include <vector>
+
+using namespace std;
+using namespace Ponca;
+
+template <typename DataPoint>
+using MomentKdTree = KdTreeDenseBase<KdTreeDefaultTraits<DataPoint, KdTreeMomentNode>>;
+
+template <typename Scalar>
+    requires std::is_floating_point_v<Scalar>
+bool isClose(Scalar a, Scalar b)
+{
+    const Scalar epsilon = Scalar(1000) * Eigen::NumTraits<Scalar>::dummy_precision();
+    return std::abs(a - b) <= epsilon * std::max(Scalar(1), std::abs(b));
+}
+
+template <typename Derived1, typename Derived2>
+bool isClose(const Eigen::MatrixBase<Derived1>& a, const Eigen::MatrixBase<Derived2>& b)
+{
+    using Scalar         = typename Derived1::Scalar;
+    const Scalar epsilon = Scalar(1000) * Eigen::NumTraits<Scalar>::dummy_precision();
+    return (a - b).norm() <= epsilon * std::max(Scalar(1), b.norm());
+}
+
+/// Check the moments of each node against the ones computed from its samples
+template <typename DataPoint>
+void testNodeMoments(const MomentKdTree<DataPoint>& tree)
+{
+    using VectorType = typename DataPoint::VectorType;
+
+    VERIFY(tree.valid());
+    VERIFY(tree.nodes()[0].moments().count == tree.sampleCount());
+
+    for (const auto& node : tree.nodes())
+    {
+        const auto& moments = node.moments();
+        if (moments.count == 0)
+            continue;
+
+        // Range of samples of the node, gathered from its leaves
+        std::vector<int> samples;
+        std::vector<typename MomentKdTree<DataPoint>::NodeIndexType> stack{
+            typename MomentKdTree<DataPoint>::NodeIndexType(&node - tree.nodes().data())};
+        while (!stack.empty())
+        {
+            const auto& n = tree.nodes()[stack.back()];
+            stack.pop_back();
+            if (n.is_leaf())
+                for (int i = n.leaf_start(); i < n.leaf_start() + n.leaf_size(); ++i)
+                    samples.push_back(i);
+            else
+            {
+                stack.push_back(n.inner_first_child_id());
+                stack.push_back(n.inner_first_child_id() + 1);
+            }
+        }
+        VERIFY(int(samples.size()) == moments.count);
+
+        VectorType centroid = VectorType::Zero();
+        for (int i : samples)
+        {
+            centroid += tree.pointDataFromSample(i).pos();
+            VERIFY(node.aabb().contains(tree.pointDataFromSample(i).pos()));
+        }
+        centroid /= typename DataPoint::Scalar(samples.size());
+        VERIFY(isClose(moments.centroid, centroid));
+
+        typename KdTreeNodeMoments<DataPoint>::MatrixType scatter = KdTreeNodeMoments<DataPoint>::MatrixType::Zero();
+        VectorType sumN                                           = VectorType::Zero();
+        for (int i : samples)
+        {
+            const VectorType q = tree.pointDataFromSample(i).pos() - centroid;
+            scatter += q * q.transpose();
+            sumN += tree.pointDataFromSample(i).normal();
+        }
+        VERIFY(isClose(moments.scatter, scatter));
+        VERIFY(isClose(moments.sumN, sumN));
+    }
+}
+
+template <typename Fit, typename Check>
+void testComputeWithMoments(const MomentKdTree<typename Fit::DataPoint>& tree, typename Fit::Scalar scale,
+                            Check check)
+{
+    using Scalar       = typename Fit::Scalar;
+    const auto& points = tree.points();
+
+    // Quick testing is requested for coverage
+    int size = QUICK_TESTS ? 1 : int(points.size());
+
+#ifdef NDEBUG
+#    pragma omp parallel for
+#endif
+    for (int i = 0; i < size; ++i)
+    {
+        const auto& pos = points[i].pos();
+
+        // The range query and the NeighborFilter may disagree on points lying on the boundary of the support: query a
+        // slightly larger range and let the filter select the neighbors, as computeWithMoments does
+        Fit ref;
+        ref.setNeighborFilter({pos, scale});
+        const FIT_RESULT refRes = ref.computeWithIds(tree.rangeNeighbors(pos, scale * Scalar(1.01)), points);
+
+        Fit fit;
+        fit.setNeighborFilter({pos, scale});
+        const FIT_RESULT res = fit.computeWithMoments(tree);
+
+        VERIFY(res == refRes);
+        VERIFY(fit.getNumNeighbors() == ref.getNumNeighbors());
+        VERIFY(isClose(fit.getWeightSum(), ref.getWeightSum()));
+        if (fit.isStable())
+            check(fit, ref);
+    }
+}
+
+template <typename Scalar>
+void callSubTests()
+{
+    using Point          = PointPositionNormal<Scalar, 3>;
+    using UniformFilter  = DistWeightFunc<Point, ConstantWeightKernel<Scalar>>;
+    using SmoothFilter   = DistWeightFunc<Point, SmoothWeightKernel<Scalar>>;
+    using PlaneFit       = Basket<Point, UniformFilter, CovariancePlaneFit>;
+    using SphereFit      = Basket<Point, UniformFilter, OrientedSphereFit>;
+    using MongeFit       = Basket<Point, UniformFilter, MongePatchQuadraticFit>;
+    using SmoothSphereFit = Basket<Point, SmoothFilter, OrientedSphereFit>;
+
+    // Only the extensions accumulating moments can consume whole subtrees
+    static_assert(PlaneFit::isMomentCompatible);
+    static_assert(SphereFit::isMomentCompatible);
+    static_assert(!MongeFit::isMomentCompatible);
+    static_assert(!Basket<Point, UniformFilter, Ponca::SphereFit>::isMomentCompatible);
+    static_assert(UniformFilter::hasUniformWeight);
+    static_assert(!SmoothFilter::hasUniformWeight);
+
+    const int nbPoints  = QUICK_TESTS ? 500 : 5000;
+    const Scalar radius = Eigen::internal::random<Scalar>(1, 10);
+    const Scalar scale  = Scalar(10) * std::sqrt(Scalar(4 * M_PI) * radius * radius / nbPoints);
+
+    std::vector<Point> points(nbPoints);
+    for (auto& p : points)
+        p = getPointOnSphere<Point>(radius, Point::VectorType::Zero(), false, false, false);
+    MomentKdTree<Point> tree;
+    tree.setMinCellSize(16);
+    tree.build(points);
+
+    // Unoriented primitives may flip when the summation order changes: compare them up to their orientation
+    auto checkPlane = [](const auto& f1, const auto& f2) {
+        const auto n1 = f1.primitiveGradient();
+        const auto n2 = f2.primitiveGradient();
+        VERIFY(isClose(n1, n2) || isClose(n1, (-n2).eval()));
+    };
+    auto checkSphere = [](const auto& f1, const auto& f2) {
+        VERIFY(isClose(f1.potential(), f2.potential()));
+        VERIFY(isClose(f1.primitiveGradient(), f2.primitiveGradient()));
+    };
+    auto checkMonge = [](const auto& f1, const auto& f2) {
+        VERIFY(isClose(std::abs(f1.kMean()), std::abs(f2.kMean())));
+    };
+
+    CALL_SUBTEST((testNodeMoments(tree)));
+    for (int i = 0; i < g_repeat; ++i)
+    {
+        for (Scalar s : {scale, Scalar(0.5) * radius})
+        {
+            CALL_SUBTEST((testComputeWithMoments<PlaneFit>(tree, s, checkPlane)));
+            CALL_SUBTEST((testComputeWithMoments<SphereFit>(tree, s, checkSphere)));
+            CALL_SUBTEST((testComputeWithMoments<SmoothSphereFit>(tree, s, checkSphere)));
+        }
+        CALL_SUBTEST((testComputeWithMoments<MongeFit>(tree, scale, checkMonge)));
+    }
+}
+
+int main(int argc, char** argv)
+{
+    if (!init_testing(argc, argv))
+    {
+        return EXIT_FAILURE;
+    }
+
+    cout << "Test fits from KdTree node moments..." << endl;
+    CALL_SUBTEST_1((callSubTests<float>()));
+    CALL_SUBTEST_2((callSubTests<double>()));
+    CALL_SUBTEST_3((callSubTests<long double>()));
+    cout << "Ok!" << endl;
+}
@@ -115,6 +115,37 @@ void testFunction(bool _bAddPositionNoise = false)
     }
 }
 
+/// Check the comparison operators, which compare the coefficients of the height field
+template <typename DataPoint, typename Fit>
+void testComparison()
+{
+    using Scalar     = typename DataPoint::Scalar;
+    using VectorType = typename DataPoint::VectorType;
+
+    const Scalar width = Eigen::internal::random<Scalar>(1., 10.);
+    const auto random  = [](Scalar _magnitude) { return Eigen::internal::random<Scalar>(-_magnitude, _magnitude); };
+    const auto quadParams = Eigen::Matrix<Scalar, 6, 1>(random(Scalar(0.1)), random(Scalar(0.1)), random(Scalar(0.1)),
+                                                        random(Scalar(1)), random(Scalar(1)), random(Scalar(1)));
+    vector<DataPoint> vectorPoints(Eigen::internal::random<int>(100, 1000));
+    for (auto& p : vectorPoints)
+        p = getPointOnParaboloid<DataPoint>(quadParams, width, true);
+
+    Fit fit;
+    fit.setNeighborFilter({VectorType::Zero(), Scalar(4.) * width});
+    fit.compute(vectorPoints);
+
+    const Fit copy = fit;
+    VERIFY(copy == fit && !(copy != fit));
+
+    // A fit of other points has other coefficients
+    for (auto& p : vectorPoints)
+        p.pos() *= Scalar(2);
+    Fit other;
+    other.setNeighborFilter({VectorType::Zero(), Scalar(8.) * width});
+    other.compute(vectorPoints);
+    VERIFY(other != fit && !(other == fit));
+}
+
 template <typename Scalar, int Dim>
 void callSubTests()
 {
@@ -141,6 +172,14 @@ void callSubTests()
         CALL_SUBTEST((testFunction<Point, CovFitConstant>(true)));
     }
     cout << "Ok!" << endl;
+
+    cout << "Testing the comparison operators" << endl;
+    for (int i = 0; i < g_repeat; ++i)
+    {
+        CALL_SUBTEST((testComparison<Point, CovFitSmooth>()));
+        CALL_SUBTEST((testComparison<Point, Basket<Point, WeightSmoothFunc, MongePatchRestrictedQuadraticFit>>()));
+    }
+    cout << "Ok!" << endl;
 }
 
 int main(int argc, char** argv)
@@ -0,0 +1,190 @@
+/*
+ This Source Code Form is subject to the terms of the Mozilla Public
+ License, v. 2.0. If a copy of the MPL was not distributed with this
+ file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+/*!
+ * \file tests/src/merge_fit.cpp
+ * \brief Test that merging fits computed over disjoint subsets of a neighborhood gives the same result as a single fit
+ */
+
+#include "../common/testing.h"
+#include "../common/testUtils.h"
+
+#include "../split_test_helper.h"
+
+#include <Ponca/src/Fitting/basket.h>
+#include <Ponca/src/Fitting/covariancePlaneFit.h>
+#include <Ponca/src/Fitting/mlsSphereFitDer.h>
+#include <Ponca/src/Fitting/mongePatch.h>
+#include <Ponca/src/Fitting/orientedSphereFit.h>
+#include <Ponca/src/Fitting/weightFunc.h>
+#include <Ponca/src/Fitting/weightKernel.h>
+#include <Ponca/src/SpatialPartitioning/KdTree/kdTree.h>
+
+#include <vector>
+
+using namespace std;
+using namespace Ponca;
+
+/// Compute the fit over nbChunks disjoint subsets of ids, and merge them at the end of each pass.
+/// A fit without neighbors is also merged, which must leave the result unchanged.
+template <typename Fit>
+FIT_RESULT computeByChunks(Fit& merged, const std::vector<int>& ids, const std::vector<typename Fit::DataPoint>& points,
+                           int nbChunks)
+{
+    std::vector<Fit> fits(nbChunks);
+    Fit empty;
+    merged.init();
+    FIT_RESULT res;
+    do
+    {
+        for (int t = 0; t < nbChunks; ++t)
+        {
+            fits[t] = merged;
+            fits[t].startNewPass();
+            if (t == 0)
+                empty = fits[0];
+            for (int j = t; j < int(ids.size()); j += nbChunks)
+                fits[t].addNeighbor(points[ids[j]]);
+        }
+        merged = fits[0];
+        for (int t = 1; t < nbChunks; ++t)
+            merged.merge(fits[t]);
+        merged.merge(empty);
+        res = merged.finalize();
+    } while (res == NEED_OTHER_PASS);
+    return res;
+}
+
+template <typename Scalar>
+    requires std::is_floating_point_v<Scalar>
+bool isClose(Scalar a, Scalar b)
+{
+    const Scalar epsilon = Scalar(100) * Eigen::NumTraits<Scalar>::dummy_precision();
+    return std::abs(a - b) <= epsilon * std::max(Scalar(1), std::abs(b));
+}
+
+template <typename Derived1, typename Derived2>
+bool isClose(const Eigen::MatrixBase<Derived1>& a, const Eigen::MatrixBase<Derived2>& b)
+{
+    using Scalar         = typename Derived1::Scalar;
+    const Scalar epsilon = Scalar(100) * Eigen::NumTraits<Scalar>::dummy_precision();
+    return (a - b).norm() <= epsilon * std::max(Scalar(1), b.norm());
+}
+
+template <typename Fit, typename Check>
+void testMerge(const KdTreeDense<typename Fit::DataPoint>& tree, typename Fit::Scalar scale, Check check)
+{
+    const auto& points = tree.points();
+
+    // Quick testing is requested for coverage
+    int size = QUICK_TESTS ? 1 : int(points.size());
+
+#ifdef NDEBUG
+#    pragma omp parallel for
+#endif
+    for (int i = 0; i < size; ++i)
+    {
+        const auto& pos = points[i].pos();
+        std::vector<int> ids;
+        for (int j : tree.rangeNeighbors(pos, scale))
+            ids.push_back(j);
+
+        Fit ref;
+        ref.setNeighborFilter({pos, scale});
+        const FIT_RESULT refRes = ref.computeWithIds(ids, points);
+
+        for (int nbChunks : {1, 3, 8})
+        {
+            Fit merged;
+            merged.setNeighborFilter({pos, scale});
+            const FIT_RESULT res = computeByChunks(merged, ids, points, nbChunks);
+
+            VERIFY(res == refRes);
+            VERIFY(merged.getNumNeighbors() == ref.getNumNeighbors());
+            if (nbChunks == 1)
+            {
+                // Same neighbors in the same order: the results are identical
+                VERIFY(merged.getWeightSum() == ref.getWeightSum());
+            }
+            else
+                VERIFY(isClose(merged.getWeightSum(), ref.getWeightSum()));
+
+            if (merged.isReady())
+                check(merged, ref);
+        }
+    }
+}
+
+template <typename Scalar>
+void callSubTests()
+{
+    using Point          = PointPositionNormal<Scalar, 3>;
+    using NeighborFilter = DistWeightFunc<Point, SmoothWeightKernel<Scalar>>;
+    using PlaneFit       = Basket<Point, NeighborFilter, CovariancePlaneFit>;
+    using SphereFit      = Basket<Point, NeighborFilter, OrientedSphereFit>;
+    using MongeFit       = Basket<Point, NeighborFilter, MongePatchQuadraticFit>;
+    using PlaneDiff      = BasketDiff<PlaneFit, FitScaleSpaceDer, CovariancePlaneDer>;
+    using SphereDiff     = BasketDiff<SphereFit, FitScaleSpaceDer, OrientedSphereDer, MlsSphereFitDer>;
+
+    const int nbPoints  = QUICK_TESTS ? 200 : 1000;
+    const Scalar radius = Eigen::internal::random<Scalar>(1, 10);
+    const Scalar scale  = Scalar(10) * std::sqrt(Scalar(4 * M_PI) * radius * radius / nbPoints);
+
+    std::vector<Point> points(nbPoints);
+    for (auto& p : points)
+        p = getPointOnSphere<Point>(radius, Point::VectorType::Zero(), false, false, false);
+    KdTreeDense<Point> tree(points);
+
+    // Unoriented primitives may flip when the summation order changes: compare them up to their orientation
+    auto checkPlane = [](const auto& f1, const auto& f2) {
+        const auto n1 = f1.primitiveGradient();
+        const auto n2 = f2.primitiveGradient();
+        VERIFY(isClose(n1, n2) || isClose(n1, (-n2).eval()));
+        VERIFY(isClose(std::abs(f1.potential()), std::abs(f2.potential())));
+    };
+    auto checkSphere = [](const auto& f1, const auto& f2) {
+        VERIFY(isClose(f1.potential(), f2.potential()));
+        VERIFY(isClose(f1.primitiveGradient(), f2.primitiveGradient()));
+        VERIFY(isClose(f1.radius(), f2.radius()));
+    };
+    auto checkMonge = [](const auto& f1, const auto& f2) {
+        VERIFY(isClose(std::abs(f1.kMean()), std::abs(f2.kMean())));
+    };
+    auto checkPlaneDiff = [&](const auto& f1, const auto& f2) {
+        checkPlane(f1, f2);
+        const auto dn1 = f1.covariancePlaneDer().dNormal();
+        const auto dn2 = f2.covariancePlaneDer().dNormal();
+        VERIFY(isClose(dn1, dn2) || isClose(dn1, (-dn2).eval()));
+    };
+    auto checkSphereDiff = [&](const auto& f1, const auto& f2) {
+        checkSphere(f1, f2);
+        VERIFY(isClose(f1.dPotential(), f2.dPotential()));
+        VERIFY(isClose(f1.dNormal(), f2.dNormal()));
+    };
+
+    for (int i = 0; i < g_repeat; ++i)
+    {
+        CALL_SUBTEST((testMerge<PlaneFit>(tree, scale, checkPlane)));
+        CALL_SUBTEST((testMerge<SphereFit>(tree, scale, checkSphere)));
+        CALL_SUBTEST((testMerge<MongeFit>(tree, scale, checkMonge)));
+        CALL_SUBTEST((testMerge<PlaneDiff>(tree, scale, checkPlaneDiff)));
+        CALL_SUBTEST((testMerge<SphereDiff>(tree, scale, checkSphereDiff)));
+    }
+}
+
+int main(int argc, char** argv)
+{
+    if (!init_testing(argc, argv))
+    {
+        return EXIT_FAILURE;
+    }
+
+    cout << "Test merge of partial fits..." << endl;
+    CALL_SUBTEST_1((callSubTests<float>()));
+    CALL_SUBTEST_2((callSubTests<double>()));
+    CALL_SUBTEST_3((callSubTests<long double>()));
+    cout << "Ok!" << endl;
+}
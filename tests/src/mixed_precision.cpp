@@ -0,0 +1,176 @@
+/*
+ This Source Code Form is subject to the terms of the Mozilla Public
+ License, v. 2.0. If a copy of the MPL was not distributed with this
+ file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+/*!
+ * \file tests/src/mixed_precision.cpp
+ * \brief Test fitting single precision points with a higher precision, using MixedPrecisionPoint
+ */
+
+#include "../common/testing.h"
+#include "../common/testUtils.h"
+
+#include "../split_test_helper.h"
+
+#include <Ponca/src/Common/pointTypes.h>
+#include <Ponca/src/Fitting/basket.h>
+#include <Ponca/src/Fitting/batchFit.h>
+#include <Ponca/src/Fitting/batchProject.h>
+#include <Ponca/src/Fitting/covariancePlaneFit.h>
+#include <Ponca/src/Fitting/orientedSphereFit.h>
+#include <Ponca/src/Fitting/weightFunc.h>
+#include <Ponca/src/Fitting/weightKernel.h>
+#include <Ponca/src/SpatialPartitioning/KdTree/kdTree.h>
+
+#include <vector>
+
+using namespace std;
+using namespace Ponca;
+
+/*!
+ * \brief Compare the fits of the single precision points computed in AccumScalar to:
+ *  - the same fits of the points converted to AccumScalar, which must be equal,
+ *  - the same fits computed in single precision, which must be less accurate.
+ */
+template <typename AccumScalar, template <class, class, typename> class Ext>
+void testMixedPrecisionFit(const std::vector<PointPositionNormal<float, 3>>& points, float scale)
+{
+    using Point          = PointPositionNormal<float, 3>;
+    using FloatFit       = Basket<Point, DistWeightFunc<Point, SmoothWeightKernel<float>>, Ext>;
+    using ReferencePoint = PointPositionNormal<AccumScalar, 3>;
+    using ReferenceFit   = Basket<ReferencePoint, DistWeightFunc<ReferencePoint, SmoothWeightKernel<AccumScalar>>, Ext>;
+    //! [MixedPrecisionFitType]
+    using MixedPoint = MixedPrecisionPoint<Point, AccumScalar>;
+    using MixedFit   = Basket<MixedPoint, DistWeightFunc<MixedPoint, SmoothWeightKernel<AccumScalar>>, Ext>;
+    //! [MixedPrecisionFitType]
+    using VectorType = typename ReferencePoint::VectorType;
+
+    std::vector<ReferencePoint> referencePoints;
+    referencePoints.reserve(points.size());
+    for (const auto& p : points)
+        referencePoints.emplace_back(p.pos().template cast<AccumScalar>(), p.normal().template cast<AccumScalar>());
+
+    // Quick testing is requested for coverage
+    const int size = QUICK_TESTS ? 1 : int(points.size());
+
+    AccumScalar floatError = 0, mixedError = 0;
+#pragma omp parallel for reduction(+ : floatError, mixedError)
+    for (int i = 0; i < size; ++i)
+    {
+        ReferenceFit ref;
+        ref.setNeighborFilter({referencePoints[i], AccumScalar(scale)});
+        ref.compute(referencePoints);
+
+        // The single precision points are converted when they are added to the fit
+        MixedFit fit;
+        fit.setNeighborFilter({points[i], AccumScalar(scale)});
+        fit.compute(points);
+
+        FloatFit floatFit;
+        floatFit.setNeighborFilter({points[i], scale});
+        floatFit.compute(points);
+
+        VERIFY(fit.isStable() == ref.isStable());
+        if (!ref.isStable() || !floatFit.isStable())
+            continue;
+
+        const VectorType& x = referencePoints[i].pos();
+        VERIFY(fit.primitiveGradient(x) == ref.primitiveGradient(x));
+        VERIFY(fit.potential(x) == ref.potential(x));
+
+        const VectorType n = ref.primitiveGradient(x).normalized();
+        mixedError += std::min((fit.primitiveGradient(x).normalized() - n).norm(),
+                               (fit.primitiveGradient(x).normalized() + n).norm());
+        const VectorType nf = floatFit.primitiveGradient(points[i].pos()).template cast<AccumScalar>().normalized();
+        floatError += std::min((nf - n).norm(), (nf + n).norm());
+    }
+    VERIFY(mixedError <= floatError);
+}
+
+/// Check that batchFit and batchProject accept a fit using a higher precision than the points of the KdTree
+template <typename AccumScalar>
+void testMixedPrecisionBatch(const KdTreeDense<PointPositionNormal<float, 3>>& tree, float scale)
+{
+    using Point      = PointPositionNormal<float, 3>;
+    using MixedPoint = MixedPrecisionPoint<Point, AccumScalar>;
+    using MixedFit =
+        Basket<MixedPoint, DistWeightFunc<MixedPoint, SmoothWeightKernel<AccumScalar>>, OrientedSphereFit>;
+    using VectorType = typename MixedPoint::VectorType;
+
+    const auto& points = tree.points();
+    const int n        = int(points.size());
+
+    std::vector<AccumScalar> potentials(n);
+    std::vector<FIT_RESULT> status(n);
+    BatchFitOutput<AccumScalar> out;
+    out.potentials = potentials.data();
+    out.status     = status.data();
+    batchFit<MixedFit>(tree, points, ConstantScale<AccumScalar>{scale}, out);
+
+    std::vector<Eigen::Vector3f> positions(n);
+    for (int i = 0; i < n; ++i)
+        positions[i] = points[i].pos();
+    batchProject<MixedFit>(tree, positions, ConstantScale<AccumScalar>{scale});
+
+    // Quick testing is requested for coverage
+    const int size = QUICK_TESTS ? 1 : n;
+    for (int i = 0; i < size; ++i)
+    {
+        MixedFit fit;
+        fit.setNeighborFilter({points[i], AccumScalar(scale)});
+        VERIFY(fit.computeWithIds(tree.rangeNeighbors(points[i].pos(), scale), points) == status[i]);
+        if (!fit.isStable())
+            continue;
+        VERIFY(fit.potential() == potentials[i]);
+
+        // The projection is on the fitted surface, up to the single precision output
+        const VectorType proj = positions[i].template cast<AccumScalar>();
+        VERIFY(std::abs(fit.potential(proj)) <= AccumScalar(1e-2) * scale);
+    }
+}
+
+template <typename AccumScalar>
+void callSubTests()
+{
+    using Point = PointPositionNormal<float, 3>;
+
+    // The adapter only stores the attributes of the stored point type
+    static_assert(MixedPrecisionPoint<Point, AccumScalar>::hasNormal);
+    static_assert(!MixedPrecisionPoint<PointPosition<float, 3>, AccumScalar>::hasNormal);
+    static_assert(sizeof(MixedPrecisionPoint<PointPosition<float, 3>, AccumScalar>) ==
+                  sizeof(Eigen::Matrix<AccumScalar, 3, 1>));
+
+    for (int i = 0; i < g_repeat; ++i)
+    {
+        // Points far from the origin, where single precision accumulations lose accuracy
+        const int nbPoints = Eigen::internal::random<int>(500, 2000);
+        const float radius = Eigen::internal::random<float>(1, 10);
+        const float scale  = 10.f * std::sqrt(4.f * float(M_PI) * radius * radius / nbPoints);
+        const Eigen::Vector3f center =
+            Eigen::Vector3f::Random().normalized() * Eigen::internal::random<float>(1e2, 1e3);
+
+        std::vector<Point> points(nbPoints);
+        for (auto& p : points)
+            p = getPointOnSphere<Point>(radius, center, true, true);
+        KdTreeDense<Point> tree(points);
+
+        CALL_SUBTEST((testMixedPrecisionFit<AccumScalar, CovariancePlaneFit>(points, scale)));
+        CALL_SUBTEST((testMixedPrecisionFit<AccumScalar, OrientedSphereFit>(points, scale)));
+        CALL_SUBTEST((testMixedPrecisionBatch<AccumScalar>(tree, scale)));
+    }
+}
+
+int main(int argc, char** argv)
+{
+    if (!init_testing(argc, argv))
+    {
+        return EXIT_FAILURE;
+    }
+
+    cout << "Test mixed precision fits..." << endl;
+    CALL_SUBTEST_1((callSubTests<double>()));
+    CALL_SUBTEST_2((callSubTests<long double>()));
+    cout << "Ok!" << endl;
+}
@@ -90,6 +90,64 @@ void testFunction()
     }
 }
 
+/// Check that reusing the neighborhoods between the MLS iterations gives the same projection as querying them again
+template <typename DataPoint, typename Fit>
+void testCachedNeighborhoods()
+{
+    using Scalar     = typename DataPoint::Scalar;
+    using VectorType = typename DataPoint::VectorType;
+
+    const int nbPoints         = Eigen::internal::random<int>(100, 1000);
+    const Scalar radius        = Eigen::internal::random<Scalar>(1, 10);
+    const VectorType center    = VectorType::Random() * Eigen::internal::random<Scalar>(1, 100);
+    const Scalar analysisScale = Scalar(10.) * std::sqrt(Scalar(4. * M_PI) * radius * radius / nbPoints);
+    const Scalar epsilon       = testEpsilon<Scalar>();
+
+    vector<DataPoint> vectorPoints(nbPoints);
+    for (auto& p : vectorPoints)
+        p = getPointOnSphere<DataPoint>(radius, center, true, true);
+    KdTreeDense<DataPoint> tree(vectorPoints);
+
+    // Quick testing is requested for coverage
+    int size = QUICK_TESTS ? 1 : int(vectorPoints.size());
+
+    MLSEvaluationScheme<Scalar> mls(1000);
+    CachedMLSEvaluationScheme<Scalar> cachedMls(1000);
+    int nbIterations = 0, nbQueries = 0;
+#pragma omp parallel for private(cachedMls) reduction(+ : nbIterations, nbQueries)
+    for (int i = 0; i < size; ++i)
+    {
+        // Offset the evaluation position so that it moves during the MLS iterations
+        const VectorType pos = vectorPoints[i].pos() + vectorPoints[i].normal() * analysisScale * Scalar(0.2);
+
+        Fit fitMLS;
+        fitMLS.setNeighborFilter({pos, analysisScale});
+        const FIT_RESULT res = mls.computeWithTree(fitMLS, tree);
+
+        Fit fitCached;
+        fitCached.setNeighborFilter({pos, analysisScale});
+        //! [Cached MLS Fit]
+        const FIT_RESULT resCached = cachedMls.computeWithTree(fitCached, tree);
+        //! [Cached MLS Fit]
+
+        VERIFY(res == resCached);
+        VERIFY(cachedMls.nbQueries() >= 1);
+        if (!fitMLS.isStable())
+            continue;
+
+        const VectorType& proj       = fitMLS.getNeighborFilter().evalPos();
+        const VectorType& projCached = fitCached.getNeighborFilter().evalPos();
+        VERIFY((proj - projCached).norm() <= epsilon * analysisScale);
+        VERIFY((fitMLS.primitiveGradient(proj).normalized() - fitCached.primitiveGradient(proj).normalized()).norm() <=
+               epsilon);
+
+        // The evaluation position converges: the first cached neighborhood is usually kept until the end
+        ++nbIterations;
+        nbQueries += cachedMls.nbQueries();
+    }
+    VERIFY(nbQueries <= 2 * nbIterations);
+}
+
 template <typename Scalar, int Dim>
 void callSubTests()
 {
@@ -118,6 +176,7 @@ void callSubTests()
     for (int i = 0; i < g_repeat; ++i)
     {
         CALL_SUBTEST((testFunction<Point, Sphere>()));
+        CALL_SUBTEST((testCachedNeighborhoods<Point, Sphere>()));
     }
 }
 
@@ -0,0 +1,139 @@
+/*
+ This Source Code Form is subject to the terms of the Mozilla Public
+ License, v. 2.0. If a copy of the MPL was not distributed with this
+ file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+/*!
+ * \file tests/src/multi_scale_fit.cpp
+ * \brief Test that MultiScaleFit gives the same results as one fit per scale
+ */
+
+#include "../common/testing.h"
+#include "../common/testUtils.h"
+
+#include "../split_test_helper.h"
+
+#include <Ponca/src/Fitting/basket.h>
+#include <Ponca/src/Fitting/covariancePlaneFit.h>
+#include <Ponca/src/Fitting/gls.h>
+#include <Ponca/src/Fitting/mongePatch.h>
+#include <Ponca/src/Fitting/multiScaleFit.h>
+#include <Ponca/src/Fitting/orientedSphereFit.h>
+#include <Ponca/src/Fitting/weightFunc.h>
+#include <Ponca/src/Fitting/weightKernel.h>
+#include <Ponca/src/SpatialPartitioning/KdTree/kdTree.h>
+
+#include <vector>
+
+using namespace std;
+using namespace Ponca;
+
+template <typename Fit, typename Functor>
+void testMultiScaleFit(const KdTreeDense<typename Fit::DataPoint>& tree,
+                       const std::vector<typename Fit::Scalar>& scales, Functor isSame)
+{
+    const auto& points = tree.points();
+
+    // Quick testing is requested for coverage
+    int size = QUICK_TESTS ? 1 : int(points.size());
+
+#ifdef NDEBUG
+#    pragma omp parallel for
+#endif
+    for (int i = 0; i < size; ++i)
+    {
+        const auto& pos = points[i].pos();
+
+        MultiScaleFit<Fit> msFit(scales);
+        msFit.setEvalPos(pos);
+        VERIFY(msFit.size() == int(scales.size()));
+        const auto neighbors = tree.rangeNeighbors(pos, msFit.maxScale());
+        const FIT_RESULT res = msFit.computeWithIds(neighbors, points);
+        VERIFY(res != NEED_OTHER_PASS && res == msFit.getCurrentState());
+
+        for (int s = 0; s < msFit.size(); ++s)
+        {
+            if (s > 0)
+                VERIFY(msFit.scale(s - 1) <= msFit.scale(s));
+
+            // Neighbors out of the scale have a null weight: we get the same fit, with the same summation order
+            Fit fit;
+            fit.setNeighborFilter({pos, msFit.scale(s)});
+            VERIFY(fit.computeWithIds(neighbors, points) == msFit[s].getCurrentState());
+            VERIFY(fit.getNumNeighbors() == msFit[s].getNumNeighbors());
+            VERIFY(res >= msFit[s].getCurrentState());
+            if (fit.isReady())
+                isSame(fit, msFit[s]);
+        }
+    }
+}
+
+template <typename Scalar>
+void callSubTests()
+{
+    using Point          = PointPositionNormal<Scalar, 3>;
+    using NeighborFilter = DistWeightFunc<Point, SmoothWeightKernel<Scalar>>;
+    using GlsFit         = Basket<Point, NeighborFilter, OrientedSphereFit, GLSParam>;
+    using MongeFit       = Basket<Point, NeighborFilter, MongePatchQuadraticFit>;
+    using PlaneDiff =
+        BasketDiff<Basket<Point, NeighborFilter, CovariancePlaneFit>, FitScaleSpaceDer, CovariancePlaneDer>;
+    // Kernels evaluated from the distance instead of the squared distance, and not compact
+    using WendlandFit = Basket<Point, DistWeightFunc<Point, WendlandWeightKernel<Scalar>>, OrientedSphereFit, GLSParam>;
+    using GaussianFit = Basket<Point, DistWeightFunc<Point, GaussianWeightKernel<Scalar>>, OrientedSphereFit, GLSParam>;
+    // Filter without weightFromSquaredDistance: the neighbors are added to each fit with addNeighbor
+    using NoWeightFit = Basket<Point, NoWeightFunc<Point>, OrientedSphereFit, GLSParam>;
+
+    const int nbPoints  = QUICK_TESTS ? 200 : 500;
+    const Scalar radius = Eigen::internal::random<Scalar>(1, 10);
+    const Scalar scale  = Scalar(10) * std::sqrt(Scalar(4 * M_PI) * radius * radius / nbPoints);
+
+    std::vector<Point> points(nbPoints);
+    for (auto& p : points)
+        p = getPointOnSphere<Point>(radius, Point::VectorType::Zero(), false, false, false);
+    KdTreeDense<Point> tree(points);
+
+    // Unsorted scales, the smallest ones having too few neighbors
+    std::vector<Scalar> scales(10);
+    for (auto& s : scales)
+        s = Eigen::internal::random<Scalar>(Scalar(0.05), Scalar(2)) * scale;
+
+    for (int i = 0; i < g_repeat; ++i)
+    {
+        CALL_SUBTEST((testMultiScaleFit<GlsFit>(tree, scales, [](const GlsFit& f1, const GlsFit& f2) {
+            VERIFY(f1.tau() == f2.tau());
+            VERIFY(f1.eta() == f2.eta());
+            VERIFY(f1.kappa() == f2.kappa());
+        })));
+        auto isSameGls = [](const auto& f1, const auto& f2) {
+            VERIFY(f1.tau() == f2.tau());
+            VERIFY(f1.eta() == f2.eta());
+            VERIFY(f1.kappa() == f2.kappa());
+        };
+        CALL_SUBTEST((testMultiScaleFit<WendlandFit>(tree, scales, isSameGls)));
+        CALL_SUBTEST((testMultiScaleFit<GaussianFit>(tree, scales, isSameGls)));
+        CALL_SUBTEST((testMultiScaleFit<NoWeightFit>(tree, scales, isSameGls)));
+        CALL_SUBTEST((testMultiScaleFit<PlaneDiff>(tree, scales, [](const PlaneDiff& f1, const PlaneDiff& f2) {
+            VERIFY(f1.potential() == f2.potential());
+            VERIFY(f1.dPotential() == f2.dPotential());
+            VERIFY(f1.dNormal() == f2.dNormal());
+        })));
+        // MongePatch needs two passes
+        CALL_SUBTEST((testMultiScaleFit<MongeFit>(
+            tree, scales, [](const MongeFit& f1, const MongeFit& f2) { VERIFY(f1.kMean() == f2.kMean()); })));
+    }
+}
+
+int main(int argc, char** argv)
+{
+    if (!init_testing(argc, argv))
+    {
+        return EXIT_FAILURE;
+    }
+
+    cout << "Test MultiScaleFit..." << endl;
+    CALL_SUBTEST_1((callSubTests<float>()));
+    CALL_SUBTEST_2((callSubTests<double>()));
+    CALL_SUBTEST_3((callSubTests<long double>()));
+    cout << "Ok!" << endl;
+}
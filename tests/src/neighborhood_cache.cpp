@@ -0,0 +1,177 @@
+/*
+ This Source Code Form is subject to the terms of the Mozilla Public
+ License, v. 2.0. If a copy of the MPL was not distributed with this
+ file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+/*!
+ * \file tests/src/neighborhood_cache.cpp
+ * \brief Test that fitting from a NeighborhoodCache gives the same results as fitting from range queries
+ */
+
+#include "../common/testing.h"
+#include "../common/testUtils.h"
+
+#include "../split_test_helper.h"
+
+#include <Ponca/src/Fitting/basket.h>
+#include <Ponca/src/Fitting/batchFit.h>
+#include <Ponca/src/Fitting/cnc.h>
+#include <Ponca/src/Fitting/covariancePlaneFit.h>
+#include <Ponca/src/Fitting/mlsEvaluationScheme.h>
+#include <Ponca/src/Fitting/mongePatch.h>
+#include <Ponca/src/Fitting/neighborhoodCache.h>
+#include <Ponca/src/Fitting/orientedSphereFit.h>
+#include <Ponca/src/Fitting/weightFunc.h>
+#include <Ponca/src/Fitting/weightKernel.h>
+#include <Ponca/src/SpatialPartitioning/KdTree/kdTree.h>
+
+#include <vector>
+
+using namespace std;
+using namespace Ponca;
+
+/// Check the ids and squared distances stored in the cache against range queries
+template <typename DataPoint>
+void testCacheContent(const KdTreeDense<DataPoint>& tree, const NeighborhoodCache<typename DataPoint::Scalar>& cache,
+                      typename DataPoint::Scalar scale)
+{
+    const auto& points = tree.points();
+
+    VERIFY(cache.size() == int(points.size()));
+    VERIFY(cache.offsets().back() == cache.nbEntries());
+    for (int i = 0; i < cache.size(); ++i)
+    {
+        VERIFY(cache.scale(i) == scale);
+        const auto ids       = cache.neighbors(i);
+        const auto distances = cache.squaredDistances(i);
+        size_t k             = 0;
+        for (int j : tree.rangeNeighbors(points[i].pos(), scale))
+        {
+            VERIFY(k < ids.size() && ids[k] == j);
+            VERIFY(distances[k] == (points[j].pos() - points[i].pos()).squaredNorm());
+            ++k;
+        }
+        VERIFY(k == ids.size());
+    }
+}
+
+/// Check that fitting from the cache gives the same results as fitting from the range queries
+template <typename Fit>
+void testFit(const KdTreeDense<typename Fit::DataPoint>& tree, const NeighborhoodCache<typename Fit::Scalar>& cache,
+             typename Fit::Scalar scale)
+{
+    const auto& points = tree.points();
+
+    // Quick testing is requested for coverage
+    const int size = QUICK_TESTS ? 1 : int(points.size());
+
+#pragma omp parallel for
+    for (int i = 0; i < size; ++i)
+    {
+        Fit fit;
+        fit.setNeighborFilter({points[i].pos(), scale});
+        const FIT_RESULT res = fit.computeWithIds(tree.rangeNeighbors(points[i].pos(), scale), points);
+
+        //! [NeighborhoodCache Fit]
+        Fit cachedFit;
+        cachedFit.setNeighborFilter({points[i].pos(), scale});
+        const FIT_RESULT cachedRes = cachedFit.computeWithCache(cache, i, points);
+        //! [NeighborhoodCache Fit]
+
+        VERIFY(cachedRes == res);
+        VERIFY(cachedFit == fit);
+    }
+}
+
+/// Check that MLS projections use the cached neighborhoods at all the iterations
+template <typename Fit>
+void testMLS(const KdTreeDense<typename Fit::DataPoint>& tree, const NeighborhoodCache<typename Fit::Scalar>& cache,
+             typename Fit::Scalar scale)
+{
+    using Scalar       = typename Fit::Scalar;
+    const auto& points = tree.points();
+
+    // Quick testing is requested for coverage
+    const int size = QUICK_TESTS ? 1 : int(points.size());
+
+    const MLSEvaluationScheme<Scalar> mls;
+
+#pragma omp parallel for
+    for (int i = 0; i < size; ++i)
+    {
+        Fit fit;
+        fit.setNeighborFilter({points[i].pos(), scale});
+        const FIT_RESULT res = mls.computeWithIds(fit, tree.rangeNeighbors(points[i].pos(), scale), points);
+
+        Fit cachedFit;
+        cachedFit.setNeighborFilter({points[i].pos(), scale});
+        VERIFY(mls.computeWithCache(cachedFit, cache, i, points) == res);
+        VERIFY(cachedFit == fit);
+        VERIFY(cachedFit.getNeighborFilter().evalPos() == fit.getNeighborFilter().evalPos());
+    }
+}
+
+template <typename Scalar>
+void callSubTests()
+{
+    using Point          = PointPositionNormal<Scalar, 3>;
+    using Kernel         = SmoothWeightKernel<Scalar>;
+    using NeighborFilter = DistWeightFunc<Point, Kernel>;
+
+    using Sphere    = Basket<Point, NeighborFilter, OrientedSphereFit>;
+    using Monge     = Basket<Point, NeighborFilter, MongePatchQuadraticFit>;
+    using Plane     = Basket<Point, NeighborFilter, CovariancePlaneFit>;
+    using PlaneDiff = BasketDiff<Plane, FitScaleSpaceDer, CovariancePlaneDer>;
+    using FitCNC    = CNC<Point, UniformGeneration>;
+
+    const int nbPoints  = QUICK_TESTS ? 200 : 1000;
+    const Scalar radius = Eigen::internal::random<Scalar>(1, 10);
+    const Scalar scale  = Scalar(10) * std::sqrt(Scalar(4 * M_PI) * radius * radius / nbPoints);
+
+    std::vector<Point> points(nbPoints);
+    for (auto& p : points)
+        p = getPointOnSphere<Point>(radius, Point::VectorType::Zero(), true, true);
+    KdTreeDense<Point> tree(points);
+
+    //! [NeighborhoodCache]
+    // Query the neighborhoods once
+    NeighborhoodCache<Scalar> cache;
+    cache.build(tree, tree.points(), ConstantScale<Scalar>{scale});
+    // Optionally, store the weights of the neighbors
+    NeighborhoodCache<Scalar> weightedCache = cache;
+    weightedCache.computeWeights(Kernel());
+    //! [NeighborhoodCache]
+    VERIFY(!cache.hasWeights() && weightedCache.hasWeights());
+
+    // The cached neighborhoods would truncate the support of the non-compact filters, which are rejected
+    static_assert(NeighborhoodCache<Scalar>::template isCompatible<NeighborFilter>);
+    static_assert(!NeighborhoodCache<Scalar>::template isCompatible<
+                  DistWeightFunc<Point, GaussianWeightKernel<Scalar>>>);
+    static_assert(!NeighborhoodCache<Scalar>::template isCompatible<NoWeightFunc<Point>>);
+
+    for (int i = 0; i < g_repeat; ++i)
+    {
+        CALL_SUBTEST((testCacheContent(tree, cache, scale)));
+        CALL_SUBTEST((testFit<Sphere>(tree, cache, scale)));
+        CALL_SUBTEST((testFit<Sphere>(tree, weightedCache, scale)));
+        CALL_SUBTEST((testFit<Monge>(tree, cache, scale)));
+        CALL_SUBTEST((testFit<Monge>(tree, weightedCache, scale)));
+        CALL_SUBTEST((testFit<PlaneDiff>(tree, weightedCache, scale)));
+        CALL_SUBTEST((testFit<FitCNC>(tree, cache, scale)));
+        CALL_SUBTEST((testMLS<Sphere>(tree, weightedCache, scale)));
+    }
+}
+
+int main(int argc, char** argv)
+{
+    if (!init_testing(argc, argv))
+    {
+        return EXIT_FAILURE;
+    }
+
+    cout << "Test fitting from a neighborhood cache..." << endl;
+    CALL_SUBTEST_1((callSubTests<float>()));
+    CALL_SUBTEST_2((callSubTests<double>()));
+    cout << "Ok!" << endl;
+}
@@ -0,0 +1,275 @@
+/*
+ This Source Code Form is subject to the terms of the Mozilla Public
+ License, v. 2.0. If a copy of the MPL was not distributed with this
+ file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+/*!
+ * \file tests/src/octree_lod.cpp
+ * \brief Test the Octree nodes, its level of detail queries and the fits computed from the selected nodes
+ */
+
+#include "../common/testing.h"
+#include "../common/testUtils.h"
+
+#include "../split_test_helper.h"
+
+#include <Ponca/src/Fitting/basket.h>
+#include <Ponca/src/Fitting/covariancePlaneFit.h>
+#include <Ponca/src/Fitting/orientedSphereFit.h>
+#include <Ponca/src/Fitting/sphereFit.h>
+#include <Ponca/src/Fitting/weightFunc.h>
+#include <Ponca/src/Fitting/weightKernel.h>
+#include <Ponca/src/SpatialPartitioning/Octree/octree.h>
+
+#include <vector>
+
+using namespace std;
+using namespace Ponca;
+
+template <typename Scalar>
+    requires std::is_floating_point_v<Scalar>
+bool isClose(Scalar a, Scalar b)
+{
+    const Scalar epsilon = Scalar(1000) * Eigen::NumTraits<Scalar>::dummy_precision();
+    return std::abs(a - b) <= epsilon * std::max(Scalar(1), std::abs(b));
+}
+
+template <typename Derived1, typename Derived2>
+bool isClose(const Eigen::MatrixBase<Derived1>& a, const Eigen::MatrixBase<Derived2>& b)
+{
+    using Scalar         = typename Derived1::Scalar;
+    const Scalar epsilon = Scalar(1000) * Eigen::NumTraits<Scalar>::dummy_precision();
+    return (a - b).norm() <= epsilon * std::max(Scalar(1), b.norm());
+}
+
+/// Check the structure of the tree and the aggregates of each node against the ones computed from its samples
+template <typename Tree>
+void testNodes(const Tree& tree, int leafSize)
+{
+    using DataPoint  = typename Tree::DataPoint;
+    using Scalar     = typename DataPoint::Scalar;
+    using VectorType = typename DataPoint::VectorType;
+    using MatrixType = typename Tree::NodeType::Moments::MatrixType;
+
+    VERIFY(tree.nodeCount() > 0);
+    VERIFY(tree.nodes()[0].sample_start() == 0);
+    VERIFY(tree.nodes()[0].sample_size() == tree.sampleCount());
+    VERIFY(tree.nodes()[0].depth() == 0);
+
+    // Each point is indexed once
+    std::vector<int> seen(tree.pointCount(), 0);
+    for (int i = 0; i < tree.sampleCount(); ++i)
+        ++seen[tree.samples()[i]];
+    VERIFY(std::all_of(seen.begin(), seen.end(), [](int s) { return s == 1; }));
+
+    for (int id = 0; id < tree.nodeCount(); ++id)
+    {
+        const auto& node = tree.nodes()[id];
+        VERIFY(node.sample_size() > 0);
+        VERIFY(node.moments().count == node.sample_size());
+
+        if (node.is_leaf())
+            VERIFY(node.sample_size() <= leafSize || node.depth() == Tree::MAX_DEPTH);
+        else
+        {
+            // The children partition the samples of the node
+            VERIFY(node.child_count() <= (1 << DataPoint::Dim));
+            int start = node.sample_start();
+            for (int c = 0; c < node.child_count(); ++c)
+            {
+                const auto& child = tree.nodes()[node.first_child_id() + c];
+                VERIFY(child.depth() == node.depth() + 1);
+                VERIFY(child.sample_start() == start);
+                start += child.sample_size();
+            }
+            VERIFY(start == node.sample_start() + node.sample_size());
+        }
+
+        const int end       = node.sample_start() + node.sample_size();
+        VectorType centroid = VectorType::Zero();
+        typename Tree::NodeType::AabbType aabb;
+        aabb.setEmpty();
+        for (int i = node.sample_start(); i < end; ++i)
+        {
+            centroid += tree.pointDataFromSample(i).pos();
+            aabb.extend(tree.pointDataFromSample(i).pos());
+        }
+        centroid /= Scalar(node.sample_size());
+        MatrixType scatter = MatrixType::Zero();
+        for (int i = node.sample_start(); i < end; ++i)
+        {
+            const VectorType q = tree.pointDataFromSample(i).pos() - centroid;
+            scatter += q * q.transpose();
+        }
+        // The aggregates of the inner nodes are merged from their children
+        VERIFY(isClose(node.moments().centroid, centroid));
+        VERIFY(isClose(node.moments().scatter, scatter));
+        VERIFY(node.aabb().isApprox(aabb));
+        VERIFY(node.error() >= 0);
+
+        // The representative of a leaf is its sample closest to the centroid, the one of an inner node is the
+        // representative of one of its children
+        VERIFY(node.representative() >= node.sample_start() && node.representative() < end);
+        if (node.is_leaf())
+        {
+            const Scalar d = (tree.pointDataFromSample(node.representative()).pos() - centroid).squaredNorm();
+            for (int i = node.sample_start(); i < end; ++i)
+                VERIFY(d <= (tree.pointDataFromSample(i).pos() - centroid).squaredNorm());
+        }
+        else
+        {
+            bool found = false;
+            for (int c = 0; c < node.child_count(); ++c)
+                found = found || tree.nodes()[node.first_child_id() + c].representative() == node.representative();
+            VERIFY(found);
+        }
+    }
+}
+
+/// Check that the selected nodes are disjoint, cover the samples in the query ball, and match the level of detail
+template <typename Tree>
+void testLodQuery(const Tree& tree, typename Tree::Scalar radius, int maxDepth, typename Tree::Scalar maxError)
+{
+    const int nbQueries = QUICK_TESTS ? 5 : 50;
+    auto query          = tree.lodNeighborsQuery();
+    query.setMaxDepth(maxDepth);
+    query.setMaxError(maxError);
+    for (int q = 0; q < nbQueries; ++q)
+    {
+        const auto& point = tree.points()[Eigen::internal::random<int>(0, tree.pointCount() - 1)].pos();
+
+        std::vector<int> covered(tree.sampleCount(), 0);
+        for (int id : query(point, radius))
+        {
+            const auto& node = tree.nodes()[id];
+            VERIFY(node.is_leaf() || node.depth() >= maxDepth || node.error() <= maxError);
+            VERIFY(node.depth() <= std::max(maxDepth, 0));
+            VERIFY(node.aabb().squaredExteriorDistance(point) <= radius * radius);
+            for (int i = node.sample_start(); i < node.sample_start() + node.sample_size(); ++i)
+                ++covered[i];
+        }
+
+        for (int i = 0; i < tree.sampleCount(); ++i)
+        {
+            VERIFY(covered[i] <= 1);
+            if ((tree.pointDataFromSample(i).pos() - point).squaredNorm() < radius * radius)
+                VERIFY(covered[i] == 1);
+        }
+    }
+
+    // The cut of the whole tree covers all the samples
+    int count = 0;
+    for (int id : tree.lodNodes(maxDepth, maxError))
+        count += tree.nodes()[id].sample_size();
+    VERIFY(count == tree.sampleCount());
+}
+
+/// Check that the fits computed from the selected nodes match the fits computed from the samples
+///
+/// With a uniform weight, the moments of the nodes contained in the support and the samples of the nodes crossing its
+/// boundary sum to the moments of the samples in the support, whatever the level of detail. The fits that do not
+/// accept moments add the samples one by one.
+template <typename Fit, typename Tree, typename Check>
+void testComputeWithNodes(const Tree& tree, typename Fit::Scalar scale, int maxDepth, Check check)
+{
+    using Scalar       = typename Fit::Scalar;
+    const auto& points = tree.points();
+
+    // Quick testing is requested for coverage
+    const int size = QUICK_TESTS ? 1 : 20;
+    for (int q = 0; q < size; ++q)
+    {
+        const auto& pos = points[Eigen::internal::random<int>(0, tree.pointCount() - 1)].pos();
+
+        Fit ref;
+        ref.setNeighborFilter({pos, scale});
+        const FIT_RESULT refRes = ref.compute(points);
+
+        Fit fit;
+        fit.setNeighborFilter({pos, scale});
+        const FIT_RESULT res = fit.computeWithNodes(tree.lodNeighbors(pos, scale * Scalar(1.01), maxDepth), tree);
+
+        VERIFY(res == refRes);
+        VERIFY(fit.getNumNeighbors() == ref.getNumNeighbors());
+        VERIFY(isClose(fit.getWeightSum(), ref.getWeightSum()));
+        if (fit.isStable())
+            check(fit, ref);
+    }
+}
+
+template <typename Scalar>
+void callSubTests()
+{
+    using Point         = PointPositionNormal<Scalar, 3>;
+    using UniformFilter = DistWeightFunc<Point, ConstantWeightKernel<Scalar>>;
+    using PlaneFit      = Basket<Point, UniformFilter, CovariancePlaneFit>;
+    using SphereFit     = Basket<Point, UniformFilter, OrientedSphereFit>;
+    using AlgebraicFit  = Basket<Point, UniformFilter, Ponca::SphereFit>;
+
+    static_assert(PlaneFit::isMomentCompatible);
+    static_assert(!AlgebraicFit::isMomentCompatible);
+
+    const int nbPoints  = QUICK_TESTS ? 500 : 5000;
+    const int leafSize  = 16;
+    const Scalar radius = Eigen::internal::random<Scalar>(1, 10);
+    const Scalar scale  = Scalar(10) * std::sqrt(Scalar(4 * M_PI) * radius * radius / nbPoints);
+
+    std::vector<Point> points(nbPoints);
+    for (auto& p : points)
+        p = getPointOnSphere<Point>(radius, Point::VectorType::Zero(), true, false, false);
+    Octree<Point> tree(points, leafSize);
+
+    // Test the Octree with raw memory pointers
+    using OctreePointerStatic = StaticOctreeBase<OctreePointerTraits<Point>>;
+    auto buffers              = tree.buffers();
+    typename OctreePointerStatic::Buffers staticBuffers{buffers.points.data(), buffers.indices.data(),
+                                                        buffers.nodes.data(),  buffers.points_size,
+                                                        buffers.indices_size,  buffers.nodes_size};
+    OctreePointerStatic treeStatic(staticBuffers);
+
+    auto checkPlane = [](const auto& f1, const auto& f2) {
+        const auto n1 = f1.primitiveGradient();
+        const auto n2 = f2.primitiveGradient();
+        VERIFY(isClose(n1, n2) || isClose(n1, (-n2).eval()));
+    };
+    auto checkSphere = [](const auto& f1, const auto& f2) {
+        VERIFY(isClose(f1.potential(), f2.potential()));
+        VERIFY(isClose(f1.primitiveGradient(), f2.primitiveGradient()));
+    };
+
+    CALL_SUBTEST((testNodes(tree, leafSize)));
+    CALL_SUBTEST((testNodes(treeStatic, leafSize)));
+    for (int i = 0; i < g_repeat; ++i)
+    {
+        CALL_SUBTEST((testLodQuery(tree, scale, Octree<Point>::MAX_DEPTH, Scalar(-1))));
+        CALL_SUBTEST((testLodQuery(tree, scale, 3, Scalar(-1))));
+        CALL_SUBTEST((testLodQuery(tree, Scalar(0.5) * radius, Octree<Point>::MAX_DEPTH, Scalar(0.01) * radius)));
+        CALL_SUBTEST((testLodQuery(treeStatic, scale, 4, Scalar(0.001) * radius)));
+
+        // The support covers all the points, or only a part of the selected nodes which are then refined
+        for (int depth : {1, 3, int(Octree<Point>::MAX_DEPTH)})
+        {
+            CALL_SUBTEST((testComputeWithNodes<PlaneFit>(tree, Scalar(3) * radius, depth, checkPlane)));
+            CALL_SUBTEST((testComputeWithNodes<SphereFit>(tree, Scalar(3) * radius, depth, checkSphere)));
+            CALL_SUBTEST((testComputeWithNodes<PlaneFit>(tree, scale, depth, checkPlane)));
+            CALL_SUBTEST((testComputeWithNodes<SphereFit>(tree, scale, depth, checkSphere)));
+        }
+        // The samples of the selected nodes are added one by one. The algebraic sphere is unoriented
+        CALL_SUBTEST((testComputeWithNodes<AlgebraicFit>(tree, scale, 2, checkPlane)));
+    }
+}
+
+int main(int argc, char** argv)
+{
+    if (!init_testing(argc, argv))
+    {
+        return EXIT_FAILURE;
+    }
+
+    cout << "Test Octree level of detail queries and fits..." << endl;
+    CALL_SUBTEST_1((callSubTests<float>()));
+    CALL_SUBTEST_2((callSubTests<double>()));
+    CALL_SUBTEST_3((callSubTests<long double>()));
+    cout << "Ok!" << endl;
+}
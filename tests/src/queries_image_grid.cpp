@@ -0,0 +1,229 @@
+/*
+ This Source Code Form is subject to the terms of the Mozilla Public
+ License, v. 2.0. If a copy of the MPL was not distributed with this
+ file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+/*!
+ * \file tests/src/queries_image_grid.cpp
+ * \brief Test the range, window and k-nearest neighbors queries of the ImageGrid, and fitting from its queries
+ */
+
+#include "../common/testing.h"
+#include "../common/testUtils.h"
+#include "../split_test_helper.h"
+
+#include <Ponca/src/Fitting/basket.h>
+#include <Ponca/src/Fitting/orientedSphereFit.h>
+#include <Ponca/src/Fitting/weightFunc.h>
+#include <Ponca/src/Fitting/weightKernel.h>
+#include <Ponca/src/SpatialPartitioning/ImageGrid/imageGrid.h>
+#include <Ponca/src/SpatialPartitioning/KdTree/kdTree.h>
+
+#include <algorithm>
+#include <vector>
+
+using namespace std;
+using namespace Ponca;
+
+/// Generate the depth image of two wavy planes seen by a pinhole camera, with a depth discontinuity between the left
+/// and the right half of the image, and with some missing measurements (null points)
+template <typename DataPoint>
+std::vector<DataPoint> generateDepthImage(int _width, int _height)
+{
+    using Scalar     = typename DataPoint::Scalar;
+    using VectorType = typename DataPoint::VectorType;
+
+    const Scalar focal = Scalar(_width);
+    std::vector<DataPoint> points(size_t(_width) * _height);
+    for (int y = 0; y < _height; ++y)
+        for (int x = 0; x < _width; ++x)
+        {
+            DataPoint& p = points[y * _width + x];
+            if (Eigen::internal::random<Scalar>(0, 1) < Scalar(0.05))
+            {
+                p.pos()    = VectorType::Zero();
+                p.normal() = VectorType::Zero();
+                continue;
+            }
+            const Scalar u     = (Scalar(x) - Scalar(_width) / 2) / focal;
+            const Scalar v     = (Scalar(y) - Scalar(_height) / 2) / focal;
+            const Scalar depth = (x < _width / 2 ? Scalar(2) : Scalar(3)) + Scalar(0.05) * std::sin(Scalar(10) * u);
+            p.pos()            = VectorType(u * depth, v * depth, depth);
+            p.normal()         = VectorType(0, 0, -1);
+        }
+    return points;
+}
+
+/// Ids of the neighbors of `_i` selected by a brute force scan of its window, in raster order
+template <typename Grid>
+std::vector<int> bruteForceWindow(const Grid& _grid, int _i, int _windowRadius, typename Grid::Scalar _r)
+{
+    std::vector<int> ids;
+    if (!_grid.isValid(_i))
+        return ids;
+    const int x = _i % _grid.width();
+    const int y = _i / _grid.width();
+    for (int ny = std::max(y - _windowRadius, 0); ny <= std::min(y + _windowRadius, _grid.height() - 1); ++ny)
+        for (int nx = std::max(x - _windowRadius, 0); nx <= std::min(x + _windowRadius, _grid.width() - 1); ++nx)
+        {
+            const int j = _grid.pixelIndex(nx, ny);
+            if (j != _i && _grid.isValid(j) &&
+                std::abs(_grid.depth(j) - _grid.depth(_i)) <= _grid.maxDepthDifference() &&
+                (_grid.points()[j].pos() - _grid.points()[_i].pos()).squaredNorm() < _r * _r)
+                ids.push_back(j);
+        }
+    return ids;
+}
+
+/// Check the range, window and k-nearest neighbors queries against a brute force scan of the windows
+template <typename Grid>
+void testQueries(const Grid& _grid, typename Grid::Scalar _r, int _k)
+{
+    using Scalar = typename Grid::Scalar;
+
+    // Quick testing is requested for coverage
+    const int size = QUICK_TESTS ? std::min(100, _grid.pointCount()) : _grid.pointCount();
+
+    auto rangeQuery = _grid.rangeNeighborsIndexQuery();
+    auto knnQuery   = _grid.kNearestNeighborsIndexQuery();
+    for (int i = 0; i < size; ++i)
+    {
+        const std::vector<int> expected = bruteForceWindow(_grid, i, _grid.windowRadius(), _r);
+
+        std::vector<int> ids;
+        for (int j : _grid.rangeNeighbors(i, _r))
+            ids.push_back(j);
+        VERIFY(ids == expected);
+
+        // Mutable query
+        ids.clear();
+        for (int j : rangeQuery(i, _r))
+            ids.push_back(j);
+        VERIFY(ids == expected);
+
+        // The window query ignores the distances
+        const int halfSize = 1 + i % 3;
+        ids.clear();
+        for (int j : _grid.windowNeighbors(i, halfSize))
+            ids.push_back(j);
+        VERIFY(ids == bruteForceWindow(_grid, i, halfSize, std::numeric_limits<Scalar>::infinity()));
+
+        // The k-nearest neighbors are the closest candidates of the window
+        std::vector<Scalar> candidates;
+        for (int j : bruteForceWindow(_grid, i, _grid.windowRadius(), std::numeric_limits<Scalar>::infinity()))
+            candidates.push_back((_grid.points()[j].pos() - _grid.points()[i].pos()).squaredNorm());
+        std::sort(candidates.begin(), candidates.end());
+        candidates.resize(std::min(int(candidates.size()), _k));
+
+        std::vector<Scalar> distances;
+        auto& query = knnQuery(i, _k);
+        for (auto it = query.begin(); it != query.end(); ++it)
+        {
+            VERIFY(it.squaredDistance() == (_grid.points()[*it].pos() - _grid.points()[i].pos()).squaredNorm());
+            distances.push_back(it.squaredDistance());
+        }
+        std::sort(distances.begin(), distances.end());
+        VERIFY(distances == candidates);
+    }
+}
+
+/// Check that, when the windows cover the whole image and the depth threshold is disabled, the range queries give the
+/// same neighbors as a KdTree built over the valid pixels
+template <typename DataPoint>
+void testKdTreeEquivalence(const ImageGrid<DataPoint>& _grid, typename DataPoint::Scalar _r)
+{
+    ImageGrid<DataPoint> grid = _grid;
+    grid.setWindowRadius(std::max(grid.width(), grid.height()));
+    grid.setMaxDepthDifference(std::numeric_limits<typename DataPoint::Scalar>::infinity());
+
+    const KdTreeSparse<DataPoint> kdtree(grid.points(), grid.samples());
+    const int size = QUICK_TESTS ? std::min(20, grid.sampleCount()) : grid.sampleCount();
+    for (int s = 0; s < size; ++s)
+    {
+        const int i = grid.samples()[s];
+        std::vector<int> ids, expected;
+        for (int j : grid.rangeNeighbors(i, _r))
+            ids.push_back(j);
+        for (int j : kdtree.rangeNeighbors(i, _r))
+            expected.push_back(j);
+        std::sort(expected.begin(), expected.end());
+        VERIFY(ids == expected);
+    }
+}
+
+/// Check that the fits run unchanged on the ImageGrid queries
+template <typename Fit>
+void testFit(const ImageGrid<typename Fit::DataPoint>& _grid, typename Fit::Scalar _r)
+{
+    const auto& points = _grid.points();
+    const int size     = QUICK_TESTS ? std::min(20, _grid.sampleCount()) : _grid.sampleCount();
+
+#pragma omp parallel for
+    for (int s = 0; s < size; ++s)
+    {
+        const int i = _grid.samples()[s];
+
+        //! [ImageGrid fit]
+        Fit fit;
+        fit.setNeighborFilter({points[i].pos(), _r});
+        const FIT_RESULT res = fit.computeWithIds(_grid.rangeNeighbors(i, _r), points);
+        //! [ImageGrid fit]
+
+        Fit reference;
+        reference.setNeighborFilter({points[i].pos(), _r});
+        VERIFY(reference.computeWithIds(bruteForceWindow(_grid, i, _grid.windowRadius(), _r), points) == res);
+        VERIFY(reference == fit);
+    }
+}
+
+template <typename Scalar>
+void callSubTests()
+{
+    using Point = PointPositionNormal<Scalar, 3>;
+    using Fit   = Basket<Point, DistWeightFunc<Point, SmoothWeightKernel<Scalar>>, OrientedSphereFit>;
+
+    const int width  = QUICK_TESTS ? 32 : 64;
+    const int height = QUICK_TESTS ? 24 : 48;
+    const Scalar r   = Scalar(4) * Scalar(2) / Scalar(width); // About 4 pixels on the closest plane
+    const int k      = 10;
+
+    //! [ImageGrid construction]
+    // Points stored in raster order, scanned in windows of 9*9 pixels, without crossing depth gaps larger than 0.5
+    ImageGrid<Point> grid(generateDepthImage<Point>(width, height), width, height, 4, Scalar(0.5));
+    //! [ImageGrid construction]
+
+    VERIFY(grid.pointCount() == width * height);
+    for (int s = 0; s < grid.sampleCount(); ++s)
+        VERIFY(grid.isValid(grid.samples()[s]) && grid.depth(grid.samples()[s]) > Scalar(0));
+
+    // Test the ImageGrid with raw memory pointers
+    using ImageGridPointerStatic = StaticImageGridBase<ImageGridPointerTraits<Point>>;
+    auto bufs                    = grid.buffers();
+    typename ImageGridPointerStatic::Buffers staticBufs{
+        bufs.points.data(), bufs.indices.data(), bufs.depths.data(), bufs.sampleFromPixel.data(),
+        bufs.points_size,   bufs.indices_size,   bufs.width,         bufs.height,
+        bufs.windowRadius,  bufs.maxDepthDifference};
+    ImageGridPointerStatic gridStatic(staticBufs);
+
+    for (int i = 0; i < g_repeat; ++i)
+    {
+        CALL_SUBTEST((testQueries(grid, r, k)));
+        CALL_SUBTEST((testQueries(gridStatic, r, k)));
+        CALL_SUBTEST((testKdTreeEquivalence(grid, r)));
+        CALL_SUBTEST((testFit<Fit>(grid, r)));
+    }
+}
+
+int main(int argc, char** argv)
+{
+    if (!init_testing(argc, argv))
+    {
+        return EXIT_FAILURE;
+    }
+
+    cout << "Test the queries of the ImageGrid..." << endl;
+    CALL_SUBTEST_1((callSubTests<float>()));
+    CALL_SUBTEST_2((callSubTests<double>()));
+    cout << "Ok!" << endl;
+}
@@ -17,6 +17,7 @@
 
 #include <Ponca/src/SpatialPartitioning/KdTree/kdTree.h>
 #include <Ponca/src/SpatialPartitioning/KnnGraph/knnGraph.h>
+#include <Ponca/src/SpatialPartitioning/HashGrid/hashGrid.h>
 #include <Ponca/src/Common/pointTypes.h>
 
 #define PRINT_TIMING
@@ -138,6 +139,148 @@ void buildAndTestKnnGraph(KdTree& kdtree, const int k, const std::string& name =
 #endif
 }
 
+//! \brief Build a KnnGraph over the samples of a KdTreeSparse, and compare it with the kdtree queries
+template <typename P, typename KdTree>
+void buildAndTestSparseKnnGraph(KdTree& kdtree, const int k)
+{
+    KnnGraph<P> knnGraph(kdtree, k);
+    VERIFY(knnGraph.hasPointMapping());
+    VERIFY(int(knnGraph.size()) == kdtree.sampleCount());
+    VERIFY(knnGraph.pointCount() == kdtree.sampleCount());
+
+    // Vertex ids are sample ids, and neighbors are the k-nearest samples
+    std::vector<int> vertexFromPoint(kdtree.pointCount(), -1);
+    for (int i = 0; i < kdtree.sampleCount(); ++i)
+    {
+        VERIFY(knnGraph.pointFromVertex(i) == kdtree.pointFromSample(i));
+        VERIFY(knnGraph.points()[i].pos() == kdtree.points()[kdtree.pointFromSample(i)].pos());
+        vertexFromPoint[kdtree.pointFromSample(i)] = i;
+    }
+    for (int i = 0; i < int(knnGraph.size()); ++i)
+    {
+        std::vector<int> neighbors, neighborsRef;
+        for (int n : knnGraph.kNearestNeighbors(i))
+            neighbors.push_back(n);
+        for (int n : kdtree.kNearestNeighbors(knnGraph.pointFromVertex(i), k))
+            neighborsRef.push_back(vertexFromPoint[n]);
+        VERIFY(neighbors == neighborsRef);
+    }
+
+    // The point mapping is kept by the graph with raw memory pointers
+    using KnnGraphPointerStatic = StaticKnnGraphBase<KnnGraphPointerTraits<P>>;
+    auto buffers                = knnGraph.buffers();
+    typename KnnGraphPointerStatic::Buffers staticBuffers{
+        buffers.points.data(), buffers.indices.data(), buffers.distances.data(), buffers.pointIds.data(),
+        buffers.points_size,   buffers.indices_size,   buffers.distances_size,   buffers.pointIds_size, k};
+    KnnGraphPointerStatic knnGraphStatic(staticBuffers);
+    VERIFY(knnGraphStatic.hasPointMapping());
+    for (int i = 0; i < int(knnGraph.size()); ++i)
+    {
+        VERIFY(knnGraphStatic.pointFromVertex(i) == knnGraph.pointFromVertex(i));
+        std::vector<int> neighbors, neighborsStatic;
+        for (int n : knnGraph.kNearestNeighbors(i))
+            neighbors.push_back(n);
+        for (int n : knnGraphStatic.kNearestNeighbors(i))
+            neighborsStatic.push_back(n);
+        VERIFY(neighbors == neighborsStatic);
+    }
+}
+
+//! \brief Move some points, update a KnnGraph, and compare it with a KnnGraph built from scratch
+//!
+//! The graph is updated twice from the KdTree used to build it, so that the second update also searches the points
+//! moved by the first one.
+template <typename P>
+void testKnnGraphUpdate(std::vector<P> points, const int k, const bool storeDistances)
+{
+    using Scalar = typename P::Scalar;
+
+    const KdTreeDense<P> kdtree(points);
+    KnnGraph<P> knnGraph(kdtree, k, storeDistances);
+
+    for (int step = 0; step < 2; ++step)
+    {
+        // Move about 5% of the points, some of them by a large amount
+        std::vector<int> changed;
+        for (int i = 0; i < int(points.size()); ++i)
+        {
+            if (Eigen::internal::random<int>(0, 19) != 0)
+                continue;
+            const Scalar amplitude = Eigen::internal::random<int>(0, 1) == 0 ? Scalar(0.01) : Scalar(0.5);
+            points[i].pos() += amplitude * P::VectorType::Random();
+            changed.push_back(i);
+        }
+
+        auto start          = std::chrono::system_clock::now();
+        const int nbUpdated = knnGraph.update(kdtree, points, changed);
+        auto end            = std::chrono::system_clock::now();
+        VERIFY(nbUpdated >= int(changed.size()) && nbUpdated <= int(points.size()));
+        const auto updateTiming = std::chrono::duration_cast<std::chrono::milliseconds>(end - start);
+
+        start = std::chrono::system_clock::now();
+        KnnGraph<P> knnGraphRef(KdTreeDense<P>(points), k, storeDistances);
+        end                      = std::chrono::system_clock::now();
+        const auto rebuildTiming = std::chrono::duration_cast<std::chrono::milliseconds>(end - start);
+#ifdef PRINT_TIMING
+        cout << "    KnnGraph update of " << changed.size() << " points (" << nbUpdated
+             << " lists recomputed) : " << updateTiming.count() << "ms, rebuild : " << rebuildTiming.count() << "ms"
+             << endl;
+#endif
+
+        VERIFY(knnGraph.size() == knnGraphRef.size());
+        for (int i = 0; i < int(points.size()); ++i)
+        {
+            VERIFY(knnGraph.points()[i].pos() == points[i].pos());
+
+            // Equidistant neighbors may be stored in a different order
+            std::vector<int> neighbors, neighborsRef;
+            for (int n : knnGraph.kNearestNeighbors(i))
+                neighbors.push_back(n);
+            for (int n : knnGraphRef.kNearestNeighbors(i))
+                neighborsRef.push_back(n);
+            std::sort(neighbors.begin(), neighbors.end());
+            std::sort(neighborsRef.begin(), neighborsRef.end());
+            VERIFY(neighbors == neighborsRef);
+
+            if (storeDistances)
+                for (int j = 0; j < k; ++j)
+                    VERIFY(knnGraph.edgeSquaredDistance(i, j) == knnGraphRef.edgeSquaredDistance(i, j));
+        }
+    }
+}
+
+//! \brief Build a HashGrid and test the KNearestNeighbors Query with default container type and raw memory pointers
+template <typename P>
+void buildAndTestHashGrid(std::vector<P>& points, std::vector<int>& sampleDense, const int k,
+                          const typename P::Scalar cellSize, const std::string& name = "HashGrid")
+{
+    HashGrid<P> grid(points, cellSize);
+
+    std::chrono::milliseconds timing = testKNearestNeighbors<true>(grid, points, sampleDense, k); // Index query test
+#ifdef PRINT_TIMING
+    cout << "    Compute Time " << name << " index query : " << timing.count() << "ms" << endl;
+#endif
+    timing = testKNearestNeighbors<false>(grid, points, sampleDense, k); // Position query test
+#ifdef PRINT_TIMING
+    cout << "    Compute Time " << name << " position query : " << timing.count() << "ms" << endl;
+#endif
+
+    // Test the HashGrid with raw memory pointers
+    using HashGridPointerStatic = StaticHashGridBase<HashGridPointerTraits<P>>;
+    auto gridBuffers            = grid.buffers(); // Buffer that use STL-like containers
+    // Convert previous HashGrid to pointers
+    typename HashGridPointerStatic::Buffers gridStaticBuffers{
+        gridBuffers.points.data(),  gridBuffers.indices.data(), gridBuffers.keys.data(),
+        gridBuffers.offsets.data(), gridBuffers.points_size,    gridBuffers.indices_size,
+        gridBuffers.offsets_size,   gridBuffers.origin,         gridBuffers.cellSize,
+        gridBuffers.cellCounts};
+    HashGridPointerStatic gridStatic(gridStaticBuffers);
+    timing = testKNearestNeighbors<true>(gridStatic, points, sampleDense, k); // Index query test
+#ifdef PRINT_TIMING
+    cout << "    Compute Time " << name << " (with pointers) index query : " << timing.count() << "ms" << endl;
+#endif
+}
+
 template <typename Scalar, int Dim>
 void testKNearestNeighborsForAllStructures(const bool quick = QUICK_TESTS)
 {
@@ -154,11 +297,22 @@ void testKNearestNeighborsForAllStructures(const bool quick = QUICK_TESTS)
     auto kdtreeDense = buildAndTestKdTree<KdTreeDense>(points, sampleDense, k);
 
     std::vector<int> sampleSparse;
-    buildAndTestKdTree<KdTreeSparse>(points, sampleSparse, k, "KdTreeSparse");
+    auto kdtreeSparse = buildAndTestKdTree<KdTreeSparse>(points, sampleSparse, k, "KdTreeSparse");
     testStaticKdTree<P>(kdtreeDense, k);
 
     //////////// Test KnnGraph
     buildAndTestKnnGraph<P>(kdtreeDense, k);
+    buildAndTestSparseKnnGraph<P>(kdtreeSparse, k);
+    cout << "  (ok)" << endl;
+
+    //////////// Test HashGrid, with cells smaller and larger than the neighborhoods
+    buildAndTestHashGrid<P>(points, sampleDense, k, Scalar(0.35));
+    buildAndTestHashGrid<P>(points, sampleDense, k, Scalar(0.7), "HashGrid (large cells)");
+    cout << "  (ok)" << endl;
+
+    //////////// Test KnnGraph update
+    testKnnGraphUpdate(points, k, false);
+    testKnnGraphUpdate(points, k, true);
     cout << "  (ok)" << endl;
 }
 
@@ -167,7 +321,7 @@ int main(const int argc, char** argv)
     if (!init_testing(argc, argv))
         return EXIT_FAILURE;
 
-    cout << "Test kNearestNeighbors query for KdTree and KnnGraph in 3D : " << endl;
+    cout << "Test kNearestNeighbors query for KdTree, KnnGraph and HashGrid in 3D : " << endl;
     cout << "  float : " << endl;
     CALL_SUBTEST_1((testKNearestNeighborsForAllStructures<float, 3>()));
     cout << "  double : " << endl;
@@ -175,7 +329,7 @@ int main(const int argc, char** argv)
     cout << "  long : " << endl;
     CALL_SUBTEST_3((testKNearestNeighborsForAllStructures<long double, 3>()));
 
-    cout << "Test kNearestNeighbors query for KdTree and KnnGraph in 4D : " << endl;
+    cout << "Test kNearestNeighbors query for KdTree, KnnGraph and HashGrid in 4D : " << endl;
     cout << "  float : " << endl;
     CALL_SUBTEST_1((testKNearestNeighborsForAllStructures<float, 4>()));
     cout << "  double : " << endl;
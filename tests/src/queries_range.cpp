@@ -16,6 +16,7 @@
 
 #include <Ponca/src/SpatialPartitioning/KdTree/kdTree.h>
 #include <Ponca/src/SpatialPartitioning/KnnGraph/knnGraph.h>
+#include <Ponca/src/SpatialPartitioning/HashGrid/hashGrid.h>
 #include <Ponca/src/Common/pointTypes.h>
 
 #define PRINT_TIMING
@@ -120,6 +121,128 @@ void buildAndTestKnnGraph(KdTree& kdtree, std::vector<int>& sampleDense, const s
     timing = testRangeNeighbors<true>(knnGraphStatic, points, sampleDense); // Index query test
 #ifdef PRINT_TIMING
     cout << "    Compute Time " << name << " (with pointers) index query : " << timing.count() << "ms" << endl;
+#endif
+    cout << "  (ok)" << endl;
+
+    // Test KnnGraph storing the edge lengths, used to prune the traversal
+    KnnGraph<P> knnGraphDist(kdtree, k, true);
+    VERIFY(knnGraphDist.hasEdgeDistances() && !knnGraph.hasEdgeDistances());
+    for (int i = 0; i < int(knnGraphDist.size()); ++i)
+    {
+        int j = 0;
+        for (int n : knnGraphDist.kNearestNeighbors(i))
+        {
+            VERIFY(n == knnGraph.samples()[i * k + j]);
+            VERIFY(knnGraphDist.edgeSquaredDistance(i, j) == (points[i].pos() - points[n].pos()).squaredNorm());
+            ++j;
+        }
+    }
+    timing = testRangeNeighbors<true>(knnGraphDist, points, sampleDense); // Index query test
+#ifdef PRINT_TIMING
+    cout << "    Compute Time " << name << " (with edge distances) index query : " << timing.count() << "ms" << endl;
+#endif
+
+    auto knngraphDistBuffers = knnGraphDist.buffers();
+    typename KnnGraphPointerStatic::Buffers knnGraphDistStaticBuffers{
+        knngraphDistBuffers.points.data(),    knngraphDistBuffers.indices.data(),
+        knngraphDistBuffers.distances.data(), knngraphDistBuffers.points_size,
+        knngraphDistBuffers.indices_size,     knngraphDistBuffers.distances_size,
+        k};
+    KnnGraphPointerStatic knnGraphDistStatic(knnGraphDistStaticBuffers);
+    timing = testRangeNeighbors<true>(knnGraphDistStatic, points, sampleDense); // Index query test
+#ifdef PRINT_TIMING
+    cout << "    Compute Time " << name << " (with edge distances and pointers) index query : " << timing.count()
+         << "ms" << endl;
+#endif
+    cout << "  (ok)" << endl;
+}
+
+//! \brief Reorder the points of a kdtree, and test the queries of the reordered kdtree and of its KnnGraph
+template <typename P, typename KdTree>
+void reorderAndTestStructures(KdTree kdtree, const std::string& name = "KdTree")
+{
+    const std::vector<P> points = kdtree.points();
+    const auto permutation      = kdtree.reorderPoints();
+
+    VERIFY(kdtree.valid());
+    VERIFY(int(permutation.size()) == kdtree.pointCount());
+    std::vector<P> reorderedPoints = kdtree.points();
+    for (int i = 0; i < kdtree.pointCount(); ++i)
+        VERIFY(reorderedPoints[i].pos() == points[permutation[i]].pos());
+
+    // Samples are now stored first, in the tree order
+    std::vector<int> sample(kdtree.sampleCount());
+    std::iota(sample.begin(), sample.end(), 0);
+    for (int i = 0; i < kdtree.sampleCount(); ++i)
+        VERIFY(kdtree.pointFromSample(i) == i);
+
+    std::chrono::milliseconds timing = testRangeNeighbors<true>(kdtree, reorderedPoints, sample); // Index query test
+#ifdef PRINT_TIMING
+    cout << "    Compute Time " << name << " (reordered) index query : " << timing.count() << "ms" << endl;
+#endif
+    timing = testRangeNeighbors<false>(kdtree, reorderedPoints, sample); // Position query test
+#ifdef PRINT_TIMING
+    cout << "    Compute Time " << name << " (reordered) position query : " << timing.count() << "ms" << endl;
+#endif
+    cout << "  (ok)" << endl;
+
+    if constexpr (!KdTree::SUPPORTS_SUBSAMPLING)
+        buildAndTestKnnGraph<P>(kdtree, sample, "KnnGraph (reordered)");
+}
+
+//! \brief Build a HashGrid and test the rangeNeighbors Query with default container type and raw memory pointers
+template <typename P>
+void buildAndTestHashGrid(std::vector<P>& points, std::vector<int>& sampleDense, const typename P::Scalar cellSize,
+                          const std::string& name = "HashGrid")
+{
+    HashGrid<P> grid(points, cellSize);
+    VERIFY(grid.pointCount() == int(points.size()) && grid.sampleCount() == int(points.size()));
+    VERIFY(grid.bucketOffsets()[grid.bucketCount()] == grid.sampleCount());
+    // The entries of each bucket are sorted by the key of their cell
+    for (int b = 0; b < grid.bucketCount(); ++b)
+        for (int e = grid.bucketOffsets()[b]; e < grid.bucketOffsets()[b + 1]; ++e)
+        {
+            using CellType      = typename HashGrid<P>::CellType;
+            const CellType cell = grid.cellCoordinates(points[grid.samples()[e]].pos())
+                                      .cwiseMax(0)
+                                      .cwiseMin(grid.cellCounts() - CellType::Ones());
+            VERIFY(grid.cellKeys()[e] == grid.cellKey(cell) && grid.bucketIndex(cell) == b);
+            VERIFY(e == grid.bucketOffsets()[b] || grid.cellKeys()[e - 1] <= grid.cellKeys()[e]);
+        }
+
+    std::chrono::milliseconds timing = testRangeNeighbors<true>(grid, points, sampleDense); // Index query test
+#ifdef PRINT_TIMING
+    cout << "    Compute Time " << name << " index query : " << timing.count() << "ms" << endl;
+#endif
+    timing = testRangeNeighbors<false>(grid, points, sampleDense); // Position query test
+#ifdef PRINT_TIMING
+    cout << "    Compute Time " << name << " position query : " << timing.count() << "ms" << endl;
+#endif
+
+    // Test the HashGrid with raw memory pointers
+    using HashGridPointerStatic = StaticHashGridBase<HashGridPointerTraits<P>>;
+    auto gridBuffers            = grid.buffers(); // Buffer that use STL-like containers
+    // Convert previous HashGrid to pointers
+    typename HashGridPointerStatic::Buffers gridStaticBuffers{
+        gridBuffers.points.data(),  gridBuffers.indices.data(), gridBuffers.keys.data(),
+        gridBuffers.offsets.data(), gridBuffers.points_size,    gridBuffers.indices_size,
+        gridBuffers.offsets_size,   gridBuffers.origin,         gridBuffers.cellSize,
+        gridBuffers.cellCounts};
+    HashGridPointerStatic gridStatic(gridStaticBuffers);
+    timing = testRangeNeighbors<false>(gridStatic, points, sampleDense); // Position query test
+#ifdef PRINT_TIMING
+    cout << "    Compute Time " << name << " (with pointers) position query : " << timing.count() << "ms" << endl;
+#endif
+
+    // Test the HashGrid with the points stored by cell
+    const auto permutation = grid.reorderPoints();
+    VERIFY(int(permutation.size()) == grid.pointCount());
+    std::vector<P> reorderedPoints = grid.points();
+    for (int i = 0; i < grid.pointCount(); ++i)
+        VERIFY(reorderedPoints[i].pos() == points[permutation[i]].pos() && grid.samples()[i] == i);
+    timing = testRangeNeighbors<true>(grid, reorderedPoints, sampleDense); // Index query test
+#ifdef PRINT_TIMING
+    cout << "    Compute Time " << name << " (reordered) index query : " << timing.count() << "ms" << endl;
 #endif
     cout << "  (ok)" << endl;
 }
@@ -139,11 +262,19 @@ void testRangeNeighborsForAllStructures(const bool quick = QUICK_TESTS)
     auto kdtreeDense = buildAndTestKdTree<KdTreeDense>(points, sampleDense);
 
     std::vector<int> sampleSparse;
-    buildAndTestKdTree<KdTreeSparse>(points, sampleSparse, "KdTreeSparse");
+    auto kdtreeSparse = buildAndTestKdTree<KdTreeSparse>(points, sampleSparse, "KdTreeSparse");
     testStaticKdTree<P>(kdtreeDense);
 
     ////////// Test KnnGraph
     buildAndTestKnnGraph<P>(kdtreeDense, sampleDense);
+
+    ////////// Test HashGrid, with cells smaller and larger than the query radius
+    buildAndTestHashGrid<P>(points, sampleDense, Scalar(0.1));
+    buildAndTestHashGrid<P>(points, sampleDense, Scalar(0.5), "HashGrid (large cells)");
+
+    ////////// Test reordered structures
+    reorderAndTestStructures<P>(kdtreeDense);
+    reorderAndTestStructures<P>(kdtreeSparse, "KdTreeSparse");
 }
 
 int main(const int argc, char** argv)
@@ -151,7 +282,7 @@ int main(const int argc, char** argv)
     if (!init_testing(argc, argv))
         return EXIT_FAILURE;
 
-    cout << "Test rangeNeighbors query for KdTree and KnnGraph in 3D : " << endl;
+    cout << "Test rangeNeighbors query for KdTree, KnnGraph and HashGrid in 3D : " << endl;
     cout << "  float : " << endl;
     CALL_SUBTEST_1((testRangeNeighborsForAllStructures<float, 3>()));
     cout << "  double : " << endl;
@@ -159,7 +290,7 @@ int main(const int argc, char** argv)
     cout << "  long : " << endl;
     CALL_SUBTEST_3((testRangeNeighborsForAllStructures<long double, 3>()));
 
-    cout << "Test rangeNeighbors query for KdTree and KnnGraph in 4D : " << endl;
+    cout << "Test rangeNeighbors query for KdTree, KnnGraph and HashGrid in 4D : " << endl;
     cout << "  float : " << endl;
     CALL_SUBTEST_1((testRangeNeighborsForAllStructures<float, 4>()));
     cout << "  double : " << endl;
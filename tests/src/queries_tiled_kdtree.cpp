@@ -0,0 +1,291 @@
+/*
+ This Source Code Form is subject to the terms of the Mozilla Public
+ License, v. 2.0. If a copy of the MPL was not distributed with this
+ file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+/*!
+ * \file tests/src/queries_tiled_kdtree.cpp
+ * \brief Test the construction of a TiledKdTree from streamed points, its range and k-nearest neighbors queries and
+ * its tile cache
+ */
+
+#include "../common/testing.h"
+#include "../common/testUtils.h"
+#include "../split_test_helper.h"
+
+#include <Ponca/src/Common/pointTypes.h>
+#include <Ponca/src/Fitting/basket.h>
+#include <Ponca/src/Fitting/orientedSphereFit.h>
+#include <Ponca/src/Fitting/weightFunc.h>
+#include <Ponca/src/Fitting/weightKernel.h>
+#include <Ponca/src/SpatialPartitioning/TiledKdTree/tiledKdTree.h>
+
+#include <algorithm>
+#include <atomic>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace std;
+using namespace Ponca;
+
+/// Sorted positions of the points of `_points` in the ball of radius `_r` around `_q`
+template <typename DataPoint>
+std::vector<typename DataPoint::VectorType> bruteForceRange(const std::vector<DataPoint>& _points,
+                                                            const typename DataPoint::VectorType& _q,
+                                                            typename DataPoint::Scalar _r)
+{
+    std::vector<typename DataPoint::VectorType> result;
+    for (const auto& p : _points)
+        if ((p.pos() - _q).squaredNorm() < _r * _r)
+            result.push_back(p.pos());
+    return result;
+}
+
+/// Lexicographic order of the positions, to compare sets of points
+template <typename VectorType>
+void sortPositions(std::vector<VectorType>& _positions)
+{
+    std::sort(_positions.begin(), _positions.end(), [](const VectorType& _a, const VectorType& _b) {
+        return std::lexicographical_compare(_a.data(), _a.data() + _a.size(), _b.data(), _b.data() + _b.size());
+    });
+}
+
+/// Check the queries against a brute force scan of the points
+template <typename DataPoint>
+void testQueries(const TiledKdTree<DataPoint>& _tree, const std::vector<DataPoint>& _points,
+                 typename DataPoint::Scalar _r, int _k)
+{
+    using Scalar     = typename DataPoint::Scalar;
+    using VectorType = typename DataPoint::VectorType;
+
+    const int nbQueries = QUICK_TESTS ? 20 : 50;
+    auto rangeQuery     = _tree.rangeNeighborsQuery();
+    auto knnQuery       = _tree.kNearestNeighborsQuery();
+    for (int i = 0; i < nbQueries; ++i)
+    {
+        const VectorType q = VectorType::Random();
+
+        std::vector<VectorType> expected = bruteForceRange(_points, q, _r);
+        sortPositions(expected);
+
+        std::vector<VectorType> positions;
+        for (const auto j : _tree.rangeNeighbors(q, _r))
+            positions.push_back(_tree.pointData(j).pos());
+        sortPositions(positions);
+        VERIFY(positions == expected);
+
+        // Mutable query
+        positions.clear();
+        for (const auto j : rangeQuery(q, _r))
+            positions.push_back(_tree.points()[j].pos());
+        sortPositions(positions);
+        VERIFY(positions == expected);
+
+        // The k-nearest neighbors have the k smallest distances, possibly crossing the tile boundaries
+        std::vector<Scalar> candidates;
+        for (const auto& p : _points)
+            candidates.push_back((p.pos() - q).squaredNorm());
+        std::sort(candidates.begin(), candidates.end());
+        candidates.resize(std::min(int(candidates.size()), _k));
+
+        std::vector<Scalar> distances;
+        auto& query = knnQuery(q, _k);
+        for (auto it = query.begin(); it != query.end(); ++it)
+        {
+            VERIFY(it.squaredDistance() == (_tree.pointData(*it).pos() - q).squaredNorm());
+            distances.push_back(it.squaredDistance());
+        }
+        std::sort(distances.begin(), distances.end());
+        VERIFY(distances == candidates);
+    }
+}
+
+/// Check that the tiles are evicted to respect the budget, and that the queries still return the same results
+template <typename DataPoint>
+void testCache(const std::string& _directory, const std::vector<DataPoint>& _points, typename DataPoint::Scalar _r,
+               int _k)
+{
+    // Room for about two tiles
+    const TiledKdTree<DataPoint> reference(_directory, std::numeric_limits<std::size_t>::max());
+    std::size_t tileBytes = 0;
+    for (int t = 0; t < reference.tileCount(); ++t)
+        tileBytes = std::max(tileBytes, reference.tile(t)->byteSize());
+    VERIFY(reference.cache().evictions() == 0 && int(reference.cache().size()) == reference.tileCount());
+
+    const TiledKdTree<DataPoint> tree(_directory, 2 * tileBytes);
+    testQueries(tree, _points, _r, _k);
+    VERIFY(tree.cache().residentBytes() <= tree.cache().budget());
+    VERIFY(tree.cache().evictions() > 0);
+    VERIFY(tree.cache().misses() == tree.cache().size() + tree.cache().evictions());
+    VERIFY(tree.cache().hits() > 0);
+}
+
+/// Tile of a fixed size, for the concurrent accesses to the cache
+struct SizedTile
+{
+    std::size_t bytes;
+    [[nodiscard]] std::size_t byteSize() const { return bytes; }
+};
+
+/// Check that each tile is loaded once by concurrent requests, and loaded again after a failed loading
+void testConcurrentCache()
+{
+    const int nbTiles    = 8;
+    const int nbRequests = QUICK_TESTS ? 1000 : 10000;
+    TileCache<SizedTile> cache(std::size_t(nbTiles * nbTiles));
+    std::vector<std::atomic<int>> loads(nbTiles);
+    for (auto& l : loads)
+        l = 0;
+
+#pragma omp parallel for
+    for (int i = 0; i < nbRequests; ++i)
+    {
+        const int id = i % nbTiles;
+        const auto tile = cache.get(std::size_t(id), [&loads, id]() {
+            ++loads[id];
+            return std::make_shared<SizedTile>(SizedTile{std::size_t(id + 1)});
+        });
+        VERIFY(tile->byteSize() == std::size_t(id + 1));
+    }
+    // The budget holds all the tiles: none is evicted, nor loaded twice
+    for (int id = 0; id < nbTiles; ++id)
+        VERIFY(loads[id] == 1);
+    VERIFY(cache.evictions() == 0 && cache.misses() == std::size_t(nbTiles));
+    VERIFY(cache.hits() == std::size_t(nbRequests - nbTiles));
+    VERIFY(cache.residentBytes() == std::size_t(nbTiles * (nbTiles + 1) / 2));
+
+    // A failed loading is not cached
+    bool thrown = false;
+    try
+    {
+        (void)cache.get(std::size_t(nbTiles), []() -> std::shared_ptr<SizedTile> { throw std::runtime_error(""); });
+    }
+    catch (const std::runtime_error&)
+    {
+        thrown = true;
+    }
+    VERIFY(thrown);
+    const auto tile = cache.get(std::size_t(nbTiles), []() { return std::make_shared<SizedTile>(SizedTile{1}); });
+    VERIFY(tile->byteSize() == 1);
+}
+
+/// Check that the fits run unchanged on the TiledKdTree queries
+template <typename Fit>
+void testFit(const TiledKdTree<typename Fit::DataPoint>& _tree, const std::vector<typename Fit::DataPoint>& _points,
+             typename Fit::Scalar _r)
+{
+    using VectorType = typename Fit::VectorType;
+    const int size   = QUICK_TESTS ? 20 : 100;
+
+#pragma omp parallel for
+    for (int i = 0; i < size; ++i)
+    {
+        const VectorType q = _points[i].pos();
+
+        //! [TiledKdTree fit]
+        Fit fit;
+        fit.setNeighborFilter({q, _r});
+        const FIT_RESULT res = fit.computeWithIds(_tree.rangeNeighbors(q, _r), _tree.points());
+        //! [TiledKdTree fit]
+
+        // Same neighbors, in the same order, copied in memory
+        std::vector<typename Fit::DataPoint> neighbors;
+        for (const auto j : _tree.rangeNeighbors(q, _r))
+            neighbors.push_back(_tree.pointData(j));
+        Fit reference;
+        reference.setNeighborFilter({q, _r});
+        VERIFY(reference.compute(neighbors) == res);
+        VERIFY(reference == fit);
+    }
+}
+
+template <typename Scalar>
+void callSubTests()
+{
+    using Point      = PointPositionNormal<Scalar, 3>;
+    using VectorType = typename Point::VectorType;
+    using Fit        = Basket<Point, DistWeightFunc<Point, SmoothWeightKernel<Scalar>>, OrientedSphereFit>;
+
+    const int nbPoints  = QUICK_TESTS ? 2000 : 5000;
+    const int nbBatches = 5;
+    const Scalar r      = Scalar(0.2);
+    const int k         = 15;
+
+    // Points in [-1,1]^3, on a sphere for the fits
+    std::vector<Point> points(nbPoints);
+    for (auto& p : points)
+    {
+        p.normal() = VectorType::Random().normalized();
+        p.pos()    = p.normal() * Scalar(0.9);
+    }
+
+    // The test parts may run concurrently, with the same seed
+    const std::string name      = "ponca_tiled_kdtree_" + std::to_string(sizeof(Scalar)) + "_" +
+                                  std::to_string(Eigen::internal::random<int>(0, 1 << 30));
+    const std::string directory = (std::filesystem::temp_directory_path() / name).string();
+    std::filesystem::create_directories(directory);
+
+    // Temporary files left by a previous build are overwritten
+    for (int key = 0; key < 5 * 5 * 5; ++key)
+        std::ofstream(directory + "/tile_" + std::to_string(key) + ".raw", std::ios::binary) << "stale";
+
+    //! [TiledKdTree construction]
+    // Tiles of size 0.5 over [-1,1]^3, the points being streamed by batches
+    Ponca::TiledKdTreeBuilder<Point> builder(directory, {VectorType::Constant(-1), VectorType::Constant(1)},
+                                             Scalar(0.5));
+    for (int b = 0; b < nbBatches; ++b)
+        builder.addPoints(std::vector<Point>(points.begin() + b * nbPoints / nbBatches,
+                                             points.begin() + (b + 1) * nbPoints / nbBatches));
+    builder.finalize();
+
+    // At most 64MB of tiles in memory
+    Ponca::TiledKdTree<Point> tree(directory, 64 << 20);
+    //! [TiledKdTree construction]
+
+    VERIFY(tree.pointCount() == nbPoints);
+    VERIFY(tree.tileCount() > 1 && tree.tileCount() <= 5 * 5 * 5);
+    for (int t = 0; t < tree.tileCount(); ++t)
+    {
+        VERIFY(tree.tilePointCount(t) > 0);
+        VERIFY(tree.tileOfIndex(tree.tileFirstIndex(t)) == t);
+        VERIFY(tree.tileOfIndex(tree.tileFirstIndex(t) + tree.tilePointCount(t) - 1) == t);
+        for (int i = 0; i < tree.tilePointCount(t); ++i)
+            VERIFY(tree.tileBounds(t).contains(tree.pointData(tree.tileFirstIndex(t) + i).pos()));
+    }
+
+    // The accessor pins the tile of the last point, and moves to the tile of the next one
+    const auto accessor = tree.points();
+    for (int i = 0; i < nbPoints; ++i)
+    {
+        const int j = i % 2 == 0 ? i : nbPoints - i;
+        VERIFY(accessor[j].pos() == tree.pointData(j).pos());
+    }
+
+    for (int i = 0; i < g_repeat; ++i)
+    {
+        CALL_SUBTEST((testQueries(tree, points, r, k)));
+        CALL_SUBTEST((testCache(directory, points, r, k)));
+        CALL_SUBTEST((testFit<Fit>(tree, points, r)));
+        CALL_SUBTEST((testConcurrentCache()));
+    }
+
+    std::filesystem::remove_all(directory);
+}
+
+int main(int argc, char** argv)
+{
+    if (!init_testing(argc, argv))
+    {
+        return EXIT_FAILURE;
+    }
+
+    cout << "Test the queries of the TiledKdTree..." << endl;
+    CALL_SUBTEST_1((callSubTests<float>()));
+    CALL_SUBTEST_2((callSubTests<double>()));
+    cout << "Ok!" << endl;
+}
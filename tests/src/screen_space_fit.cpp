@@ -0,0 +1,155 @@
+/*
+ This Source Code Form is subject to the terms of the Mozilla Public
+ License, v. 2.0. If a copy of the MPL was not distributed with this
+ file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+/*!
+ * \file tests/src/screen_space_fit.cpp
+ * \brief Test the screen-space GLS fits against a brute force fit over all the pixels
+ */
+
+#include "../common/testing.h"
+#include "../common/testUtils.h"
+#include "../split_test_helper.h"
+
+#include <Ponca/src/Fitting/basket.h>
+#include <Ponca/src/Fitting/covariancePlaneFit.h>
+#include <Ponca/src/Fitting/gls.h>
+#include <Ponca/src/Fitting/orientedSphereFit.h>
+#include <Ponca/src/Fitting/screenSpaceFit.h>
+#include <Ponca/src/Fitting/weightKernel.h>
+
+#include <vector>
+
+using namespace std;
+using namespace Ponca;
+
+/// Orthographic rendering of a sphere of radius `_radius` pixels, in front of a plane
+template <typename Point>
+ScreenSpaceBuffers<Point> renderSphere(int _size, typename Point::Scalar _radius)
+{
+    using Scalar     = typename Point::Scalar;
+    using VectorType = typename Point::VectorType;
+
+    const Scalar center = Scalar(_size) / 2;
+    std::vector<Point> points(size_t(_size) * _size);
+    for (int y = 0; y < _size; ++y)
+        for (int x = 0; x < _size; ++x)
+        {
+            const Scalar px = Scalar(x) - center, py = Scalar(y) - center;
+            const Scalar d2 = px * px + py * py;
+            if (d2 < _radius * _radius)
+            {
+                const VectorType pos(px, py, std::sqrt(_radius * _radius - d2));
+                points[y * _size + x] = {pos, pos / _radius, {Scalar(x), Scalar(y)}};
+            }
+            // The plane leaves a few background pixels in the corners
+            else if (d2 < Scalar(0.45) * _size * _size)
+                points[y * _size + x] = {VectorType(px, py, -_radius), VectorType::UnitZ(), {Scalar(x), Scalar(y)}};
+            else
+                points[y * _size + x] = {VectorType::Zero(), VectorType::Zero(), {Scalar(x), Scalar(y)}};
+        }
+    return ScreenSpaceBuffers<Point>(_size, _size, std::move(points));
+}
+
+/// Values compared between the fits: the GLS descriptor, or the plane and the surface variation of covariance fits.
+/// The covariance planes are not oriented, so their potential and normal are compared up to their sign
+template <typename Fit>
+Eigen::Matrix<typename Fit::Scalar, 3, 1> descriptor(const Fit& _fit)
+{
+    using Scalar = typename Fit::Scalar;
+    if constexpr (requires { _fit.kappa(); })
+        return {_fit.kappa(), _fit.tau(), Scalar(0)};
+    else
+        return {std::abs(_fit.potential()), std::abs(_fit.primitiveGradient().normalized().z()),
+                _fit.surfaceVariation()};
+}
+
+/// Compare the fits of screenSpaceFit with fits over all the pixels, where the filter rejects the pixels out of the
+/// window
+template <ScreenSpaceAccumulation accumulation, typename Fit>
+void testFit(const ScreenSpaceBuffers<typename Fit::DataPoint>& _buffers, int _scale,
+             typename Fit::Scalar _maxDepthDiff, int _tileSize)
+{
+    using Scalar       = typename Fit::Scalar;
+    const auto& points = _buffers.points();
+    const int n        = int(points.size());
+
+    using Descriptor   = Eigen::Matrix<Scalar, 3, 1>;
+    std::vector<Descriptor> descriptors(n, Descriptor::Zero());
+    std::vector<FIT_RESULT> status(n, UNDEFINED);
+    std::vector<int> visits(n, 0);
+    //! [ScreenSpaceFit]
+    screenSpaceFit<accumulation, Fit>(_buffers, _scale, _maxDepthDiff, _tileSize, [&](int _i, const Fit& _fit) {
+        ++visits[_i];
+        status[_i] = _fit.getCurrentState();
+        if (_fit.isStable())
+            descriptors[_i] = descriptor(_fit);
+    });
+    //! [ScreenSpaceFit]
+
+    // The accumulations by blocks and by moments sum the neighbors in a different order
+    const Scalar epsilon = accumulation == ScreenSpaceAccumulation::OneByOne
+                               ? Scalar(0)
+                               : std::sqrt(Eigen::NumTraits<Scalar>::dummy_precision());
+    const int step = QUICK_TESTS ? 7 : 1;
+#pragma omp parallel for
+    for (int i = 0; i < n; i += step)
+    {
+        VERIFY(visits[i] == (points[i].valid() ? 1 : 0));
+        if (!points[i].valid())
+            continue;
+
+        Fit reference;
+        reference.setNeighborFilter({points[i], Scalar(_scale), _maxDepthDiff});
+        VERIFY(reference.compute(points) == status[i]);
+        if (!reference.isStable())
+            continue;
+        const Descriptor expected = descriptor(reference);
+        VERIFY(((expected - descriptors[i]).array().abs() <= epsilon * (Scalar(1) + expected.array().abs())).all());
+    }
+}
+
+template <typename Scalar>
+void callSubTests()
+{
+    using Point          = ScreenSpacePoint<Scalar>;
+    using NeighborFilter = ScreenSpaceWeightFunc<Point, SmoothWeightKernel<Scalar>>;
+    using Fit            = Basket<Point, NeighborFilter, OrientedSphereFit, GLSParam>;
+    using PlaneFit       = Basket<Point, NeighborFilter, CovariancePlaneFit>;
+    static_assert(Fit::isBlockCompatible && Fit::isMomentCompatible && PlaneFit::isMomentCompatible);
+
+    const int size      = QUICK_TESTS ? 32 : 64;
+    const Scalar radius = Scalar(size) / 3;
+    const auto buffers  = renderSphere<Point>(size, radius);
+    const int scale     = Eigen::internal::random<int>(2, 6);
+    const int tileSize  = Eigen::internal::random<int>(3, 16);
+
+    for (int i = 0; i < g_repeat; ++i)
+    {
+        // Without depth threshold, the windows on the border of the sphere mix the sphere and the plane
+        for (const Scalar maxDepthDiff : {Scalar(0), radius / 4})
+        {
+            CALL_SUBTEST((testFit<ScreenSpaceAccumulation::OneByOne, Fit>(buffers, scale, maxDepthDiff, tileSize)));
+            CALL_SUBTEST((testFit<ScreenSpaceAccumulation::Blocks, Fit>(buffers, scale, maxDepthDiff, tileSize)));
+            CALL_SUBTEST((testFit<ScreenSpaceAccumulation::WindowRows, Fit>(buffers, scale, maxDepthDiff, tileSize)));
+            // The covariance fits also use the second order moments of the window rows
+            CALL_SUBTEST((testFit<ScreenSpaceAccumulation::OneByOne, PlaneFit>(buffers, scale, maxDepthDiff, 8)));
+            CALL_SUBTEST((testFit<ScreenSpaceAccumulation::WindowRows, PlaneFit>(buffers, scale, maxDepthDiff, 8)));
+        }
+    }
+}
+
+int main(int argc, char** argv)
+{
+    if (!init_testing(argc, argv))
+    {
+        return EXIT_FAILURE;
+    }
+
+    cout << "Test the screen-space fits..." << endl;
+    CALL_SUBTEST_1((callSubTests<float>()));
+    CALL_SUBTEST_2((callSubTests<double>()));
+    cout << "Ok!" << endl;
+}
@@ -89,6 +89,36 @@ void testFunction(typename Kernel::Scalar mmin = 0, typename Kernel::Scalar mmax
     }
 }
 
+/// Check that the kernel gives the same values when evaluated from the squared distance, also through DistWeightFunc
+template <class Kernel>
+void testSquaredEvaluation(typename Kernel::Scalar mmin = 0, typename Kernel::Scalar mmax = 1)
+{
+    using Scalar         = typename Kernel::Scalar;
+    using Point          = PointPositionNormal<Scalar, 3>;
+    using NeighborFilter = DistWeightFunc<Point, Kernel>;
+    using VectorType     = typename Point::VectorType;
+    static_assert(hasSquaredDistanceEvaluation<Kernel>);
+
+    Scalar step    = Scalar(0.05);
+    int n          = int((mmax - mmin) / Scalar(step));
+    Scalar epsilon = Scalar(10) * testEpsilon<Scalar>();
+
+    Kernel k;
+    const Scalar t          = Eigen::internal::random<Scalar>(Scalar(0.5), Scalar(2));
+    const VectorType center = VectorType::Random();
+    NeighborFilter filter(center, t);
+
+    for (int i = 1; i < n; ++i)
+    {
+        Scalar a = mmin + i * step;
+        VERIFY(Eigen::internal::isApprox(k.fSquared(a * a), k.f(a), epsilon));
+
+        Point q(center + VectorType::Random().normalized() * a * t, VectorType::Zero());
+        const Scalar x = (q.pos() - center).norm() / t;
+        VERIFY(Eigen::internal::isApprox(filter(q).first, k.f(x), epsilon));
+    }
+}
+
 template <typename W1, typename W2>
 void testKernelDiff(int nbSteps = 1000)
 {
@@ -146,6 +176,8 @@ void callSubTests(Scalar mmin = 0, Scalar mmax = 1)
     using ScalarDiff = Eigen::AutoDiffScalar<Eigen::Matrix<Scalar, 1, 1>>;
     using Kernel     = KernelT<Scalar>;
     CALL_SUBTEST((testFunction<Kernel>(mmin, mmax)));
+    if constexpr (hasSquaredDistanceEvaluation<Kernel>)
+        CALL_SUBTEST((testSquaredEvaluation<Kernel>(mmin, mmax)));
 
     cout << "ok" << endl;
 }
@@ -159,6 +191,12 @@ void callAutoDiffSubTests()
     cout << "ok" << endl;
 }
 
+template <typename Scalar>
+using QuarticCubeSmoothWeightKernel = PolynomialSmoothWeightKernel<Scalar, 3, 4>;
+
+template <typename Scalar>
+using OddSmoothWeightKernel = PolynomialSmoothWeightKernel<Scalar, 2, 3>;
+
 int main(int argc, char** argv)
 {
     if (!init_testing(argc, argv))
@@ -186,7 +224,16 @@ int main(int argc, char** argv)
 
     cout << "Verify Compact Exponential weight kernel derivatives" << endl;
     callSubTests<long double, CompactExpWeightKernel>();
-    /// autodiffs are not compatible with pow, used in this class
+    /// autodiffs are not compatible with pow, still used by CompactExpWeightKernel::ddf (the polynomial kernels below
+    /// use integer powers and are checked with autodiffs)
+
+    cout << "Verify generalised smooth weight kernel derivatives" << endl;
+    callSubTests<long double, QuarticCubeSmoothWeightKernel>();
+    callAutoDiffSubTests<long double, QuarticCubeSmoothWeightKernel>();
+    callSubTests<long double, OddSmoothWeightKernel>();
+    callAutoDiffSubTests<long double, OddSmoothWeightKernel>();
+    static_assert(!hasSquaredDistanceEvaluation<OddSmoothWeightKernel<double>>);
+    static_assert(!hasSquaredDistanceEvaluation<WendlandWeightKernel<double>>);
 
     // Testing Smooth / QuadSmooth kernel
     cout << "Verify generalised smooth weight kernel" << endl;